@@ -0,0 +1,36 @@
+include(FetchContent)
+
+message(STATUS "Configuring Basis Universal transcoder...")
+
+FetchContent_Declare(
+    basisu
+    GIT_REPOSITORY https://github.com/BinomialLLC/basis_universal.git
+    GIT_TAG        master
+    GIT_SHALLOW    TRUE
+)
+
+# Only the transcoder is needed, the project's own CMakeLists builds the
+# encoder and its command line tool so it is skipped.
+FetchContent_GetProperties(basisu)
+if(NOT basisu_POPULATED)
+    FetchContent_Populate(basisu)
+endif()
+
+add_library(basisu_transcoder STATIC
+    ${basisu_SOURCE_DIR}/transcoder/basisu_transcoder.cpp
+    ${basisu_SOURCE_DIR}/zstd/zstddeclib.c
+)
+
+target_include_directories(basisu_transcoder PUBLIC
+    ${basisu_SOURCE_DIR}/transcoder
+)
+
+# KTX2 with zstd is what UASTC files use for supercompression
+target_compile_definitions(basisu_transcoder PUBLIC
+    BASISD_SUPPORT_KTX2=1
+    BASISD_SUPPORT_KTX2_ZSTD=1
+)
+
+target_compile_features(basisu_transcoder PRIVATE cxx_std_17)
+
+message(STATUS " Basis Universal transcoder configured")
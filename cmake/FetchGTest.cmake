@@ -32,6 +32,14 @@ if(BUILD_TESTS)
 
         target_compile_features(${TEST_NAME} PRIVATE cxx_std_23)
 
+        # Tests pull the CPU only engine sources in directly
+        target_include_directories(${TEST_NAME} PRIVATE ${CMAKE_SOURCE_DIR}/src)
+
+        # SSSE3 is a given on MSVC x64, match it so the SIMD paths are tested
+        if(NOT MSVC AND CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64")
+            target_compile_options(${TEST_NAME} PRIVATE -mssse3)
+        endif()
+
         if(WIN32)
             target_compile_definitions(${TEST_NAME} PRIVATE
                 WIN32_LEAN_AND_MEAN
@@ -0,0 +1,17 @@
+include(FetchContent)
+
+message(STATUS "Configuring nlohmann/json...")
+
+# Same version the Windows build pulls in, for the CPU tests that dump
+# JSON on other platforms.
+FetchContent_Declare(
+    json
+    GIT_REPOSITORY https://github.com/nlohmann/json.git
+    GIT_TAG        v3.11.3
+    GIT_SHALLOW    TRUE
+)
+set(JSON_BuildTests OFF CACHE INTERNAL "")
+
+FetchContent_MakeAvailable(json)
+
+message(STATUS " nlohmann/json configured")
@@ -0,0 +1,20 @@
+include(FetchContent)
+
+message(STATUS "Configuring stb...")
+
+FetchContent_Declare(
+    stb
+    GIT_REPOSITORY https://github.com/nothings/stb.git
+    GIT_TAG        master
+    GIT_SHALLOW    TRUE
+)
+
+FetchContent_MakeAvailable(stb)
+
+# Header only, STB_IMAGE_IMPLEMENTATION lives in ImageDecoder.cpp and a
+# static STB_IMAGE_WRITE_IMPLEMENTATION in ImageEncoder.cpp (the tests that
+# encode on their own define it again).
+add_library(stb INTERFACE)
+target_include_directories(stb INTERFACE ${stb_SOURCE_DIR})
+
+message(STATUS " stb configured")
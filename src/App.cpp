@@ -18,7 +18,10 @@
 #include "ui/widgets/Outliner.h"
 #include "ui/widgets/TitleBar.h"
 #include "ui/widgets/Properties.h"
+#include "utils/FileUtils.h"
+#include "utils/MemoryTracker.h"
 #include "imgui.h"
+#include <format>
 
 #ifdef _WIN32
 #include <shellapi.h>
@@ -82,12 +85,32 @@ bool App::Initialize()
 	mSwapChain->Create(GetHwnd(), settings.windowWidth, settings.windowHeight, Graphics::gDevice,
 					   Graphics::gCommandListManager->GetCommandQueue());
 
+	// Every frame in flight records into its own context, the CPU only
+	// waits when it gets frameLatency frames ahead of the GPU.
+	CommandQueue& graphicsQueue = Graphics::gCommandListManager->GetGraphicsQueue();
+	Graphics::FrameQueue frameQueue;
+	frameQueue.mGetCompletedFence = [&graphicsQueue]() {
+		return graphicsQueue.GetCompletedFenceValue();
+	};
+	frameQueue.mWaitForFence = [&graphicsQueue](uint64_t fence) {
+		graphicsQueue.WaitForFence(fence);
+	};
+	mFrames = std::make_unique<Graphics::FrameRing<Graphics::GraphicsContext>>(
+		frameQueue,
+		[]() {
+			auto context = std::make_unique<Graphics::GraphicsContext>();
+			context->Create(Graphics::gDevice);
+			return context;
+		},
+		settings.frameLatency);
+	mLogger->info("Frame latency: {}", mFrames->GetLatency());
+
 	// Initialize UI system FIRST (Dear ImGui)
 	// Renderer needs UISystem for allocating viewport SRV from ImGui's descriptor heap
 	mUISystem = std::make_unique<UISystem>();
 	if (!mUISystem->Initialize(mWindow, Graphics::gDevice,
 							   Graphics::gCommandListManager->GetCommandQueue(),
-							   DXGI_FORMAT_R8G8B8A8_UNORM, 2))
+							   DXGI_FORMAT_R8G8B8A8_UNORM, mFrames->GetLatency()))
 	{
 		mLogger->error("Failed to initialize UI system");
 		return false;
@@ -96,6 +119,7 @@ bool App::Initialize()
 	mRenderer = std::make_unique<Renderer>();
 	mRenderer->Initialize(mUISystem.get());
 	mRenderer->SetViewport(settings.windowWidth, settings.windowHeight);
+	mRenderer->SetAsyncCompute(settings.asyncCompute);
 
 	// NOTE This is a slang test for shader test code, due for removal.
 	// SlangHelper::Compile();  // Commented out during SlangHelper refactoring
@@ -162,6 +186,8 @@ void App::Shutdown()
 		mRenderer.reset();
 	}
 
+	mFrames.reset();
+
 	if (mSwapChain)
 	{
 		mSwapChain->Shutdown();
@@ -217,6 +243,16 @@ bool App::ProcessEvent(const SDL_Event& event)
 			mRunning = false;
 			return true;
 		}
+		if (event.key.scancode == SDL_SCANCODE_F12 && mRenderer)
+		{
+			std::string path = std::format("captures/frame_{:04}.png", mCaptureCount);
+			if (mRenderer->CaptureFrame(path))
+			{
+				mCaptureCount++;
+				mLogger->info("Capturing frame to {}", path);
+			}
+			return true;
+		}
 		break;
 
 	case SDL_EVENT_WINDOW_RESIZED:
@@ -273,11 +309,13 @@ void App::Update(float deltaTime)
 	mRenderer->Update(deltaTime);
 }
 
-void App::Render(Graphics::GraphicsContext& context)
+void App::Render()
 {
-	if (!mSwapChain || !Graphics::gCommandListManager)
+	if (!mSwapChain || !mFrames || !Graphics::gCommandListManager)
 		return;
 
+	Graphics::GraphicsContext& context = mFrames->BeginFrame();
+
 	if (mUISystem)
 	{
 		mUISystem->NewFrame();
@@ -312,7 +350,9 @@ void App::Render(Graphics::GraphicsContext& context)
 
 	mSwapChain->Present();
 
-	queue.WaitForFence(fenceValue);
+	// No wait here, the next BeginFrame on this context does it if the
+	// GPU falls behind.
+	mFrames->EndFrame(fenceValue);
 }
 
 HWND App::GetHwnd() const
@@ -418,7 +458,10 @@ void App::RenderUI()
 	/// We are now checking which of the UI widgets state.
 	static bool isViewportOpen = true;
 	D3D12_GPU_DESCRIPTOR_HANDLE viewportSRV = mRenderer->GetViewportSRV();
-	UI::ViewportState viewportState = UI::ShowViewport(&isViewportOpen, viewportSRV);
+	// The part of the texture last frame's size settled on, the resize
+	// below only shows up from the next frame.
+	ImVec2 viewportUV(mRenderer->GetViewportUVWidth(), mRenderer->GetViewportUVHeight());
+	UI::ViewportState viewportState = UI::ShowViewport(&isViewportOpen, viewportSRV, viewportUV);
 	mViewportHovered = viewportState.isHovered;
 
 	/// Viewport
@@ -512,7 +555,28 @@ void App::RenderUI()
 		mRenderer->SetBlurIntensity(intensity);
 	};
 
+	propCallbacks.onDumpMemoryStats = [this]() {
+		const char* path = "memory_stats.json";
+		std::string json = Utils::DumpMemoryStatsJson();
+		if (Utils::WriteBinaryFile(path, json.data(), json.size()))
+		{
+			mLogger->info("Wrote memory stats to {}", path);
+		}
+		else
+		{
+			mLogger->error("Failed to write memory stats to {}", path);
+		}
+	};
+
+	const Utils::FrameArenaStats& arenaStats = mRenderer->GetFrameArenaStats();
+	UI::FrameStats frameStats;
+	frameStats.mHeapAllocations = mRenderer->GetFrameHeapAllocations();
+	frameStats.mArenaUsed = arenaStats.mUsed;
+	frameStats.mArenaCapacity = arenaStats.mCapacity;
+	frameStats.mArenaBlockAllocations = arenaStats.mBlockAllocations;
+
 	SpotLight* spotlight = mRenderer->GetSpotLight();
 	float blurIntensity = mRenderer->GetBlurIntensity();
-	UI::ShowProperties(&isPropertiesOpen, "", transform, propCallbacks, spotlight, &blurIntensity);
+	UI::ShowProperties(&isPropertiesOpen, "", transform, propCallbacks, spotlight, &blurIntensity,
+					   &frameStats);
 }
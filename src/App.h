@@ -8,6 +8,7 @@
 #include <wrl/client.h>
 #include <spdlog/spdlog.h>
 #include <imgui.h>
+#include "graphics/FrameRing.h"
 
 namespace Graphics
 {
@@ -46,9 +47,10 @@ public:
 	/// Iteratively calls at each tick update for the App class.
 	void Update(float deltaTime);
 
-	/// Renders a GraphicsContext object (has the command list,
-	/// allocator, root sig, PSO).
-	void Render(Graphics::GraphicsContext& context);
+	/// Records the frame into the next frame context (has the command
+	/// list, allocator, root sig, PSO) and submits it. Only blocks when
+	/// the GPU is more than the configured frame latency behind.
+	void Render();
 
 	/// Mainly for the swapchain so it know where to draw the
 	/// texture.
@@ -85,6 +87,10 @@ private:
 	/// UI system for Dear ImGui integration
 	std::unique_ptr<class UISystem> mUISystem;
 
+	/// One GraphicsContext (and so command allocator) per frame in
+	/// flight, see ConfigSettings::frameLatency.
+	std::unique_ptr<Graphics::FrameRing<Graphics::GraphicsContext>> mFrames;
+
 	/// Configuration manager for loading/saving settings
 	std::unique_ptr<class ConfigManager> mConfigManager;
 
@@ -92,6 +98,8 @@ private:
 	std::shared_ptr<spdlog::logger> mLogger;
 
 	uint64_t mLastTicks = 0;
+	/// F12 saves the viewport to captures/frame_NNNN.png.
+	uint32_t mCaptureCount = 0;
 	bool mRunning = true;
 	bool mInitialized = false;
 	bool mIsRotatingCamera = false;
@@ -6,9 +6,13 @@
 #include <utility>
 #include <vectormath.hpp>
 #include "Material.h"
+#include "graphics/ResourceRegistry.h"
 
 class Mesh;
 
+/// Resolved through the Renderer's mesh registry.
+using MeshHandle = Graphics::Handle<Mesh>;
+
 /// The transform "component" for the Entity class.
 struct TransformEntity
 {
@@ -36,7 +40,7 @@ public:
 	uint32_t GetId() const { return mId; }
 
 	const std::string& GetName() const { return mName; }
-	std::shared_ptr<Mesh> GetMesh() const { return mMesh; }
+	MeshHandle GetMesh() const { return mMesh; }
 
 	bool IsVisible() const { return mVisible; }
 	bool IsSelected() const { return mSelected; }
@@ -50,7 +54,7 @@ public:
 
 	void SetVisible(bool visible) { mVisible = visible; }
 	void SetSelected(bool selected) { mSelected = selected; }
-	void SetMesh(std::shared_ptr<Mesh> mesh) { mMesh = std::move(mesh); }
+	void SetMesh(MeshHandle mesh) { mMesh = mesh; }
 
 	uint32_t GetRenderFlags() const { return mRenderFlags; }
 	void SetRenderFlags(uint32_t flags) { mRenderFlags = flags; }
@@ -70,7 +74,7 @@ private:
 	bool mSelected = false;
 
 	TransformEntity mTransform;
-	std::shared_ptr<Mesh> mMesh;
+	MeshHandle mMesh;
 	Material mMaterial;
 
 	uint32_t mRenderFlags = CASTS_SHADOWS | RECEIVES_SHADOWS;
@@ -82,7 +82,7 @@ public:
 	Float2 padding;
 };
 
-// 96 byte struct LightingConstants
+// 256 byte struct LightingConstants
 struct LightingConstants
 {
 public:
@@ -93,4 +93,14 @@ public:
 
 	Float3 ambientLight;
 	float padding{};
+
+	/// Diffuse irradiance of the environment as SH9, already divided by
+	/// pi. Only xyz is used, w keeps the float4 array layout.
+	Vector4 shIrradiance[9]; // 144 bytes
+
+	/// Mips in the prefiltered environment cube, the last one is roughness 1.
+	float prefilteredMipCount{};
+	/// 0 falls back to the flat ambientLight.
+	uint32_t hasEnvironment{};
+	Float2 environmentPadding;
 };
@@ -2,6 +2,8 @@
 
 #include "graphics/Texture.h"
 #include "graphics/Constants.h"
+#include "graphics/ResourceRegistry.h"
+#include "MaterialAsset.h"
 #include "vectormath.hpp"
 #include "Lighting.h"
 #include <cstdint>
@@ -11,22 +13,26 @@
 /// Metallic, Roughness, AO, and Albedo.
 struct Material
 {
-	std::shared_ptr<Texture> mAlbedoTexture;
+	TextureHandle mAlbedoTexture;
 	Vector4 mAlbedoColor = Vector4(1.0F, 1.0F, 1.0F, 1.0F);
 
-	std::shared_ptr<Texture> mNormalTexture;
+	TextureHandle mNormalTexture;
 	float mNormalStrength = 1.0F;
 
-	std::shared_ptr<Texture> mMetallicTexture;
+	TextureHandle mMetallicTexture;
 	float mMetallicFactor = 0.0F;
 
-	std::shared_ptr<Texture> mRoughnessTexture;
+	TextureHandle mRoughnessTexture;
 	float mRoughnessFactor = 0.5F;
 
-	std::shared_ptr<Texture> mAmbientOcclusionTexture;
+	TextureHandle mAmbientOcclusionTexture;
 	float mAmbientOcclusionFactor = 1.0F;
 
-	std::shared_ptr<Texture> mEmissiveTexture;
+	TextureHandle mEmissiveTexture;
+
+	/// Packed occlusion/roughness/metallic, replaces the three separate
+	/// maps when set (see MaterialAsset::ormTexture).
+	TextureHandle mOrmTexture;
 	//NOTE Does this break with Vector3 ?
 	Float3 mEmissiveFactor = Float3(0.0F, 0.0F, 0.0F);
 
@@ -48,6 +54,13 @@ struct Material
 
 	ShaderType mShaderType = PBR;
 
+	/// Atlas regions of the sampled maps, see TextureRegion.
+	TextureRegion mAlbedoRegion;
+	TextureRegion mNormalRegion;
+	TextureRegion mMetallicRegion;
+	TextureRegion mRoughnessRegion;
+	TextureRegion mOrmRegion;
+
 	/// For use in the constant buffer uploads since the
 	/// PBR shader needs it.
 	MaterialConstants ToGPUConstants() const
@@ -68,6 +81,13 @@ struct Material
 		gpu.mHasRoughnessTexture = mRoughnessTexture ? 1 : 0;
 		gpu.mHasAmbientOcclusionTexture = mAmbientOcclusionTexture ? 1 : 0;
 		gpu.mHasEmissiveTexture = mEmissiveTexture ? 1 : 0;
+		gpu.mHasOrmTexture = mOrmTexture ? 1 : 0;
+
+		gpu.mAlbedoUVTransform = mAlbedoRegion.ToUVTransform();
+		gpu.mNormalUVTransform = mNormalRegion.ToUVTransform();
+		gpu.mMetallicUVTransform = mMetallicRegion.ToUVTransform();
+		gpu.mRoughnessUVTransform = mRoughnessRegion.ToUVTransform();
+		gpu.mOrmUVTransform = mOrmRegion.ToUVTransform();
 
 		return gpu;
 	}
@@ -1,23 +1,48 @@
 #pragma once
 #include <string>
-#include <memory>
+#include "graphics/ResourceRegistry.h"
 #include "vectormath.hpp"
 #include "Lighting.h"
 
 class Texture;
 
+/// Resolved through the Renderer's texture registry.
+using TextureHandle = Graphics::Handle<Texture>;
+
+/// Part of a texture a material map uses. The whole texture unless the
+/// map was packed into an atlas page with other small maps.
+struct TextureRegion
+{
+	Float2 uvScale = Float2(1.0f, 1.0f);
+	Float2 uvOffset = Float2(0.0f, 0.0f);
+
+	Vector4 ToUVTransform() const { return Vector4(uvScale.x, uvScale.y, uvOffset.x, uvOffset.y); }
+};
+
 /// For use in the Renderer to get the data needed for
 /// some material, e.g. LoadMaterialAsset(std::string s)
 struct MaterialAsset
 {
 	std::string name;
 
-	std::shared_ptr<Texture> albedoTexture;
-	std::shared_ptr<Texture> normalTexture;
-	std::shared_ptr<Texture> metallicTexture;
-	std::shared_ptr<Texture> roughnessTexture;
-	std::shared_ptr<Texture> aoTexture;
-	std::shared_ptr<Texture> emissiveTexture;
+	TextureHandle albedoTexture;
+	TextureHandle normalTexture;
+	TextureHandle metallicTexture;
+	TextureHandle roughnessTexture;
+	TextureHandle aoTexture;
+	TextureHandle emissiveTexture;
+	/// Occlusion, roughness and metallic packed into R, G and B. Cooked
+	/// from the separate maps when they can be decoded (or given directly
+	/// as "orm" in the json), the separate textures stay null then.
+	TextureHandle ormTexture;
+
+	TextureRegion albedoRegion;
+	TextureRegion normalRegion;
+	TextureRegion metallicRegion;
+	TextureRegion roughnessRegion;
+	TextureRegion aoRegion;
+	TextureRegion emissiveRegion;
+	TextureRegion ormRegion;
 
 	Vector4 albedoColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
 	Float3 emissiveFactor = Float3(0.0f, 0.0f, 0.0f);
@@ -166,18 +166,18 @@ bool Mesh::LoadFromOBJ(const std::string& filepath)
 	return true;
 }
 
-void Mesh::UploadToGPU()
+bool Mesh::RecordUpload(Graphics::CommandContext& context)
 {
 	if (mIsUploaded)
 	{
 		mLogger->info("Already uploaded to GPU");
-		return;
+		return true;
 	}
 
 	if (mVertices.empty() || mIndices.empty())
 	{
 		mLogger->error("No mesh data to upload");
-		return;
+		return false;
 	}
 
 	mLogger->info("Uploading mesh to GPU...");
@@ -191,38 +191,68 @@ void Mesh::UploadToGPU()
 
 	// The basic steps for uploading:
 	// - Create UploadBuffer and Initialize it
-	// - Use a GraphicsContext temp variable
 	// - CopyResource the data buffer to upload buffer
 	// - Transition
-	// - Execute
-	UploadBuffer vertexUpload;
-	vertexUpload.Initialize(mVertices.data(), vertexBufferSize);
+	// The upload buffers stay alive until ClearUploadBuffers, after the
+	// copy has finished.
+	mVertexUpload = std::make_unique<UploadBuffer>();
+	mVertexUpload->Initialize(mVertices.data(), vertexBufferSize);
+
+	mIndexUpload = std::make_unique<UploadBuffer>();
+	mIndexUpload->Initialize(mIndices.data(), indexBufferSize);
+
+	// Since UploadBuffer the CPU can write, we copy over the Upload to the
+	// faster GPU only.
+	context.GetCommandList()->CopyResource(mVertexBuffer.GetResource(),
+										   mVertexUpload->GetResource());
+
+	context.GetCommandList()->CopyResource(mIndexBuffer.GetResource(),
+										   mIndexUpload->GetResource());
 
-	UploadBuffer indexUpload;
-	indexUpload.Initialize(mIndices.data(), indexBufferSize);
+	// On a copy context the buffers are left in COMMON and get promoted
+	// by the graphics queue.
+	context.TransitionResource(mVertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+	context.TransitionResource(mIndexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+
+	mIsUploaded = true;
+	return true;
+}
+
+size_t Mesh::GetUploadSize() const
+{
+	return mVertices.size() * sizeof(Vertex) + mIndices.size() * sizeof(uint32_t);
+}
+
+void Mesh::ClearUploadBuffers()
+{
+	mVertexUpload.reset();
+	mIndexUpload.reset();
+}
+
+void Mesh::UploadToGPU()
+{
+	if (mIsUploaded)
+	{
+		mLogger->info("Already uploaded to GPU");
+		return;
+	}
 
 	// Create temporary context for copy.
 	Graphics::GraphicsContext copyContext;
 	copyContext.Create(Graphics::gDevice);
 	copyContext.Begin();
 
-	// Since UploadBuffer the CPU can write, we copy over the Upload to the
-	// faster GPU only.
-	copyContext.GetCommandList()->CopyResource(mVertexBuffer.GetResource(),
-											   vertexUpload.GetResource());
-
-	copyContext.GetCommandList()->CopyResource(mIndexBuffer.GetResource(),
-											   indexUpload.GetResource());
-
-	copyContext.TransitionResource(mVertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
-	copyContext.TransitionResource(mIndexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+	if (!RecordUpload(copyContext))
+	{
+		return;
+	}
 
 	copyContext.Flush();
 	CommandQueue& queue = Graphics::gCommandListManager->GetGraphicsQueue();
 	uint64_t fenceValue = queue.ExecuteCommandList(copyContext.GetCommandList());
 	queue.WaitForFence(fenceValue);
 
-	mIsUploaded = true;
+	ClearUploadBuffers();
 	mLogger->info("Upload complete");
 }
 
@@ -2,11 +2,18 @@
 
 #include "Vertex.h"
 #include "graphics/GpuBuffer.h"
+#include "graphics/UploadBuffer.h"
+#include "utils/MemoryTracker.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <spdlog/spdlog.h>
 
+namespace Graphics
+{
+	class CommandContext;
+}
+
 /// Holds all mesh geometry data including buffers and
 /// the CPU/GPU side data for its Vertices.
 class Mesh
@@ -21,30 +28,51 @@ public:
 	bool LoadFromOBJ(const std::string& filepath);
 
 	/// Creates the internal GpuBuffers, only after the vertices
-	/// are loaded.
+	/// are loaded. Blocks until the GPU has the data.
 	void UploadToGPU(); // NOTE: should call from the LoadFromOBJ?
 
+	/// Creates the GpuBuffers and records their copies into context (a
+	/// copy queue context works) without executing anything. Call
+	/// ClearUploadBuffers once the copy has finished.
+	bool RecordUpload(Graphics::CommandContext& context);
+	void ClearUploadBuffers();
+
+	/// Vertex plus index bytes.
+	size_t GetUploadSize() const;
+
+	/// The copies have been recorded, the mesh can be drawn from the next
+	/// graphics submit on.
+	bool IsUploaded() const { return mIsUploaded; }
+
 	const GpuBuffer& GetVertexBuffer() const { return mVertexBuffer; }
 	const GpuBuffer& GetIndexBuffer() const { return mIndexBuffer; }
 	uint32_t GetIndexCount() const { return mIndexCount; }
 	uint32_t GetVertexCount() const { return mVertexCount; }
 
-	const std::vector<Vertex>& GetVertices() const { return mVertices; }
-	const std::vector<uint32_t>& GetIndices() const { return mIndices; }
+	/// CPU copies are charged to Mesh.CPU.
+	using VertexVector = Utils::TaggedVector<Vertex, Utils::MemoryTag::MESH_CPU>;
+	using IndexVector = Utils::TaggedVector<uint32_t, Utils::MemoryTag::MESH_CPU>;
+
+	const VertexVector& GetVertices() const { return mVertices; }
+	const IndexVector& GetIndices() const { return mIndices; }
 
 	void ComputeBoundingBox();
 
 private:
 	void InitLogger();
 
-	std::vector<Vertex> mVertices;
-	std::vector<uint32_t> mIndices;
+	VertexVector mVertices;
+	IndexVector mIndices;
 	uint32_t mVertexCount = 0;
 	uint32_t mIndexCount = 0;
 
 	GpuBuffer mVertexBuffer;
 	GpuBuffer mIndexBuffer;
 
+	/// Staging for RecordUpload, null once cleared.
+	std::unique_ptr<UploadBuffer> mVertexUpload;
+	std::unique_ptr<UploadBuffer> mIndexUpload;
+
 	/// Tracking the upload state since loading another mesh
 	/// will cause issues.
 	bool mIsUploaded = false;
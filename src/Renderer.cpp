@@ -6,9 +6,20 @@
 #include "graphics/CommandContext.h"
 #include "graphics/CommandListManager.h"
 #include "graphics/ColorBuffer.h"
+#include "graphics/ResidencyManager.h"
 #include "graphics/UploadBuffer.h"
+#include "graphics/texture/AtlasPacker.h"
+#include "graphics/texture/IBLBaker.h"
+#include "graphics/texture/ImageDecoder.h"
+#include "utils/FileUtils.h"
+#include "utils/Hash.h"
+#include "utils/HeapCounter.h"
+#include "utils/ThreadPool.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include <d3dx12/d3dx12.h>
+#include <algorithm>
+#include <chrono>
+#include <format>
 #include <numbers>
 #include <cstddef>
 #include <DirectXMesh.h>
@@ -22,6 +33,16 @@
 
 using namespace Graphics;
 
+namespace
+{
+	// Interned once, the passes look their pipelines up by these every
+	// frame.
+	const Utils::StringId GEOMETRY_PASS_SHADER("GeometryPass");
+	const Utils::StringId LIGHTING_PASS_SHADER("LightingPass");
+	const Utils::StringId BLUR_HORIZONTAL_SHADER("BlurHorizontal");
+	const Utils::StringId BLUR_VERTICAL_SHADER("BlurVertical");
+} // namespace
+
 void Renderer::InitLogger()
 {
 	if (!mLogger)
@@ -55,29 +76,26 @@ void Renderer::Initialize(UISystem* uiSystem)
 				  offsetof(LightingConstants, numActiveLights));
 	mLogger->info("\toffsetof(ambientLight) = {} bytes", offsetof(LightingConstants, ambientLight));
 	mLogger->info("\toffsetof(padding) = {} bytes", offsetof(LightingConstants, padding));
+	mLogger->info("\toffsetof(shIrradiance) = {} bytes", offsetof(LightingConstants, shIrradiance));
+	mLogger->info("\toffsetof(prefilteredMipCount) = {} bytes",
+				  offsetof(LightingConstants, prefilteredMipCount));
 
-	static_assert(sizeof(LightingConstants) == 96, "LightingConstants size mismatch with Slang");
+	static_assert(sizeof(LightingConstants) == 256, "LightingConstants size mismatch with Slang");
 	static_assert(sizeof(SpotLight) == 64, "SpotLight size mismatch with Slang");
 
-	// Initialize constant buffers.
-	const uint32_t CONSTANT_BUFFER_SIZE = ((sizeof(Transform) + 255U) & ~255U) * 64;
-	mConstantUploadBuffer.Initialize(CONSTANT_BUFFER_SIZE);
-
-	const uint32_t MATERIAL_BUFFER_SIZE = ((sizeof(MaterialConstants) + 255U) & ~255U) * 64;
-	mMaterialUploadBuffer.Initialize(MATERIAL_BUFFER_SIZE);
-
-	// Clear the material buffer to prevent garbage data
-	{
-		MaterialConstants zeroMat = {};
-		const uint32_t MATERIAL_ALIGNMENT = (sizeof(MaterialConstants) + 255U) & ~255U;
-		for (uint32_t i = 0; i < 64; ++i)
-		{
-			mMaterialUploadBuffer.Copy(&zeroMat, sizeof(MaterialConstants), i * MATERIAL_ALIGNMENT);
-		}
-	}
-
-	const uint32_t LIGHTING_BUFFER_SIZE = (sizeof(LightingConstants) + 255U) & ~255U;
-	mLightingUploadBuffer.Initialize(LIGHTING_BUFFER_SIZE);
+	// Per draw and per pass constants come out of persistently mapped
+	// upload pages, one more gets chained whenever a frame needs it and
+	// they are reused once the GPU is past the frames that wrote them.
+	mDynamicConstants = std::make_unique<Graphics::RingAllocator>(
+		[](size_t size, Graphics::RingPage& page) {
+			auto buffer = std::make_shared<UploadBuffer>();
+			buffer->Initialize(static_cast<UINT>(size));
+			page.mCpuAddress = static_cast<uint8_t*>(buffer->GetMappedData());
+			page.mGpuAddress = buffer->GetGpuVirtualAddress();
+			page.mSize = size;
+			page.mResource = buffer;
+			return page.mCpuAddress != nullptr;
+		});
 
 	mConstants.wvp = Matrix4::identity();
 	mConstants.world = Matrix4::identity();
@@ -88,6 +106,7 @@ void Renderer::Initialize(UISystem* uiSystem)
 	mLightingConstants.eyePosition = Float3(0.0F, 0.0F, -20.0F);
 	mLightingConstants.numActiveLights = 0;
 	mLightingConstants.ambientLight = Float3(0.1F, 0.1F, 0.1F);
+	mLightingConstants.hasEnvironment = 0;
 
 	// The lights data are better suited with StructuredBuffers since the array
 	// is not fixed.
@@ -108,27 +127,24 @@ void Renderer::Initialize(UISystem* uiSystem)
 
 	mScene = std::make_unique<Scene>();
 
+	// The loads below queue their copies with the upload scheduler, or
+	// stream them through mTextureLoader.
+	InitUploadBatch();
+	InitTextureLoader();
+
 	// ---
 	//NOTE Due to remove as it is hard coded.
 	// Loading materials
 	auto mesh = LoadMesh("assets/ball.obj");
-	MaterialAsset plasticMat = LoadMaterialAsset("green_plastic");
-	MaterialAsset rustMat = LoadMaterialAsset("rust");
-	MaterialAsset goldMat = LoadMaterialAsset("gold");
-	MaterialAsset stoneMat = LoadMaterialAsset("stone");
-	MaterialAsset woodMat = LoadMaterialAsset("wooden_gate");
-	MaterialAsset brushedMetalMat = LoadMaterialAsset("brushed_metal");
+	std::vector<std::string> materialNames = {"green_plastic", "rust",	"wooden_gate",
+											  "gold",		   "stone", "brushed_metal"};
+	std::vector<MaterialAsset> materials = LoadMaterialAssets(materialNames);
 
 	if (mesh)
 	{
 		const float SPACING = 20.0F;
 		const float VERTICAL_SPACING = 20.0F;
 
-		std::vector<MaterialAsset*> materials = {&plasticMat, &rustMat,	 &woodMat,
-												 &goldMat,	  &stoneMat, &brushedMetalMat};
-		std::vector<std::string> materialNames = {"green_plastic", "rust",	"wooden_gate",
-												  "gold",		   "stone", "brushed_metal"};
-
 		for (size_t i = 0; i < 6; ++i)
 		{
 			std::string name = "Sphere_" + materialNames[i];
@@ -143,17 +159,23 @@ void Renderer::Initialize(UISystem* uiSystem)
 				float posZ = static_cast<float>(row) * VERTICAL_SPACING;
 				entity->GetTransform().position = Vector3(posX, 0.0F, posZ);
 
-				MaterialAsset* mat = materials[i];
+				MaterialAsset* mat = &materials[i];
 				entity->GetMaterial().mAlbedoTexture = mat->albedoTexture;
 				entity->GetMaterial().mNormalTexture = mat->normalTexture;
 				entity->GetMaterial().mMetallicTexture = mat->metallicTexture;
 				entity->GetMaterial().mRoughnessTexture = mat->roughnessTexture;
 				entity->GetMaterial().mAmbientOcclusionTexture = mat->aoTexture;
+				entity->GetMaterial().mOrmTexture = mat->ormTexture;
 				entity->GetMaterial().mAlbedoColor = mat->albedoColor;
 				entity->GetMaterial().mMetallicFactor = mat->metallicFactor;
 				entity->GetMaterial().mRoughnessFactor = mat->roughnessFactor;
 				entity->GetMaterial().mNormalStrength = mat->normalStrength;
 				entity->GetMaterial().mAmbientOcclusionFactor = mat->aoStrength;
+				entity->GetMaterial().mAlbedoRegion = mat->albedoRegion;
+				entity->GetMaterial().mNormalRegion = mat->normalRegion;
+				entity->GetMaterial().mMetallicRegion = mat->metallicRegion;
+				entity->GetMaterial().mRoughnessRegion = mat->roughnessRegion;
+				entity->GetMaterial().mOrmRegion = mat->ormRegion;
 			}
 		}
 	}
@@ -169,33 +191,49 @@ void Renderer::Initialize(UISystem* uiSystem)
 	mLogger->info("Textures using bindless heap with {} descriptors",
 				  Graphics::gBindlessAllocator->GetHeapSize());
 #else
-	mMaterialCBVStart = mTextureHeap.Alloc(MAX_MATERIALS);
-
-	const uint32_t MATERIAL_BUFFER_ALIGNMENT = (sizeof(MaterialConstants) + 255U) & ~255U;
-	for (uint32_t i = 0; i < MAX_MATERIALS; ++i)
-	{
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-		cbvDesc.BufferLocation =
-			mMaterialUploadBuffer.GetGpuVirtualAddress() +
-			(static_cast<D3D12_GPU_VIRTUAL_ADDRESS>(i * MATERIAL_BUFFER_ALIGNMENT));
-		cbvDesc.SizeInBytes = MATERIAL_BUFFER_ALIGNMENT;
-
-		D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = mMaterialCBVStart.GetCpuHandle();
-		cpuHandle.ptr +=
-			static_cast<SIZE_T>(i * Graphics::gDevice->GetDescriptorHandleIncrementSize(
-										D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-		Graphics::gDevice->CreateConstantBufferView(&cbvDesc, cpuHandle);
-	}
-
 	// Allocate space for material texture SRVs
 	// Recall 4 srv, albedo, normal, mellatic, roughness
 	mMaterialTextureSRVStart = mTextureHeap.Alloc(MAX_MATERIALS * 4);
+	Graphics::DescriptorTableCacheDesc tableDesc;
+	tableDesc.mCapacity = MAX_MATERIALS;
+	tableDesc.mWriteTable = [this](uint32_t table, const Graphics::DescriptorTableKey& key)
+	{
+		WriteMaterialTable(table, key);
+	};
+	mMaterialTables = std::make_unique<Graphics::DescriptorTableCache>(tableDesc);
+
+	// Allocate 7 descriptors for the lighting pass
+	// Recall Albedo/AO, Normal/Rough, Metallic, Emissive, Depth, Environment, BRDF LUT
+	mGBufferSRVStart = mTextureHeap.Alloc(7);
 
-	// Allocate 5 descriptors for GBuffer textures
-	// Recall Albedo/AO, Normal/Rough, Metallic, Emissive, Depth
-	mGBufferSRVStart = mTextureHeap.Alloc(5);
+	// Null environment until LoadEnvironment fills these in.
+	{
+		const UINT descriptorSize = Graphics::gDevice->GetDescriptorHandleIncrementSize(
+			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		D3D12_CPU_DESCRIPTOR_HANDLE iblHandle = mGBufferSRVStart.GetCpuHandle();
+		iblHandle.ptr += static_cast<SIZE_T>(5 * descriptorSize);
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
+		nullSrvDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+		nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+		nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		nullSrvDesc.TextureCube.MipLevels = 1;
+		Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, iblHandle);
+		iblHandle.ptr += descriptorSize;
+
+		nullSrvDesc = {};
+		nullSrvDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
+		nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		nullSrvDesc.Texture2D.MipLevels = 1;
+		Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, iblHandle);
+	}
 #endif
 
+	InitQueueScheduler();
+	InitFrameCapture();
+	LoadEnvironment(L"assets/environment.hdr");
+
 	mSamplerHandle = mSamplerHeap.Alloc(1);
 	D3D12_SAMPLER_DESC samplerDesc = {};
 	samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
@@ -209,89 +247,82 @@ void Renderer::Initialize(UISystem* uiSystem)
 	samplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
 	Graphics::gDevice->CreateSampler(&samplerDesc, mSamplerHandle.GetCpuHandle());
 
-	// Offscreen viewport render target, allow UAV
-	mViewportTexture = std::make_unique<ColorBuffer>();
-	mViewportTexture->Create(L"ViewportTexture", mViewportWidth, mViewportHeight, 1,
-							 DXGI_FORMAT_R8G8B8A8_UNORM, true);
-
-	// Post process blur after, allow UAV
-	mBlurTempTexture = std::make_unique<ColorBuffer>();
-	mBlurTempTexture->Create(L"BlurTempTexture", mViewportWidth, mViewportHeight, 1,
-							 DXGI_FORMAT_R8G8B8A8_UNORM, true);
-
-	// Depth buffer for viewport
-	mViewportDepth = std::make_unique<DepthBuffer>();
-	mViewportDepth->Create(L"ViewportDepth", mViewportWidth, mViewportHeight,
-						   DXGI_FORMAT_D32_FLOAT);
-	mViewportDepth->CreateView(Graphics::gDevice);
-
-	// GBuffer for deferred rendering
-	mGBuffer = std::make_unique<GBuffer>();
-	mGBuffer->Create(mViewportWidth, mViewportHeight);
-	mLogger->info("GBuffer created: {}x{}", mViewportWidth, mViewportHeight);
-
-	// G BUFFER SRV
-#ifdef ENABLE_BINDLESS
-	// Create SRVs in bindless heap for GBuffer textures
-	// These are needed for the lighting pass to sample from GBuffer
-	mGBuffer->GetRenderTarget0().CreateSRV({});
-	mGBuffer->GetRenderTarget1().CreateSRV({});
-	mGBuffer->GetRenderTarget2().CreateSRV({});
-	mGBuffer->GetRenderTarget3().CreateSRV({});
-	mGBuffer->GetDepthBuffer().CreateSRV({});
-#else
-	// Create SRVs for GBuffer textures lighting pass sampling
-	UINT descriptorSize =
-		Graphics::gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = mGBufferSRVStart.GetCpuHandle();
-
-	mGBuffer->GetRenderTarget0().CreateSRV(srvHandle);
-	srvHandle.ptr += descriptorSize;
-
-	mGBuffer->GetRenderTarget1().CreateSRV(srvHandle);
-	srvHandle.ptr += descriptorSize;
-
-	mGBuffer->GetRenderTarget2().CreateSRV(srvHandle);
-	srvHandle.ptr += descriptorSize;
-
-	mGBuffer->GetRenderTarget3().CreateSRV(srvHandle);
-	srvHandle.ptr += descriptorSize;
-
-	mGBuffer->GetDepthBuffer().CreateSRV(srvHandle);
-#endif
-
-	// SRV for ImGui to sample the viewport texture
+	// SRVs for ImGui to sample the viewport textures, two per texture so
+	// a new one never overwrites one the UI of a frame in flight uses.
 	// NOTE: Allocate from ImGui's heap so it can reference it when rendering
-	mViewportSRV = uiSystem->AllocateDescriptor(1);
-	mViewportTexture->CreateSRV(mViewportSRV.GetCpuHandle());
+	for (DescriptorHandle& srv : mViewportSRVs)
+	{
+		srv = uiSystem->AllocateDescriptor(1);
+	}
 
-	// Post process initialization SRV,UAV
-#ifdef ENABLE_BINDLESS
-	mViewportTexture->CreateSRV({});
-	mViewportTexture->CreateUAV({});
-	mBlurTempTexture->CreateSRV({});
-	mBlurTempTexture->CreateUAV({});
-#else
-	mViewportTextureSRV = mTextureHeap.Alloc(1);
-	mViewportTextureUAV = mTextureHeap.Alloc(1);
-	mBlurTempSRV = mTextureHeap.Alloc(1);
-	mBlurTempUAV = mTextureHeap.Alloc(1);
-
-	mViewportTexture->CreateSRV(mViewportTextureSRV.GetCpuHandle());
-	mViewportTexture->CreateUAV(mViewportTextureUAV.GetCpuHandle());
-	mBlurTempTexture->CreateSRV(mBlurTempSRV.GetCpuHandle());
-	mBlurTempTexture->CreateUAV(mBlurTempUAV.GetCpuHandle());
+#ifndef ENABLE_BINDLESS
+	// Post process SRV,UAV, written whenever the targets change
+	for (uint32_t target = 0; target < 2; ++target)
+	{
+		mViewportTextureSRV[target] = mTextureHeap.Alloc(1);
+		mViewportTextureUAV[target] = mTextureHeap.Alloc(1);
+		mBlurTempSRV[target] = mTextureHeap.Alloc(1);
+		mBlurTempUAV[target] = mTextureHeap.Alloc(1);
+	}
 #endif
 
+	// Offscreen viewport, blur and GBuffer targets for deferred rendering
+	InitRenderTargetPools();
+	mGBuffer = std::make_unique<GBuffer>();
+	ResizeViewport(mViewportWidth, mViewportHeight);
+
 	mLogger->info("Viewport offscreen texture created: {}x{}", mViewportWidth, mViewportHeight);
 }
 
 void Renderer::Update(float deltaTime)
 {
+	// Last frame's transient lists were recorded and are gone by now.
+	mFrameArena.Reset();
+	uint64_t heapAllocations = Utils::GetHeapAllocationCount();
+	mFrameHeapAllocations = heapAllocations - mHeapAllocationsAtUpdate;
+	mHeapAllocationsAtUpdate = heapAllocations;
+
 	// Delete any descriptor allocations form previous frames
 	uint64_t completedFence =
 		Graphics::gCommandListManager->GetGraphicsQueue().GetCompletedFenceValue();
 	Graphics::gBindlessAllocator->ProcessDeletions(completedFence);
+	mDynamicConstants->Retire(completedFence);
+	mColorTargets->Retire(completedFence);
+	mDepthTargets->Retire(completedFence);
+	mUploadBatch->Retire();
+	Graphics::gResidencyManager->Retire(completedFence);
+	mMeshes.Retire(completedFence);
+	mTextures.Retire(completedFence);
+	mFrameCapture->Retire(completedFence);
+#ifndef ENABLE_BINDLESS
+	mMaterialTables->Retire(completedFence);
+#endif
+	Graphics::UpdateMemoryStats();
+
+	// Queued mesh copies go out a frame's budget at a time, what the
+	// last frame wanted to draw first.
+	if (mUploadScheduler->HasPending())
+	{
+		mUploadBatch->Begin();
+		mUploadScheduler->Pump();
+		mUploadBatch->Submit();
+
+		if (!mUploadScheduler->HasPending())
+		{
+			const Graphics::UploadSchedulerStats& stats = mUploadScheduler->GetStats();
+			const Graphics::UploadHitchHistogram& hitches = mUploadScheduler->GetHitchHistogram();
+			mLogger->info("Uploads done: {} jobs, {} MB in {} frames, worst frame {:.2f} ms",
+						  stats.mJobsCompleted, stats.mBytes / (1024 * 1024), hitches.GetTotal(),
+						  hitches.mWorstMs);
+		}
+	}
+
+	// Streamed textures whose copy finished become visible here, then a
+	// few more decoded ones get uploaded.
+	if (mTextureLoader)
+	{
+		mTextureLoader->Pump(completedFence, MAX_STREAMING_UPLOADS_PER_FRAME);
+	}
 
 	mCamera->Update(deltaTime);
 
@@ -357,7 +388,7 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetDescriptorHeaps(bindlessHeap, samplerHeap);
 #endif
 
-	context.SetShaderMRT("GeometryPass", rtFormats.data(), 4, DXGI_FORMAT_D32_FLOAT);
+	context.SetShaderMRT(GEOMETRY_PASS_SHADER, rtFormats.data(), 4, DXGI_FORMAT_D32_FLOAT);
 
 	context.BindGraphicsPipeline();
 
@@ -376,10 +407,17 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetDescriptorHeaps(mTextureHeap, mSamplerHeap);
 #endif
 
-	int entityCount = 0;
-	const uint32_t CONSTANT_BUFFER_ALIGNMENT = (sizeof(Transform) + 255U) & ~255U;
-	const uint32_t MATERIAL_BUFFER_ALIGNMENT = (sizeof(MaterialConstants) + 255U) & ~255U;
-
+	// What gets drawn this frame. Lives in the frame arena like the rest of
+	// the per-frame lists, culling and sorting will work on it.
+	struct DrawItem
+	{
+		const Entity* mEntity;
+		const Mesh* mMesh;
+		/// Albedo, normal, metallic (or ORM) and roughness, null for none.
+		std::array<Texture*, 4> mTextures;
+	};
+	Utils::FrameVector<DrawItem> drawList{Utils::FrameAllocator<DrawItem>(mFrameArena)};
+	drawList.reserve(mScene->GetEntities().size());
 	for (const auto& entity : mScene->GetEntities())
 	{
 		if (!entity->IsVisible())
@@ -387,16 +425,67 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 			mLogger->debug("Entity '{}' is not visible", entity->GetName());
 			continue;
 		}
-
-		auto mesh = entity->GetMesh();
+		const Mesh* mesh = mMeshes.Get(entity->GetMesh());
 		if (!mesh)
 		{
 			mLogger->debug("Entity '{}' has no mesh", entity->GetName());
 			continue;
 		}
+		if (!mesh->IsUploaded())
+		{
+			mUploadScheduler->MarkVisible(mesh);
+			continue;
+		}
+
+		const Material& mat = entity->GetMaterial();
+		// A packed ORM map takes the metallic slot and leaves roughness empty.
+		DrawItem& item = drawList.emplace_back(DrawItem{
+			entity.get(),
+			mesh,
+			{mTextures.Get(mat.mAlbedoTexture), mTextures.Get(mat.mNormalTexture),
+			 mTextures.Get(mat.mOrmTexture ? mat.mOrmTexture : mat.mMetallicTexture),
+			 mat.mOrmTexture ? nullptr : mTextures.Get(mat.mRoughnessTexture)}});
+		for (Texture* texture : item.mTextures)
+		{
+			MarkTextureUsed(texture);
+		}
+	}
 
+	// Everything the scene samples is marked by now, page it in before any
+	// draw is recorded. If that fails the frame goes out without whatever
+	// is still evicted, sampling it would be undefined.
+	MarkTextureUsed(mEnvironmentCube.get());
+	MarkTextureUsed(mBrdfLut.get());
+	bool environmentResident = true;
+	if (!Graphics::gResidencyManager->Commit())
+	{
+		mLogger->error("Failed to make this frame's textures resident, drawing without them");
+		auto isSafe = [](const Texture* texture) {
+			return !texture || Graphics::gResidencyManager->IsSafeToUse(
+								   static_cast<ID3D12Pageable*>(texture->GetResource()));
+		};
+		for (DrawItem& item : drawList)
+		{
+			for (Texture*& texture : item.mTextures)
+			{
+				if (!isSafe(texture))
+				{
+					texture = nullptr;
+				}
+			}
+		}
+		environmentResident = isSafe(mEnvironmentCube.get()) && isSafe(mBrdfLut.get());
+	}
+
+	for (const auto& [entity, mesh, textures] : drawList)
+	{
 		const Material& mat = entity->GetMaterial();
 
+		Texture* albedoTexture = textures[0];
+		Texture* normalTexture = textures[1];
+		Texture* metallicTexture = textures[2];
+		Texture* roughnessTexture = textures[3];
+
 		Matrix4 world = entity->GetTransform().ToMatrix();
 		Matrix4 view = mCamera->GetViewMatrix();
 		Matrix4 proj = mCamera->GetProjectionMatrix();
@@ -407,22 +496,21 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 
 		MaterialConstants matConsts = mat.ToGPUConstants();
 
-		uint32_t constantBufferOffset = static_cast<uint32_t>(entityCount) *
-										CONSTANT_BUFFER_ALIGNMENT;
-		uint32_t materialBufferOffset = static_cast<uint32_t>(entityCount) *
-										MATERIAL_BUFFER_ALIGNMENT;
-		mConstantUploadBuffer.Copy(&mConstants, sizeof(mConstants), constantBufferOffset);
-		mMaterialUploadBuffer.Copy(&matConsts, sizeof(matConsts), materialBufferOffset);
+		Graphics::RingAllocation transformConstants = mDynamicConstants->Push(mConstants);
+		Graphics::RingAllocation materialConstants = mDynamicConstants->Push(matConsts);
+		if (!transformConstants.IsValid() || !materialConstants.IsValid())
+		{
+			mLogger->error("Out of dynamic constant memory, skipping the remaining entities");
+			break;
+		}
 
 		// Geometry pass bindings:
 		// b0 transform
 		// b1 material constants
 		// t0-t3 textures
 		// s0 Sampler
-		context.SetConstantBuffer(0, mConstantUploadBuffer.GetGpuVirtualAddress() +
-										 constantBufferOffset);
-		context.SetConstantBuffer(1, mMaterialUploadBuffer.GetGpuVirtualAddress() +
-										 materialBufferOffset);
+		context.SetConstantBuffer(0, transformConstants.mGpuAddress);
+		context.SetConstantBuffer(1, materialConstants.mGpuAddress);
 
 #ifdef ENABLE_BINDLESS
 
@@ -437,96 +525,46 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 
 		MaterialResources resources = {};
 
-		resources.mAlbedoTex.x = mat.mAlbedoTexture ? mat.mAlbedoTexture->GetSRVIndex() : 0;
+		resources.mAlbedoTex.x = albedoTexture ? albedoTexture->GetSRVIndex() : 0;
 		resources.mAlbedoTex.y = 0; // Sampler
 
-		resources.mNormalTex.x = mat.mNormalTexture ? mat.mNormalTexture->GetSRVIndex() : 0;
+		resources.mNormalTex.x = normalTexture ? normalTexture->GetSRVIndex() : 0;
 		resources.mNormalTex.y = 0;
 
-		resources.mMetallicTex.x = mat.mMetallicTexture ? mat.mMetallicTexture->GetSRVIndex() : 0;
+		resources.mMetallicTex.x = metallicTexture ? metallicTexture->GetSRVIndex() : 0;
 		resources.mMetallicTex.y = 0;
 
-		resources.mRoughnessTex.x = mat.mRoughnessTexture ? mat.mRoughnessTexture->GetSRVIndex()
-														  : 0;
+		resources.mRoughnessTex.x = roughnessTexture ? roughnessTexture->GetSRVIndex() : 0;
 		resources.mRoughnessTex.y = 0;
 
 		// Set as root constants (b2) - 8 uint32s, 32 bytes
 		context.GetCommandList()->SetGraphicsRoot32BitConstants(2, 8, &resources, 0);
 #else
-		const uint32_t DESCRIPTOR_SIZE = Graphics::gDevice->GetDescriptorHandleIncrementSize(
-			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-		// Using 4 srvs
-		const uint32_t MATERIAL_TEXTURE_SRV_OFFSET = static_cast<UINT>(entityCount) * 4;
-
-		D3D12_CPU_DESCRIPTOR_HANDLE destCPU = mMaterialTextureSRVStart.GetCpuHandle();
-		destCPU.ptr += static_cast<SIZE_T>(MATERIAL_TEXTURE_SRV_OFFSET * DESCRIPTOR_SIZE);
-
-		// Create SRVs for albedo, normal, metallic, roughness
-		if (mat.mAlbedoTexture)
-		{
-			mat.mAlbedoTexture->CreateSRV(destCPU);
-		}
-		else
-		{
-			D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
-			nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-			nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-			nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			nullSrvDesc.Texture2D.MipLevels = 1;
-			Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, destCPU);
-		}
-		destCPU.ptr += DESCRIPTOR_SIZE;
-
-		if (mat.mNormalTexture)
-		{
-			mat.mNormalTexture->CreateSRV(destCPU);
-		}
-		else
-		{
-			D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
-			nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-			nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-			nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			nullSrvDesc.Texture2D.MipLevels = 1;
-			Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, destCPU);
-		}
-		destCPU.ptr += DESCRIPTOR_SIZE;
-
-		if (mat.mMetallicTexture)
-		{
-			mat.mMetallicTexture->CreateSRV(destCPU);
-		}
-		else
-		{
-			D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
-			nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-			nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-			nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			nullSrvDesc.Texture2D.MipLevels = 1;
-			Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, destCPU);
-		}
-		destCPU.ptr += DESCRIPTOR_SIZE;
+		// Textures still uploading count as none, the table gets replaced
+		// once they can be drawn.
+		TextureHandle metallicHandle = mat.mOrmTexture ? mat.mOrmTexture : mat.mMetallicTexture;
+		Graphics::DescriptorTableKey tableKey = {
+			albedoTexture ? mat.mAlbedoTexture.GetValue() : 0,
+			normalTexture ? mat.mNormalTexture.GetValue() : 0,
+			metallicTexture ? metallicHandle.GetValue() : 0,
+			roughnessTexture ? mat.mRoughnessTexture.GetValue() : 0,
+		};
 
-		if (mat.mRoughnessTexture)
+		uint32_t table = mMaterialTables->Get(tableKey);
+		if (table == Graphics::DescriptorTableCache::INVALID_TABLE)
 		{
-			mat.mRoughnessTexture->CreateSRV(destCPU);
-		}
-		else
-		{
-			D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
-			nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-			nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-			nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			nullSrvDesc.Texture2D.MipLevels = 1;
-			Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, destCPU);
+			mLogger->warn("More than {} materials in flight without bindless, skipping the rest",
+						  MAX_MATERIALS);
+			break;
 		}
 
 		// Bind material texture descriptor table with the 4 consecutive SRV
+		const uint32_t DESCRIPTOR_SIZE = Graphics::gDevice->GetDescriptorHandleIncrementSize(
+			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 		D3D12_GPU_DESCRIPTOR_HANDLE materialTextureSRVHandle =
 			mMaterialTextureSRVStart.GetGpuHandle();
 		materialTextureSRVHandle.ptr +=
-			static_cast<UINT64>(MATERIAL_TEXTURE_SRV_OFFSET * DESCRIPTOR_SIZE);
+			static_cast<UINT64>(table) * tableKey.size() * DESCRIPTOR_SIZE;
 		context.GetCommandList()->SetGraphicsRootDescriptorTable(2, materialTextureSRVHandle);
 #endif
 
@@ -537,7 +575,6 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 		context.SetIndexBuffer(ibv);
 
 		context.DrawIndexedInstanced(mesh->GetIndexCount());
-		entityCount++;
 	}
 
 	// Transition for lighting pass next
@@ -562,7 +599,12 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 #endif
 
 	// Upload lighting constants (eye position, num lights, ambient light)
-	mLightingUploadBuffer.Copy(&mLightingConstants, sizeof(LightingConstants), 0);
+	LightingConstants lighting = mLightingConstants;
+	if (!environmentResident)
+	{
+		lighting.hasEnvironment = 0;
+	}
+	Graphics::RingAllocation lightingConstants = mDynamicConstants->Push(lighting);
 
 #ifdef ENABLE_BINDLESS
 	context.SetDescriptorHeaps(Graphics::gBindlessAllocator->GetHeap(),
@@ -571,7 +613,7 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetDescriptorHeaps(mTextureHeap, mSamplerHeap);
 #endif
 
-	context.SetShader("LightingPass");
+	context.SetShader(LIGHTING_PASS_SHADER);
 
 	// NOTE This probably should be done automatically but for right now manually
 	// is fine.
@@ -579,7 +621,7 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.GetCommandList()->SetGraphicsRootSignature(context.GetRootSignature());
 
 	// Root 0 Bind cbuffer, for lighting pass its just some eye, matrices, number of lights etc.
-	context.SetConstantBuffer(0, mLightingUploadBuffer.GetGpuVirtualAddress());
+	context.SetConstantBuffer(0, lightingConstants.mGpuAddress);
 
 // Root 1 Bind GBuffer textures
 #ifdef ENABLE_BINDLESS
@@ -593,6 +635,8 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 			DirectX::XMUINT2 mEmissive;
 			DirectX::XMUINT2 mDepth;
 			DirectX::XMUINT2 mSpotLights;
+			DirectX::XMUINT2 mPrefilteredEnv;
+			DirectX::XMUINT2 mBrdfLut;
 		};
 
 		GBufferResources gbuffer = {};
@@ -614,8 +658,21 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 		gbuffer.mSpotLights.x = mLightBuffer->GetSRVIndex();
 		gbuffer.mSpotLights.y = 0;
 
-		// Set as root constants (b1) - 12 uint32s, 48 bytes
-		context.GetCommandList()->SetGraphicsRoot32BitConstants(1, 12, &gbuffer, 0);
+		// Only sampled when hasEnvironment is set, the null cube keeps the
+		// handle valid otherwise.
+		gbuffer.mPrefilteredEnv.x =
+			mEnvironmentCube
+				? mEnvironmentCube->GetSRVIndex()
+				: Graphics::gBindlessAllocator->GetNullDescriptorIndex(NullDescriptor::TextureCube);
+		gbuffer.mPrefilteredEnv.y = 0;
+
+		gbuffer.mBrdfLut.x = mBrdfLut ? mBrdfLut->GetSRVIndex()
+									  : Graphics::gBindlessAllocator->GetNullDescriptorIndex(
+											NullDescriptor::Texture2D);
+		gbuffer.mBrdfLut.y = 0;
+
+		// Set as root constants (b1) - 16 uint32s, 64 bytes
+		context.GetCommandList()->SetGraphicsRoot32BitConstants(1, 16, &gbuffer, 0);
 	}
 #else
 	context.GetCommandList()->SetGraphicsRootDescriptorTable(1, mGBufferSRVStart.GetGpuHandle());
@@ -624,9 +681,10 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.GetCommandList()->SetGraphicsRootDescriptorTable(2, mLightBuffer->GetSRVGpu());
 #endif
 
-	// The mViewportTexture is our final render target for the imgui widget.
-	context.TransitionResource(*mViewportTexture, D3D12_RESOURCE_STATE_RENDER_TARGET);
-	context.SetRenderTarget(mViewportTexture->GetRTV(), mViewportDepth->GetDSV());
+	// The viewport texture is our final render target for the imgui widget.
+	ColorBuffer& viewport = *mViewportTextures[mViewportTarget];
+	context.TransitionResource(viewport, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	context.SetRenderTarget(viewport.GetRTV(), mViewportDepth->GetDSV());
 
 	context.ClearDepth(mViewportDepth->GetDSV(), 1.0F);
 
@@ -638,7 +696,151 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	context.DrawInstanced(3, 1);
 
+#ifdef USE_PIX
+	PIXEndEvent(context.GetCommandList()); // Lighting Pass
+#endif
+
 	// POST PROCESS
+	Graphics::QueueFence blur;
+	if (mAsyncCompute)
+	{
+		// Compute lists can't touch the render target or pixel shader
+		// states, the scene list hands both textures over in ones they can.
+		context.TransitionResource(viewport, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+		context.TransitionResource(*mBlurTempTextures[mViewportTarget],
+								   D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+#ifdef USE_PIX
+		PIXEndEvent(context.GetCommandList()); // End Frame
+#endif
+
+		Graphics::QueueFence scene = mQueueScheduler->Submit(
+			Graphics::QueueType::Graphics, [&context]() { return context.Execute(); });
+
+		mComputeContext->Begin();
+		RecordBlur(*mComputeContext);
+		blur = mQueueScheduler->Submit(
+			Graphics::QueueType::Compute, [this]() { return mComputeContext->Execute(); }, {scene});
+		context.Begin();
+	}
+	else
+	{
+		RecordBlur(context);
+		context.TransitionResource(viewport, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+#ifdef USE_PIX
+		PIXEndEvent(context.GetCommandList()); // End Frame
+#endif
+	}
+
+	// The UI shows the target last frame blurred, so this frame's blur has
+	// until the next frame's UI to finish. Only then does the graphics
+	// queue wait for it. Straight after a switch to async compute there's
+	// no older one to show and the UI waits for this frame's.
+	if (blur.IsValid() && mShownTexture == mViewportTextures[mViewportTarget])
+	{
+		mShownBlur = blur;
+		blur = {};
+	}
+	if (mShownBlur.IsValid())
+	{
+		mQueueScheduler->Wait(Graphics::QueueType::Graphics, mShownBlur);
+		context.TransitionResource(*mShownTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		mShownBlur = {};
+	}
+
+	if (!mCaptureRequest.empty())
+	{
+		// The viewport is drawn into the top left of a pooled target that
+		// can be bigger, only that part is captured. Clamped here so the
+		// size FrameCapture reads back is the size that was copied.
+		uint32_t captureWidth = std::min(mViewportWidth, mShownTexture->GetWidth());
+		uint32_t captureHeight = std::min(mViewportHeight, mShownTexture->GetHeight());
+
+		mCaptureContext = &context;
+		if (!mFrameCapture->Capture(captureWidth, captureHeight, mCaptureRequest))
+		{
+			mLogger->warn("Frame capture to {} skipped: {}", mCaptureRequest.string(),
+						  mFrameCapture->HasFreeSlot() ? mFrameCapture->GetLastError()
+													   : "readback ring is full");
+		}
+		mCaptureContext = nullptr;
+		mCaptureRequest.clear();
+	}
+
+	// App executes this frame's command list next, its fence (the next one
+	// the graphics queue signals) covers the scene list too when that went
+	// out early for the compute queue.
+	uint64_t frameFence =
+		Graphics::gCommandListManager->GetGraphicsQueue().GetLastSignaledFenceValue() + 1;
+	mDynamicConstants->EndFrame(frameFence);
+	mColorTargets->EndFrame(frameFence);
+	mDepthTargets->EndFrame(frameFence);
+	Graphics::gResidencyManager->EndFrame(frameFence);
+	mFrameCapture->EndFrame(frameFence);
+#ifndef ENABLE_BINDLESS
+	mMaterialTables->EndFrame(frameFence);
+#endif
+
+	// The UI draws the viewport from this slot in this frame's list.
+	mViewportSRVFences[mDisplayedSRVIndex] = frameFence;
+	mDisplayedSRVIndex = mViewportSRVIndex;
+
+	// The next frame shows what was drawn here. With async compute it
+	// draws into the other target while this one is still being blurred.
+	mShownTexture = mViewportTextures[mViewportTarget];
+	mShownTarget = mViewportTarget;
+	mShownBlur = blur;
+	if (mAsyncCompute)
+	{
+		mViewportTarget ^= 1;
+	}
+}
+
+void Renderer::WriteMaterialTable(uint32_t table, const Graphics::DescriptorTableKey& key)
+{
+	const uint32_t DESCRIPTOR_SIZE = Graphics::gDevice->GetDescriptorHandleIncrementSize(
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE destCPU = mMaterialTextureSRVStart.GetCpuHandle();
+	destCPU.ptr += static_cast<SIZE_T>(table) * key.size() * DESCRIPTOR_SIZE;
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC nullSrvDesc = {};
+	nullSrvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	nullSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	nullSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	nullSrvDesc.Texture2D.MipLevels = 1;
+
+	// Albedo, normal, metallic, roughness
+	for (uint32_t value : key)
+	{
+		Texture* texture = value ? mTextures.Get(TextureHandle::FromValue(value)) : nullptr;
+		if (texture)
+		{
+			texture->WriteSRV(destCPU);
+		}
+		else
+		{
+			Graphics::gDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, destCPU);
+		}
+		destCPU.ptr += DESCRIPTOR_SIZE;
+	}
+}
+
+void Renderer::MarkTextureUsed(const Texture* texture)
+{
+	if (texture && texture->GetResource())
+	{
+		Graphics::gResidencyManager->MarkUsed(
+			static_cast<ID3D12Pageable*>(texture->GetResource()));
+	}
+}
+
+void Renderer::RecordBlur(Graphics::GraphicsContext& context)
+{
+	ColorBuffer& viewport = *mViewportTextures[mViewportTarget];
+	ColorBuffer& blurTemp = *mBlurTempTextures[mViewportTarget];
+
 #ifdef USE_PIX
 	PIXBeginEvent(context.GetCommandList(), PIX_COLOR_INDEX(200), "Post-Process");
 #endif
@@ -648,8 +850,8 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	PIXBeginEvent(context.GetCommandList(), PIX_COLOR_INDEX(210), "Gaussian Blur");
 #endif
 
-	context.TransitionResource(*mViewportTexture, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-	context.TransitionResource(*mBlurTempTexture, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	context.TransitionResource(viewport, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	context.TransitionResource(blurTemp, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
 	// Horiziontal
 #ifdef USE_PIX
@@ -663,10 +865,17 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetDescriptorHeaps(mTextureHeap);
 #endif
 
-	context.SetComputeShader("BlurHorizontal");
+	context.SetComputeShader(BLUR_HORIZONTAL_SHADER);
 	context.BindComputePipeline();
 
-	context.SetComputeConstants(0, 1, &mBlurIntensity);
+	// Matches BlurParams, the targets can be bigger than what was rendered.
+	struct BlurParams
+	{
+		float mIntensity;
+		uint32_t mExtent[2];
+	};
+	BlurParams params = {mBlurIntensity, {mViewportWidth, mViewportHeight}};
+	context.SetComputeConstants(0, 3, &params);
 
 #ifdef ENABLE_BINDLESS
 	{
@@ -678,17 +887,17 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 
 		ComputeResources resources = {};
 
-		resources.mInputTex.x = mViewportTexture->GetSRVIndex();
+		resources.mInputTex.x = viewport.GetSRVIndex();
 		resources.mInputTex.y = 0;
 
-		resources.mOutputTex.x = mBlurTempTexture->GetUAVIndex();
+		resources.mOutputTex.x = blurTemp.GetUAVIndex();
 		resources.mOutputTex.y = 0;
 
 		context.GetCommandList()->SetComputeRoot32BitConstants(1, 4, &resources, 0);
 	}
 #else
-	context.SetComputeRootDescriptorTable(1, mViewportTextureSRV);
-	context.SetComputeRootDescriptorTable(2, mBlurTempUAV);
+	context.SetComputeRootDescriptorTable(1, mViewportTextureSRV[mViewportTarget]);
+	context.SetComputeRootDescriptorTable(2, mBlurTempUAV[mViewportTarget]);
 #endif
 
 	uint32_t groupsX = (mViewportWidth + 7) / 8;
@@ -699,8 +908,8 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	PIXEndEvent(context.GetCommandList());
 #endif
 
-	context.TransitionResource(*mBlurTempTexture, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-	context.TransitionResource(*mViewportTexture, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	context.TransitionResource(blurTemp, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	context.TransitionResource(viewport, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
 	// Vertical
 #ifdef USE_PIX
@@ -714,10 +923,10 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	context.SetDescriptorHeaps(mTextureHeap);
 #endif
 
-	context.SetComputeShader("BlurVertical");
+	context.SetComputeShader(BLUR_VERTICAL_SHADER);
 	context.BindComputePipeline();
 
-	context.SetComputeConstants(0, 1, &mBlurIntensity);
+	context.SetComputeConstants(0, 3, &params);
 
 #ifdef ENABLE_BINDLESS
 	{
@@ -729,17 +938,17 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 
 		ComputeResources resources = {};
 
-		resources.mInputTex.x = mBlurTempTexture->GetSRVIndex();
+		resources.mInputTex.x = blurTemp.GetSRVIndex();
 		resources.mInputTex.y = 0;
 
-		resources.mOutputTex.x = mViewportTexture->GetUAVIndex();
+		resources.mOutputTex.x = viewport.GetUAVIndex();
 		resources.mOutputTex.y = 0;
 
 		context.GetCommandList()->SetComputeRoot32BitConstants(1, 4, &resources, 0);
 	}
 #else
-	context.SetComputeRootDescriptorTable(1, mBlurTempSRV);
-	context.SetComputeRootDescriptorTable(2, mViewportTextureUAV);
+	context.SetComputeRootDescriptorTable(1, mBlurTempSRV[mViewportTarget]);
+	context.SetComputeRootDescriptorTable(2, mViewportTextureUAV[mViewportTarget]);
 #endif
 
 	context.Dispatch(groupsX, groupsY, 1);
@@ -748,7 +957,8 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 	PIXEndEvent(context.GetCommandList());
 #endif
 
-	context.TransitionResource(*mViewportTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	// The viewport is left as a UAV, a compute list can't make it a pixel
+	// shader resource. The graphics side does that.
 
 #ifdef USE_PIX
 	PIXEndEvent(context.GetCommandList()); // Gaussian Blur
@@ -757,14 +967,6 @@ void Renderer::Render(Graphics::GraphicsContext& context)
 #ifdef USE_PIX
 	PIXEndEvent(context.GetCommandList()); // Post-Process
 #endif
-
-#ifdef USE_PIX
-	PIXEndEvent(context.GetCommandList());
-#endif
-
-#ifdef USE_PIX
-	PIXEndEvent(context.GetCommandList()); // End Frame
-#endif
 }
 
 void Renderer::SetViewport(UINT width, UINT height)
@@ -787,9 +989,10 @@ void Renderer::SetViewport(UINT width, UINT height)
 	}
 }
 
-std::shared_ptr<Mesh> Renderer::LoadMesh(const std::string& objPath)
+MeshHandle Renderer::LoadMesh(const std::string& objPath)
 {
-	auto it = mMeshCache.find(objPath);
+	Utils::StringId pathId(objPath);
+	auto it = mMeshCache.find(pathId);
 	if (it != mMeshCache.end())
 	{
 		mLogger->info("Using cached mesh: {}", objPath);
@@ -803,152 +1006,839 @@ std::shared_ptr<Mesh> Renderer::LoadMesh(const std::string& objPath)
 	if (!mesh->LoadFromOBJ(objPath))
 	{
 		mLogger->error("Failed to load mesh");
-		return nullptr;
+		return {};
 	}
 
-	mesh->UploadToGPU();
+	ScheduleMeshUpload(mesh);
 
 	mLogger->info("Mesh loaded successfully");
-	return mMeshCache[objPath] = mesh;
+	return mMeshCache[pathId] = mMeshes.Add(std::move(mesh));
 }
 
-std::shared_ptr<Texture> Renderer::LoadTexture(const std::wstring& ddsPath)
+TextureHandle Renderer::RegisterTexture(std::shared_ptr<Texture> texture)
 {
-	auto it = mTextureCache.find(ddsPath);
-	if (it != mTextureCache.end())
+	return mTextures.Add(std::move(texture));
+}
+
+namespace
+{
+	/// Identity of a texture for deduplication. The mip settings only
+	/// matter for the formats we generate mips for, DDS and KTX2 are used
+	/// as they are.
+	uint64_t ComputeTextureKey(const TextureSource& source, const TextureTools::MipDesc& mipDesc)
 	{
-		mLogger->info("Using cached texture: {}", std::string(ddsPath.begin(), ddsPath.end()));
-		return it->second;
+		if (TextureTools::GetImageFormat(source.mPath) == TextureTools::ImageFormat::Unknown)
+		{
+			return source.mContentHash;
+		}
+
+		uint64_t settings = static_cast<uint64_t>(mipDesc.mFilter) |
+							(static_cast<uint64_t>(mipDesc.mIsSRGB) << 2) |
+							(static_cast<uint64_t>(mipDesc.mIsNormalMap) << 3) |
+							(static_cast<uint64_t>(mipDesc.mWrap) << 4) |
+							(static_cast<uint64_t>(mipDesc.mMaxLevels) << 8);
+		return Utils::HashCombine(source.mContentHash, settings);
 	}
+} // namespace
 
-	mLogger->info("Loading texture: {}", std::string(ddsPath.begin(), ddsPath.end()));
+namespace
+{
+	/// Carried through the streaming pipeline in LoadItem::mUserData.
+	struct AsyncTextureRequest
+	{
+		std::wstring mPath;
+		TextureTools::MipDesc mMipDesc;
+		TextureHandle mHandle;
+		uint64_t mKey = 0;
+		/// Size of the file, counted as saved if it turns out a copy.
+		size_t mFileBytes = 0;
+		/// Set when the upload stage found the same contents already
+		/// loaded, the decoded copy is dropped for it.
+		std::shared_ptr<Texture> mExisting;
+	};
+} // namespace
+
+void Renderer::InitFrameCapture()
+{
+	mCaptureBuffers.resize(CAPTURE_RING_SIZE);
+	mCaptureRowPitches.resize(CAPTURE_RING_SIZE);
+
+	Graphics::CaptureBackend backend;
+	backend.mRecordCopy = [this](uint32_t slot, uint32_t width, uint32_t height) {
+		return RecordCaptureCopy(slot, width, height);
+	};
+	backend.mMap = [this](uint32_t slot, uint32_t& rowPitch) -> const uint8_t* {
+		rowPitch = mCaptureRowPitches[slot];
+		return mCaptureBuffers[slot]->Map<uint8_t>();
+	};
+	backend.mUnmap = [this](uint32_t slot) { mCaptureBuffers[slot]->Unmap(); };
+
+	Graphics::FrameCaptureDesc desc;
+	desc.mRingSize = CAPTURE_RING_SIZE;
+	mFrameCapture = std::make_unique<Graphics::FrameCapture>(backend, desc);
+}
 
-	auto texture = std::make_shared<Texture>();
+bool Renderer::CaptureFrame(const std::filesystem::path& path)
+{
+	if (!mCaptureRequest.empty() || !mFrameCapture->HasFreeSlot())
+	{
+		return false;
+	}
+	mCaptureRequest = path;
+	return true;
+}
 
-	if (!texture->LoadFromFile(ddsPath))
+bool Renderer::RecordCaptureCopy(uint32_t slot, uint32_t width, uint32_t height)
+{
+	if (!mCaptureContext || !mShownTexture)
 	{
-		mLogger->error("Failed to load texture");
-		return nullptr;
+		return false;
 	}
 
-	texture->UploadToGPU();
+	// Render clamps to the target, a bigger copy would leave the read
+	// back short of what FrameCapture expects.
+	if (width > mShownTexture->GetWidth() || height > mShownTexture->GetHeight())
+	{
+		return false;
+	}
+
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+	footprint.Footprint.Format = mShownTexture->GetFormat();
+	footprint.Footprint.Width = width;
+	footprint.Footprint.Height = height;
+	footprint.Footprint.Depth = 1;
+	const uint32_t pitchAlignment = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+	footprint.Footprint.RowPitch = ((width * 4) + pitchAlignment - 1) & ~(pitchAlignment - 1);
+	uint32_t size = footprint.Footprint.RowPitch * height;
+
+	std::unique_ptr<Graphics::ReadbackBuffer>& buffer = mCaptureBuffers[slot];
+	if (!buffer || buffer->GetBufferSize() < size)
+	{
+		buffer = std::make_unique<Graphics::ReadbackBuffer>();
+		buffer->Create(L"Frame Capture " + std::to_wstring(slot), size);
+		if (!buffer->GetResource())
+		{
+			buffer.reset();
+			return false;
+		}
+	}
+	mCaptureRowPitches[slot] = footprint.Footprint.RowPitch;
+
+	CD3DX12_TEXTURE_COPY_LOCATION dst(buffer->GetResource(), footprint);
+	CD3DX12_TEXTURE_COPY_LOCATION src(mShownTexture->GetResource(), 0);
+	D3D12_BOX box = {0, 0, 0, width, height, 1};
+
+	mCaptureContext->TransitionResource(*mShownTexture, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	mCaptureContext->GetCommandList()->CopyTextureRegion(&dst, 0, 0, 0, &src, &box);
+	mCaptureContext->TransitionResource(*mShownTexture,
+										D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	return true;
+}
+
+void Renderer::InitQueueScheduler()
+{
+	mComputeContext = std::make_unique<GraphicsContext>();
+	mComputeContext->Create(gDevice, D3D12_COMMAND_LIST_TYPE_COMPUTE);
+
+	Graphics::QueueSchedulerBackend backend;
+	backend.mGetCompletedFence = [](Graphics::QueueType queue) {
+		return gCommandListManager->GetQueue(queue).GetCompletedFenceValue();
+	};
+	backend.mWait = [](Graphics::QueueType consumer, Graphics::QueueFence producer) {
+		CommandQueue& consumerQueue = gCommandListManager->GetQueue(consumer);
+		consumerQueue.WaitForQueue(gCommandListManager->GetQueue(producer.mQueue), producer.mValue);
+	};
+	mQueueScheduler = std::make_unique<Graphics::QueueScheduler>(std::move(backend));
+}
+
+void Renderer::InitUploadBatch()
+{
+	mCopyContext = std::make_unique<GraphicsContext>();
+	mCopyContext->Create(gDevice, D3D12_COMMAND_LIST_TYPE_COPY);
+
+	CommandQueue& copyQueue = gCommandListManager->GetCopyQueue();
+	CommandQueue& graphicsQueue = gCommandListManager->GetGraphicsQueue();
+
+	Graphics::UploadBatchQueue queue;
+	// Begin takes a fresh allocator from the copy queue's pool, no need to
+	// wait for the previous batch.
+	queue.mBegin = [this]() { mCopyContext->Begin(); };
+	queue.mSubmit = [this]() { return mCopyContext->Execute(); };
+	queue.mGetCompletedFence = [&copyQueue]() { return copyQueue.GetCompletedFenceValue(); };
+	queue.mGraphicsWait = [&copyQueue, &graphicsQueue](uint64_t fence) {
+		graphicsQueue.WaitForQueue(copyQueue, fence);
+	};
+	mUploadBatch = std::make_unique<Graphics::UploadBatch>(std::move(queue));
+	mUploadScheduler = std::make_unique<Graphics::UploadScheduler>();
+}
+
+void Renderer::ScheduleMeshUpload(const std::shared_ptr<Mesh>& mesh)
+{
+	Graphics::UploadJob job;
+	job.mKey = mesh.get();
+	job.mSliceBytes = {mesh->GetUploadSize()};
+	// The staging buffers are dropped once the copy queue is past them,
+	// the graphics queue already waits on the GPU before drawing it.
+	job.mRecord = [this, mesh](uint32_t) {
+		if (!mesh->RecordUpload(*mCopyContext))
+		{
+			return false;
+		}
+		mUploadBatch->Add(mesh->GetUploadSize(), [mesh]() { mesh->ClearUploadBuffers(); });
+		return true;
+	};
+	mUploadScheduler->Enqueue(std::move(job));
+}
+
+void Renderer::InitTextureLoader()
+{
+	TextureTools::LoadStages stages;
+
+	stages.mRead = [](TextureTools::LoadItem& item) {
+		TextureSource source;
+		if (!Texture::ReadSource(item.mPath.wstring(), source))
+		{
+			return false;
+		}
+		item.mFileData = std::move(source.mData);
+		item.mContentHash = source.mContentHash;
+
+		// Reserve roughly the decoded size with its mips so decode waits
+		// for room before allocating it. DDS/KTX2 stay close to file size.
+		uint32_t width = 0;
+		uint32_t height = 0;
+		if (TextureTools::GetImageFormat(item.mPath) != TextureTools::ImageFormat::Unknown &&
+			TextureTools::GetImageInfo(item.mFileData.data(), item.mFileData.size(), width, height))
+		{
+			item.mStagingBytes = static_cast<size_t>(width) * height * 4 * 4 / 3;
+		}
+		else
+		{
+			item.mStagingBytes = item.mFileData.size();
+		}
+		return true;
+	};
+
+	stages.mDecode = [](TextureTools::LoadItem& item) {
+		auto* request = static_cast<AsyncTextureRequest*>(item.mUserData.get());
+
+		TextureSource source;
+		source.mPath = request->mPath;
+		source.mData = std::move(item.mFileData);
+		source.mContentHash = item.mContentHash;
+		request->mKey = ComputeTextureKey(source, request->mMipDesc);
+		request->mFileBytes = source.mData.size();
+
+		auto texture = std::make_shared<Texture>();
+		if (!texture->LoadFromSource(std::move(source), request->mMipDesc))
+		{
+			return false;
+		}
+
+		item.mStagingBytes = texture->GetDeferredDataSize();
+		item.mResult = texture;
+		return true;
+	};
+
+	stages.mUpload = [this](TextureTools::LoadItem& item) {
+		auto* request = static_cast<AsyncTextureRequest*>(item.mUserData.get());
+
+		// Something with the same contents finished while this one was
+		// decoding, no need for a second copy on the GPU.
+		auto existing = mTextureByContent.find(request->mKey);
+		if (existing != mTextureByContent.end())
+		{
+			request->mExisting = existing->second;
+			return true;
+		}
+
+		if (!mStreamingRecording)
+		{
+			if (!mStreamingContext)
+			{
+				mStreamingContext = std::make_unique<GraphicsContext>();
+				mStreamingContext->Create(gDevice);
+			}
+			mStreamingContext->Begin();
+			mStreamingRecording = true;
+		}
+
+		auto texture = std::static_pointer_cast<Texture>(item.mResult);
+		return texture->UploadDeferredData(*mStreamingContext);
+	};
+
+	stages.mSubmit = [this]() -> uint64_t {
+		if (!mStreamingRecording)
+		{
+			return 0;
+		}
+
+		mStreamingRecording = false;
+		return mStreamingContext->Execute();
+	};
+
+	stages.mComplete = [this](TextureTools::LoadItem& item) {
+		auto* request = static_cast<AsyncTextureRequest*>(item.mUserData.get());
+		const std::string path(request->mPath.begin(), request->mPath.end());
+
+		// A failed load leaves the handle empty, it keeps drawing with the
+		// null SRV.
+		if (item.mFailed)
+		{
+			mLogger->error("Failed to stream texture: {}", path);
+		}
+		else if (request->mExisting)
+		{
+			mTextures.Set(request->mHandle, request->mExisting);
+			mTextureDedupStats.mAliasedPaths++;
+			mTextureDedupStats.mBytesSaved += request->mFileBytes;
+		}
+		else
+		{
+			auto texture = std::static_pointer_cast<Texture>(item.mResult);
+			texture->ClearUploadBuffer();
 
-	DescriptorHandle textureHandle = mTextureHeap.Alloc(1);
-	texture->CreateSRV(textureHandle.GetCpuHandle());
-	texture->SetSRVHandles(textureHandle.GetCpuHandle(), textureHandle.GetGpuHandle());
+			DescriptorHandle textureHandle = mTextureHeap.Alloc(1);
+			texture->CreateSRV(textureHandle.GetCpuHandle());
+			texture->SetSRVHandles(textureHandle.GetCpuHandle(), textureHandle.GetGpuHandle());
 
-	mLogger->info("Texture loaded successfully");
-	return mTextureCache[ddsPath] = texture;
+			mTextures.Set(request->mHandle, texture);
+			mTextureByContent[request->mKey] = texture;
+			mTextureDedupStats.mUniqueTextures++;
+		}
+	};
+
+	mTextureLoader = std::make_unique<TextureTools::TextureLoadPipeline>(std::move(stages));
+}
+
+TextureHandle Renderer::LoadTexture(const std::wstring& path, const TextureTools::MipDesc& mipDesc)
+{
+	auto it = mTextureCache.find(path);
+	if (it != mTextureCache.end())
+	{
+		mLogger->info("Using cached texture: {}", std::string(path.begin(), path.end()));
+		return it->second;
+	}
+
+	// The slot stays empty, and the handle resolves to null, until
+	// mComplete fills it in.
+	TextureHandle handle = mTextures.Reserve();
+	mTextureCache[path] = handle;
+
+	auto request = std::make_shared<AsyncTextureRequest>();
+	request->mPath = path;
+	request->mMipDesc = mipDesc;
+	request->mHandle = handle;
+	mTextureLoader->Enqueue(path, std::move(request));
+	return handle;
 }
 
 MaterialAsset Renderer::LoadMaterialAsset(const std::string& materialName)
+{
+	return LoadMaterialAssets({materialName})[0];
+}
+
+std::vector<MaterialAsset>
+Renderer::LoadMaterialAssets(const std::vector<std::string>& materialNames)
 {
 	// NOTE This is horribly hard coded in the asset folder.
-	auto it = mMaterialLibrary.find(materialName);
-	if (it != mMaterialLibrary.end())
+	std::vector<MaterialAsset> materials(materialNames.size());
+	std::vector<uint8_t> parsed(materialNames.size(), 0);
+	std::vector<MaterialTextureSlot> slots;
+	std::vector<TextureTools::ORMSources> ormSources(materialNames.size());
+
+	TextureTools::MipDesc colorDesc;
+	TextureTools::MipDesc linearDesc;
+	linearDesc.mIsSRGB = false;
+	TextureTools::MipDesc normalDesc;
+	normalDesc.mIsNormalMap = true;
+
+	for (size_t m = 0; m < materialNames.size(); ++m)
 	{
-		mLogger->info("Using cached material: {}", materialName);
-		return it->second;
+		const std::string& materialName = materialNames[m];
+		auto it = mMaterialLibrary.find(Utils::StringId(materialName));
+		if (it != mMaterialLibrary.end())
+		{
+			mLogger->info("Using cached material: {}", materialName);
+			materials[m] = it->second;
+			continue;
+		}
+
+		mLogger->info("Loading material: {}", materialName);
+
+		MaterialAsset& mat = materials[m];
+		mat.name = materialName;
+
+		std::string jsonPath = "assets/materials/" + materialName + "/material.json";
+		std::ifstream file(jsonPath);
+
+		if (!file.is_open())
+		{
+			mLogger->error("Failed to open material file: {}", jsonPath);
+			continue;
+		}
+
+		try
+		{
+			nlohmann::json j;
+			file >> j;
+
+			struct TextureSlot
+			{
+				const char* key;
+				TextureHandle* texture;
+				TextureRegion* region;
+				const TextureTools::MipDesc& mipDesc;
+			};
+
+			const TextureSlot textureSlots[] = {
+				{"albedo", &mat.albedoTexture, &mat.albedoRegion, colorDesc},
+				{"normal", &mat.normalTexture, &mat.normalRegion, normalDesc},
+				{"emissive", &mat.emissiveTexture, &mat.emissiveRegion, colorDesc},
+				{"orm", &mat.ormTexture, &mat.ormRegion, linearDesc},
+			};
+
+			auto getPath = [&](const char* key) {
+				return j.contains(key) ? j[key].get<std::string>() : std::string();
+			};
+
+			// The maps of all the materials are loaded together further
+			// down so they decode in parallel and can share atlases.
+			for (const TextureSlot& slot : textureSlots)
+			{
+				// Materials share maps, the wide path is made once per map.
+				Utils::StringId path(getPath(slot.key));
+				if (path)
+				{
+					slots.push_back({path.GetWide(), slot.mipDesc, slot.texture, slot.region});
+				}
+			}
+
+			// Occlusion, roughness and metallic get cooked into one map
+			// below, unless the material already comes with one.
+			if (getPath("orm").empty())
+			{
+				ormSources[m].mOcclusion = getPath("ao");
+				ormSources[m].mRoughness = getPath("roughness");
+				ormSources[m].mMetallic = getPath("metallic");
+			}
+
+			if (j.contains("albedoColor") && j["albedoColor"].is_array() &&
+				j["albedoColor"].size() >= 3)
+			{
+				mat.albedoColor =
+					Vector4(j["albedoColor"][0].get<float>(), j["albedoColor"][1].get<float>(),
+							j["albedoColor"][2].get<float>(),
+							j["albedoColor"].size() >= 4 ? j["albedoColor"][3].get<float>() : 1.0F);
+			}
+
+			if (j.contains("emissiveFactor") && j["emissiveFactor"].is_array() &&
+				j["emissiveFactor"].size() >= 3)
+			{
+				mat.emissiveFactor = Vector3(j["emissiveFactor"][0].get<float>(),
+											 j["emissiveFactor"][1].get<float>(),
+											 j["emissiveFactor"][2].get<float>());
+			}
+
+			if (j.contains("metallicFactor"))
+				mat.metallicFactor = j["metallicFactor"].get<float>();
+
+			if (j.contains("roughnessFactor"))
+				mat.roughnessFactor = j["roughnessFactor"].get<float>();
+
+			if (j.contains("normalStrength"))
+				mat.normalStrength = j["normalStrength"].get<float>();
+
+			if (j.contains("aoStrength"))
+				mat.aoStrength = j["aoStrength"].get<float>();
+
+			parsed[m] = 1;
+		}
+		catch (const nlohmann::json::exception& e)
+		{
+			mLogger->error("Failed to parse material JSON: {}", e.what());
+		}
 	}
 
-	mLogger->info("Loading material: {}", materialName);
+	CookORMTextures(materials, ormSources, slots);
+	PackTextureAtlases(slots);
 
-	MaterialAsset mat;
-	mat.name = materialName;
+	// The maps stream in over the next frames, materials draw without
+	// them until they're done.
+	for (const MaterialTextureSlot& slot : slots)
+	{
+		*slot.mTexture = LoadTexture(slot.mPath, slot.mMipDesc);
+	}
 
-	std::string jsonPath = "assets/materials/" + materialName + "/material.json";
-	std::ifstream file(jsonPath);
+	for (size_t m = 0; m < materialNames.size(); ++m)
+	{
+		if (parsed[m])
+		{
+			mMaterialLibrary[Utils::StringId(materialNames[m])] = materials[m];
+			mLogger->info("Material '{}' loaded successfully", materialNames[m]);
+		}
+	}
+
+	return materials;
+}
+
+void Renderer::CookORMTextures(std::vector<MaterialAsset>& materials,
+							   const std::vector<TextureTools::ORMSources>& sources,
+							   std::vector<MaterialTextureSlot>& slots)
+{
+	TextureTools::MipDesc linearDesc;
+	linearDesc.mIsSRGB = false;
+
+	std::vector<std::filesystem::path> cookedPaths(sources.size());
+	std::vector<std::string> errors(sources.size());
+	std::vector<uint8_t> cooked(sources.size(), 0);
+
+	// Cooking decodes up to three maps per material, the cooked file is
+	// reused on later runs so this is only slow the first time.
+	Utils::ThreadPool::GetDefault().ParallelFor(
+		static_cast<uint32_t>(sources.size()), [&](uint32_t m) {
+			if (!sources[m].IsEmpty())
+			{
+				cooked[m] = TextureTools::CookORM(sources[m], "cache/orm", cookedPaths[m],
+												  &errors[m])
+								? 1
+								: 0;
+			}
+		});
 
-	if (!file.is_open())
+	for (size_t m = 0; m < sources.size(); ++m)
 	{
-		mLogger->error("Failed to open material file: {}", jsonPath);
-		return mat;
+		MaterialAsset& mat = materials[m];
+		if (cooked[m])
+		{
+			slots.push_back(
+				{cookedPaths[m].wstring(), linearDesc, &mat.ormTexture, &mat.ormRegion});
+			continue;
+		}
+
+		if (sources[m].IsEmpty())
+		{
+			continue;
+		}
+
+		// DDS maps and the like can't be packed on the CPU, load them as is.
+		mLogger->warn("Not packing ORM for material '{}': {}", mat.name, errors[m]);
+
+		const struct
+		{
+			const std::filesystem::path& mPath;
+			TextureHandle* mTexture;
+			TextureRegion* mRegion;
+		} separate[] = {
+			{sources[m].mOcclusion, &mat.aoTexture, &mat.aoRegion},
+			{sources[m].mRoughness, &mat.roughnessTexture, &mat.roughnessRegion},
+			{sources[m].mMetallic, &mat.metallicTexture, &mat.metallicRegion},
+		};
+		for (const auto& map : separate)
+		{
+			if (!map.mPath.empty())
+			{
+				slots.push_back({map.mPath.wstring(), linearDesc, map.mTexture, map.mRegion});
+			}
+		}
 	}
+}
+
+void Renderer::PackTextureAtlases(std::vector<MaterialTextureSlot>& slots)
+{
+	const TextureTools::AtlasDesc atlasDesc;
+
+	// Maps packed by an earlier call are reused, anything already loaded
+	// as a standalone texture stays that way.
+	std::vector<std::wstring> candidates;
+	std::vector<TextureTools::MipDesc> candidateDescs;
+	std::unordered_map<std::wstring, uint32_t> candidateIndex;
+	for (const MaterialTextureSlot& slot : slots)
+	{
+		if (TextureTools::GetImageFormat(slot.mPath) == TextureTools::ImageFormat::Unknown ||
+			mAtlasCache.contains(slot.mPath) || mTextureCache.contains(slot.mPath))
+		{
+			continue;
+		}
+
+		if (candidateIndex.emplace(slot.mPath, static_cast<uint32_t>(candidates.size())).second)
+		{
+			candidates.push_back(slot.mPath);
+			candidateDescs.push_back(slot.mMipDesc);
+		}
+	}
+
+	// Only the header is needed to tell if a map is small enough, the big
+	// ones are left for LoadTexture.
+	std::vector<TextureTools::Image> images(candidates.size());
+	Utils::ThreadPool::GetDefault().ParallelFor(
+		static_cast<uint32_t>(candidates.size()), [&](uint32_t i) {
+			TextureSource source;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			if (!Texture::ReadSource(candidates[i], source) ||
+				!TextureTools::GetImageInfo(source.mData.data(), source.mData.size(), width,
+											height) ||
+				width > atlasDesc.mMaxInputSize || height > atlasDesc.mMaxInputSize)
+			{
+				return;
+			}
 
-	try
+			if (!TextureTools::DecodeImage(source.mData.data(), source.mData.size(), images[i],
+										   &TextureTools::StagingPool::GetDefault()))
+			{
+				images[i] = {};
+			}
+		});
+
+	// One set of pages per kind of map since they need different formats
+	// and mip filtering: sRGB colour, linear data, normals.
+	auto getKind = [](const TextureTools::MipDesc& desc) {
+		return desc.mIsNormalMap ? 2U : (desc.mIsSRGB ? 0U : 1U);
+	};
+
+	struct PageUpload
 	{
-		nlohmann::json j;
-		file >> j;
+		std::shared_ptr<Texture> mTexture;
+		std::vector<uint32_t> mCandidates;
+		std::vector<TextureRegion> mRegions;
+	};
+	std::vector<PageUpload> pages;
 
-		// std::string basePath = "assets/materials/" + materialName + "/";
+	for (uint32_t kind = 0; kind < 3; ++kind)
+	{
+		std::vector<uint32_t> members;
+		std::vector<const TextureTools::Image*> memberImages;
+		for (uint32_t i = 0; i < candidates.size(); ++i)
+		{
+			if (!images[i].IsEmpty() && getKind(candidateDescs[i]) == kind)
+			{
+				members.push_back(i);
+				memberImages.push_back(&images[i]);
+			}
+		}
 
-		if (j.contains("albedo") && !j["albedo"].get<std::string>().empty())
+		// A single map gains nothing from a page, it just gets a gutter.
+		if (members.size() < 2)
 		{
-			std::string albedoPath = j["albedo"].get<std::string>();
-			mat.albedoTexture = LoadTexture(std::wstring(albedoPath.begin(), albedoPath.end()));
+			continue;
 		}
 
-		if (j.contains("normal") && !j["normal"].get<std::string>().empty())
+		TextureTools::AtlasResult atlas = TextureTools::BuildAtlases(memberImages, atlasDesc);
+
+		// The gutters only protect the first few levels, and the page is
+		// not tiling even if the maps are.
+		TextureTools::MipDesc pageDesc = candidateDescs[members[0]];
+		pageDesc.mWrap = false;
+		pageDesc.mMaxLevels = TextureTools::GetAtlasMipLevels(atlasDesc);
+
+		std::vector<const TextureTools::Image*> pageImages;
+		std::vector<TextureTools::MipDesc> pageDescs;
+		for (const TextureTools::AtlasPage& page : atlas.mPages)
 		{
-			std::string normalPath = j["normal"].get<std::string>();
-			mat.normalTexture = LoadTexture(std::wstring(normalPath.begin(), normalPath.end()));
+			pageImages.push_back(&page.mImage);
+			pageDescs.push_back(pageDesc);
 		}
+		std::vector<TextureTools::MipChain> chains = TextureTools::GenerateMipsBatch(
+			pageImages, pageDescs, Utils::ThreadPool::GetDefault());
 
-		if (j.contains("metallic") && !j["metallic"].get<std::string>().empty())
+		const size_t firstPage = pages.size();
+		for (const TextureTools::MipChain& chain : chains)
 		{
-			std::string metallicPath = j["metallic"].get<std::string>();
-			mat.metallicTexture =
-				LoadTexture(std::wstring(metallicPath.begin(), metallicPath.end()));
+			PageUpload upload;
+			upload.mTexture = std::make_shared<Texture>();
+			if (!upload.mTexture->LoadFromMipChain(chain))
+			{
+				upload.mTexture.reset();
+			}
+			pages.push_back(std::move(upload));
 		}
 
-		if (j.contains("roughness") && !j["roughness"].get<std::string>().empty())
+		for (size_t m = 0; m < members.size(); ++m)
 		{
-			std::string roughnessPath = j["roughness"].get<std::string>();
-			mat.roughnessTexture =
-				LoadTexture(std::wstring(roughnessPath.begin(), roughnessPath.end()));
+			const TextureTools::AtlasPlacement& placement = atlas.mPlacements[m];
+			if (!placement.mPacked)
+			{
+				continue;
+			}
+
+			TextureRegion region;
+			region.uvScale = Float2(placement.mUVScale[0], placement.mUVScale[1]);
+			region.uvOffset = Float2(placement.mUVOffset[0], placement.mUVOffset[1]);
+
+			PageUpload& page = pages[firstPage + placement.mPage];
+			page.mCandidates.push_back(members[m]);
+			page.mRegions.push_back(region);
 		}
 
-		if (j.contains("ao") && !j["ao"].get<std::string>().empty())
+		mLogger->info("Texture atlas: packed {} of {} small maps into {} page(s), {:.1f}% "
+					  "efficiency",
+					  atlas.GetPackedCount(), members.size(), atlas.mPages.size(),
+					  atlas.GetEfficiency() * 100.0F);
+	}
+
+	for (TextureTools::Image& image : images)
+	{
+		TextureTools::StagingPool::GetDefault().Release(std::move(image.mPixels));
+	}
+
+	if (pages.empty())
+	{
+		return;
+	}
+
+	mUploadBatch->Begin();
+	for (PageUpload& page : pages)
+	{
+		if (page.mTexture && !page.mTexture->UploadDeferredData(*mCopyContext))
+		{
+			page.mTexture.reset();
+		}
+		if (page.mTexture)
 		{
-			std::string aoPath = j["ao"].get<std::string>();
-			mat.aoTexture = LoadTexture(std::wstring(aoPath.begin(), aoPath.end()));
+			std::shared_ptr<Texture> texture = page.mTexture;
+			mUploadBatch->Add(texture->GetDeferredDataSize(),
+							  [texture]() { texture->ClearUploadBuffer(); });
 		}
+	}
+	mUploadBatch->Submit();
 
-		if (j.contains("emissive") && !j["emissive"].get<std::string>().empty())
+	for (PageUpload& page : pages)
+	{
+		if (!page.mTexture)
 		{
-			std::string emissivePath = j["emissive"].get<std::string>();
-			mat.emissiveTexture =
-				LoadTexture(std::wstring(emissivePath.begin(), emissivePath.end()));
+			mLogger->error("Failed to create texture atlas page");
+			continue;
 		}
 
-		if (j.contains("albedoColor") && j["albedoColor"].is_array() &&
-			j["albedoColor"].size() >= 3)
+		DescriptorHandle textureHandle = mTextureHeap.Alloc(1);
+		page.mTexture->CreateSRV(textureHandle.GetCpuHandle());
+		page.mTexture->SetSRVHandles(textureHandle.GetCpuHandle(), textureHandle.GetGpuHandle());
+
+		TextureHandle handle = RegisterTexture(page.mTexture);
+		for (size_t i = 0; i < page.mCandidates.size(); ++i)
 		{
-			mat.albedoColor =
-				Vector4(j["albedoColor"][0].get<float>(), j["albedoColor"][1].get<float>(),
-						j["albedoColor"][2].get<float>(),
-						j["albedoColor"].size() >= 4 ? j["albedoColor"][3].get<float>() : 1.0F);
+			mAtlasCache[candidates[page.mCandidates[i]]] = {handle, page.mRegions[i]};
 		}
+	}
 
-		if (j.contains("emissiveFactor") && j["emissiveFactor"].is_array() &&
-			j["emissiveFactor"].size() >= 3)
+	// Fill in every slot that now points into a page, the rest stay for
+	// LoadTexture.
+	std::erase_if(slots, [&](const MaterialTextureSlot& slot) {
+		auto it = mAtlasCache.find(slot.mPath);
+		if (it == mAtlasCache.end())
 		{
-			mat.emissiveFactor = Vector3(j["emissiveFactor"][0].get<float>(),
-										 j["emissiveFactor"][1].get<float>(),
-										 j["emissiveFactor"][2].get<float>());
+			return false;
 		}
 
-		if (j.contains("metallicFactor"))
-			mat.metallicFactor = j["metallicFactor"].get<float>();
+		*slot.mTexture = it->second.mTexture;
+		*slot.mRegion = it->second.mRegion;
+		return true;
+	});
+}
 
-		if (j.contains("roughnessFactor"))
-			mat.roughnessFactor = j["roughnessFactor"].get<float>();
+bool Renderer::LoadEnvironment(const std::wstring& hdrPath)
+{
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point start = Clock::now();
 
-		if (j.contains("normalStrength"))
-			mat.normalStrength = j["normalStrength"].get<float>();
+	const std::string pathName(hdrPath.begin(), hdrPath.end());
 
-		if (j.contains("aoStrength"))
-			mat.aoStrength = j["aoStrength"].get<float>();
+	std::vector<uint8_t> fileData;
+	uint64_t sourceHash = 0;
+	if (!Utils::ReadBinaryFile(hdrPath, fileData, sourceHash))
+	{
+		mLogger->warn("No environment at {}, using flat ambient light", pathName);
+		return false;
+	}
+
+	// Baking takes seconds at the default settings, the cache is keyed by the
+	// file contents and the settings so editing either rebakes.
+	TextureTools::IBLDesc desc;
+	const uint64_t key = TextureTools::ComputeIBLKey(sourceHash, desc);
+	const std::filesystem::path cachePath =
+		std::filesystem::path("cache/ibl") / std::format("{:016x}.bin", key);
 
-		mMaterialLibrary[materialName] = mat;
-		mLogger->info("Material '{}' loaded successfully", materialName);
+	TextureTools::IBLData ibl;
+	bool fromCache = TextureTools::LoadIBLCache(cachePath, key, ibl);
+	if (!fromCache)
+	{
+		TextureTools::ImageF equirect;
+		std::string error;
+		if (!TextureTools::DecodeHDRImage(fileData.data(), fileData.size(), equirect, &error))
+		{
+			mLogger->error("Failed to decode environment {}: {}", pathName, error);
+			return false;
+		}
+
+		ibl = TextureTools::BakeIBL(equirect, desc, Utils::ThreadPool::GetDefault());
+		if (!TextureTools::SaveIBLCache(cachePath, key, ibl))
+		{
+			mLogger->warn("Failed to write IBL cache {}", cachePath.string());
+		}
+	}
+
+	auto cube = std::make_shared<Texture>();
+	auto lut = std::make_shared<Texture>();
+	if (!cube->LoadFromCubeMap(ibl.mPrefiltered) || !lut->LoadFromBrdfLut(ibl.mBrdfLut))
+	{
+		mLogger->error("Failed to create IBL textures for {}", pathName);
+		return false;
+	}
+
+	// Whatever got recorded is submitted either way, the callbacks keep
+	// the textures alive until the copy queue is done with them.
+	mUploadBatch->Begin();
+	bool uploaded = true;
+	for (const std::shared_ptr<Texture>& texture : {cube, lut})
+	{
+		if (!uploaded || !texture->UploadDeferredData(*mCopyContext))
+		{
+			uploaded = false;
+			continue;
+		}
+		mUploadBatch->Add(texture->GetDeferredDataSize(),
+						  [texture]() { texture->ClearUploadBuffer(); });
 	}
-	catch (const nlohmann::json::exception& e)
+	mUploadBatch->Submit();
+	if (!uploaded)
 	{
-		mLogger->error("Failed to parse material JSON: {}", e.what());
+		mLogger->error("Failed to upload IBL textures for {}", pathName);
+		return false;
 	}
 
-	return mat;
+	cube->CreateSRV({});
+	lut->CreateSRV({});
+
+#ifndef ENABLE_BINDLESS
+	// The lighting pass table continues after the GBuffer SRVs. Written in
+	// place, the bindless heap is shader visible and can't be copied from.
+	const UINT descriptorSize =
+		Graphics::gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	D3D12_CPU_DESCRIPTOR_HANDLE destCPU = mGBufferSRVStart.GetCpuHandle();
+	destCPU.ptr += static_cast<SIZE_T>(5 * descriptorSize);
+	cube->WriteSRV(destCPU);
+	destCPU.ptr += descriptorSize;
+	lut->WriteSRV(destCPU);
+#endif
+
+	mEnvironmentCube = std::move(cube);
+	mBrdfLut = std::move(lut);
+
+	for (size_t i = 0; i < 9; ++i)
+	{
+		const std::array<float, 3>& c = ibl.mIrradiance.mCoefficients[i];
+		mLightingConstants.shIrradiance[i] = Vector4(c[0], c[1], c[2], 0.0F);
+	}
+	mLightingConstants.prefilteredMipCount = static_cast<float>(mEnvironmentCube->GetMipLevels());
+	mLightingConstants.hasEnvironment = 1;
+
+	double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	mLogger->info("Environment {} ({}): {}x{} cube, {} mips, LUT {}, {:.1f} ms", pathName,
+				  fromCache ? "cached" : "baked", ibl.mPrefiltered.mSize,
+				  ibl.mPrefiltered.mSize, ibl.mPrefiltered.mLevels.size(), ibl.mBrdfLut.mSize,
+				  totalMs);
+	return true;
 }
 
 void Renderer::AddSpotLight(const SpotLight& light)
@@ -972,81 +1862,212 @@ void Renderer::AddSpotLight(const SpotLight& light)
 
 void Renderer::ResizeViewport(uint32_t width, uint32_t height)
 {
-	if (width == mViewportWidth && height == mViewportHeight)
+	if (width == 0 || height == 0)
 		return;
 
-	if (width == 0 || height == 0)
+	Graphics::ResizeDecision decision = mResizeCoalescer.Update(width, height);
+	if (decision.mAction == Graphics::ResizeDecision::Action::None)
 		return;
 
-	mViewportWidth = width;
-	mViewportHeight = height;
+	mViewportWidth = decision.mWidth;
+	mViewportHeight = decision.mHeight;
 
-	// Resetting the ColorBuffers since we have to recreate a new one.
-	mViewportTexture.reset();
-	mViewportDepth.reset();
-	mBlurTempTexture.reset();
+	if (decision.mAction == Graphics::ResizeDecision::Action::Reallocate)
+	{
+		AcquireViewportTargets(decision.mTargetWidth, decision.mTargetHeight);
+		mLogger->info("Viewport targets reallocated: {}x{}", mTargetWidth, mTargetHeight);
+		PlanViewportAliasing();
+	}
+	mGBuffer->SetRenderSize(mViewportWidth, mViewportHeight);
 
-	mViewportTexture = std::make_unique<ColorBuffer>();
-	mViewportTexture->Create(L"ViewportTexture", mViewportWidth, mViewportHeight, 1,
-							 DXGI_FORMAT_R8G8B8A8_UNORM, true);
+	SetViewport(mViewportWidth, mViewportHeight);
+}
 
-	mBlurTempTexture = std::make_unique<ColorBuffer>();
-	mBlurTempTexture->Create(L"BlurTempTexture", mViewportWidth, mViewportHeight, 1,
-							 DXGI_FORMAT_R8G8B8A8_UNORM, true);
+void Renderer::InitRenderTargetPools()
+{
+	Graphics::RenderTargetPoolDesc desc;
+	mResizeCoalescer = Graphics::ResizeCoalescer(desc);
+
+	// Views are made once here, a target handed out again keeps them.
+	mColorTargets = std::make_unique<ColorTargetPool>(
+		[](const Graphics::RenderTargetKey& key) {
+			bool allowUAV = (key.mFlags & Graphics::RENDER_TARGET_UAV) != 0;
+			auto target = std::make_shared<ColorBuffer>();
+			target->Create(L"PooledColorTarget", key.mWidth, key.mHeight, 1,
+						   static_cast<DXGI_FORMAT>(key.mFormat), allowUAV);
+#ifdef ENABLE_BINDLESS
+			target->CreateSRV({});
+			if (allowUAV)
+			{
+				target->CreateUAV({});
+			}
+#endif
+			return target;
+		},
+		desc);
+
+	mDepthTargets = std::make_unique<DepthTargetPool>(
+		[](const Graphics::RenderTargetKey& key) {
+			auto target = std::make_shared<DepthBuffer>();
+			target->Create(L"PooledDepthTarget", key.mWidth, key.mHeight,
+						   static_cast<DXGI_FORMAT>(key.mFormat));
+			target->CreateView(Graphics::gDevice);
+#ifdef ENABLE_BINDLESS
+			target->CreateSRV({});
+#endif
+			return target;
+		},
+		desc);
+}
 
-	mViewportDepth = std::make_unique<DepthBuffer>();
-	mViewportDepth->Create(L"ViewportDepth", mViewportWidth, mViewportHeight,
-						   DXGI_FORMAT_D32_FLOAT);
-	mViewportDepth->CreateView(Graphics::gDevice);
+void Renderer::AcquireViewportTargets(uint32_t targetWidth, uint32_t targetHeight)
+{
+	auto viewportKey = [](uint32_t width, uint32_t height) {
+		return Graphics::RenderTargetKey{static_cast<uint32_t>(DXGI_FORMAT_R8G8B8A8_UNORM), width,
+										 height, Graphics::RENDER_TARGET_UAV};
+	};
+	auto depthKey = [](uint32_t width, uint32_t height) {
+		return Graphics::RenderTargetKey{static_cast<uint32_t>(DXGI_FORMAT_D32_FLOAT), width,
+										 height, Graphics::RENDER_TARGET_DEPTH};
+	};
+
+	CommandQueue& queue = Graphics::gCommandListManager->GetGraphicsQueue();
+
+	// The old targets go back to the pools and get this frame's fence in
+	// Render, nothing waits for the GPU to be done with them. The one the
+	// UI shows this frame is kept alive by mShownTexture.
+	if (mViewportDepth)
+	{
+		for (uint32_t target = 0; target < 2; ++target)
+		{
+			mColorTargets->Release(viewportKey(mTargetWidth, mTargetHeight),
+								   std::move(mViewportTextures[target]));
+			mColorTargets->Release(viewportKey(mTargetWidth, mTargetHeight),
+								   std::move(mBlurTempTextures[target]));
+		}
+		mDepthTargets->Release(depthKey(mTargetWidth, mTargetHeight), std::move(mViewportDepth));
+	}
 
-	mViewportTexture->CreateSRV(mViewportSRV.GetCpuHandle());
+	mTargetWidth = targetWidth;
+	mTargetHeight = targetHeight;
 
-	// Recreate blur descriptors for post process
-#ifdef ENABLE_BINDLESS
-	mViewportTexture->CreateSRV({});
-	mViewportTexture->CreateUAV({});
-	mBlurTempTexture->CreateSRV({});
-	mBlurTempTexture->CreateUAV({});
-#else
-	mViewportTexture->CreateSRV(mViewportTextureSRV.GetCpuHandle());
-	mViewportTexture->CreateUAV(mViewportTextureUAV.GetCpuHandle());
-	mBlurTempTexture->CreateSRV(mBlurTempSRV.GetCpuHandle());
-	mBlurTempTexture->CreateUAV(mBlurTempUAV.GetCpuHandle());
-#endif
+	for (uint32_t target = 0; target < 2; ++target)
+	{
+		const Graphics::RenderTargetKey key = viewportKey(mTargetWidth, mTargetHeight);
+		mViewportTextures[target] = mColorTargets->Acquire(key);
+		mBlurTempTextures[target] = mColorTargets->Acquire(key);
+	}
+	mViewportDepth = mDepthTargets->Acquire(depthKey(mTargetWidth, mTargetHeight));
+	mGBuffer->Acquire(*mColorTargets, *mDepthTargets, mTargetWidth, mTargetHeight);
+
+	// The other ImGui slot, its last frame is long done unless the targets
+	// changed twice in a few frames.
+	uint32_t slot = mViewportSRVIndex ^ 1;
+	queue.WaitForFence(mViewportSRVFences[slot]);
+	for (uint32_t target = 0; target < 2; ++target)
+	{
+		mViewportTextures[target]->CreateSRV(mViewportSRVs[slot * 2 + target].GetCpuHandle());
+	}
+	mViewportSRVIndex = slot;
 
-	if (mGBuffer)
+	// Nothing has been drawn yet the first time, the first frame shows
+	// what it draws.
+	if (!mShownTexture)
 	{
-		mGBuffer->Resize(mViewportWidth, mViewportHeight);
-		mLogger->info("GBuffer resized to: {}x{}", mViewportWidth, mViewportHeight);
+		mShownTexture = mViewportTextures[mViewportTarget];
+	}
 
-#ifdef ENABLE_BINDLESS
-		mGBuffer->GetRenderTarget0().CreateSRV({});
-		mGBuffer->GetRenderTarget1().CreateSRV({});
-		mGBuffer->GetRenderTarget2().CreateSRV({});
-		mGBuffer->GetRenderTarget3().CreateSRV({});
-		mGBuffer->GetDepthBuffer().CreateSRV({});
-#else
-		UINT descriptorSize = Graphics::gDevice->GetDescriptorHandleIncrementSize(
-			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-		D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = mGBufferSRVStart.GetCpuHandle();
+#ifndef ENABLE_BINDLESS
+	// These tables are rewritten in place and frames in flight read them,
+	// only bindless gets away without the wait.
+	queue.WaitForFence(queue.GetLastSignaledFenceValue());
 
-		mGBuffer->GetRenderTarget0().CreateSRV(srvHandle);
-		srvHandle.ptr += descriptorSize;
+	for (uint32_t target = 0; target < 2; ++target)
+	{
+		ColorBuffer& viewport = *mViewportTextures[target];
+		ColorBuffer& blurTemp = *mBlurTempTextures[target];
+		viewport.CreateSRV(mViewportTextureSRV[target].GetCpuHandle());
+		blurTemp.CreateSRV(mBlurTempSRV[target].GetCpuHandle());
+		if (!viewport.HasUAV())
+		{
+			viewport.CreateUAV(mViewportTextureUAV[target].GetCpuHandle());
+		}
+		if (!blurTemp.HasUAV())
+		{
+			blurTemp.CreateUAV(mBlurTempUAV[target].GetCpuHandle());
+		}
+	}
 
-		mGBuffer->GetRenderTarget1().CreateSRV(srvHandle);
-		srvHandle.ptr += descriptorSize;
+	UINT descriptorSize =
+		Graphics::gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = mGBufferSRVStart.GetCpuHandle();
 
-		mGBuffer->GetRenderTarget2().CreateSRV(srvHandle);
-		srvHandle.ptr += descriptorSize;
+	mGBuffer->GetRenderTarget0().CreateSRV(srvHandle);
+	srvHandle.ptr += descriptorSize;
 
-		mGBuffer->GetRenderTarget3().CreateSRV(srvHandle);
-		srvHandle.ptr += descriptorSize;
+	mGBuffer->GetRenderTarget1().CreateSRV(srvHandle);
+	srvHandle.ptr += descriptorSize;
 
-		mGBuffer->GetDepthBuffer().CreateSRV(srvHandle);
-#endif
-	}
+	mGBuffer->GetRenderTarget2().CreateSRV(srvHandle);
+	srvHandle.ptr += descriptorSize;
+
+	mGBuffer->GetRenderTarget3().CreateSRV(srvHandle);
+	srvHandle.ptr += descriptorSize;
 
-	SetViewport(width, height);
+	mGBuffer->GetDepthBuffer().CreateSRV(srvHandle);
+#endif
+}
 
-	mLogger->info("Viewport resized to: {}x{}", width, height);
+void Renderer::PlanViewportAliasing()
+{
+	// In the order Render records them, the blur passes run on whichever
+	// queue, the UI reads the viewport at the end of the frame.
+	enum Pass : uint32_t
+	{
+		GEOMETRY_PASS,
+		LIGHTING_PASS,
+		BLUR_HORIZONTAL_PASS,
+		BLUR_VERTICAL_PASS,
+		UI_PASS,
+	};
+
+	auto describe = [](const char* name, const GpuResource& target, uint32_t first,
+					   uint32_t last) {
+		D3D12_RESOURCE_DESC desc = target.GetResource()->GetDesc();
+		D3D12_RESOURCE_ALLOCATION_INFO info =
+			Graphics::gDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+		Graphics::TransientResource resource;
+		resource.mName = name;
+		resource.mSize = info.SizeInBytes;
+		resource.mAlignment = info.Alignment;
+		resource.mFirstPass = first;
+		resource.mLastPass = last;
+		return resource;
+	};
+
+	std::vector<Graphics::TransientResource> resources = {
+		describe("GBuffer_Albedo_AO", mGBuffer->GetRenderTarget0(), GEOMETRY_PASS, LIGHTING_PASS),
+		describe("GBuffer_Normal_Roughness", mGBuffer->GetRenderTarget1(), GEOMETRY_PASS,
+				 LIGHTING_PASS),
+		describe("GBuffer_Metallic_Flags", mGBuffer->GetRenderTarget2(), GEOMETRY_PASS,
+				 LIGHTING_PASS),
+		describe("GBuffer_Emissive", mGBuffer->GetRenderTarget3(), GEOMETRY_PASS, LIGHTING_PASS),
+		describe("GBuffer_Depth", mGBuffer->GetDepthBuffer(), GEOMETRY_PASS, LIGHTING_PASS),
+		describe("ViewportDepth", *mViewportDepth, LIGHTING_PASS, LIGHTING_PASS),
+		describe("ViewportTexture", *mViewportTextures[0], LIGHTING_PASS, UI_PASS),
+		describe("BlurTempTexture", *mBlurTempTextures[0], BLUR_HORIZONTAL_PASS,
+				 BLUR_VERTICAL_PASS),
+		// The second pair for async compute, shown by the UI and possibly
+		// still being blurred while the first is drawn.
+		describe("ViewportTexture1", *mViewportTextures[1], GEOMETRY_PASS, UI_PASS),
+		describe("BlurTempTexture1", *mBlurTempTextures[1], GEOMETRY_PASS, UI_PASS),
+	};
+
+	mTransientAliasing = Graphics::PlanTransientAliasing(resources);
+	mLogger->info("Transient aliasing at {}x{}: {:.1f} MB -> {:.1f} MB, {:.1f} MB saved",
+				  mTargetWidth, mTargetHeight,
+				  static_cast<double>(mTransientAliasing.mUnaliasedSize) / (1024.0 * 1024.0),
+				  static_cast<double>(mTransientAliasing.mAliasedSize) / (1024.0 * 1024.0),
+				  static_cast<double>(mTransientAliasing.GetSavedBytes()) / (1024.0 * 1024.0));
 }
@@ -9,10 +9,25 @@
 #include "graphics/Core.h"
 #include "graphics/Texture.h"
 #include "graphics/DescriptorHeap.h"
+#include "graphics/DescriptorTableCache.h"
 #include "graphics/GBuffer.h"
+#include "graphics/CommandContext.h"
+#include "graphics/RingAllocator.h"
+#include "graphics/UploadBatch.h"
+#include "graphics/UploadScheduler.h"
+#include "graphics/FrameCapture.h"
+#include "graphics/ReadbackBuffer.h"
+#include "graphics/QueueScheduler.h"
+#include "graphics/TransientAliasing.h"
+#include "graphics/texture/ChannelPacker.h"
+#include "graphics/texture/TextureLoadPipeline.h"
+#include "utils/FrameArena.h"
+#include "utils/StringId.h"
 #include "Mesh.h"
 #include "Lighting.h"
 #include "ICamera.h"
+#include <array>
+#include <filesystem>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -25,6 +40,15 @@ namespace Graphics
 
 class UISystem;
 
+/// Textures with the same file contents share one Texture and SRV, these
+/// count how often that happened.
+struct TextureDedupStats
+{
+	uint32_t mUniqueTextures = 0;
+	uint32_t mAliasedPaths = 0;
+	uint64_t mBytesSaved = 0;
+};
+
 /*
 TODO
 [x] Deferred
@@ -63,13 +87,40 @@ public:
 
 	void SetViewport(UINT width, UINT height);
 
-	std::shared_ptr<Mesh> LoadMesh(const std::string& objPath);
-	std::shared_ptr<Texture> LoadTexture(const std::wstring& ddsPath);
+	/// Null handle if the file couldn't be loaded.
+	MeshHandle LoadMesh(const std::string& objPath);
+	Mesh* GetMesh(MeshHandle mesh) const { return mMeshes.Get(mesh); }
+
+	/// Hands a loaded texture to the registry so materials can refer to
+	/// it by handle. The same texture always gets the same handle.
+	TextureHandle RegisterTexture(std::shared_ptr<Texture> texture);
+	Texture* GetTexture(TextureHandle texture) const { return mTextures.Get(texture); }
+	/// DDS files are loaded as is, PNG/JPEG/TGA are decoded and get their
+	/// mips generated with mipDesc. Streams in the background: reading and
+	/// decoding happen off the main thread and Update uploads a few per
+	/// frame. The handle resolves to null (drawn with the null SRV) until
+	/// the copy is done, and stays null if the load fails. The same path
+	/// always gets the same handle.
+	TextureHandle LoadTexture(const std::wstring& path, const TextureTools::MipDesc& mipDesc = {});
+
+	const TextureDedupStats& GetTextureDedupStats() const { return mTextureDedupStats; }
 
 	/// The JSON loader for some material that we defined as the
 	/// material .json metadata (in Assets/Material folder).
 	MaterialAsset LoadMaterialAsset(const std::string& materialName);
 
+	/// Same as LoadMaterialAsset for several materials. Their small
+	/// PNG/JPEG/TGA maps get packed into shared atlas pages (one set per
+	/// kind of map) instead of each becoming its own texture, the regions
+	/// in the returned assets say where each map ended up.
+	std::vector<MaterialAsset> LoadMaterialAssets(const std::vector<std::string>& materialNames);
+
+	/// Loads a lat-long .hdr environment for image based lighting. The
+	/// SH irradiance, prefiltered cube and BRDF LUT are baked on the worker
+	/// pool the first time and cached on disk (cache/ibl) after that.
+	/// Without one the lighting pass uses the flat ambient colour.
+	bool LoadEnvironment(const std::wstring& hdrPath);
+
 	void AddSpotLight(const SpotLight& light);
 
 	Scene* GetScene() const { return mScene.get(); }
@@ -86,45 +137,220 @@ public:
 			mLightBuffer->Upload(mSpotLights.data(), mSpotLights.size() * sizeof(SpotLight));
 	}
 
-	D3D12_GPU_DESCRIPTOR_HANDLE GetViewportSRV() const { return mViewportSRV.GetGpuHandle(); }
+	D3D12_GPU_DESCRIPTOR_HANDLE GetViewportSRV() const
+	{
+		return mViewportSRVs[mViewportSRVIndex * 2 + mShownTarget].GetGpuHandle();
+	}
 
-	/// ResizeViewport recreates the offscreen render target to match
-	/// the ImGui viewport widget's size. The 3d scene is rendered to
-	/// this texture at its native resolution (no scaling), then ImGui
-	/// displays it 1:1 in the viewport widget wherever it's docked.
+	/// How much of the viewport texture holds the image, the bottom right
+	/// UV for the ImGui widget. The targets are allocated a bucket at a
+	/// time so they're usually a little bigger than the widget.
+	float GetViewportUVWidth() const
+	{
+		return static_cast<float>(mViewportWidth) / static_cast<float>(mTargetWidth);
+	}
+	float GetViewportUVHeight() const
+	{
+		return static_cast<float>(mViewportHeight) / static_cast<float>(mTargetHeight);
+	}
+
+	/// ResizeViewport matches the offscreen render targets to the ImGui
+	/// viewport widget's size. The 3d scene is rendered at its native
+	/// resolution (no scaling) into the top left of the targets, and ImGui
+	/// displays that part 1:1 wherever it's docked. The targets come from
+	/// size bucketed pools and are only swapped once a new size has held
+	/// for a few frames, the old ones go back to the pools behind the
+	/// frame's fence instead of waiting on the GPU.
 	void ResizeViewport(uint32_t width, uint32_t height);
 
+	const Graphics::RenderTargetPoolStats& GetColorTargetStats() const
+	{
+		return mColorTargets->GetStats();
+	}
+	const Graphics::RenderTargetPoolStats& GetDepthTargetStats() const
+	{
+		return mDepthTargets->GetStats();
+	}
+
+	/// How the viewport sized targets could share memory given which
+	/// passes use them, planned whenever they're reallocated.
+	const Graphics::AliasingPlan& GetTransientAliasingPlan() const { return mTransientAliasing; }
+	const Utils::FrameArenaStats& GetFrameArenaStats() const { return mFrameArena.GetStats(); }
+	/// operator new calls between the last two Updates, 0 once the frames
+	/// settle.
+	uint64_t GetFrameHeapAllocations() const { return mFrameHeapAllocations; }
+	const Graphics::UploadSchedulerStats& GetUploadStats() const
+	{
+		return mUploadScheduler->GetStats();
+	}
+	const Graphics::UploadHitchHistogram& GetUploadHitchHistogram() const
+	{
+		return mUploadScheduler->GetHitchHistogram();
+	}
+
+	/// Saves the viewport as the next Render leaves it to path (.png, .qoi
+	/// or .exr). The copy is read back a few frames later and a worker
+	/// writes the file. False when every readback buffer is in flight.
+	bool CaptureFrame(const std::filesystem::path& path);
+	const Graphics::FrameCaptureStats& GetFrameCaptureStats() const
+	{
+		return mFrameCapture->GetStats();
+	}
+
 	/// Post process
 	float GetBlurIntensity() const { return mBlurIntensity; }
 	void SetBlurIntensity(float intensity) { mBlurIntensity = intensity; }
 
+	/// Blur on the compute queue instead of the end of the frame's list.
+	/// The UI then shows the viewport a frame late, so the blur can run
+	/// alongside the next frame's scene.
+	bool GetAsyncCompute() const { return mAsyncCompute; }
+	void SetAsyncCompute(bool enabled) { mAsyncCompute = enabled; }
+
 private:
 	void InitLogger();
 
+	/// A map some material wants, pointing back into the MaterialAsset.
+	struct MaterialTextureSlot
+	{
+		std::wstring mPath;
+		TextureTools::MipDesc mMipDesc;
+		TextureHandle* mTexture;
+		TextureRegion* mRegion;
+	};
+
+	/// Cooks each material's occlusion/roughness/metallic maps into one
+	/// ORM texture (cached in cache/orm) and adds a slot for it. Materials
+	/// whose maps can't be packed get slots for the separate maps instead.
+	void CookORMTextures(std::vector<MaterialAsset>& materials,
+						 const std::vector<TextureTools::ORMSources>& sources,
+						 std::vector<MaterialTextureSlot>& slots);
+
+	/// Packs the small image maps of the slots into atlas pages and fills
+	/// those slots in. Slots that don't qualify are left in the list.
+	void PackTextureAtlases(std::vector<MaterialTextureSlot>& slots);
+
+	/// Plugs the Texture read/decode/upload steps into mTextureLoader.
+	void InitTextureLoader();
+	/// Hooks mUploadBatch up to the copy queue and mCopyContext, and
+	/// creates mUploadScheduler.
+	void InitUploadBatch();
+
+	/// Queue the copies with mUploadScheduler, they get recorded over the
+	/// next frames. Drawing skips the mesh until they have been.
+	void ScheduleMeshUpload(const std::shared_ptr<Mesh>& mesh);
+
+	/// Fills one table of mMaterialTextureSRVStart for mMaterialTables,
+	/// null SRVs where the key has no texture.
+	void WriteMaterialTable(uint32_t table, const Graphics::DescriptorTableKey& key);
+
+	/// Readback ring for CaptureFrame.
+	void InitFrameCapture();
+	/// Copies the visible part of the viewport into the slot's readback
+	/// buffer, (re)creating it when the size changed.
+	bool RecordCaptureCopy(uint32_t slot, uint32_t width, uint32_t height);
+
+	/// Compute context plus the scheduler over the CommandListManager queues.
+	void InitQueueScheduler();
+
+	/// The color and depth pools behind the viewport and GBuffer targets.
+	void InitRenderTargetPools();
+
+	/// Swaps the viewport, blur and GBuffer targets for pooled ones of
+	/// targetWidth x targetHeight and points their descriptors at them.
+	void AcquireViewportTargets(uint32_t targetWidth, uint32_t targetHeight);
+
+	/// Plans aliasing for the current viewport targets over the frame's
+	/// passes and logs what it would save.
+	void PlanViewportAliasing();
+
+	/// Both blur passes over mViewportTarget, into whichever context
+	/// (graphics or compute) runs them. Leaves the viewport as a UAV.
+	void RecordBlur(Graphics::GraphicsContext& context);
+
+	/// Tells the residency manager this frame samples texture.
+	static void MarkTextureUsed(const Texture* texture);
+
 	std::unique_ptr<Scene> mScene;
-	std::unordered_map<std::string, std::shared_ptr<Mesh>> mMeshCache;
-	std::unordered_map<std::wstring, std::shared_ptr<Texture>> mTextureCache;
-	std::unordered_map<std::string, MaterialAsset> mMaterialLibrary;
+	std::unordered_map<Utils::StringId, MeshHandle> mMeshCache;
+
+	/// Own what entities and materials refer to by handle.
+	Graphics::ResourceRegistry<Mesh> mMeshes;
+	Graphics::ResourceRegistry<Texture> mTextures;
+	std::unordered_map<std::wstring, TextureHandle> mTextureCache;
+	/// Keyed by the hash of the file contents (and mip settings), the
+	/// path cache above points several paths at the same entry.
+	std::unordered_map<uint64_t, std::shared_ptr<Texture>> mTextureByContent;
+	TextureDedupStats mTextureDedupStats;
+
+	/// Mesh and texture loads record into mCopyContext and go out on the
+	/// copy queue as one batch, the graphics queue waits for it on the GPU.
+	std::unique_ptr<Graphics::GraphicsContext> mCopyContext;
+	std::unique_ptr<Graphics::UploadBatch> mUploadBatch;
+	/// Decides which of the queued copies go into this frame's batch.
+	std::unique_ptr<Graphics::UploadScheduler> mUploadScheduler;
+
+	/// Viewport captures. A slot's buffer is only touched again once
+	/// FrameCapture has read it back, so resizing it never waits.
+	std::vector<std::unique_ptr<Graphics::ReadbackBuffer>> mCaptureBuffers;
+	std::vector<uint32_t> mCaptureRowPitches;
+	std::unique_ptr<Graphics::FrameCapture> mFrameCapture;
+	/// Set by CaptureFrame, recorded at the end of the next Render into
+	/// mCaptureContext.
+	std::filesystem::path mCaptureRequest;
+	Graphics::GraphicsContext* mCaptureContext = nullptr;
+	/// The most frames ConfigSettings::frameLatency allows in flight plus
+	/// the one being recorded, so capturing every frame never drops.
+	static constexpr uint32_t CAPTURE_RING_SIZE = 5;
+
+	/// Post processing on the compute queue, ordered against the graphics
+	/// queue by the scheduler's fences.
+	std::unique_ptr<Graphics::GraphicsContext> mComputeContext;
+	std::unique_ptr<Graphics::QueueScheduler> mQueueScheduler;
+	bool mAsyncCompute = false;
+
+	/// Streaming uploads get recorded into mStreamingContext. Begin takes a
+	/// fresh allocator each time, so one context is enough.
+	std::unique_ptr<Graphics::GraphicsContext> mStreamingContext;
+	bool mStreamingRecording = false;
+	/// Declared after the contexts so its threads stop first.
+	std::unique_ptr<TextureTools::TextureLoadPipeline> mTextureLoader;
+	static constexpr uint32_t MAX_STREAMING_UPLOADS_PER_FRAME = 8;
+
+	struct AtlasEntry
+	{
+		TextureHandle mTexture;
+		TextureRegion mRegion;
+	};
+	/// Maps packed into an atlas page, by path.
+	std::unordered_map<std::wstring, AtlasEntry> mAtlasCache;
+	std::unordered_map<Utils::StringId, MaterialAsset> mMaterialLibrary;
 
 	DescriptorHeap mTextureHeap;
 	DescriptorHeap mSamplerHeap;
 	DescriptorHandle mSamplerHandle;
 
-	UploadBuffer mConstantUploadBuffer;
-	UploadBuffer mMaterialUploadBuffer;
-	UploadBuffer mLightingUploadBuffer;
+	/// Transform, material and lighting constants, fresh memory every draw.
+	std::unique_ptr<Graphics::RingAllocator> mDynamicConstants;
 
 	Transform mConstants;
 
 	static constexpr uint32_t MAX_MATERIALS = 64;
-	DescriptorHandle mMaterialCBVStart;
 
-	// 4 SRVs per entity - albedo, normal, metallic, roughness
+	// 4 SRVs per material table - albedo, normal, metallic, roughness
 	DescriptorHandle mMaterialTextureSRVStart;
+	/// Which textures each table holds, without bindless. Entities with
+	/// the same textures share a table and it's only written once.
+	std::unique_ptr<Graphics::DescriptorTableCache> mMaterialTables;
 
-	// 4 SRVs for GBuffer textures - albedo/AO, normal/rough, metallic/flags, emissive
+	// 7 SRVs for the lighting pass - albedo/AO, normal/rough, metallic/flags, emissive,
+	// depth, then the prefiltered environment and BRDF LUT
 	DescriptorHandle mGBufferSRVStart;
 
+	/// Image based lighting, null when no environment is loaded.
+	std::shared_ptr<Texture> mEnvironmentCube;
+	std::shared_ptr<Texture> mBrdfLut;
+
 	std::vector<SpotLight> mSpotLights;
 	std::unique_ptr<Graphics::StructuredBuffer> mLightBuffer;
 
@@ -135,30 +361,65 @@ private:
 
 	std::unique_ptr<ICamera> mCamera;
 
-	/// Viewport offscreen rendering.
-	std::unique_ptr<ColorBuffer> mViewportTexture;
-	std::unique_ptr<DepthBuffer> mViewportDepth;
-	DescriptorHandle mViewportSRV;
+	/// Viewport offscreen rendering. Two targets for async compute, the UI
+	/// shows the one last frame blurred while the compute queue is still
+	/// blurring this frame's. mViewportTarget is the one Render draws into.
+	std::array<std::shared_ptr<ColorBuffer>, 2> mViewportTextures;
+	std::shared_ptr<DepthBuffer> mViewportDepth;
+	uint32_t mViewportTarget = 0;
+	/// What the UI samples this frame, kept alive if a resize swaps it
+	/// out. Its blur, if that went to the compute queue, is waited for
+	/// on the graphics queue right before the UI draws it.
+	std::shared_ptr<ColorBuffer> mShownTexture;
+	uint32_t mShownTarget = 0;
+	Graphics::QueueFence mShownBlur;
+
+	/// Two ImGui SRV slots for each viewport texture, slot * 2 + target.
+	/// Frames in flight may still draw the UI from one when the targets
+	/// change, the new textures go in the other. Each slot has the fence
+	/// of the last frame drawn from it.
+	std::array<DescriptorHandle, 4> mViewportSRVs;
+	std::array<uint64_t, 2> mViewportSRVFences = {};
+	uint32_t mViewportSRVIndex = 0;
+	/// The slot the UI draws from this frame, GetViewportSRV is called
+	/// before ResizeViewport.
+	uint32_t mDisplayedSRVIndex = 0;
 
 	std::unique_ptr<GBuffer> mGBuffer;
 
 	/// Blur post process intermediate texture since we can not modify
-	/// in place of the textures.
-	std::unique_ptr<ColorBuffer> mBlurTempTexture;
+	/// in place of the textures. One per viewport target, so the next
+	/// frame's list never touches the one the compute queue is using.
+	std::array<std::shared_ptr<ColorBuffer>, 2> mBlurTempTextures;
+
+	/// Every viewport sized target comes from these.
+	std::unique_ptr<ColorTargetPool> mColorTargets;
+	std::unique_ptr<DepthTargetPool> mDepthTargets;
+	Graphics::ResizeCoalescer mResizeCoalescer;
+	Graphics::AliasingPlan mTransientAliasing;
+
+	/// Per-frame scratch memory, reset at the start of Update.
+	Utils::FrameArena mFrameArena;
+	uint64_t mHeapAllocationsAtUpdate = 0;
+	uint64_t mFrameHeapAllocations = 0;
 
-	DescriptorHandle mViewportTextureSRV;
-	DescriptorHandle mViewportTextureUAV;
+	std::array<DescriptorHandle, 2> mViewportTextureSRV;
+	std::array<DescriptorHandle, 2> mViewportTextureUAV;
 
-	DescriptorHandle mBlurTempSRV;
-	DescriptorHandle mBlurTempUAV;
+	std::array<DescriptorHandle, 2> mBlurTempSRV;
+	std::array<DescriptorHandle, 2> mBlurTempUAV;
 
 	float mBlurIntensity = 0.0F;
 
 	/// Probably misleading naming, the this viewport width and height
-	/// are for the actual texture generated for the viewport widget.
+	/// are what gets rendered for the viewport widget.
 	/// Will get overriden anyway immediately.
 	uint32_t mViewportWidth = 1280;
 	uint32_t mViewportHeight = 800;
+	/// Size of the viewport textures, the render size rounded up to a
+	/// bucket.
+	uint32_t mTargetWidth = 1280;
+	uint32_t mTargetHeight = 800;
 
 	std::shared_ptr<spdlog::logger> mLogger;
 };
@@ -4,10 +4,10 @@
 #include <algorithm>
 #include <utility>
 
-Entity* Scene::AddEntity(const std::string& name, std::shared_ptr<Mesh> mesh)
+Entity* Scene::AddEntity(const std::string& name, MeshHandle mesh)
 {
 	auto entity = std::make_unique<Entity>(mNextEntityId++, name);
-	entity->SetMesh(std::move(mesh));
+	entity->SetMesh(mesh);
 
 	Entity* ptr = entity.get();
 	mEntities.push_back(std::move(entity));
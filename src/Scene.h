@@ -18,7 +18,7 @@ class Scene
 public:
 	Scene() = default;
 
-	Entity* AddEntity(const std::string& name, std::shared_ptr<Mesh> mesh);
+	Entity* AddEntity(const std::string& name, MeshHandle mesh);
 	void RemoveEntity(uint32_t id);
 
 	Entity* GetEntity(uint32_t id);
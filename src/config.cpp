@@ -16,6 +16,8 @@ nlohmann::json ConfigSettings::ToJson() const
 	j["windowWidth"] = windowWidth;
 	j["windowHeight"] = windowHeight;
 	j["heapSize"] = heapSize;
+	j["frameLatency"] = frameLatency;
+	j["asyncCompute"] = asyncCompute;
 	j["assetPath"] = assetPath.string();
 	j["maxEntities"] = maxEntities;
 	j["maxMaterials"] = maxMaterials;
@@ -34,6 +36,10 @@ ConfigSettings ConfigSettings::FromJson(const nlohmann::json& json)
 		settings.windowHeight = json["windowHeight"].get<uint32_t>();
 	if (json.contains("heapSize"))
 		settings.heapSize = json["heapSize"].get<uint32_t>();
+	if (json.contains("frameLatency"))
+		settings.frameLatency = json["frameLatency"].get<uint32_t>();
+	if (json.contains("asyncCompute"))
+		settings.asyncCompute = json["asyncCompute"].get<bool>();
 	if (json.contains("assetPath"))
 		settings.assetPath = json["assetPath"].get<std::string>();
 	if (json.contains("maxEntities"))
@@ -13,6 +13,8 @@ struct ConfigSettings
 
 	// Graphics settings
 	uint32_t heapSize = 1000000; // Almost always going to use 1m descriptors
+	uint32_t frameLatency = 2;   // Frames the CPU may record ahead of the GPU, 1 to 4
+	bool asyncCompute = false;   // Post processing on the compute queue, a frame late
 
 	// Asset paths
 	std::filesystem::path assetPath = "assets";
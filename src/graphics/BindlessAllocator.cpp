@@ -36,7 +36,7 @@ bool BindlessAllocator::Initialize(uint32_t numDescriptors,
 	}
 
 	// Init with descriptor size and all zeroes
-	mGenerations.resize(numDescriptors, 0);
+	mGenerations = std::make_unique<std::atomic<uint32_t>[]>(numDescriptors);
 
 	mDescriptorSize = Graphics::gDevice->GetDescriptorHandleIncrementSize(mDescriptorType);
 
@@ -58,12 +58,40 @@ bool BindlessAllocator::Initialize(uint32_t numDescriptors,
 								 : D3D12_GPU_DESCRIPTOR_HANDLE{0};
 
 	mHeapCount = numDescriptors;
-	mNextFreeIndex = 0;
+	mRanges.Reset(numDescriptors);
+	mMemory.Set(static_cast<size_t>(numDescriptors) * mDescriptorSize);
+
+	Graphics::DescriptorSlotPoolDesc slotDesc;
+	slotDesc.mGrow = [this](uint32_t count)
+	{
+		std::lock_guard<std::mutex> lock(mRangesMutex);
+		Graphics::RangeAllocation range = mRanges.Allocate(count);
+		if (!range.IsValid())
+		{
+			return Graphics::DescriptorSlotPool::INVALID_SLOT;
+		}
+
+		uint32_t first = range.mOffset;
+		for (uint32_t i = 1; i < count; ++i)
+		{
+			Graphics::RangeAllocation rest = mRanges.Split(range, 1);
+			mSlotNodes[range.mOffset] = range.mNode;
+			range = rest;
+		}
+		mSlotNodes[range.mOffset] = range.mNode;
+		return first;
+	};
+	slotDesc.mShrink = [this](uint32_t slot)
+	{
+		std::lock_guard<std::mutex> lock(mRangesMutex);
+		mRanges.Free({slot, 1, mSlotNodes[slot]});
+	};
+	mSlotNodes.assign(numDescriptors, Graphics::RangeAllocation::INVALID);
+	mSlots = std::make_unique<Graphics::DescriptorSlotPool>(slotDesc);
 
 	// Reserve the first  5 indices dedicated to nulls
 	Allocation nullReservations = Allocate(5);
-	assert(nullReservations.mStartIndex == 0);
-	assert(mNextFreeIndex == 5);
+	assert(nullReservations.mStartIndex == 0 && nullReservations.mCount == 5);
 	CreateNullDescriptors();
 
 	return true;
@@ -72,64 +100,86 @@ bool BindlessAllocator::Initialize(uint32_t numDescriptors,
 void BindlessAllocator::Shutdown()
 {
 	// Process any remaining pending deletions before we ultimately shutdown
-	if (!mPendingDeletion.empty())
+	size_t pending = mPendingDeletion.size();
+	if (mSlots)
 	{
-		sLogger->warn("Shutting down with {} pending deletions", mPendingDeletion.size());
+		pending += mSlots->GetStats().mPendingFrees;
+		mSlots->ProcessDeletions(UINT64_MAX);
+		mSlots.reset();
+	}
+	if (pending > 0)
+	{
+		sLogger->warn("Shutting down with {} pending deletions", pending);
+	}
 
+	{
+		std::lock_guard<std::mutex> lock(mRangesMutex);
 		while (!mPendingDeletion.empty())
 		{
 			Free(mPendingDeletion.front().mAllocation);
 			mPendingDeletion.pop();
 		}
+		mRanges.Reset(0);
 	}
-
-	mFreeList.clear();
 	mHeap.Reset();
+	mMemory.Set(0);
 
 	sLogger->info("Shutdown complete");
 }
 
 Allocation BindlessAllocator::Allocate(uint32_t count)
 {
-	Allocation res = {};
-
-	if (mFreeList.contains(count) && !mFreeList.at(count).empty())
+	// Nearly everything is a single SRV or UAV, those skip the lock.
+	if (count == 1 && mSlots)
 	{
-		// Free list contains available _count_ of descriptors. Use the value pair to get start.
-		res.mCount = count;
-		res.mStartIndex = mFreeList.at(count).back();
-		res.mGeneration = mGenerations[res.mStartIndex];
-
-		mFreeList.at(count).pop_back();
+		uint32_t slot = mSlots->Allocate();
+		if (slot != Graphics::DescriptorSlotPool::INVALID_SLOT)
+		{
+			return {.mStartIndex = slot,
+					.mCount = 1,
+					.mGeneration = mGenerations[slot].load(),
+					.mNode = SLOT_NODE};
+		}
 	}
 	else
 	{
-		if (mNextFreeIndex + count > mHeapCount)
+		std::lock_guard<std::mutex> lock(mRangesMutex);
+		Graphics::RangeAllocation range = mRanges.Allocate(count);
+		if (range.IsValid())
 		{
-			sLogger->error("Out of bounds");
-			return {.mStartIndex = UINT32_MAX, .mCount = UINT32_MAX, .mGeneration = UINT32_MAX};
+			return {.mStartIndex = range.mOffset,
+					.mCount = range.mSize,
+					.mGeneration = mGenerations[range.mOffset].load(),
+					.mNode = range.mNode};
 		}
-
-		// Free list is empty OR no suitable allocation
-		// TODO should be implemented to find split blocks or something
-		res.mCount = count;
-		res.mStartIndex = mNextFreeIndex;
-		res.mGeneration = mGenerations[res.mStartIndex];
-
-		mNextFreeIndex += count;
 	}
 
-	return res;
+	{
+		std::lock_guard<std::mutex> lock(mRangesMutex);
+		sLogger->error("Out of descriptors: {} requested, {} free, largest free block {}", count,
+					   mRanges.GetFreeSize(), mRanges.GetLargestFreeRange());
+	}
+	return {.mStartIndex = UINT32_MAX,
+			.mCount = UINT32_MAX,
+			.mGeneration = UINT32_MAX,
+			.mNode = UINT32_MAX};
 }
 
 bool BindlessAllocator::Free(Allocation allocation)
 {
-	if (allocation.mStartIndex > mHeapCount || !allocation.IsValid())
+	// Called with mRangesMutex held.
+	// A stale generation means the block was freed already.
+	if (!allocation.IsValid() || !IsValid(allocation))
 	{
 		return false;
 	}
 
-	mFreeList[allocation.mCount].push_back(allocation.mStartIndex);
+	if (!mRanges.Free({allocation.mStartIndex, allocation.mCount, allocation.mNode}))
+	{
+		sLogger->warn("Free of {} descriptors at index {} that aren't allocated",
+					  allocation.mCount, allocation.mStartIndex);
+		return false;
+	}
 
 	uint32_t total = allocation.mStartIndex + allocation.mCount;
 
@@ -159,12 +209,33 @@ DescriptorHandle BindlessAllocator::GetHandle(uint32_t index)
 
 void BindlessAllocator::FreeDeferred(Allocation allocation, uint64_t fence)
 {
+	if (allocation.mNode == SLOT_NODE)
+	{
+		// The generation moves on now rather than when the fence passes, so
+		// a second free of the same handle is caught here. The slot itself
+		// stays out of circulation until the GPU is done with it.
+		uint32_t expected = allocation.mGeneration;
+		if (allocation.mStartIndex >= mHeapCount ||
+			!mGenerations[allocation.mStartIndex].compare_exchange_strong(expected, expected + 1))
+		{
+			sLogger->warn("Deferred free of descriptor {} that isn't allocated",
+						  allocation.mStartIndex);
+			return;
+		}
+		mSlots->FreeDeferred(allocation.mStartIndex, fence);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mRangesMutex);
 	mPendingDeletion.push({.mAllocation = allocation, .mFence = fence});
 	// sLogger->info("Deferred Deletionf for allocation at fence {}", fence);
 }
 
 void BindlessAllocator::ProcessDeletions(uint64_t completedFence)
 {
+	mSlots->ProcessDeletions(completedFence);
+
+	std::lock_guard<std::mutex> lock(mRangesMutex);
 	while (!mPendingDeletion.empty())
 	{
 		auto& pendingDeletion = mPendingDeletion.front();
@@ -193,7 +264,7 @@ bool BindlessAllocator::IsValid(const Allocation& allocation) const
 		return false;
 	}
 
-	return mGenerations[allocation.mStartIndex] == allocation.mGeneration;
+	return mGenerations[allocation.mStartIndex].load() == allocation.mGeneration;
 }
 
 void BindlessAllocator::CreateNullDescriptors()
@@ -3,11 +3,15 @@
 #include <queue>
 #include <wrl.h>
 #include "DescriptorHeap.h"
+#include "DescriptorSlotPool.h"
+#include "RangeAllocator.h"
+#include "../utils/MemoryTracker.h"
 #include "directx/d3d12.h"
+#include <atomic>
 #include <cstdint>
-#include <map>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <spdlog/spdlog.h>
 
 struct Allocation
@@ -18,9 +22,12 @@ struct Allocation
 	/// Using generations to prevent stale or invalid indices.
 	uint32_t mGeneration;
 
+	/// The range allocator's node for the block, needed to free it.
+	uint32_t mNode;
+
 	bool IsValid() const { return mCount != UINT32_MAX && mStartIndex != UINT32_MAX; }
 
-	void Reset() { mStartIndex = mCount = mGeneration = UINT32_MAX; }
+	void Reset() { mStartIndex = mCount = mGeneration = mNode = UINT32_MAX; }
 };
 
 struct PendingDeletion
@@ -41,6 +48,9 @@ enum NullDescriptor
 
 class DescriptorHandle;
 
+/// Allocate, FreeDeferred, IsValid and GetGeneration can be called from any
+/// thread. Single descriptors come out of a DescriptorSlotPool with a cache
+/// per thread, tables go through the range allocator under a lock.
 class BindlessAllocator
 {
 
@@ -69,7 +79,9 @@ public:
 	void ProcessDeletions(uint64_t completedFence);
 
 	/// Generation
-	uint32_t GetGeneration(uint32_t index) { return mGenerations[index]; }
+	uint32_t GetGeneration(uint32_t index) { return mGenerations[index].load(); }
+
+	Graphics::DescriptorSlotPoolStats GetSlotStats() const { return mSlots->GetStats(); }
 
 	bool IsValid(const Allocation& allocation) const;
 
@@ -81,11 +93,12 @@ private:
 
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
 	D3D12_DESCRIPTOR_HEAP_TYPE mDescriptorType;
+	Utils::MemoryCharge mMemory{Utils::MemoryTag::DESCRIPTORS};
 
 	uint32_t mHeapCount;
-	uint32_t mNextFreeIndex;
 
-	std::vector<uint32_t> mGenerations;
+	/// Atomic so IsValid can run on any thread while another frees.
+	std::unique_ptr<std::atomic<uint32_t>[]> mGenerations;
 
 	uint32_t mDescriptorSize;
 
@@ -95,23 +108,27 @@ private:
 
 	D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart;
 
-	/// Free List
-	/// NOTE look into intrusive lists for optimization
+	/// mNode of a single descriptor from mSlots, it has no range of its own.
+	static constexpr uint32_t SLOT_NODE = UINT32_MAX - 1;
+
+	/// Free ranges of the heap. Freed blocks merge with their free
+	/// neighbours and bigger ones get split, so churn doesn't fragment the
+	/// heap until it runs out the way exact size reuse did.
+	Graphics::RangeAllocator mRanges;
+
+	/// Guards mRanges, mSlotNodes and mPendingDeletion.
+	std::mutex mRangesMutex;
 
-	/// This data structure uses:
-	///     Key:   Block size, how many descriptors
-	///     Value: List of start indcies with that (key) size
-	///
-	/// When we free an Allocation {startIndex, count}, example we add to the free list
-	/// that we just free 10 descriptors at index 50, so mFreeList[10].push_back(50).
-	///
-	/// In other words, track how many slots in the descriptor heap we can reuse.
-	/// NOTE Slow, look into splitting or optimization if profile shows slowness.
-	std::map<uint32_t, std::vector<uint32_t>> mFreeList;
+	/// Single descriptors, carved from mRanges a magazine at a time. The
+	/// run is split into one range per slot, so slots the pool has too
+	/// many of go back one by one and merge with their free neighbours.
+	std::unique_ptr<Graphics::DescriptorSlotPool> mSlots;
+	/// mRanges node of each slot mSlots holds, by index.
+	std::vector<uint32_t> mSlotNodes;
 
 	bool Free(Allocation allocation);
 
-	/// Pending Queue
+	/// Pending Queue, tables only. Single descriptors wait in mSlots.
 	std::queue<PendingDeletion> mPendingDeletion;
 
 	/// Logger
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace Graphics
+{
+	struct CommandAllocatorPoolStats
+	{
+		uint32_t mCreated = 0;
+		uint64_t mReused = 0;
+		/// Discarded allocators still waiting on their fence.
+		uint32_t mRetired = 0;
+	};
+
+	/// Command allocators of one list type, each one given back tagged with
+	/// the fence of the last list recorded from it. Request reuses the
+	/// oldest one whose fence has completed and only creates a new one
+	/// when they're all still on the GPU, so an allocator is never reset
+	/// under a running list no matter who else waits on what.
+	/// T is a ComPtr<ID3D12CommandAllocator> on the CommandQueue, anything
+	/// copyable in the tests. Not thread safe.
+	template <typename T>
+	class CommandAllocatorPool
+	{
+	public:
+		using Factory = std::function<T()>;
+		/// Resets an allocator that's about to be reused.
+		using Reset = std::function<void(T&)>;
+
+		CommandAllocatorPool(Factory factory, Reset reset)
+		: mFactory(std::move(factory))
+		, mReset(std::move(reset))
+		{
+		}
+
+		CommandAllocatorPool(const CommandAllocatorPool&) = delete;
+		CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
+
+		/// completedFence is what the queue has finished, the allocator
+		/// returned is ready to record into.
+		T Request(uint64_t completedFence)
+		{
+			// Allocators come back in fence order (near enough), so only
+			// the front needs checking.
+			if (!mRetired.empty() && mRetired.front().mFence <= completedFence)
+			{
+				T allocator = std::move(mRetired.front().mAllocator);
+				mRetired.pop_front();
+				mReset(allocator);
+				mStats.mReused++;
+				mStats.mRetired = static_cast<uint32_t>(mRetired.size());
+				return allocator;
+			}
+
+			mStats.mCreated++;
+			return mFactory();
+		}
+
+		/// fence is the value the queue signals after the last list
+		/// recorded from allocator.
+		void Discard(uint64_t fence, T allocator)
+		{
+			mRetired.push_back({fence, std::move(allocator)});
+			mStats.mRetired = static_cast<uint32_t>(mRetired.size());
+		}
+
+		/// Every allocator made so far, handed out or not.
+		uint32_t GetSize() const { return mStats.mCreated; }
+		const CommandAllocatorPoolStats& GetStats() const { return mStats; }
+
+	private:
+		struct Retired
+		{
+			uint64_t mFence;
+			T mAllocator;
+		};
+
+		Factory mFactory;
+		Reset mReset;
+		std::deque<Retired> mRetired;
+		CommandAllocatorPoolStats mStats;
+	};
+} // namespace Graphics
@@ -32,18 +32,34 @@ namespace Graphics
 		assert(pDevice != nullptr);
 		mType = type;
 
-		HRESULT hr = pDevice->CreateCommandAllocator(type, IID_PPV_ARGS(&mAllocator));
-		assert(SUCCEEDED(hr) && "Failed to create command allocator");
+		CommandQueue& queue = gCommandListManager->GetQueue(type);
+		assert(queue.GetType() == type && "No queue for this command list type");
+		mAllocator = queue.RequestAllocator();
 
-		hr = pDevice->CreateCommandList(0, type, mAllocator.Get(), nullptr,
-										IID_PPV_ARGS(&mCommandList));
+		HRESULT hr = pDevice->CreateCommandList(0, type, mAllocator.Get(), nullptr,
+												IID_PPV_ARGS(&mCommandList));
 		assert(SUCCEEDED(hr) && "Failed to create command list");
 
 		mCommandList->Close();
 	}
 
+	void CommandContext::ReleaseAllocator()
+	{
+		if (!mAllocator || !gCommandListManager)
+		{
+			return;
+		}
+
+		// Flush leaves the execute to the caller so the exact fence isn't
+		// known here. It has been submitted by now though, and the last
+		// signaled value is at or past it.
+		CommandQueue& queue = gCommandListManager->GetQueue(mType);
+		queue.DiscardAllocator(queue.GetLastSignaledFenceValue(), std::move(mAllocator));
+	}
+
 	void CommandContext::Shutdown()
 	{
+		ReleaseAllocator();
 		mCommandList.Reset();
 		mAllocator.Reset();
 		mRootSignature.Reset();
@@ -52,11 +68,13 @@ namespace Graphics
 
 	void CommandContext::Begin()
 	{
-		// Start fresh for every new frame
-		HRESULT hr = mAllocator->Reset();
-		assert(SUCCEEDED(hr) && "Failed to reset command allocator");
+		// A fresh allocator from the queue's pool every time, the one used
+		// last goes back tagged with its fence. The list itself can be
+		// reset as soon as it was submitted.
+		ReleaseAllocator();
+		mAllocator = gCommandListManager->GetQueue(mType).RequestAllocator();
 
-		hr = mCommandList->Reset(mAllocator.Get(), mPipelineState.Get());
+		HRESULT hr = mCommandList->Reset(mAllocator.Get(), mPipelineState.Get());
 		assert(SUCCEEDED(hr) && "Failed to reset command list");
 
 		// NOTE Commented out for bindless
@@ -82,17 +100,19 @@ namespace Graphics
 		HRESULT hr = mCommandList->Close();
 		assert(SUCCEEDED(hr) && "Failed to close command list");
 
-		// NOTE Misleading name for GetGraphicsQueue(), will work for
-		// both graphics and compute pipelines.
-		auto& queue = gCommandListManager->GetGraphicsQueue();
-		return queue.ExecuteCommandList(mCommandList.Get());
+		// Copy contexts go to the copy queue, graphics and compute both
+		// still run on the graphics queue.
+		auto& queue = gCommandListManager->GetQueue(mType);
+		uint64_t fenceValue = queue.ExecuteCommandList(mCommandList.Get());
+		queue.DiscardAllocator(fenceValue, std::move(mAllocator));
+		return fenceValue;
 	}
 
 	void CommandContext::ExecuteAndWait()
 	{
 		uint64_t fenceValue = Execute();
 
-		auto& queue = gCommandListManager->GetGraphicsQueue();
+		auto& queue = gCommandListManager->GetQueue(mType);
 		queue.WaitForFence(fenceValue);
 	}
 
@@ -100,6 +120,17 @@ namespace Graphics
 	{
 		D3D12_RESOURCE_STATES oldState = resource.mUsageState;
 
+		// Copy lists can't use the read states. Everything a copy queue
+		// touches decays to COMMON once it's done, and the graphics queue
+		// promotes it from there on first use.
+		const D3D12_RESOURCE_STATES COPY_STATES =
+			D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_COPY_SOURCE;
+		if (mType == D3D12_COMMAND_LIST_TYPE_COPY && (newState & ~COPY_STATES) != 0)
+		{
+			resource.mUsageState = D3D12_RESOURCE_STATE_COMMON;
+			return;
+		}
+
 		if (oldState != newState)
 		{
 			CD3DX12_RESOURCE_BARRIER barrier =
@@ -121,7 +152,7 @@ namespace Graphics
 		// shader file look ups?
 	}
 
-	void CommandContext::SetShader(const std::string& shaderName)
+	void CommandContext::SetShader(Utils::StringId shaderName)
 	{
 		// We are grabbing the shaders,pso, root sigs entirely from the
 		// Slang reflection API.
@@ -140,7 +171,7 @@ namespace Graphics
 			return;
 		}
 
-		std::filesystem::path shaderPath = "shaders/" + shaderName + ".slang";
+		std::filesystem::path shaderPath = "shaders/" + shaderName.GetString() + ".slang";
 
 		if (!std::filesystem::exists(shaderPath))
 		{
@@ -149,7 +180,7 @@ namespace Graphics
 			return;
 		}
 
-		sLogger->info("Compiling shader: {}", shaderName);
+		sLogger->info("Compiling shader: {}", shaderName.GetString());
 
 		if (!Graphics::gDevice)
 		{
@@ -221,7 +252,7 @@ namespace Graphics
 		}
 	}
 
-	void CommandContext::SetShaderMRT(const std::string& shaderName, const DXGI_FORMAT* rtFormats,
+	void CommandContext::SetShaderMRT(Utils::StringId shaderName, const DXGI_FORMAT* rtFormats,
 									  uint32_t numRenderTargets, DXGI_FORMAT depthStencilFormat)
 	{
 		InitLogger();
@@ -236,7 +267,7 @@ namespace Graphics
 			return;
 		}
 
-		std::filesystem::path shaderPath = "shaders/" + shaderName + ".slang";
+		std::filesystem::path shaderPath = "shaders/" + shaderName.GetString() + ".slang";
 
 		if (!std::filesystem::exists(shaderPath))
 		{
@@ -245,7 +276,7 @@ namespace Graphics
 			return;
 		}
 
-		sLogger->info("Compiling MRT shader: {}", shaderName);
+		sLogger->info("Compiling MRT shader: {}", shaderName.GetString());
 
 		if (!Graphics::gDevice)
 		{
@@ -307,7 +338,7 @@ namespace Graphics
 		}
 	}
 
-	void CommandContext::SetComputeShader(const std::string& shaderName)
+	void CommandContext::SetComputeShader(Utils::StringId shaderName)
 	{
 		InitLogger();
 
@@ -321,7 +352,7 @@ namespace Graphics
 			return;
 		}
 
-		std::filesystem::path shaderPath = "shaders/" + shaderName + ".slang";
+		std::filesystem::path shaderPath = "shaders/" + shaderName.GetString() + ".slang";
 
 		if (!std::filesystem::exists(shaderPath))
 		{
@@ -329,7 +360,7 @@ namespace Graphics
 			return;
 		}
 
-		sLogger->info("Compiling compute shader: {}", shaderName);
+		sLogger->info("Compiling compute shader: {}", shaderName.GetString());
 
 		SlangHelper::CompiledShaderData shaderData =
 			SlangHelper::CompileShaderForPSO(shaderPath, Graphics::gDevice);
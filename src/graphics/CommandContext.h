@@ -6,11 +6,13 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "GpuResource.h"
+#include "../utils/StringId.h"
 
 namespace Graphics
 {
-	/// Encapsulates command list recording with its own allocator.
-	/// Each context owns and manages a single command list/allocator pair.
+	/// Encapsulates command list recording. Each context owns a single
+	/// command list and takes an allocator from its queue's pool for every
+	/// Begin, so it can be begun again before the GPU is done with it.
 	class CommandContext
 	{
 	public:
@@ -44,11 +46,12 @@ namespace Graphics
 		void ExecuteAndWait();
 
 		/// Extracts the .slang file and creats root signature, PSO, vertex, pixel
-		/// bytecode.
-		void SetShader(const std::string& shaderName);
+		/// bytecode. Takes an interned name since it runs every frame, the
+		/// cache lookup then costs no string hashing.
+		void SetShader(Utils::StringId shaderName);
 
 		/// Multi render target version of SetShader(..)
-		void SetShaderMRT(const std::string& shaderName, const DXGI_FORMAT* rtFormats,
+		void SetShaderMRT(Utils::StringId shaderName, const DXGI_FORMAT* rtFormats,
 						  uint32_t numRenderTargets,
 						  DXGI_FORMAT depthStencilFormat = DXGI_FORMAT_D32_FLOAT);
 
@@ -56,7 +59,7 @@ namespace Graphics
 		void BindGraphicsPipeline();
 
 		/// Loads compute shader from .slang file in shaders directory.
-		void SetComputeShader(const std::string& shaderName);
+		void SetComputeShader(Utils::StringId shaderName);
 
 		/// Binds compute root signature and PSO to command list.
 		void BindComputePipeline();
@@ -121,6 +124,9 @@ namespace Graphics
 		// TODO: DESCRIPTOR HEAP
 
 	private:
+		/// Gives mAllocator back to the queue's pool, if still held.
+		void ReleaseAllocator();
+
 		void InitLogger();
 		static std::shared_ptr<spdlog::logger> sLogger;
 	};
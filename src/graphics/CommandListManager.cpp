@@ -4,6 +4,18 @@
 
 CommandQueue::CommandQueue(D3D12_COMMAND_LIST_TYPE type)
 : TYPE(type)
+, mFenceRing([this]() { return mFence->GetCompletedValue(); })
+, mAllocatorPool(
+	  [this]() {
+		  Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+		  HRESULT hr = mDevice->CreateCommandAllocator(TYPE, IID_PPV_ARGS(&allocator));
+		  assert(SUCCEEDED(hr) && "Failed to create command allocator");
+		  return allocator;
+	  },
+	  [](Microsoft::WRL::ComPtr<ID3D12CommandAllocator>& allocator) {
+		  HRESULT hr = allocator->Reset();
+		  assert(SUCCEEDED(hr) && "Failed to reset command allocator");
+	  })
 {
 }
 
@@ -15,6 +27,7 @@ CommandQueue::~CommandQueue()
 void CommandQueue::Create(ID3D12Device* pDevice)
 {
 	assert(pDevice != nullptr);
+	mDevice = pDevice;
 
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 	queueDesc.Type = TYPE;
@@ -44,6 +57,12 @@ void CommandQueue::Create(ID3D12Device* pDevice)
 
 void CommandQueue::Shutdown()
 {
+	// The pooled allocators may still be under running lists.
+	if (mFence != nullptr)
+	{
+		WaitForFence(GetLastSignaledFenceValue());
+	}
+
 	if (mFenceEventHandle != nullptr)
 	{
 		CloseHandle(mFenceEventHandle);
@@ -62,19 +81,64 @@ uint64_t CommandQueue::ExecuteCommandList(ID3D12CommandList* list)
 	ID3D12CommandList* ppCommandLists[] = {list};
 	mCommandQueue->ExecuteCommandLists(1, ppCommandLists);
 
-	mCommandQueue->Signal(mFence.Get(), mNextFenceValue);
-
-	return mNextFenceValue++;
+	uint64_t fenceValue = NextFenceValue();
+	mCommandQueue->Signal(mFence.Get(), fenceValue);
+	return fenceValue;
 }
 
 void CommandQueue::WaitForFence(uint64_t fenceValue)
 {
-	if (mFence->GetCompletedValue() < fenceValue)
+	if (mFenceRing.IsComplete(fenceValue))
 	{
-		mFence->SetEventOnCompletion(fenceValue, mFenceEventHandle);
-		WaitForSingleObject(mFenceEventHandle, INFINITE);
+		return;
 	}
-	mLastCompletedFenceValue = fenceValue;
+
+	mFence->SetEventOnCompletion(fenceValue, mFenceEventHandle);
+	WaitForSingleObject(mFenceEventHandle, INFINITE);
+	mFenceRing.Poll();
+}
+
+bool CommandQueue::IsFenceComplete(uint64_t fenceValue)
+{
+	return mFenceRing.IsComplete(fenceValue);
+}
+
+uint64_t CommandQueue::GetCompletedFenceValue()
+{
+	return mFenceRing.Poll();
+}
+
+uint64_t CommandQueue::NextFenceValue()
+{
+	// Only when the CPU is a long way ahead, the frame ring normally
+	// throttles well before this.
+	if (mFenceRing.IsFull() && !mFenceRing.IsComplete(mFenceRing.GetOldestPending()))
+	{
+		mFenceRing.NoteFullWait();
+		WaitForFence(mFenceRing.GetOldestPending());
+	}
+	return mFenceRing.Advance();
+}
+
+Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CommandQueue::RequestAllocator()
+{
+	assert(mDevice != nullptr);
+	// Straight from the fence, the ring belongs to whoever submits.
+	std::lock_guard<std::mutex> lock(mAllocatorMutex);
+	return mAllocatorPool.Request(mFence->GetCompletedValue());
+}
+
+void CommandQueue::DiscardAllocator(uint64_t fenceValue,
+									Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator)
+{
+	std::lock_guard<std::mutex> lock(mAllocatorMutex);
+	mAllocatorPool.Discard(fenceValue, std::move(allocator));
+}
+
+void CommandQueue::WaitForQueue(CommandQueue& producer, uint64_t fenceValue)
+{
+	assert(producer.mFence != nullptr);
+	mCommandQueue->Wait(producer.mFence.Get(), fenceValue);
 }
 
 void CommandListManager::Create(ID3D12Device14* pDevice)
@@ -83,10 +147,14 @@ void CommandListManager::Create(ID3D12Device14* pDevice)
 	mDevice = pDevice;
 
 	mGraphicsQueue.Create(pDevice);
+	mCopyQueue.Create(pDevice);
+	mComputeQueue.Create(pDevice);
 }
 
 void CommandListManager::Shutdown()
 {
+	mComputeQueue.Shutdown();
+	mCopyQueue.Shutdown();
 	mGraphicsQueue.Shutdown();
 	mDevice = nullptr;
 }
@@ -114,8 +182,9 @@ void CommandListManager::WaitForFence(uint64_t fenceValue)
 
 uint64_t CommandQueue::Signal()
 {
-	mCommandQueue->Signal(mFence.Get(), mNextFenceValue);
-	return mNextFenceValue++;
+	uint64_t fenceValue = NextFenceValue();
+	mCommandQueue->Signal(mFence.Get(), fenceValue);
+	return fenceValue;
 }
 
 ID3D12CommandQueue* CommandQueue::GetCommandQueue()
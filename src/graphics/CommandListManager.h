@@ -3,9 +3,15 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 #include <cstdint>
-
-/// Encapsulates a D3D12 command queue with fence synchronization.
-/// TODO ring fence
+#include <mutex>
+#include "CommandAllocatorPool.h"
+#include "FenceRing.h"
+#include "QueueScheduler.h"
+
+/// Encapsulates a D3D12 command queue with fence synchronization. The
+/// signaled values go through a FenceRing, so checking on one doesn't
+/// need a kernel wait, and the queue owns the pool its contexts take
+/// their allocators from.
 class CommandQueue
 {
 	friend class CommandListManager;
@@ -19,9 +25,13 @@ public:
 	void Shutdown();
 
 	/// Seteventoncompletion wait for single object, not really the best
-	/// method for the waiting for sync.
+	/// method for the waiting for sync. Returns straight away if the
+	/// fence is already known to be past fenceValue.
 	void WaitForFence(uint64_t fenceValue);
 
+	/// Non blocking, answers from the cached completed value when it can.
+	bool IsFenceComplete(uint64_t fenceValue);
+
 	/// Signal the queue and return fence value
 	uint64_t Signal();
 
@@ -30,19 +40,41 @@ public:
 	/// function is to only execute the list.
 	uint64_t ExecuteCommandList(ID3D12CommandList* list);
 
-	uint64_t GetCompletedFenceValue() const { return mFence->GetCompletedValue(); }
+	uint64_t GetCompletedFenceValue();
+
+	uint64_t GetLastSignaledFenceValue() const { return mFenceRing.GetLastSignaled(); }
+
+	/// Makes this queue wait on the GPU until producer reaches
+	/// fenceValue, the CPU carries on. Work submitted here afterwards
+	/// sees everything producer did before that fence.
+	void WaitForQueue(CommandQueue& producer, uint64_t fenceValue);
+
+	/// An allocator of this queue's type, reset and ready to record into.
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> RequestAllocator();
 
-	uint64_t GetLastSignaledFenceValue() const { return mNextFenceValue - 1; }
+	/// Hands the allocator back, it gets reused once fenceValue completes.
+	void DiscardAllocator(uint64_t fenceValue,
+						  Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator);
 
 	ID3D12CommandQueue* GetCommandQueue();
+	D3D12_COMMAND_LIST_TYPE GetType() const { return TYPE; }
 
 private:
+	/// Next value to signal, waits on the oldest one first if the ring is
+	/// full.
+	uint64_t NextFenceValue();
+
 	const D3D12_COMMAND_LIST_TYPE TYPE;
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
 	Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
-	uint64_t mNextFenceValue = 1;
-	uint64_t mLastCompletedFenceValue = 0;
+	Graphics::FenceRing mFenceRing;
 	HANDLE mFenceEventHandle = nullptr;
+
+	ID3D12Device* mDevice = nullptr;
+	/// Any thread can Begin a context, so the pool is locked.
+	std::mutex mAllocatorMutex;
+	Graphics::CommandAllocatorPool<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>>
+		mAllocatorPool;
 };
 
 /// Manages GPU queues and provides factory methods for creating command resources.
@@ -60,19 +92,38 @@ public:
 
 	CommandQueue& GetGraphicsQueue() { return mGraphicsQueue; }
 
-	/// Only supporting a DIRECT command list type since we are not using
-	/// compute shaders just yet.
-	/// TODO support other queues
+	/// Asset uploads go here so they don't queue up behind rendering.
+	CommandQueue& GetCopyQueue() { return mCopyQueue; }
+
+	/// Async compute, post processing for now.
+	CommandQueue& GetComputeQueue() { return mComputeQueue; }
+
+	/// DIRECT, COMPUTE and COPY each have their own queue.
 	CommandQueue& GetQueue(D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT)
 	{
 		switch (type)
 		{
+		case D3D12_COMMAND_LIST_TYPE_COPY:
+			return mCopyQueue;
+		case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+			return mComputeQueue;
 		case D3D12_COMMAND_LIST_TYPE_DIRECT:
+		default:
 			return mGraphicsQueue;
-		case D3D12_COMMAND_LIST_TYPE_COMPUTE:
-		case D3D12_COMMAND_LIST_TYPE_COPY:
+		}
+	}
+
+	/// The queue behind a QueueScheduler slot.
+	CommandQueue& GetQueue(Graphics::QueueType type)
+	{
+		switch (type)
+		{
+		case Graphics::QueueType::Compute:
+			return mComputeQueue;
+		case Graphics::QueueType::Copy:
+			return mCopyQueue;
+		case Graphics::QueueType::Graphics:
 		default:
-			// No compute or copy yet do not add just placeholder or refactor
 			return mGraphicsQueue;
 		}
 	}
@@ -88,4 +139,6 @@ public:
 private:
 	ID3D12Device14* mDevice = nullptr;
 	CommandQueue mGraphicsQueue{D3D12_COMMAND_LIST_TYPE_DIRECT};
+	CommandQueue mCopyQueue{D3D12_COMMAND_LIST_TYPE_COPY};
+	CommandQueue mComputeQueue{D3D12_COMMAND_LIST_TYPE_COMPUTE};
 };
@@ -14,7 +14,7 @@ struct Transform
 	Matrix4 worldInvTrans;
 };
 
-/// 80 bytes - must match Slang shader layout exactly
+/// 160 bytes - must match Slang shader layout exactly
 /// The vectormath does some alignment for SIMD so the data
 /// types are a bit misleading so just using a simple Float3
 /// to get the correct alignment to match the slang struct
@@ -40,5 +40,15 @@ struct MaterialConstants
 	uint32_t mHasAmbientOcclusionTexture;
 	uint32_t mHasEmissiveTexture;
 
-	Float2 pad;
+	/// The metallic slot holds the packed ORM map instead.
+	uint32_t mHasOrmTexture;
+	float pad;
+
+	/// xy scale, zw offset into the bound texture. Identity unless the map
+	/// was packed into an atlas.
+	Vector4 mAlbedoUVTransform;
+	Vector4 mNormalUVTransform;
+	Vector4 mMetallicUVTransform;
+	Vector4 mRoughnessUVTransform;
+	Vector4 mOrmUVTransform;
 };
@@ -6,11 +6,14 @@
 #include "CommandListManager.h"
 #include "CommandContext.h"
 #include "ShaderCache.h"
+#include "ResidencyManager.h"
+#include "../utils/MemoryTracker.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include <cstdint>
 #include <dxgi1_6.h>
 #include <format>
 #include <cassert>
+#include <iterator>
 #include <string>
 #include <windows.h>
 #include <D3D12MemAlloc.h>
@@ -38,6 +41,10 @@ namespace Graphics
 	CommandListManager* gCommandListManager = nullptr;
 	GraphicsContext* gGraphicsContext = nullptr;
 
+	ResidencyManager* gResidencyManager = nullptr;
+	// Kept for the residency budget, which changes while running.
+	static Microsoft::WRL::ComPtr<IDXGIAdapter4> sAdapter;
+
 	// Global shader cache
 	ShaderCache* gShaderCache = nullptr;
 
@@ -327,6 +334,45 @@ namespace Graphics
 		gLogger->info("Graphics context initialized");
 	}
 
+	static void InitializeResidency(IDXGIAdapter4* adapter)
+	{
+		sAdapter = adapter;
+
+		ResidencyBackend backend;
+		backend.mGetBudget = []() -> uint64_t {
+			DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+			if (FAILED(sAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+			{
+				return 0;
+			}
+			return info.Budget;
+		};
+		backend.mMakeResident = [](const std::vector<void*>& objects) {
+			std::vector<ID3D12Pageable*> pageables;
+			pageables.reserve(objects.size());
+			for (void* object : objects)
+			{
+				pageables.push_back(static_cast<ID3D12Pageable*>(object));
+			}
+			HRESULT hr =
+				gDevice->MakeResident(static_cast<UINT>(pageables.size()), pageables.data());
+			return SUCCEEDED(hr);
+		};
+		backend.mEvict = [](const std::vector<void*>& objects) {
+			std::vector<ID3D12Pageable*> pageables;
+			pageables.reserve(objects.size());
+			for (void* object : objects)
+			{
+				pageables.push_back(static_cast<ID3D12Pageable*>(object));
+			}
+			gDevice->Evict(static_cast<UINT>(pageables.size()), pageables.data());
+		};
+
+		gResidencyManager = new ResidencyManager(std::move(backend));
+		gLogger->info("Residency manager initialized, budget {} MB",
+					  gResidencyManager->GetBudget() / (1024 * 1024));
+	}
+
 	static void SetupDebugInfoQueue()
 	{
 #if _DEBUG
@@ -501,6 +547,7 @@ void Graphics::Init()
 	gBindlessAllocator->Initialize(1000000, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
 	InitializeCommandSystem();
+	InitializeResidency(adapter.Get());
 
 	gShaderCache = new ShaderCache();
 
@@ -509,6 +556,27 @@ void Graphics::Init()
 	gLogger->info("Graphics system initialization complete");
 }
 
+void Graphics::UpdateMemoryStats()
+{
+	if (!gAllocator)
+	{
+		return;
+	}
+
+	D3D12MA::TotalStatistics stats = {};
+	gAllocator->CalculateStatistics(&stats);
+
+	// HeapType is indexed by D3D12_HEAP_TYPE - 1.
+	const Utils::MemoryTag tags[] = {Utils::MemoryTag::D3D12MA_DEFAULT,
+									 Utils::MemoryTag::D3D12MA_UPLOAD,
+									 Utils::MemoryTag::D3D12MA_READBACK};
+	for (size_t i = 0; i < std::size(tags); ++i)
+	{
+		const D3D12MA::Statistics& heap = stats.HeapType[i].Stats;
+		Utils::SetTrackedBytes(tags[i], heap.AllocationBytes, heap.AllocationCount);
+	}
+}
+
 void Graphics::Shutdown()
 {
 	if (gCommandListManager)
@@ -538,6 +606,13 @@ void Graphics::Shutdown()
 		gShaderCache = nullptr;
 	}
 
+	if (gResidencyManager)
+	{
+		delete gResidencyManager;
+		gResidencyManager = nullptr;
+	}
+	sAdapter.Reset();
+
 	for (auto& i : gDescriptorAllocator)
 	{
 		delete i;
@@ -15,6 +15,7 @@ namespace Graphics
 {
 	class GraphicsContext;
 	class ShaderCache;
+	class ResidencyManager;
 } // namespace Graphics
 
 /// Global D3D12 graphics system state and initialization.
@@ -37,6 +38,8 @@ namespace Graphics
 	extern CommandListManager* gCommandListManager;
 	extern GraphicsContext* gGraphicsContext;
 	extern ShaderCache* gShaderCache;
+	/// Keeps textures under the adapter's video memory budget.
+	extern ResidencyManager* gResidencyManager;
 
 	/// Initization for the globals
 	void Init();
@@ -44,6 +47,10 @@ namespace Graphics
 	/// Cleans up the globals
 	void Shutdown();
 
+	/// Copies gAllocator's per heap type statistics into the D3D12MA
+	/// memory tags. Walks every block, once a frame is plenty.
+	void UpdateMemoryStats();
+
 	/// Global logger mainly for the init D3D12 objects
 	void InitLogger();
 	extern std::shared_ptr<spdlog::logger> gLogger;
@@ -3,12 +3,12 @@
 #include <cassert>
 #include <vector>
 
-// TODO parallel support
-// static std::mutex& GetAllocationMutex()
-// {
-// 	static std::mutex s_mutex;
-// 	return s_mutex;
-// }
+/// Shared by every DescriptorAllocator, they also share the heap pool.
+static std::mutex& GetAllocationMutex()
+{
+	static std::mutex sMutex;
+	return sMutex;
+}
 
 static std::vector<Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>>& GetDescriptorHeapPool()
 {
@@ -30,6 +30,7 @@ void DescriptorHeap::Create(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t maxCount,
 
 	mDescriptorSize = Graphics::gDevice->GetDescriptorHandleIncrementSize(type);
 	mNumFreeDescriptors = maxCount;
+	mMemory.Set(static_cast<size_t>(maxCount) * mDescriptorSize);
 
 	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
 	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = shaderVisible
@@ -54,7 +55,7 @@ DescriptorHandle DescriptorHeap::Alloc(uint32_t count)
 
 ID3D12DescriptorHeap* DescriptorAllocator::RequestNewHeap(D3D12_DESCRIPTOR_HEAP_TYPE type)
 {
-	// NOTE Mutex should be locked here
+	// Called from Allocate, GetAllocationMutex is held.
 	D3D12_DESCRIPTOR_HEAP_DESC desc = {};
 	desc.Type = type;
 	desc.NumDescriptors = NUM_DESCRIPTORS_PER_HEAP;
@@ -66,12 +67,16 @@ ID3D12DescriptorHeap* DescriptorAllocator::RequestNewHeap(D3D12_DESCRIPTOR_HEAP_
 	assert(SUCCEEDED(hr));
 
 	GetDescriptorHeapPool().push_back(heap);
+	// The pool keeps its heaps until shutdown, nothing to give back.
+	Utils::TrackAllocation(Utils::MemoryTag::DESCRIPTORS,
+						   static_cast<size_t>(NUM_DESCRIPTORS_PER_HEAP) *
+							   Graphics::gDevice->GetDescriptorHandleIncrementSize(type));
 	return heap.Get();
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::Allocate(uint32_t count)
 {
-	// std::lock_guard<std::mutex> lockGuard(GetAllocationMutex());
+	std::lock_guard<std::mutex> lockGuard(GetAllocationMutex());
 
 	if (mCurrentHeap == nullptr || mRemainingFreeHandles < count)
 	{
@@ -3,7 +3,8 @@
 #include <cstdint>
 #include <d3d12.h>
 #include <wrl/client.h>
-// #include <mutex>
+#include "../utils/MemoryTracker.h"
+#include <mutex>
 
 /// Simple handle wrapper for CPU/GPU descriptors handles.
 class DescriptorHandle
@@ -60,7 +61,11 @@ public:
 	~DescriptorHeap() { Destroy(); }
 
 	void Create(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t maxCount, bool shaderVisible = false);
-	void Destroy() { mHeap = nullptr; }
+	void Destroy()
+	{
+		mHeap = nullptr;
+		mMemory.Set(0);
+	}
 
 	bool HasAvailableSpace(uint32_t count) const { return count <= mNumFreeDescriptors; }
 	DescriptorHandle Alloc(uint32_t count = 1);
@@ -76,6 +81,9 @@ private:
 	/// Should error if full for now.
 	uint32_t mNumFreeDescriptors = 0;
 
+	/// Descriptor bytes charged to the Descriptors tag.
+	Utils::MemoryCharge mMemory{Utils::MemoryTag::DESCRIPTORS};
+
 	/// Keeping track of first index and next free based on how
 	/// much we alloc.
 	DescriptorHandle mFirstHandle;
@@ -0,0 +1,297 @@
+#include "DescriptorSlotPool.h"
+#include <algorithm>
+
+namespace Graphics
+{
+	namespace
+	{
+		std::atomic<uint64_t> sNextPoolId{1};
+
+		/// Only the owning thread writes, no need for a locked add.
+		void Bump(std::atomic<uint64_t>& counter)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	} // namespace
+
+	DescriptorSlotPool::DescriptorSlotPool(const DescriptorSlotPoolDesc& desc)
+	: mDesc(desc)
+	, mId(sNextPoolId.fetch_add(1))
+	{
+		mDesc.mMagazineSize = std::max(mDesc.mMagazineSize, 1U);
+		mDesc.mFenceShards = std::max(mDesc.mFenceShards, 1U);
+		for (uint32_t i = 0; i < mDesc.mFenceShards; ++i)
+		{
+			mShards.push_back(std::make_unique<FenceShard>());
+		}
+		mPartial.reserve(mDesc.mMagazineSize);
+	}
+
+	DescriptorSlotPool::~DescriptorSlotPool() = default;
+
+	DescriptorSlotPool::ThreadCache& DescriptorSlotPool::GetThreadCache()
+	{
+		// A thread touches one or two pools, the list stays short.
+		thread_local std::vector<std::pair<uint64_t, ThreadCache*>> tCaches;
+		for (const auto& [id, cache] : tCaches)
+		{
+			if (id == mId)
+			{
+				return *cache;
+			}
+		}
+
+		auto cache = std::make_unique<ThreadCache>();
+		cache->mLoaded.reserve(mDesc.mMagazineSize);
+		cache->mPrevious.reserve(mDesc.mMagazineSize);
+
+		ThreadCache* owned = cache.get();
+		{
+			std::lock_guard<std::mutex> lock(mCachesMutex);
+			cache->mShard = static_cast<uint32_t>(mCaches.size() % mShards.size());
+			mCaches.push_back(std::move(cache));
+		}
+		tCaches.emplace_back(mId, owned);
+		return *owned;
+	}
+
+	uint32_t DescriptorSlotPool::Allocate()
+	{
+		ThreadCache& cache = GetThreadCache();
+		if (cache.mLoaded.empty())
+		{
+			if (!cache.mPrevious.empty())
+			{
+				std::swap(cache.mLoaded, cache.mPrevious);
+			}
+			else if (!ExchangeEmpty(cache.mLoaded))
+			{
+				return INVALID_SLOT;
+			}
+		}
+
+		uint32_t slot = cache.mLoaded.back();
+		cache.mLoaded.pop_back();
+		Bump(cache.mAllocations);
+		return slot;
+	}
+
+	void DescriptorSlotPool::Free(uint32_t slot)
+	{
+		ThreadCache& cache = GetThreadCache();
+		if (cache.mLoaded.size() >= mDesc.mMagazineSize)
+		{
+			// Both full, the older one goes to the depot. Either way the
+			// full one ends up as mPrevious and mLoaded is empty.
+			if (!cache.mPrevious.empty())
+			{
+				ExchangeFull(cache.mPrevious);
+			}
+			std::swap(cache.mLoaded, cache.mPrevious);
+		}
+
+		cache.mLoaded.push_back(slot);
+		Bump(cache.mFrees);
+	}
+
+	void DescriptorSlotPool::FreeDeferred(uint32_t slot, uint64_t fence)
+	{
+		ThreadCache& cache = GetThreadCache();
+		FenceShard& shard = *mShards[cache.mShard];
+		{
+			std::lock_guard<std::mutex> lock(shard.mMutex);
+			shard.mPending.push_back({fence, slot});
+		}
+		Bump(cache.mFrees);
+	}
+
+	uint32_t DescriptorSlotPool::ProcessDeletions(uint64_t completedFence,
+												  const std::function<void(uint32_t)>& onFree)
+	{
+		std::vector<uint32_t> ready;
+		for (const std::unique_ptr<FenceShard>& shard : mShards)
+		{
+			std::lock_guard<std::mutex> lock(shard->mMutex);
+			// Threads free with whatever fence they last saw, so a shard can
+			// be a little out of order. A later fence holds the ones behind
+			// it back a few frames, nothing goes back early.
+			while (!shard->mPending.empty() && shard->mPending.front().mFence <= completedFence)
+			{
+				ready.push_back(shard->mPending.front().mSlot);
+				shard->mPending.pop_front();
+			}
+		}
+		if (ready.empty())
+		{
+			return 0;
+		}
+
+		if (onFree)
+		{
+			for (uint32_t slot : ready)
+			{
+				onFree(slot);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mDepotMutex);
+		for (uint32_t slot : ready)
+		{
+			mPartial.push_back(slot);
+			if (mPartial.size() == mDesc.mMagazineSize)
+			{
+				mFull.push_back(std::move(mPartial));
+				mPartial = {};
+				if (!mEmpty.empty())
+				{
+					mPartial = std::move(mEmpty.back());
+					mEmpty.pop_back();
+				}
+				mPartial.reserve(mDesc.mMagazineSize);
+			}
+		}
+		TrimDepot();
+		return static_cast<uint32_t>(ready.size());
+	}
+
+	void DescriptorSlotPool::FlushThreadCache()
+	{
+		ThreadCache& cache = GetThreadCache();
+
+		std::lock_guard<std::mutex> lock(mDepotMutex);
+		for (Magazine* magazine : {&cache.mLoaded, &cache.mPrevious})
+		{
+			for (uint32_t slot : *magazine)
+			{
+				mPartial.push_back(slot);
+				if (mPartial.size() == mDesc.mMagazineSize)
+				{
+					mFull.push_back(std::move(mPartial));
+					mPartial = {};
+					mPartial.reserve(mDesc.mMagazineSize);
+				}
+			}
+			magazine->clear();
+		}
+		TrimDepot();
+	}
+
+	bool DescriptorSlotPool::ExchangeEmpty(Magazine& magazine)
+	{
+		std::lock_guard<std::mutex> lock(mDepotMutex);
+		if (!mFull.empty())
+		{
+			mEmpty.push_back(std::move(magazine));
+			magazine = std::move(mFull.back());
+			mFull.pop_back();
+			mDepotExchanges++;
+			return true;
+		}
+		if (!mPartial.empty())
+		{
+			std::swap(magazine, mPartial);
+			mDepotExchanges++;
+			return true;
+		}
+
+		// Near a full heap there may be no run of a whole magazine left,
+		// halve it down to single slots before giving up.
+		uint32_t first = INVALID_SLOT;
+		uint32_t count = mDesc.mMagazineSize;
+		while (mDesc.mGrow && count > 0)
+		{
+			first = mDesc.mGrow(count);
+			if (first != INVALID_SLOT)
+			{
+				break;
+			}
+			count /= 2;
+		}
+		if (first == INVALID_SLOT)
+		{
+			mFailedAllocations++;
+			return false;
+		}
+		mGrows++;
+		mSlots += count;
+
+		// Reversed, so the run is handed out in order.
+		magazine.clear();
+		for (uint32_t i = count; i > 0; --i)
+		{
+			magazine.push_back(first + i - 1);
+		}
+		return true;
+	}
+
+	void DescriptorSlotPool::ExchangeFull(Magazine& magazine)
+	{
+		std::lock_guard<std::mutex> lock(mDepotMutex);
+		mFull.push_back(std::move(magazine));
+		magazine = {};
+		if (!mEmpty.empty())
+		{
+			magazine = std::move(mEmpty.back());
+			mEmpty.pop_back();
+		}
+		mDepotExchanges++;
+		TrimDepot();
+	}
+
+	void DescriptorSlotPool::TrimDepot()
+	{
+		if (!mDesc.mShrink)
+		{
+			return;
+		}
+
+		while (mFull.size() > mDesc.mMaxDepotMagazines)
+		{
+			Magazine& magazine = mFull.back();
+			for (uint32_t slot : magazine)
+			{
+				mDesc.mShrink(slot);
+			}
+			mSlots -= static_cast<uint32_t>(magazine.size());
+			mShrinks++;
+
+			magazine.clear();
+			mEmpty.push_back(std::move(magazine));
+			mFull.pop_back();
+		}
+	}
+
+	DescriptorSlotPoolStats DescriptorSlotPool::GetStats() const
+	{
+		DescriptorSlotPoolStats stats;
+		{
+			std::lock_guard<std::mutex> lock(mCachesMutex);
+			for (const std::unique_ptr<ThreadCache>& cache : mCaches)
+			{
+				stats.mAllocations += cache->mAllocations.load(std::memory_order_relaxed);
+				stats.mFrees += cache->mFrees.load(std::memory_order_relaxed);
+			}
+			stats.mThreadCaches = static_cast<uint32_t>(mCaches.size());
+		}
+		{
+			std::lock_guard<std::mutex> lock(mDepotMutex);
+			size_t depotSlots = mPartial.size();
+			for (const Magazine& magazine : mFull)
+			{
+				depotSlots += magazine.size();
+			}
+			stats.mDepotSlots = static_cast<uint32_t>(depotSlots);
+			stats.mDepotExchanges = mDepotExchanges;
+			stats.mGrows = mGrows;
+			stats.mShrinks = mShrinks;
+			stats.mSlots = mSlots;
+			stats.mFailedAllocations = mFailedAllocations;
+		}
+		for (const std::unique_ptr<FenceShard>& shard : mShards)
+		{
+			std::lock_guard<std::mutex> lock(shard->mMutex);
+			stats.mPendingFrees += static_cast<uint32_t>(shard->mPending.size());
+		}
+		return stats;
+	}
+} // namespace Graphics
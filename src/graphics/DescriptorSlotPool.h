@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Graphics
+{
+	struct DescriptorSlotPoolDesc
+	{
+		/// Slots a thread keeps in each of its two magazines, and how many
+		/// move between it and the depot at once.
+		uint32_t mMagazineSize = 64;
+		/// Deferred frees are spread over this many queues, each with its
+		/// own lock, so freeing threads rarely meet.
+		uint32_t mFenceShards = 8;
+		/// Carves count new slots out of the heap, returns the first of a
+		/// contiguous run or UINT32_MAX when there's no run that long.
+		/// Called with the depot locked, with mMagazineSize first and then
+		/// halved until it fits or 1 fails too.
+		std::function<uint32_t(uint32_t count)> mGrow;
+		/// Full magazines the depot holds on to. Past that they go back
+		/// through mShrink, so the slots freed after a burst of single
+		/// descriptors can be used for tables again.
+		uint32_t mMaxDepotMagazines = 8;
+		/// Hands one slot mGrow carved back to the heap. Called with the
+		/// depot locked. Without it slots stay with the pool for good.
+		std::function<void(uint32_t slot)> mShrink;
+	};
+
+	struct DescriptorSlotPoolStats
+	{
+		uint64_t mAllocations = 0;
+		uint64_t mFrees = 0;
+		uint32_t mFailedAllocations = 0;
+		/// Whole magazines swapped with the depot.
+		uint64_t mDepotExchanges = 0;
+		uint32_t mGrows = 0;
+		/// Magazines handed back to the heap with mShrink.
+		uint32_t mShrinks = 0;
+		/// Slots carved from the heap and not handed back.
+		uint32_t mSlots = 0;
+		/// Slots sitting in the depot, not counting thread magazines.
+		uint32_t mDepotSlots = 0;
+		uint32_t mPendingFrees = 0;
+		uint32_t mThreadCaches = 0;
+	};
+
+	/// Single descriptor slots for BindlessAllocator that any thread can
+	/// allocate and free. Every thread gets two magazines (stacks of free
+	/// slots) of its own, so most allocations and frees touch nothing
+	/// shared. An empty or full magazine is swapped whole with the depot
+	/// under its lock, and only when the depot is out does it carve a new
+	/// run of slots from the heap. Slots freed with a fence queue up in
+	/// sharded lists and ProcessDeletions hands them back to the depot.
+	/// Full magazines past mMaxDepotMagazines go back to the heap.
+	///
+	/// A thread's magazines stay with the pool when the thread exits,
+	/// fine for the long lived loader and pool threads this is for.
+	class DescriptorSlotPool
+	{
+	public:
+		static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+		explicit DescriptorSlotPool(const DescriptorSlotPoolDesc& desc);
+		~DescriptorSlotPool();
+
+		DescriptorSlotPool(const DescriptorSlotPool&) = delete;
+		DescriptorSlotPool& operator=(const DescriptorSlotPool&) = delete;
+
+		/// INVALID_SLOT when the heap can't give any more.
+		uint32_t Allocate();
+
+		/// Back into this thread's magazine straight away, only for slots
+		/// the GPU never saw.
+		void Free(uint32_t slot);
+
+		/// Slot goes back once fence has completed. Any thread.
+		void FreeDeferred(uint32_t slot, uint64_t fence);
+
+		/// Returns the slots whose fence is at or below completedFence to
+		/// the depot, calling onFree for each first. Returns how many.
+		uint32_t ProcessDeletions(uint64_t completedFence,
+								  const std::function<void(uint32_t)>& onFree = {});
+
+		/// Moves the calling thread's magazines into the depot.
+		void FlushThreadCache();
+
+		/// Adds up the threads' counters, a snapshot while they run.
+		DescriptorSlotPoolStats GetStats() const;
+
+	private:
+		using Magazine = std::vector<uint32_t>;
+
+		struct alignas(64) ThreadCache
+		{
+			Magazine mLoaded;
+			Magazine mPrevious;
+			uint32_t mShard = 0;
+			/// Only the owning thread writes these.
+			std::atomic<uint64_t> mAllocations{0};
+			std::atomic<uint64_t> mFrees{0};
+		};
+
+		struct PendingFree
+		{
+			uint64_t mFence;
+			uint32_t mSlot;
+		};
+
+		struct alignas(64) FenceShard
+		{
+			std::mutex mMutex;
+			std::deque<PendingFree> mPending;
+		};
+
+		ThreadCache& GetThreadCache();
+		/// Swaps an empty magazine for a full one from the depot, growing
+		/// the heap if it has none. False when the heap is full.
+		bool ExchangeEmpty(Magazine& magazine);
+		void ExchangeFull(Magazine& magazine);
+		/// Hands full magazines past mMaxDepotMagazines back to the heap.
+		/// Called with the depot locked.
+		void TrimDepot();
+
+		DescriptorSlotPoolDesc mDesc;
+		/// Unique across all pools, how a thread tells its cache for this
+		/// pool from one for a pool that died at the same address.
+		uint64_t mId;
+
+		mutable std::mutex mCachesMutex;
+		std::vector<std::unique_ptr<ThreadCache>> mCaches;
+
+		mutable std::mutex mDepotMutex;
+		std::vector<Magazine> mFull;
+		/// Emptied magazines kept for their storage, so swapping doesn't
+		/// allocate once the pool has warmed up.
+		std::vector<Magazine> mEmpty;
+		/// Loose slots from ProcessDeletions and FlushThreadCache, packed
+		/// into magazines as they fill up.
+		Magazine mPartial;
+		uint64_t mDepotExchanges = 0;
+		uint32_t mGrows = 0;
+		uint32_t mShrinks = 0;
+		uint32_t mSlots = 0;
+		uint32_t mFailedAllocations = 0;
+
+		std::vector<std::unique_ptr<FenceShard>> mShards;
+	};
+} // namespace Graphics
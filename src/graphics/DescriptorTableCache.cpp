@@ -0,0 +1,166 @@
+#include "DescriptorTableCache.h"
+#include "../utils/Hash.h"
+
+namespace Graphics
+{
+	size_t DescriptorTableKeyHash::operator()(const DescriptorTableKey& key) const
+	{
+		uint64_t hash = 0;
+		for (uint32_t texture : key)
+		{
+			hash = Utils::HashCombine(hash, texture);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	DescriptorTableCache::DescriptorTableCache(const DescriptorTableCacheDesc& desc)
+	: mDesc(desc)
+	, mTables(desc.mCapacity)
+	{
+		// Handed out from the front of the range.
+		for (uint32_t i = mDesc.mCapacity; i > 0; --i)
+		{
+			mUnused.push_back(i - 1);
+		}
+		mLookup.reserve(mDesc.mCapacity);
+	}
+
+	uint32_t DescriptorTableCache::Get(const DescriptorTableKey& key)
+	{
+		uint32_t table = NONE;
+		auto it = mLookup.find(key);
+		if (it != mLookup.end())
+		{
+			table = it->second;
+			mStats.mHits++;
+		}
+		else
+		{
+			table = TakeTable();
+			if (table == NONE)
+			{
+				mStats.mFailures++;
+				return INVALID_TABLE;
+			}
+
+			Table& entry = mTables[table];
+			entry.mKey = key;
+			entry.mCached = true;
+			mLookup.emplace(key, table);
+			if (mDesc.mWriteTable)
+			{
+				mDesc.mWriteTable(table, key);
+			}
+			mStats.mWrites++;
+		}
+
+		Table& entry = mTables[table];
+		if (entry.mFence != IN_FLIGHT)
+		{
+			entry.mFence = IN_FLIGHT;
+			mUsed.push_back(table);
+		}
+		Unlink(table);
+		PushNewest(table);
+		return table;
+	}
+
+	void DescriptorTableCache::EndFrame(uint64_t fence)
+	{
+		for (uint32_t table : mUsed)
+		{
+			mTables[table].mFence = fence;
+		}
+		mUsed.clear();
+	}
+
+	void DescriptorTableCache::Retire(uint64_t completedFence)
+	{
+		if (completedFence > mCompletedFence)
+		{
+			mCompletedFence = completedFence;
+		}
+	}
+
+	void DescriptorTableCache::Clear()
+	{
+		for (Table& table : mTables)
+		{
+			table.mCached = false;
+		}
+		mLookup.clear();
+		mStats.mTables = 0;
+	}
+
+	void DescriptorTableCache::Unlink(uint32_t table)
+	{
+		Table& entry = mTables[table];
+		if (entry.mOlder != NONE)
+		{
+			mTables[entry.mOlder].mNewer = entry.mNewer;
+		}
+		else if (mOldest == table)
+		{
+			mOldest = entry.mNewer;
+		}
+
+		if (entry.mNewer != NONE)
+		{
+			mTables[entry.mNewer].mOlder = entry.mOlder;
+		}
+		else if (mNewest == table)
+		{
+			mNewest = entry.mOlder;
+		}
+		entry.mOlder = NONE;
+		entry.mNewer = NONE;
+	}
+
+	void DescriptorTableCache::PushNewest(uint32_t table)
+	{
+		Table& entry = mTables[table];
+		entry.mOlder = mNewest;
+		entry.mNewer = NONE;
+		if (mNewest != NONE)
+		{
+			mTables[mNewest].mNewer = table;
+		}
+		mNewest = table;
+		if (mOldest == NONE)
+		{
+			mOldest = table;
+		}
+	}
+
+	uint32_t DescriptorTableCache::TakeTable()
+	{
+		if (!mUnused.empty())
+		{
+			uint32_t table = mUnused.back();
+			mUnused.pop_back();
+			mStats.mTables++;
+			return table;
+		}
+
+		// Everything newer than the oldest was used at the same time or
+		// later, if the oldest is still in flight they all are.
+		uint32_t table = mOldest;
+		if (table == NONE || mTables[table].mFence > mCompletedFence)
+		{
+			return NONE;
+		}
+
+		Table& entry = mTables[table];
+		if (entry.mCached)
+		{
+			mLookup.erase(entry.mKey);
+			mStats.mEvictions++;
+		}
+		else
+		{
+			// Forgotten by Clear, it's back in use now.
+			mStats.mTables++;
+		}
+		return table;
+	}
+} // namespace Graphics
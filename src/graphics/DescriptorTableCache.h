@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics
+{
+	/// The textures of one material table, albedo, normal, metallic and
+	/// roughness, as TextureHandle values. 0 is a null descriptor, also
+	/// used for a texture still uploading so it gets a new table once it
+	/// can be drawn.
+	using DescriptorTableKey = std::array<uint32_t, 4>;
+
+	struct DescriptorTableKeyHash
+	{
+		size_t operator()(const DescriptorTableKey& key) const;
+	};
+
+	struct DescriptorTableCacheDesc
+	{
+		/// Tables in the heap range the cache hands out.
+		uint32_t mCapacity = 64;
+		/// Writes the descriptors of key into table, only on a miss.
+		std::function<void(uint32_t table, const DescriptorTableKey& key)> mWriteTable;
+	};
+
+	struct DescriptorTableCacheStats
+	{
+		uint64_t mHits = 0;
+		/// Tables written, the only time descriptors get created.
+		uint32_t mWrites = 0;
+		/// Tables taken over from a key nobody used for a while.
+		uint32_t mEvictions = 0;
+		/// Get calls that found every table in use by a frame in flight.
+		uint32_t mFailures = 0;
+		uint32_t mTables = 0;
+	};
+
+	/// Material descriptor tables for the non-bindless path, built once
+	/// per set of textures and shared by every entity and frame that draws
+	/// with it. A texture changing means a new key, the old table is left
+	/// until it is the least recently used. Same fences as the
+	/// RenderTargetPool: tables used in a frame get its fence in EndFrame
+	/// and are only rewritten once Retire sees it complete.
+	/// Not thread safe.
+	class DescriptorTableCache
+	{
+	public:
+		static constexpr uint32_t INVALID_TABLE = UINT32_MAX;
+
+		explicit DescriptorTableCache(const DescriptorTableCacheDesc& desc);
+
+		DescriptorTableCache(const DescriptorTableCache&) = delete;
+		DescriptorTableCache& operator=(const DescriptorTableCache&) = delete;
+
+		/// Index of the table for key, writing it first if it isn't
+		/// cached. INVALID_TABLE when all of them are still in flight.
+		uint32_t Get(const DescriptorTableKey& key);
+
+		void EndFrame(uint64_t fence);
+		void Retire(uint64_t completedFence);
+
+		/// Forgets every key, the tables get rewritten as they're asked
+		/// for again. Doesn't wait for the GPU.
+		void Clear();
+
+		const DescriptorTableCacheStats& GetStats() const { return mStats; }
+
+	private:
+		static constexpr uint32_t NONE = UINT32_MAX;
+		/// mFence of a table used since the last EndFrame.
+		static constexpr uint64_t IN_FLIGHT = UINT64_MAX;
+
+		struct Table
+		{
+			DescriptorTableKey mKey = {};
+			uint64_t mFence = 0;
+			/// Least recently used list, mOldest first.
+			uint32_t mOlder = NONE;
+			uint32_t mNewer = NONE;
+			bool mCached = false;
+		};
+
+		void Unlink(uint32_t table);
+		void PushNewest(uint32_t table);
+		/// A table that's free or safe to rewrite, or NONE.
+		uint32_t TakeTable();
+
+		DescriptorTableCacheDesc mDesc;
+		std::vector<Table> mTables;
+		std::unordered_map<DescriptorTableKey, uint32_t, DescriptorTableKeyHash> mLookup;
+		std::vector<uint32_t> mUnused;
+		/// Used since the last EndFrame.
+		std::vector<uint32_t> mUsed;
+		uint32_t mOldest = NONE;
+		uint32_t mNewest = NONE;
+		uint64_t mCompletedFence = 0;
+		DescriptorTableCacheStats mStats;
+	};
+} // namespace Graphics
@@ -0,0 +1,61 @@
+#include "FenceRing.h"
+#include <cassert>
+
+namespace Graphics
+{
+	FenceRing::FenceRing(ReadCompleted readCompleted, uint32_t capacity)
+	: mReadCompleted(std::move(readCompleted))
+	, mValues(capacity > 0 ? capacity : 1, 0)
+	{
+	}
+
+	uint64_t FenceRing::Advance()
+	{
+		if (IsFull())
+		{
+			Poll();
+		}
+		assert(!IsFull() && "FenceRing full, wait on GetOldestPending first");
+
+		uint64_t value = mNextValue++;
+		uint32_t tail = (mHead + mCount) % static_cast<uint32_t>(mValues.size());
+		mValues[tail] = value;
+		mCount++;
+		return value;
+	}
+
+	bool FenceRing::IsComplete(uint64_t value)
+	{
+		if (value <= mLastCompleted)
+		{
+			mStats.mCacheHits++;
+			return true;
+		}
+
+		// Never signaled, reading the fence won't change that.
+		if (value >= mNextValue)
+		{
+			return false;
+		}
+		return value <= Poll();
+	}
+
+	uint64_t FenceRing::Poll()
+	{
+		mStats.mPolls++;
+		uint64_t completed = mReadCompleted();
+		// A fence only moves forward, a stale read can't undo what was
+		// already seen.
+		if (completed > mLastCompleted)
+		{
+			mLastCompleted = completed;
+		}
+
+		while (mCount > 0 && mValues[mHead] <= mLastCompleted)
+		{
+			mHead = (mHead + 1) % static_cast<uint32_t>(mValues.size());
+			mCount--;
+		}
+		return mLastCompleted;
+	}
+} // namespace Graphics
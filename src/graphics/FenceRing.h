@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Graphics
+{
+	struct FenceRingStats
+	{
+		/// Times the fence itself was read.
+		uint64_t mPolls = 0;
+		/// IsComplete answers that came from the cached value.
+		uint64_t mCacheHits = 0;
+		/// Times the ring was full and the oldest value had to be waited on.
+		uint64_t mFullWaits = 0;
+	};
+
+	/// The fence values a queue has signaled and not seen complete yet,
+	/// oldest first. IsComplete answers from the last completed value it
+	/// read and only reads the fence again when asked about something
+	/// newer, there's never a kernel wait in here. The capacity bounds how
+	/// many signals can be outstanding, once full the queue has to wait on
+	/// GetOldestPending before signaling another.
+	/// Not thread safe.
+	class FenceRing
+	{
+	public:
+		/// Reads the fence's completed value (GetCompletedValue), cheap
+		/// but not free.
+		using ReadCompleted = std::function<uint64_t()>;
+
+		static constexpr uint32_t DEFAULT_CAPACITY = 64;
+
+		explicit FenceRing(ReadCompleted readCompleted, uint32_t capacity = DEFAULT_CAPACITY);
+
+		/// Records and returns the next value to signal. Values start at
+		/// 1, 0 counts as always complete.
+		uint64_t Advance();
+
+		bool IsComplete(uint64_t value);
+
+		/// Reads the fence, drops what completed from the ring and returns
+		/// the completed value.
+		uint64_t Poll();
+
+		bool IsFull() const { return mCount == mValues.size(); }
+		/// Only valid while something is pending.
+		uint64_t GetOldestPending() const { return mValues[mHead]; }
+		uint32_t GetPendingCount() const { return mCount; }
+
+		uint64_t GetLastCompleted() const { return mLastCompleted; }
+		uint64_t GetLastSignaled() const { return mNextValue - 1; }
+
+		/// For the queue to count the waits IsFull caused.
+		void NoteFullWait() { mStats.mFullWaits++; }
+		const FenceRingStats& GetStats() const { return mStats; }
+
+	private:
+		ReadCompleted mReadCompleted;
+		std::vector<uint64_t> mValues;
+		uint32_t mHead = 0;
+		uint32_t mCount = 0;
+		uint64_t mNextValue = 1;
+		uint64_t mLastCompleted = 0;
+		FenceRingStats mStats;
+	};
+} // namespace Graphics
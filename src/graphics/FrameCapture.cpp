@@ -0,0 +1,198 @@
+#include "FrameCapture.h"
+#include "../utils/FileUtils.h"
+#include "../utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Graphics
+{
+	FrameCapture::FrameCapture(const CaptureBackend& backend, const FrameCaptureDesc& desc)
+	: mBackend(backend)
+	, mDesc(desc)
+	, mSlots(std::max(desc.mRingSize, 1U))
+	{
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		WaitForEncodes();
+	}
+
+	bool FrameCapture::Capture(uint32_t width, uint32_t height, const std::filesystem::path& path)
+	{
+		mStats.mRequested++;
+
+		TextureTools::EncodeFormat format = TextureTools::GetEncodeFormat(path);
+		if (format == TextureTools::EncodeFormat::Unknown || width == 0 || height == 0)
+		{
+			mStats.mFailed++;
+			mLastError = "Can't capture to " + path.string();
+			return false;
+		}
+
+		auto it = std::find_if(mSlots.begin(), mSlots.end(),
+							   [](const Slot& slot) { return slot.mState == SlotState::Free; });
+		if (it == mSlots.end())
+		{
+			mStats.mDropped++;
+			return false;
+		}
+
+		auto index = static_cast<uint32_t>(it - mSlots.begin());
+		if (!mBackend.mRecordCopy(index, width, height))
+		{
+			mStats.mFailed++;
+			mLastError = "Failed to record the copy for " + path.string();
+			return false;
+		}
+
+		it->mState = SlotState::Recorded;
+		it->mFence = 0;
+		it->mSequence = mNextSequence++;
+		it->mWidth = width;
+		it->mHeight = height;
+		it->mPath = path;
+		it->mFormat = format;
+		UpdateCounts();
+		return true;
+	}
+
+	void FrameCapture::EndFrame(uint64_t fence)
+	{
+		for (Slot& slot : mSlots)
+		{
+			if (slot.mState == SlotState::Recorded)
+			{
+				slot.mState = SlotState::InFlight;
+				slot.mFence = fence;
+			}
+		}
+	}
+
+	void FrameCapture::Retire(uint64_t completedFence)
+	{
+		CollectEncodes(false);
+
+		// Oldest first, so a backed up encoder queue delays the newest
+		// captures and the files still come out in order.
+		while (mEncodes.size() < mDesc.mMaxEncodesInFlight)
+		{
+			Slot* oldest = nullptr;
+			for (Slot& slot : mSlots)
+			{
+				if (slot.mState == SlotState::InFlight && slot.mFence <= completedFence &&
+					(!oldest || slot.mSequence < oldest->mSequence))
+				{
+					oldest = &slot;
+				}
+			}
+			if (!oldest)
+			{
+				break;
+			}
+			ReadBack(*oldest, static_cast<uint32_t>(oldest - mSlots.data()));
+		}
+
+		UpdateCounts();
+	}
+
+	bool FrameCapture::ReadBack(Slot& slot, uint32_t index)
+	{
+		uint32_t rowPitch = 0;
+		const uint8_t* mapped = mBackend.mMap(index, rowPitch);
+		if (!mapped)
+		{
+			mStats.mFailed++;
+			mLastError = "Failed to map the readback for " + slot.mPath.string();
+			slot.mState = SlotState::Free;
+			return false;
+		}
+
+		// Strip the row padding the copy footprint needs, the encoders
+		// want tightly packed rows. This memcpy is the only part of a
+		// capture on the render thread.
+		TextureTools::Image image(slot.mWidth, slot.mHeight);
+		for (uint32_t y = 0; y < slot.mHeight; ++y)
+		{
+			std::memcpy(image.GetPixel(0, y), mapped + (static_cast<size_t>(y) * rowPitch),
+						image.GetRowPitch());
+		}
+		mBackend.mUnmap(index);
+		mStats.mReadBack++;
+
+		Utils::ThreadPool& pool = mDesc.mPool ? *mDesc.mPool : Utils::ThreadPool::GetDefault();
+		mEncodes.push_back(pool.Submit([image = std::move(image), path = slot.mPath,
+										format = slot.mFormat]() {
+			EncodeResult result;
+			std::vector<uint8_t> encoded;
+			if (!TextureTools::EncodeImage(image, format, encoded, &result.mError))
+			{
+				result.mError = path.string() + ": " + result.mError;
+				return result;
+			}
+			if (!Utils::WriteBinaryFile(path, encoded.data(), encoded.size()))
+			{
+				result.mError = "Failed to write " + path.string();
+				return result;
+			}
+			result.mSuccess = true;
+			result.mBytes = encoded.size();
+			return result;
+		}));
+
+		slot.mState = SlotState::Free;
+		slot.mPath.clear();
+		return true;
+	}
+
+	void FrameCapture::CollectEncodes(bool wait)
+	{
+		std::erase_if(mEncodes, [this, wait](std::future<EncodeResult>& encode) {
+			if (!wait && encode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				return false;
+			}
+
+			EncodeResult result = encode.get();
+			if (result.mSuccess)
+			{
+				mStats.mEncoded++;
+				mStats.mBytesWritten += result.mBytes;
+			}
+			else
+			{
+				mStats.mFailed++;
+				mLastError = result.mError;
+			}
+			return true;
+		});
+	}
+
+	void FrameCapture::WaitForEncodes()
+	{
+		CollectEncodes(true);
+		UpdateCounts();
+	}
+
+	bool FrameCapture::HasFreeSlot() const
+	{
+		return std::any_of(mSlots.begin(), mSlots.end(),
+						   [](const Slot& slot) { return slot.mState == SlotState::Free; });
+	}
+
+	bool FrameCapture::IsIdle() const
+	{
+		return mEncodes.empty() &&
+			   std::all_of(mSlots.begin(), mSlots.end(),
+						   [](const Slot& slot) { return slot.mState == SlotState::Free; });
+	}
+
+	void FrameCapture::UpdateCounts()
+	{
+		mStats.mPendingSlots = static_cast<uint32_t>(
+			std::count_if(mSlots.begin(), mSlots.end(),
+						  [](const Slot& slot) { return slot.mState != SlotState::Free; }));
+		mStats.mEncodesInFlight = static_cast<uint32_t>(mEncodes.size());
+	}
+} // namespace Graphics
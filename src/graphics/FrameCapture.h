@@ -0,0 +1,135 @@
+#pragma once
+
+#include "texture/Image.h"
+#include "texture/ImageEncoder.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+namespace Graphics
+{
+	/// What FrameCapture needs from the GPU side, one readback buffer per
+	/// slot. The renderer plugs in ReadbackBuffers, the tests fakes.
+	struct CaptureBackend
+	{
+		/// Records the copy of this frame's image into the slot's buffer.
+		std::function<bool(uint32_t slot, uint32_t width, uint32_t height)> mRecordCopy;
+		/// Maps the slot's buffer, only called once its copy's fence has
+		/// passed. Rows are rowPitch bytes apart, width * 4 of them pixels.
+		std::function<const uint8_t*(uint32_t slot, uint32_t& rowPitch)> mMap;
+		std::function<void(uint32_t slot)> mUnmap;
+	};
+
+	struct FrameCaptureDesc
+	{
+		/// Readback buffers, so this many frames can be in flight before
+		/// Capture has to say no.
+		uint32_t mRingSize = 3;
+		/// Frames copied out and waiting on (or in) an encoder. Past this
+		/// the readback buffers stay held, which fills the ring and pushes
+		/// back on Capture instead of queueing images without bound.
+		uint32_t mMaxEncodesInFlight = 8;
+		/// Encoders run here, ThreadPool::GetDefault when null.
+		Utils::ThreadPool* mPool = nullptr;
+	};
+
+	struct FrameCaptureStats
+	{
+		uint64_t mRequested = 0;
+		/// Ring full, Capture returned false.
+		uint64_t mDropped = 0;
+		/// Copied out of a readback buffer.
+		uint64_t mReadBack = 0;
+		uint64_t mEncoded = 0;
+		uint64_t mFailed = 0;
+		uint64_t mBytesWritten = 0;
+		uint32_t mPendingSlots = 0;
+		uint32_t mEncodesInFlight = 0;
+	};
+
+	/// Saves rendered frames to disk without stalling the frame. Capture
+	/// records a copy into a free readback buffer, Retire maps the buffers
+	/// whose fence has passed, copies the pixels out and hands them to a
+	/// worker to encode (PNG, QOI or EXR from the extension) and write. The
+	/// CPU never waits on the GPU, so with enough workers the capture rate
+	/// is whatever the GPU renders at.
+	/// The images are RGBA8 holding sRGB colour. Not thread safe, call
+	/// from the render thread.
+	class FrameCapture
+	{
+	public:
+		FrameCapture(const CaptureBackend& backend, const FrameCaptureDesc& desc = {});
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		/// Records a copy of a width x height image to be written to path.
+		/// False when every slot is still in flight (counted as dropped),
+		/// the extension isn't one we encode, or the copy failed.
+		bool Capture(uint32_t width, uint32_t height, const std::filesystem::path& path);
+
+		/// Stamps this frame's captures with the fence its commands signal.
+		void EndFrame(uint64_t fence);
+
+		/// Reads back whatever completedFence covers and queues the
+		/// encodes. Also collects finished encodes. Once a frame.
+		void Retire(uint64_t completedFence);
+
+		/// Blocks until every queued encode has been written. Captures
+		/// still on the GPU are left alone.
+		void WaitForEncodes();
+
+		bool HasFreeSlot() const;
+		bool IsIdle() const;
+
+		const FrameCaptureStats& GetStats() const { return mStats; }
+		const std::string& GetLastError() const { return mLastError; }
+
+	private:
+		enum class SlotState
+		{
+			Free,
+			Recorded,
+			InFlight
+		};
+
+		struct Slot
+		{
+			SlotState mState = SlotState::Free;
+			uint64_t mFence = 0;
+			uint64_t mSequence = 0;
+			uint32_t mWidth = 0;
+			uint32_t mHeight = 0;
+			std::filesystem::path mPath;
+			TextureTools::EncodeFormat mFormat = TextureTools::EncodeFormat::Unknown;
+		};
+
+		struct EncodeResult
+		{
+			bool mSuccess = false;
+			size_t mBytes = 0;
+			std::string mError;
+		};
+
+		void CollectEncodes(bool wait);
+		bool ReadBack(Slot& slot, uint32_t index);
+		void UpdateCounts();
+
+		CaptureBackend mBackend;
+		FrameCaptureDesc mDesc;
+		std::vector<Slot> mSlots;
+		std::vector<std::future<EncodeResult>> mEncodes;
+		uint64_t mNextSequence = 0;
+		FrameCaptureStats mStats;
+		std::string mLastError;
+	};
+} // namespace Graphics
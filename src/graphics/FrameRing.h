@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Graphics
+{
+	/// What FrameRing needs from a command queue. The App plugs in the
+	/// graphics CommandQueue, the tests a fake one.
+	struct FrameQueue
+	{
+		std::function<uint64_t()> mGetCompletedFence;
+		/// Blocks until the fence has completed.
+		std::function<void(uint64_t)> mWaitForFence;
+	};
+
+	struct FrameRingStats
+	{
+		uint64_t mFrames = 0;
+		/// Frames where BeginFrame had to block on the GPU.
+		uint64_t mWaits = 0;
+	};
+
+	/// N copies of whatever a frame records into (a GraphicsContext with
+	/// its command allocator in the App), each tagged with the fence of the
+	/// last frame that used it. BeginFrame only blocks when the slot it is
+	/// about to reuse is still on the GPU, so with a latency of 2 the CPU
+	/// records frame N+1 while the GPU runs frame N. A latency of 1 is the
+	/// old wait-every-frame behaviour.
+	template <typename T>
+	class FrameRing
+	{
+	public:
+		using Factory = std::function<std::unique_ptr<T>()>;
+
+		static constexpr uint32_t MAX_LATENCY = 4;
+
+		FrameRing(FrameQueue queue, Factory factory, uint32_t latency = 2)
+		: mQueue(std::move(queue))
+		, mFactory(std::move(factory))
+		{
+			Resize(latency);
+		}
+
+		FrameRing(const FrameRing&) = delete;
+		FrameRing& operator=(const FrameRing&) = delete;
+
+		/// Waits for the GPU to be done with the frame that last used the
+		/// next slot and hands that slot over for recording.
+		T& BeginFrame()
+		{
+			assert(!mInFrame && "BeginFrame called twice without EndFrame");
+			mInFrame = true;
+
+			Slot& slot = mSlots[mCurrent];
+			if (slot.mFence != 0 && mQueue.mGetCompletedFence() < slot.mFence)
+			{
+				mQueue.mWaitForFence(slot.mFence);
+				mStats.mWaits++;
+			}
+			return *slot.mResources;
+		}
+
+		/// The fence the frame's work completes at, from ExecuteCommandList.
+		void EndFrame(uint64_t fence)
+		{
+			assert(mInFrame && "EndFrame without BeginFrame");
+			mInFrame = false;
+
+			mSlots[mCurrent].mFence = fence;
+			mCurrent = (mCurrent + 1) % static_cast<uint32_t>(mSlots.size());
+			mStats.mFrames++;
+		}
+
+		/// Waits for every frame still on the GPU.
+		void WaitForIdle()
+		{
+			uint64_t latest = 0;
+			for (const Slot& slot : mSlots)
+			{
+				latest = slot.mFence > latest ? slot.mFence : latest;
+			}
+			if (latest != 0 && mQueue.mGetCompletedFence() < latest)
+			{
+				mQueue.mWaitForFence(latest);
+			}
+		}
+
+		/// Drains the GPU and rebuilds the slots. Only between frames.
+		void SetLatency(uint32_t latency)
+		{
+			assert(!mInFrame && "Can't change the latency mid frame");
+			WaitForIdle();
+			Resize(latency);
+		}
+
+		uint32_t GetLatency() const { return static_cast<uint32_t>(mSlots.size()); }
+		/// Slot the next (or current) frame records into.
+		uint32_t GetFrameIndex() const { return mCurrent; }
+		uint64_t GetFence(uint32_t index) const { return mSlots[index].mFence; }
+		const FrameRingStats& GetStats() const { return mStats; }
+
+	private:
+		struct Slot
+		{
+			std::unique_ptr<T> mResources;
+			uint64_t mFence = 0;
+		};
+
+		void Resize(uint32_t latency)
+		{
+			latency = latency < 1 ? 1 : (latency > MAX_LATENCY ? MAX_LATENCY : latency);
+
+			// Keep what exists, the GPU is idle so every fence is done.
+			mSlots.resize(latency);
+			for (Slot& slot : mSlots)
+			{
+				if (!slot.mResources)
+				{
+					slot.mResources = mFactory();
+				}
+				slot.mFence = 0;
+			}
+			mCurrent = 0;
+		}
+
+		FrameQueue mQueue;
+		Factory mFactory;
+		std::vector<Slot> mSlots;
+		uint32_t mCurrent = 0;
+		bool mInFrame = false;
+		FrameRingStats mStats;
+	};
+} // namespace Graphics
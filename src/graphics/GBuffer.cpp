@@ -2,8 +2,31 @@
 #include "CommandContext.h"
 #include "Core.h"
 #include "d3d12.h"
+#include <algorithm>
 #include <spdlog/spdlog.h>
 
+namespace
+{
+	constexpr DXGI_FORMAT TARGET_FORMATS[4] = {
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		DXGI_FORMAT_R16G16B16A16_FLOAT,
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		DXGI_FORMAT_R16G16B16A16_FLOAT,
+	};
+	constexpr DXGI_FORMAT DEPTH_FORMAT = DXGI_FORMAT_D32_FLOAT;
+
+	Graphics::RenderTargetKey ColorKey(DXGI_FORMAT format, uint32_t width, uint32_t height)
+	{
+		return {static_cast<uint32_t>(format), width, height, Graphics::RENDER_TARGET_NONE};
+	}
+
+	Graphics::RenderTargetKey DepthKey(uint32_t width, uint32_t height)
+	{
+		return {static_cast<uint32_t>(DEPTH_FORMAT), width, height,
+				Graphics::RENDER_TARGET_DEPTH};
+	}
+} // namespace
+
 void GBuffer::Create(uint32_t width, uint32_t height)
 {
 	if (width <= 0 || height <= 0)
@@ -13,38 +36,42 @@ void GBuffer::Create(uint32_t width, uint32_t height)
 
 	mWidth = width;
 	mHeight = height;
+	mTargetWidth = width;
+	mTargetHeight = height;
 
-	mRenderTarget0.Create(L"GBuffer_Albedo_AO", mWidth, mHeight, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
-	mRenderTarget0.CreateView(Graphics::gDevice);
+	// Create makes the RTV.
+	mRenderTarget0 = std::make_shared<ColorBuffer>();
+	mRenderTarget0->Create(L"GBuffer_Albedo_AO", mWidth, mHeight, 1, TARGET_FORMATS[0]);
 
-	mRenderTarget1.Create(L"GBuffer_Normal_Roughness", mWidth, mHeight, 1,
-						  DXGI_FORMAT_R16G16B16A16_FLOAT);
-	mRenderTarget1.CreateView(Graphics::gDevice);
+	mRenderTarget1 = std::make_shared<ColorBuffer>();
+	mRenderTarget1->Create(L"GBuffer_Normal_Roughness", mWidth, mHeight, 1, TARGET_FORMATS[1]);
 
-	mRenderTarget2.Create(L"GBuffer_Metallic_Flags", mWidth, mHeight, 1,
-						  DXGI_FORMAT_R8G8B8A8_UNORM);
-	mRenderTarget2.CreateView(Graphics::gDevice);
+	mRenderTarget2 = std::make_shared<ColorBuffer>();
+	mRenderTarget2->Create(L"GBuffer_Metallic_Flags", mWidth, mHeight, 1, TARGET_FORMATS[2]);
 
-	mRenderTarget3.Create(L"GBuffer_Emissive", mWidth, mHeight, 1, DXGI_FORMAT_R16G16B16A16_FLOAT);
-	mRenderTarget3.CreateView(Graphics::gDevice);
+	mRenderTarget3 = std::make_shared<ColorBuffer>();
+	mRenderTarget3->Create(L"GBuffer_Emissive", mWidth, mHeight, 1, TARGET_FORMATS[3]);
 
-	mDepth.Create(L"GBuffer_Depth", mWidth, mHeight, DXGI_FORMAT_D32_FLOAT);
-	mDepth.CreateView(Graphics::gDevice);
+	mDepth = std::make_shared<DepthBuffer>();
+	mDepth->Create(L"GBuffer_Depth", mWidth, mHeight, DEPTH_FORMAT);
+	mDepth->CreateView(Graphics::gDevice);
 
 	// Log?
 }
 
 void GBuffer::Destroy()
 {
-	mRenderTarget0.Destroy();
-	mRenderTarget1.Destroy();
-	mRenderTarget2.Destroy();
-	mRenderTarget3.Destroy();
+	mRenderTarget0.reset();
+	mRenderTarget1.reset();
+	mRenderTarget2.reset();
+	mRenderTarget3.reset();
 
-	mDepth.Destroy();
+	mDepth.reset();
 
 	mWidth = 0;
 	mHeight = 0;
+	mTargetWidth = 0;
+	mTargetHeight = 0;
 }
 
 void GBuffer::Resize(uint32_t width, uint32_t height)
@@ -55,32 +82,78 @@ void GBuffer::Resize(uint32_t width, uint32_t height)
 	Create(width, height);
 }
 
+void GBuffer::Acquire(ColorTargetPool& colors, DepthTargetPool& depths, uint32_t targetWidth,
+					  uint32_t targetHeight)
+{
+	Release(colors, depths);
+
+	mTargetWidth = targetWidth;
+	mTargetHeight = targetHeight;
+
+	mRenderTarget0 = colors.Acquire(ColorKey(TARGET_FORMATS[0], targetWidth, targetHeight));
+	mRenderTarget1 = colors.Acquire(ColorKey(TARGET_FORMATS[1], targetWidth, targetHeight));
+	mRenderTarget2 = colors.Acquire(ColorKey(TARGET_FORMATS[2], targetWidth, targetHeight));
+	mRenderTarget3 = colors.Acquire(ColorKey(TARGET_FORMATS[3], targetWidth, targetHeight));
+	mDepth = depths.Acquire(DepthKey(targetWidth, targetHeight));
+
+	SetRenderSize(mWidth, mHeight);
+}
+
+void GBuffer::Release(ColorTargetPool& colors, DepthTargetPool& depths)
+{
+	if (!mDepth)
+		return;
+
+	colors.Release(ColorKey(TARGET_FORMATS[0], mTargetWidth, mTargetHeight),
+				   std::move(mRenderTarget0));
+	colors.Release(ColorKey(TARGET_FORMATS[1], mTargetWidth, mTargetHeight),
+				   std::move(mRenderTarget1));
+	colors.Release(ColorKey(TARGET_FORMATS[2], mTargetWidth, mTargetHeight),
+				   std::move(mRenderTarget2));
+	colors.Release(ColorKey(TARGET_FORMATS[3], mTargetWidth, mTargetHeight),
+				   std::move(mRenderTarget3));
+	depths.Release(DepthKey(mTargetWidth, mTargetHeight), std::move(mDepth));
+
+	mRenderTarget0.reset();
+	mRenderTarget1.reset();
+	mRenderTarget2.reset();
+	mRenderTarget3.reset();
+	mDepth.reset();
+}
+
+void GBuffer::SetRenderSize(uint32_t width, uint32_t height)
+{
+	mWidth = std::min(width, mTargetWidth);
+	mHeight = std::min(height, mTargetHeight);
+}
+
 void GBuffer::Clear(Graphics::GraphicsContext& ctx)
 {
 	float clearColor[4] = {0.0F, 0.0F, 0.0F, 0.0F};
 
-	ctx.ClearColor(mRenderTarget0.GetRTV(), clearColor);
-	ctx.ClearColor(mRenderTarget1.GetRTV(), clearColor);
-	ctx.ClearColor(mRenderTarget2.GetRTV(), clearColor);
-	ctx.ClearColor(mRenderTarget3.GetRTV(), clearColor);
+	ctx.ClearColor(mRenderTarget0->GetRTV(), clearColor);
+	ctx.ClearColor(mRenderTarget1->GetRTV(), clearColor);
+	ctx.ClearColor(mRenderTarget2->GetRTV(), clearColor);
+	ctx.ClearColor(mRenderTarget3->GetRTV(), clearColor);
 
-	ctx.ClearDepth(mDepth.GetDSV(), 1.0F);
+	ctx.ClearDepth(mDepth->GetDSV(), 1.0F);
 }
 
 void GBuffer::SetAsRenderTargets(Graphics::GraphicsContext& ctx)
 {
 	// TODO: Implement setting GBuffer as render targets
 	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandles[4] = {
-		mRenderTarget0.GetRTV(),
-		mRenderTarget1.GetRTV(),
-		mRenderTarget2.GetRTV(),
-		mRenderTarget3.GetRTV(),
+		mRenderTarget0->GetRTV(),
+		mRenderTarget1->GetRTV(),
+		mRenderTarget2->GetRTV(),
+		mRenderTarget3->GetRTV(),
 	};
 
-	D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = mDepth.GetDSV();
+	D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = mDepth->GetDSV();
 
 	ctx.GetCommandList()->OMSetRenderTargets(4, rtvHandles, FALSE, &dsvHandle);
 
+	// Only the render size, the targets can be bigger.
 	ctx.SetViewport(0.0F, 0.0F, static_cast<float>(mWidth), static_cast<float>(mHeight));
 	ctx.SetScissorRect(0, 0, mWidth, mHeight);
 }
@@ -2,51 +2,74 @@
 
 #include "ColorBuffer.h"
 #include "DepthBuffer.h"
+#include "RenderTargetPool.h"
 #include <cstdint>
+#include <memory>
 
 namespace Graphics
 {
 	class GraphicsContext;
 }
 
+using ColorTargetPool = Graphics::RenderTargetPool<std::shared_ptr<ColorBuffer>>;
+using DepthTargetPool = Graphics::RenderTargetPool<std::shared_ptr<DepthBuffer>>;
+
 struct GBuffer
 {
 	void Create(uint32_t width, uint32_t height);
 	void Destroy();
 	void Resize(uint32_t width, uint32_t height);
+
+	/// Swaps the targets for pooled ones of targetWidth x targetHeight,
+	/// the old ones go back to the pools. The pool factories make the
+	/// views, Acquire doesn't.
+	void Acquire(ColorTargetPool& colors, DepthTargetPool& depths, uint32_t targetWidth,
+				 uint32_t targetHeight);
+	void Release(ColorTargetPool& colors, DepthTargetPool& depths);
+
+	/// The part of the targets rendered into, the viewport and scissor
+	/// in SetAsRenderTargets.
+	void SetRenderSize(uint32_t width, uint32_t height);
+
 	void Clear(Graphics::GraphicsContext& ctx);
 	void SetAsRenderTargets(Graphics::GraphicsContext& ctx);
 
-	ColorBuffer& GetRenderTarget0() { return mRenderTarget0; }
-	ColorBuffer& GetRenderTarget1() { return mRenderTarget1; }
-	ColorBuffer& GetRenderTarget2() { return mRenderTarget2; }
-	ColorBuffer& GetRenderTarget3() { return mRenderTarget3; }
-	DepthBuffer& GetDepthBuffer() { return mDepth; }
+	ColorBuffer& GetRenderTarget0() { return *mRenderTarget0; }
+	ColorBuffer& GetRenderTarget1() { return *mRenderTarget1; }
+	ColorBuffer& GetRenderTarget2() { return *mRenderTarget2; }
+	ColorBuffer& GetRenderTarget3() { return *mRenderTarget3; }
+	DepthBuffer& GetDepthBuffer() { return *mDepth; }
 
 	uint32_t GetWidth() const { return mWidth; }
 	uint32_t GetHeight() const { return mHeight; }
+	uint32_t GetTargetWidth() const { return mTargetWidth; }
+	uint32_t GetTargetHeight() const { return mTargetHeight; }
 
 private:
 	// rgba8_UNORM
 	// Albedo / AO
-	ColorBuffer mRenderTarget0;
+	std::shared_ptr<ColorBuffer> mRenderTarget0;
 
 	// rgb16_float
 	// World Normal, Roughness
-	ColorBuffer mRenderTarget1;
+	std::shared_ptr<ColorBuffer> mRenderTarget1;
 
 	//rgba8_unorm
 	// Metallic / null / null / Flags
 	// TODO material id?
-	ColorBuffer mRenderTarget2;
+	std::shared_ptr<ColorBuffer> mRenderTarget2;
 
 	// rgba16_float
 	// Emissive / null
-	ColorBuffer mRenderTarget3;
+	std::shared_ptr<ColorBuffer> mRenderTarget3;
 
 	// d32_float
-	DepthBuffer mDepth;
+	std::shared_ptr<DepthBuffer> mDepth;
 
+	/// Render size.
 	uint32_t mWidth = 0;
 	uint32_t mHeight = 0;
+	/// Size of the targets themselves.
+	uint32_t mTargetWidth = 0;
+	uint32_t mTargetHeight = 0;
 };
@@ -0,0 +1,59 @@
+#include "QueueScheduler.h"
+#include <cassert>
+
+namespace Graphics
+{
+	QueueScheduler::QueueScheduler(QueueSchedulerBackend backend)
+	: mBackend(std::move(backend))
+	{
+	}
+
+	void QueueScheduler::Wait(QueueType queue, QueueFence fence)
+	{
+		assert(queue != QueueType::Count && fence.mQueue != QueueType::Count);
+		if (!fence.IsValid())
+		{
+			return;
+		}
+
+		size_t consumer = static_cast<size_t>(queue);
+		size_t producer = static_cast<size_t>(fence.mQueue);
+
+		// A queue runs its own work in order, and a GPU wait on something
+		// already finished costs a submit for nothing.
+		if (consumer == producer || mWaited[consumer][producer] >= fence.mValue ||
+			IsComplete(fence))
+		{
+			mStats.mSkippedWaits++;
+			return;
+		}
+
+		mBackend.mWait(queue, fence);
+		mWaited[consumer][producer] = fence.mValue;
+		mStats.mWaits++;
+	}
+
+	QueueFence QueueScheduler::Submit(QueueType queue, const Execute& execute,
+									  std::initializer_list<QueueFence> dependsOn)
+	{
+		for (const QueueFence& fence : dependsOn)
+		{
+			Wait(queue, fence);
+		}
+
+		uint64_t value = execute();
+		mLastSubmitted[static_cast<size_t>(queue)] = value;
+		mStats.mSubmits++;
+		return {queue, value};
+	}
+
+	bool QueueScheduler::IsComplete(QueueFence fence)
+	{
+		return !fence.IsValid() || fence.mValue <= mBackend.mGetCompletedFence(fence.mQueue);
+	}
+
+	QueueFence QueueScheduler::GetLastSubmitted(QueueType queue) const
+	{
+		return {queue, mLastSubmitted[static_cast<size_t>(queue)]};
+	}
+} // namespace Graphics
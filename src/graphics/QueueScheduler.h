@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+
+namespace Graphics
+{
+	enum class QueueType : uint8_t
+	{
+		Graphics = 0,
+		Compute,
+		Copy,
+		Count
+	};
+
+	/// A point on one queue's timeline, what a Submit returns.
+	struct QueueFence
+	{
+		QueueType mQueue = QueueType::Graphics;
+		/// 0 for nothing to wait on.
+		uint64_t mValue = 0;
+
+		bool IsValid() const { return mValue != 0; }
+	};
+
+	/// The queue work behind a QueueScheduler. The Renderer plugs in the
+	/// CommandListManager queues, the tests a fake GPU.
+	struct QueueSchedulerBackend
+	{
+		std::function<uint64_t(QueueType queue)> mGetCompletedFence;
+		/// Makes consumer wait on the GPU until producer reaches its
+		/// value. Only work submitted to consumer afterwards is held back.
+		std::function<void(QueueType consumer, QueueFence producer)> mWait;
+	};
+
+	struct QueueSchedulerStats
+	{
+		uint64_t mSubmits = 0;
+		uint64_t mWaits = 0;
+		/// Waits dropped because the queue already waited on something at
+		/// or past it, it was the same queue, or the fence had completed.
+		uint64_t mSkippedWaits = 0;
+	};
+
+	/// Orders work across the graphics, compute and copy queues with fences
+	/// instead of CPU waits. Submit runs the execute callback for a queue
+	/// (a context's Execute), after making that queue wait on the GPU for
+	/// the fences it depends on, and returns where that work ends on its
+	/// timeline for later submits to depend on. A queue only ever waits
+	/// once for the same producer value. Not thread safe.
+	class QueueScheduler
+	{
+	public:
+		/// Executes the recorded list and returns the fence it signals.
+		using Execute = std::function<uint64_t()>;
+
+		explicit QueueScheduler(QueueSchedulerBackend backend);
+
+		QueueScheduler(const QueueScheduler&) = delete;
+		QueueScheduler& operator=(const QueueScheduler&) = delete;
+
+		/// Holds back everything submitted to queue after this until fence.
+		/// For work the scheduler doesn't submit itself (the App's frame
+		/// list), the wait still applies to it.
+		void Wait(QueueType queue, QueueFence fence);
+
+		QueueFence Submit(QueueType queue, const Execute& execute,
+						  std::initializer_list<QueueFence> dependsOn = {});
+
+		bool IsComplete(QueueFence fence);
+
+		QueueFence GetLastSubmitted(QueueType queue) const;
+		const QueueSchedulerStats& GetStats() const { return mStats; }
+
+	private:
+		static constexpr size_t QUEUE_COUNT = static_cast<size_t>(QueueType::Count);
+
+		QueueSchedulerBackend mBackend;
+		std::array<uint64_t, QUEUE_COUNT> mLastSubmitted = {};
+		/// [consumer][producer], the highest value consumer waited for.
+		std::array<std::array<uint64_t, QUEUE_COUNT>, QUEUE_COUNT> mWaited = {};
+		QueueSchedulerStats mStats;
+	};
+} // namespace Graphics
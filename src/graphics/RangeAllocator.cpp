@@ -0,0 +1,338 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+#include <bit>
+
+namespace Graphics
+{
+	namespace
+	{
+		constexpr uint32_t INVALID = RangeAllocation::INVALID;
+	}
+
+	RangeAllocator::RangeAllocator(uint32_t capacity)
+	{
+		Reset(capacity);
+	}
+
+	void RangeAllocator::Reset(uint32_t capacity)
+	{
+		mNodes.clear();
+		mUnusedNodes.clear();
+		mFirstLevelBitmap = 0;
+		mSecondLevelBitmaps.fill(0);
+		for (auto& lists : mFreeLists)
+		{
+			lists.fill(INVALID);
+		}
+		mStats = {};
+		mStats.mCapacity = capacity;
+
+		if (capacity > 0)
+		{
+			uint32_t node = NewNode();
+			mNodes[node].mOffset = 0;
+			mNodes[node].mSize = capacity;
+			InsertFree(node);
+		}
+	}
+
+	void RangeAllocator::GetBin(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		if (size < SMALL_SIZE)
+		{
+			firstLevel = 0;
+			secondLevel = size;
+			return;
+		}
+
+		// The top bit picks the first level, the next SECOND_LEVEL_LOG2
+		// bits below it the second.
+		uint32_t log2 = std::bit_width(size) - 1;
+		firstLevel = log2 - SECOND_LEVEL_LOG2 + 1;
+		secondLevel = (size >> (log2 - SECOND_LEVEL_LOG2)) - SECOND_LEVEL_COUNT;
+	}
+
+	RangeAllocation RangeAllocator::Allocate(uint32_t size)
+	{
+		uint32_t node = size == 0 ? INVALID : FindFree(size);
+		if (node == INVALID)
+		{
+			mStats.mFailedAllocations++;
+			return {};
+		}
+
+		RemoveFree(node);
+		if (mNodes[node].mSize > size)
+		{
+			// The rest stays free right after the allocation.
+			uint32_t rest = NewNode();
+			Node& block = mNodes[node];
+			Node& remainder = mNodes[rest];
+			remainder.mOffset = block.mOffset + size;
+			remainder.mSize = block.mSize - size;
+			remainder.mPrevPhysical = node;
+			remainder.mNextPhysical = block.mNextPhysical;
+			if (block.mNextPhysical != INVALID)
+			{
+				mNodes[block.mNextPhysical].mPrevPhysical = rest;
+			}
+			block.mNextPhysical = rest;
+			block.mSize = size;
+			InsertFree(rest);
+			mStats.mSplits++;
+		}
+
+		mStats.mUsed += size;
+		mStats.mAllocations++;
+		return {mNodes[node].mOffset, size, node};
+	}
+
+	bool RangeAllocator::Free(const RangeAllocation& allocation)
+	{
+		if (!allocation.IsValid() || allocation.mNode >= mNodes.size())
+		{
+			return false;
+		}
+
+		uint32_t node = allocation.mNode;
+		const Node& block = mNodes[node];
+		if (!block.mLive || block.mFree || block.mOffset != allocation.mOffset ||
+			block.mSize != allocation.mSize)
+		{
+			return false;
+		}
+
+		mStats.mUsed -= block.mSize;
+		mStats.mAllocations--;
+
+		uint32_t prev = block.mPrevPhysical;
+		if (prev != INVALID && mNodes[prev].mFree)
+		{
+			RemoveFree(prev);
+			mNodes[prev].mSize += mNodes[node].mSize;
+			mNodes[prev].mNextPhysical = mNodes[node].mNextPhysical;
+			if (mNodes[node].mNextPhysical != INVALID)
+			{
+				mNodes[mNodes[node].mNextPhysical].mPrevPhysical = prev;
+			}
+			ReleaseNode(node);
+			node = prev;
+			mStats.mMerges++;
+		}
+
+		uint32_t next = mNodes[node].mNextPhysical;
+		if (next != INVALID && mNodes[next].mFree)
+		{
+			RemoveFree(next);
+			mNodes[node].mSize += mNodes[next].mSize;
+			mNodes[node].mNextPhysical = mNodes[next].mNextPhysical;
+			if (mNodes[next].mNextPhysical != INVALID)
+			{
+				mNodes[mNodes[next].mNextPhysical].mPrevPhysical = node;
+			}
+			ReleaseNode(next);
+			mStats.mMerges++;
+		}
+
+		InsertFree(node);
+		return true;
+	}
+
+	RangeAllocation RangeAllocator::Split(RangeAllocation& allocation, uint32_t size)
+	{
+		if (!allocation.IsValid() || allocation.mNode >= mNodes.size() || size == 0)
+		{
+			return {};
+		}
+
+		uint32_t node = allocation.mNode;
+		const Node& block = mNodes[node];
+		if (!block.mLive || block.mFree || block.mOffset != allocation.mOffset ||
+			block.mSize != allocation.mSize || size >= block.mSize)
+		{
+			return {};
+		}
+
+		uint32_t rest = NewNode();
+		Node& front = mNodes[node];
+		Node& back = mNodes[rest];
+		back.mOffset = front.mOffset + size;
+		back.mSize = front.mSize - size;
+		back.mPrevPhysical = node;
+		back.mNextPhysical = front.mNextPhysical;
+		if (front.mNextPhysical != INVALID)
+		{
+			mNodes[front.mNextPhysical].mPrevPhysical = rest;
+		}
+		front.mNextPhysical = rest;
+		front.mSize = size;
+		mStats.mAllocations++;
+		mStats.mSplits++;
+
+		allocation.mSize = size;
+		return {back.mOffset, back.mSize, rest};
+	}
+
+	uint32_t RangeAllocator::FindFree(uint32_t size) const
+	{
+		if (size > mStats.mCapacity)
+		{
+			return INVALID;
+		}
+
+		// Round up to the next bin so anything in the bin found fits,
+		// no need to look at the sizes in the list.
+		uint64_t rounded = size;
+		if (size >= SMALL_SIZE)
+		{
+			uint32_t log2 = std::bit_width(size) - 1;
+			rounded += (1ULL << (log2 - SECOND_LEVEL_LOG2)) - 1;
+		}
+
+		if (rounded <= UINT32_MAX)
+		{
+			uint32_t firstLevel = 0;
+			uint32_t secondLevel = 0;
+			GetBin(static_cast<uint32_t>(rounded), firstLevel, secondLevel);
+
+			uint32_t secondMap = mSecondLevelBitmaps[firstLevel] & (~0U << secondLevel);
+			if (secondMap == 0)
+			{
+				uint32_t firstMap =
+					firstLevel + 1 < 32 ? mFirstLevelBitmap & (~0U << (firstLevel + 1)) : 0;
+				if (firstMap != 0)
+				{
+					firstLevel = std::countr_zero(firstMap);
+					secondMap = mSecondLevelBitmaps[firstLevel];
+				}
+			}
+			if (secondMap != 0)
+			{
+				return mFreeLists[firstLevel][std::countr_zero(secondMap)];
+			}
+		}
+
+		// Nothing in the bins above, but the size's own bin can still hold
+		// one big enough. Only happens when the space is nearly gone.
+		uint32_t firstLevel = 0;
+		uint32_t secondLevel = 0;
+		GetBin(size, firstLevel, secondLevel);
+		for (uint32_t node = mFreeLists[firstLevel][secondLevel]; node != INVALID;
+			 node = mNodes[node].mNextFree)
+		{
+			if (mNodes[node].mSize >= size)
+			{
+				return node;
+			}
+		}
+		return INVALID;
+	}
+
+	uint32_t RangeAllocator::GetLargestFreeRange() const
+	{
+		if (mFirstLevelBitmap == 0)
+		{
+			return 0;
+		}
+
+		uint32_t firstLevel = std::bit_width(mFirstLevelBitmap) - 1;
+		uint32_t secondLevel = std::bit_width(mSecondLevelBitmaps[firstLevel]) - 1;
+		uint32_t largest = 0;
+		for (uint32_t node = mFreeLists[firstLevel][secondLevel]; node != INVALID;
+			 node = mNodes[node].mNextFree)
+		{
+			largest = std::max(largest, mNodes[node].mSize);
+		}
+		return largest;
+	}
+
+	float RangeAllocator::GetFragmentation() const
+	{
+		uint32_t free = GetFreeSize();
+		if (free == 0)
+		{
+			return 0.0F;
+		}
+		return 1.0F - (static_cast<float>(GetLargestFreeRange()) / static_cast<float>(free));
+	}
+
+	uint32_t RangeAllocator::NewNode()
+	{
+		uint32_t node = 0;
+		if (!mUnusedNodes.empty())
+		{
+			node = mUnusedNodes.back();
+			mUnusedNodes.pop_back();
+			mNodes[node] = {};
+		}
+		else
+		{
+			node = static_cast<uint32_t>(mNodes.size());
+			mNodes.emplace_back();
+		}
+		mNodes[node].mLive = true;
+		return node;
+	}
+
+	void RangeAllocator::ReleaseNode(uint32_t node)
+	{
+		mNodes[node].mLive = false;
+		mUnusedNodes.push_back(node);
+	}
+
+	void RangeAllocator::InsertFree(uint32_t node)
+	{
+		uint32_t firstLevel = 0;
+		uint32_t secondLevel = 0;
+		GetBin(mNodes[node].mSize, firstLevel, secondLevel);
+
+		uint32_t& head = mFreeLists[firstLevel][secondLevel];
+		mNodes[node].mPrevFree = INVALID;
+		mNodes[node].mNextFree = head;
+		if (head != INVALID)
+		{
+			mNodes[head].mPrevFree = node;
+		}
+		head = node;
+
+		mNodes[node].mFree = true;
+		mFirstLevelBitmap |= 1U << firstLevel;
+		mSecondLevelBitmaps[firstLevel] |= 1U << secondLevel;
+		mStats.mFreeRanges++;
+	}
+
+	void RangeAllocator::RemoveFree(uint32_t node)
+	{
+		Node& block = mNodes[node];
+		if (block.mPrevFree != INVALID)
+		{
+			mNodes[block.mPrevFree].mNextFree = block.mNextFree;
+		}
+		if (block.mNextFree != INVALID)
+		{
+			mNodes[block.mNextFree].mPrevFree = block.mPrevFree;
+		}
+
+		uint32_t firstLevel = 0;
+		uint32_t secondLevel = 0;
+		GetBin(block.mSize, firstLevel, secondLevel);
+		uint32_t& head = mFreeLists[firstLevel][secondLevel];
+		if (head == node)
+		{
+			head = block.mNextFree;
+			if (head == INVALID)
+			{
+				mSecondLevelBitmaps[firstLevel] &= ~(1U << secondLevel);
+				if (mSecondLevelBitmaps[firstLevel] == 0)
+				{
+					mFirstLevelBitmap &= ~(1U << firstLevel);
+				}
+			}
+		}
+
+		block.mPrevFree = INVALID;
+		block.mNextFree = INVALID;
+		block.mFree = false;
+		mStats.mFreeRanges--;
+	}
+} // namespace Graphics
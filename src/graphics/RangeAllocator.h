@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Graphics
+{
+	struct RangeAllocation
+	{
+		static constexpr uint32_t INVALID = UINT32_MAX;
+
+		uint32_t mOffset = INVALID;
+		uint32_t mSize = 0;
+		/// The allocator's bookkeeping for the range, Free needs it back.
+		uint32_t mNode = INVALID;
+
+		bool IsValid() const { return mOffset != INVALID; }
+	};
+
+	struct RangeAllocatorStats
+	{
+		uint32_t mCapacity = 0;
+		uint32_t mUsed = 0;
+		uint32_t mAllocations = 0;
+		uint32_t mFreeRanges = 0;
+		uint64_t mSplits = 0;
+		uint64_t mMerges = 0;
+		uint32_t mFailedAllocations = 0;
+	};
+
+	/// Hands out [offset, offset + size) ranges of a fixed capacity, the
+	/// slots of a descriptor heap for BindlessAllocator. Two level
+	/// segregated fit (TLSF): free ranges sit in lists binned by the
+	/// power of two of their size, split 16 ways again below that, with a
+	/// bitmap per level. Allocate finds a big enough bin with two bit
+	/// scans and splits off the rest, Free merges with free neighbours.
+	/// Both are O(1). Only when no bin above the size's own has anything
+	/// left does Allocate look through that one bin for a fit.
+	/// Not thread safe.
+	class RangeAllocator
+	{
+	public:
+		explicit RangeAllocator(uint32_t capacity = 0);
+
+		/// Forgets every allocation, the whole capacity is one free range.
+		void Reset(uint32_t capacity);
+
+		/// Invalid when there is no free range of size, however much is
+		/// free in total.
+		RangeAllocation Allocate(uint32_t size);
+
+		/// False for an allocation that isn't live, so freeing twice is
+		/// caught instead of corrupting the lists.
+		bool Free(const RangeAllocation& allocation);
+
+		/// Shrinks a live allocation to its first size slots and returns the
+		/// rest as an allocation of its own, so the two can be freed apart.
+		/// Invalid, and allocation left alone, unless size is less than its
+		/// size.
+		RangeAllocation Split(RangeAllocation& allocation, uint32_t size);
+
+		uint32_t GetCapacity() const { return mStats.mCapacity; }
+		uint32_t GetFreeSize() const { return mStats.mCapacity - mStats.mUsed; }
+
+		/// Biggest single range Allocate could hand out right now.
+		uint32_t GetLargestFreeRange() const;
+
+		/// 0 when all the free space is one range, towards 1 the more it
+		/// is scattered into small ones.
+		float GetFragmentation() const;
+
+		const RangeAllocatorStats& GetStats() const { return mStats; }
+
+	private:
+		static constexpr uint32_t SECOND_LEVEL_LOG2 = 4;
+		static constexpr uint32_t SECOND_LEVEL_COUNT = 1U << SECOND_LEVEL_LOG2;
+		/// Sizes below this all share first level 0, one bin per size.
+		static constexpr uint32_t SMALL_SIZE = SECOND_LEVEL_COUNT;
+		static constexpr uint32_t FIRST_LEVEL_COUNT = 32 - SECOND_LEVEL_LOG2 + 1;
+
+		struct Node
+		{
+			uint32_t mOffset = 0;
+			uint32_t mSize = 0;
+			/// Neighbours in the address space.
+			uint32_t mPrevPhysical = RangeAllocation::INVALID;
+			uint32_t mNextPhysical = RangeAllocation::INVALID;
+			/// Neighbours in the bin's free list.
+			uint32_t mPrevFree = RangeAllocation::INVALID;
+			uint32_t mNextFree = RangeAllocation::INVALID;
+			bool mFree = false;
+			bool mLive = false;
+		};
+
+		static void GetBin(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t NewNode();
+		void ReleaseNode(uint32_t node);
+		void InsertFree(uint32_t node);
+		void RemoveFree(uint32_t node);
+		/// A free node of at least size, or INVALID.
+		uint32_t FindFree(uint32_t size) const;
+
+		std::vector<Node> mNodes;
+		std::vector<uint32_t> mUnusedNodes;
+
+		uint32_t mFirstLevelBitmap = 0;
+		std::array<uint32_t, FIRST_LEVEL_COUNT> mSecondLevelBitmaps = {};
+		std::array<std::array<uint32_t, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> mFreeLists;
+
+		RangeAllocatorStats mStats;
+	};
+} // namespace Graphics
@@ -9,7 +9,8 @@
 namespace Graphics
 {
 	/// CPU readable buffer for reading GPU results back to the CPU.
-	/// NOTE Only for debugging, too slow.
+	/// Only map it once the fence of the copy into it has passed, Map
+	/// doesn't wait. FrameCapture keeps a ring of these for that.
 	class ReadbackBuffer : public GpuResource
 	{
 	public:
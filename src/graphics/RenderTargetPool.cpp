@@ -0,0 +1,97 @@
+#include "RenderTargetPool.h"
+#include <algorithm>
+
+namespace Graphics
+{
+	uint32_t BucketDimension(uint32_t size, uint32_t granularity)
+	{
+		if (granularity == 0)
+		{
+			return std::max(size, 1U);
+		}
+		uint32_t buckets = (std::max(size, 1U) + granularity - 1) / granularity;
+		return buckets * granularity;
+	}
+
+	RenderTargetKey MakeRenderTargetKey(uint32_t format, uint32_t width, uint32_t height,
+										uint32_t flags, const RenderTargetPoolDesc& desc)
+	{
+		return {format, BucketDimension(width, desc.mGranularity),
+				BucketDimension(height, desc.mGranularity), flags};
+	}
+
+	bool FitsAllocation(uint32_t allocWidth, uint32_t allocHeight, uint32_t width,
+						uint32_t height, const RenderTargetPoolDesc& desc)
+	{
+		if (width > allocWidth || height > allocHeight)
+		{
+			return false;
+		}
+
+		// Measured against the bucket the size would get on its own, so a
+		// bucket's worth of slack is allowed on top of the rounding.
+		uint64_t slack = static_cast<uint64_t>(desc.mSlackBuckets) * desc.mGranularity;
+		return allocWidth <= BucketDimension(width, desc.mGranularity) + slack &&
+			   allocHeight <= BucketDimension(height, desc.mGranularity) + slack;
+	}
+
+	ResizeCoalescer::ResizeCoalescer(const RenderTargetPoolDesc& desc)
+	: mDesc(desc)
+	{
+	}
+
+	ResizeDecision ResizeCoalescer::Update(uint32_t width, uint32_t height)
+	{
+		width = std::max(width, 1U);
+		height = std::max(height, 1U);
+
+		uint32_t bucketWidth = BucketDimension(width, mDesc.mGranularity);
+		uint32_t bucketHeight = BucketDimension(height, mDesc.mGranularity);
+
+		ResizeDecision decision;
+		bool covered = width <= mTargetWidth && height <= mTargetHeight;
+
+		if (mTargetWidth == 0 || FitsAllocation(mTargetWidth, mTargetHeight, width, height, mDesc))
+		{
+			mPendingFrames = 0;
+		}
+		else
+		{
+			// The exact size, a slow drag stays in one bucket for a while.
+			if (width == mPendingWidth && height == mPendingHeight)
+			{
+				mPendingFrames++;
+			}
+			else
+			{
+				mPendingWidth = width;
+				mPendingHeight = height;
+				mPendingFrames = 1;
+			}
+		}
+
+		// Nothing allocated yet, nothing to wait for.
+		if (mTargetWidth == 0 || mPendingFrames >= std::max(mDesc.mStableFrames, 1U))
+		{
+			mTargetWidth = bucketWidth;
+			mTargetHeight = bucketHeight;
+			mWidth = width;
+			mHeight = height;
+			mPendingFrames = 0;
+			mReallocations++;
+			decision.mAction = ResizeDecision::Action::Reallocate;
+		}
+		else if (covered && (width != mWidth || height != mHeight))
+		{
+			mWidth = width;
+			mHeight = height;
+			decision.mAction = ResizeDecision::Action::Resize;
+		}
+
+		decision.mWidth = mWidth;
+		decision.mHeight = mHeight;
+		decision.mTargetWidth = mTargetWidth;
+		decision.mTargetHeight = mTargetHeight;
+		return decision;
+	}
+} // namespace Graphics
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Graphics
+{
+	enum RenderTargetFlags : uint32_t
+	{
+		RENDER_TARGET_NONE = 0,
+		RENDER_TARGET_UAV = 1 << 0,
+		RENDER_TARGET_DEPTH = 1 << 1,
+	};
+
+	/// What makes two pooled targets interchangeable. The size is the
+	/// bucketed allocation size, not what gets rendered into it.
+	struct RenderTargetKey
+	{
+		/// A DXGI_FORMAT, kept as a plain integer so this builds without D3D.
+		uint32_t mFormat = 0;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		uint32_t mFlags = RENDER_TARGET_NONE;
+
+		bool operator==(const RenderTargetKey&) const = default;
+	};
+
+	struct RenderTargetPoolDesc
+	{
+		/// Allocation sizes are rounded up to a multiple of this.
+		uint32_t mGranularity = 128;
+		/// How many buckets bigger than needed an allocation may stay
+		/// before shrinking it is worth a reallocation.
+		uint32_t mSlackBuckets = 1;
+		/// Frames a new size has to hold before the targets are
+		/// reallocated for it, so dragging a splitter doesn't allocate
+		/// every frame.
+		uint32_t mStableFrames = 8;
+		/// Free targets not asked for in this many frames are destroyed.
+		uint32_t mMaxIdleFrames = 120;
+	};
+
+	/// size rounded up to the next multiple of granularity, at least one
+	/// bucket.
+	uint32_t BucketDimension(uint32_t size, uint32_t granularity);
+
+	RenderTargetKey MakeRenderTargetKey(uint32_t format, uint32_t width, uint32_t height,
+										uint32_t flags, const RenderTargetPoolDesc& desc);
+
+	/// True if an allocation of allocWidth x allocHeight covers width x
+	/// height without more than mSlackBuckets of waste on either side.
+	bool FitsAllocation(uint32_t allocWidth, uint32_t allocHeight, uint32_t width,
+						uint32_t height, const RenderTargetPoolDesc& desc);
+
+	struct ResizeDecision
+	{
+		enum class Action : uint8_t
+		{
+			/// Same size as last frame.
+			None,
+			/// Render at a new size inside the targets already allocated.
+			Resize,
+			/// Allocate targets of mTargetWidth x mTargetHeight.
+			Reallocate,
+		};
+
+		Action mAction = Action::None;
+		/// The size to render at.
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		/// The size of the targets.
+		uint32_t mTargetWidth = 0;
+		uint32_t mTargetHeight = 0;
+	};
+
+	/// Turns the viewport size asked for every frame into when to render
+	/// at a new size and when to reallocate. Anything the current targets
+	/// cover is applied straight away by rendering into part of them, a
+	/// size they don't cover (or cover with too much to spare) has to
+	/// stay put for mStableFrames before the targets change. Until then a
+	/// bigger viewport keeps the old size and gets scaled up on screen.
+	class ResizeCoalescer
+	{
+	public:
+		explicit ResizeCoalescer(const RenderTargetPoolDesc& desc = {});
+
+		ResizeDecision Update(uint32_t width, uint32_t height);
+
+		uint32_t GetWidth() const { return mWidth; }
+		uint32_t GetHeight() const { return mHeight; }
+		uint32_t GetTargetWidth() const { return mTargetWidth; }
+		uint32_t GetTargetHeight() const { return mTargetHeight; }
+		uint32_t GetReallocations() const { return mReallocations; }
+
+	private:
+		RenderTargetPoolDesc mDesc;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		uint32_t mTargetWidth = 0;
+		uint32_t mTargetHeight = 0;
+		/// The size waiting to prove itself, and for how long.
+		uint32_t mPendingWidth = 0;
+		uint32_t mPendingHeight = 0;
+		uint32_t mPendingFrames = 0;
+		uint32_t mReallocations = 0;
+	};
+
+	struct RenderTargetPoolStats
+	{
+		uint32_t mCreated = 0;
+		uint64_t mReused = 0;
+		uint32_t mDestroyed = 0;
+		/// Released targets, waiting on their fence or for someone to ask.
+		uint32_t mFree = 0;
+	};
+
+	/// Render targets kept by key once nobody needs them, so a viewport
+	/// going back to a size it had, or a pass asking for the same kind of
+	/// target, gets one without allocating. Works like the RingAllocator:
+	/// targets released during a frame get its fence in EndFrame and can't
+	/// be handed out again until Retire sees that fence complete, so
+	/// nothing is destroyed or rewritten under the GPU. Targets unused for
+	/// mMaxIdleFrames are dropped.
+	/// T is a shared_ptr to a ColorBuffer or DepthBuffer in the Renderer,
+	/// anything in the tests. Not thread safe.
+	template <typename T>
+	class RenderTargetPool
+	{
+	public:
+		using Factory = std::function<T(const RenderTargetKey& key)>;
+
+		explicit RenderTargetPool(Factory factory, const RenderTargetPoolDesc& desc = {})
+		: mFactory(std::move(factory))
+		, mDesc(desc)
+		{
+		}
+
+		RenderTargetPool(const RenderTargetPool&) = delete;
+		RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+		T Acquire(const RenderTargetKey& key)
+		{
+			for (size_t i = 0; i < mFree.size(); ++i)
+			{
+				Entry& entry = mFree[i];
+				if (entry.mKey == key && entry.mFence <= mCompletedFence)
+				{
+					T target = std::move(entry.mTarget);
+					entry = std::move(mFree.back());
+					mFree.pop_back();
+					mStats.mReused++;
+					UpdateFreeCount();
+					return target;
+				}
+			}
+
+			mStats.mCreated++;
+			return mFactory(key);
+		}
+
+		/// The GPU may still be using target until the fence EndFrame gets.
+		void Release(const RenderTargetKey& key, T target)
+		{
+			mReleased.push_back({key, 0, mFrame, std::move(target)});
+			UpdateFreeCount();
+		}
+
+		void EndFrame(uint64_t fence)
+		{
+			for (Entry& entry : mReleased)
+			{
+				entry.mFence = fence;
+				mFree.push_back(std::move(entry));
+			}
+			mReleased.clear();
+			mFrame++;
+		}
+
+		/// Makes targets released at or below completedFence available and
+		/// destroys the ones idle for too long.
+		void Retire(uint64_t completedFence)
+		{
+			if (completedFence > mCompletedFence)
+			{
+				mCompletedFence = completedFence;
+			}
+
+			for (size_t i = 0; i < mFree.size();)
+			{
+				Entry& entry = mFree[i];
+				if (entry.mFence <= mCompletedFence &&
+					mFrame - entry.mReleasedFrame > mDesc.mMaxIdleFrames)
+				{
+					entry = std::move(mFree.back());
+					mFree.pop_back();
+					mStats.mDestroyed++;
+					continue;
+				}
+				++i;
+			}
+			UpdateFreeCount();
+		}
+
+		const RenderTargetPoolDesc& GetDesc() const { return mDesc; }
+		const RenderTargetPoolStats& GetStats() const { return mStats; }
+
+	private:
+		struct Entry
+		{
+			RenderTargetKey mKey;
+			uint64_t mFence;
+			uint64_t mReleasedFrame;
+			T mTarget;
+		};
+
+		void UpdateFreeCount()
+		{
+			mStats.mFree = static_cast<uint32_t>(mFree.size() + mReleased.size());
+		}
+
+		Factory mFactory;
+		RenderTargetPoolDesc mDesc;
+		std::vector<Entry> mFree;
+		/// Released this frame, they get their fence in EndFrame.
+		std::vector<Entry> mReleased;
+		uint64_t mCompletedFence = 0;
+		uint64_t mFrame = 0;
+		RenderTargetPoolStats mStats;
+	};
+} // namespace Graphics
@@ -0,0 +1,215 @@
+#include "ResidencyManager.h"
+#include <algorithm>
+
+namespace Graphics
+{
+	ResidencyManager::ResidencyManager(ResidencyBackend backend, const ResidencyDesc& desc)
+	: mBackend(std::move(backend))
+	, mDesc(desc)
+	{
+	}
+
+	void ResidencyManager::Track(void* object, uint64_t size)
+	{
+		if (mEntries.contains(object))
+		{
+			return;
+		}
+
+		mLru.push_front(object);
+		Entry& entry = mEntries[object];
+		entry.mSize = size;
+		entry.mLruPosition = mLru.begin();
+		entry.mLastUsedFrame = mFrame;
+		// Whatever created it (an upload) goes out with this frame.
+		mUsed.push_back(object);
+		mStats.mUsedThisFrame = static_cast<uint32_t>(mUsed.size());
+
+		mStats.mTracked++;
+		mStats.mResident++;
+		mStats.mTrackedBytes += size;
+		mStats.mResidentBytes += size;
+	}
+
+	void ResidencyManager::Untrack(void* object)
+	{
+		auto it = mEntries.find(object);
+		if (it == mEntries.end())
+		{
+			return;
+		}
+
+		Entry& entry = it->second;
+		mStats.mTracked--;
+		mStats.mTrackedBytes -= entry.mSize;
+		if (entry.mResident)
+		{
+			mStats.mResident--;
+			mStats.mResidentBytes -= entry.mSize;
+		}
+		mLru.erase(entry.mLruPosition);
+		mEntries.erase(it);
+
+		// The address can come back for a new object, don't page it in or
+		// stamp it on its behalf.
+		std::erase(mPageIn, object);
+		std::erase(mUsed, object);
+		mStats.mUsedThisFrame = static_cast<uint32_t>(mUsed.size());
+	}
+
+	void ResidencyManager::MarkUsed(void* object)
+	{
+		auto it = mEntries.find(object);
+		if (it == mEntries.end() || it->second.mLastUsedFrame == mFrame)
+		{
+			return;
+		}
+		Touch(object, it->second);
+	}
+
+	void ResidencyManager::Touch(void* object, Entry& entry)
+	{
+		entry.mLastUsedFrame = mFrame;
+		mLru.splice(mLru.begin(), mLru, entry.mLruPosition);
+		mUsed.push_back(object);
+		mStats.mUsedThisFrame = static_cast<uint32_t>(mUsed.size());
+		if (!entry.mResident)
+		{
+			mPageIn.push_back(object);
+		}
+	}
+
+	bool ResidencyManager::Commit()
+	{
+		uint64_t budget = GetBudget();
+		uint64_t incoming = 0;
+		for (void* object : mPageIn)
+		{
+			incoming += mEntries[object].mSize;
+		}
+
+		// Least recently used first. The list is in use order, so the first
+		// one that's too recent (or still on the GPU) ends the search.
+		std::vector<void*> evict;
+		uint64_t resident = mStats.mResidentBytes + incoming;
+		for (auto it = mLru.rbegin(); it != mLru.rend() && resident > budget; ++it)
+		{
+			Entry& entry = mEntries[*it];
+			if (mFrame - entry.mLastUsedFrame <= mDesc.mMinIdleFrames ||
+				entry.mFence > mCompletedFence)
+			{
+				break;
+			}
+			if (!entry.mResident)
+			{
+				continue;
+			}
+
+			evict.push_back(*it);
+			entry.mResident = false;
+			resident -= entry.mSize;
+			mStats.mResident--;
+			mStats.mResidentBytes -= entry.mSize;
+			mStats.mEvictions++;
+			mStats.mEvictedBytes += entry.mSize;
+		}
+		if (!evict.empty())
+		{
+			mBackend.mEvict(evict);
+		}
+
+		bool paged = true;
+		if (!mPageIn.empty())
+		{
+			paged = mBackend.mMakeResident(mPageIn);
+			if (paged)
+			{
+				for (void* object : mPageIn)
+				{
+					Entry& entry = mEntries[object];
+					entry.mResident = true;
+					mStats.mResident++;
+					mStats.mResidentBytes += entry.mSize;
+					mStats.mPageIns++;
+					mStats.mPagedInBytes += entry.mSize;
+				}
+			}
+			else
+			{
+				mStats.mFailedPageIns += static_cast<uint32_t>(mPageIn.size());
+			}
+			mPageIn.clear();
+		}
+
+		if (mStats.mResidentBytes > budget)
+		{
+			mStats.mOverBudgetFrames++;
+		}
+		return paged;
+	}
+
+	void ResidencyManager::EndFrame(uint64_t fence)
+	{
+		for (void* object : mUsed)
+		{
+			mEntries[object].mFence = fence;
+		}
+		mStats.mUsedThisFrame = 0;
+		mUsed.clear();
+		mFrame++;
+	}
+
+	void ResidencyManager::Retire(uint64_t completedFence)
+	{
+		mCompletedFence = std::max(mCompletedFence, completedFence);
+	}
+
+	bool ResidencyManager::IsResident(void* object) const
+	{
+		auto it = mEntries.find(object);
+		return it != mEntries.end() && it->second.mResident;
+	}
+
+	bool ResidencyManager::IsSafeToUse(void* object) const
+	{
+		auto it = mEntries.find(object);
+		return it == mEntries.end() || it->second.mResident;
+	}
+
+	uint64_t ResidencyManager::GetBudget() const
+	{
+		if (mDesc.mBudgetOverride != 0)
+		{
+			mStats.mBudget = mDesc.mBudgetOverride;
+		}
+		else
+		{
+			mStats.mBudget = static_cast<uint64_t>(static_cast<double>(mBackend.mGetBudget()) *
+												   mDesc.mBudgetFraction);
+		}
+		return mStats.mBudget;
+	}
+
+	ResidencyBackend SimulatedResidency::GetBackend()
+	{
+		ResidencyBackend backend;
+		backend.mGetBudget = [this]() { return mBudget; };
+		backend.mMakeResident = [this](const std::vector<void*>& objects) {
+			mMakeResidentCalls++;
+			if (mFailMakeResident)
+			{
+				return false;
+			}
+			for (void* object : objects)
+			{
+				mEvicted.erase(object);
+			}
+			return true;
+		};
+		backend.mEvict = [this](const std::vector<void*>& objects) {
+			mEvictCalls++;
+			mEvicted.insert(objects.begin(), objects.end());
+		};
+		return backend;
+	}
+} // namespace Graphics
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Graphics
+{
+	/// What the ResidencyManager pages through. Objects are ID3D12Pageable
+	/// pointers on D3D, anything unique in the tests.
+	struct ResidencyBackend
+	{
+		/// Bytes the process may keep in video memory right now, DXGI's
+		/// budget on D3D. It moves when other applications want memory.
+		std::function<uint64_t()> mGetBudget;
+		/// False if they couldn't be made resident.
+		std::function<bool(const std::vector<void*>& objects)> mMakeResident;
+		std::function<void(const std::vector<void*>& objects)> mEvict;
+	};
+
+	struct ResidencyDesc
+	{
+		/// Share of the backend's budget the tracked resources may take,
+		/// the rest is headroom for render targets and buffers that aren't
+		/// tracked.
+		float mBudgetFraction = 0.8F;
+		/// A fixed budget instead of asking the backend, 0 for none.
+		uint64_t mBudgetOverride = 0;
+		/// Resources used this many frames ago or less are never evicted,
+		/// so a camera turning back and forth doesn't page every frame.
+		uint32_t mMinIdleFrames = 3;
+	};
+
+	struct ResidencyStats
+	{
+		uint32_t mTracked = 0;
+		uint32_t mResident = 0;
+		uint64_t mTrackedBytes = 0;
+		uint64_t mResidentBytes = 0;
+		uint64_t mBudget = 0;
+		/// Distinct resources marked used in the current frame.
+		uint32_t mUsedThisFrame = 0;
+		uint64_t mEvictions = 0;
+		uint64_t mEvictedBytes = 0;
+		uint64_t mPageIns = 0;
+		uint64_t mPagedInBytes = 0;
+		uint32_t mFailedPageIns = 0;
+		/// Commits that couldn't get under the budget because everything
+		/// resident was in use or still on the GPU.
+		uint64_t mOverBudgetFrames = 0;
+	};
+
+	/// Keeps the tracked resources under a video memory budget. Every
+	/// frame marks what it draws with, Commit (before the frame is
+	/// submitted) pages those back in if they were evicted and evicts the
+	/// least recently used ones that are over the budget. A resource is
+	/// only evicted once the fence of the last frame that used it has
+	/// completed and it's been idle for mMinIdleFrames, so the GPU never
+	/// sees an evicted resource. Tracked resources start resident and
+	/// count as used in the frame they're tracked in.
+	/// Not thread safe.
+	class ResidencyManager
+	{
+	public:
+		explicit ResidencyManager(ResidencyBackend backend, const ResidencyDesc& desc = {});
+
+		ResidencyManager(const ResidencyManager&) = delete;
+		ResidencyManager& operator=(const ResidencyManager&) = delete;
+
+		void Track(void* object, uint64_t size);
+		/// Before the object is destroyed.
+		void Untrack(void* object);
+
+		/// This frame's command lists use object.
+		void MarkUsed(void* object);
+
+		/// Pages in what this frame uses and evicts down to the budget.
+		/// False if something used couldn't be made resident.
+		bool Commit();
+
+		/// Everything used since the last EndFrame is in use until fence.
+		void EndFrame(uint64_t fence);
+		void Retire(uint64_t completedFence);
+
+		bool IsTracked(void* object) const { return mEntries.contains(object); }
+		bool IsResident(void* object) const;
+		/// False only for a tracked object that's evicted, what a frame has
+		/// to leave out when Commit couldn't page it back in. Untracked
+		/// objects are never paged, they're always fine.
+		bool IsSafeToUse(void* object) const;
+
+		/// What the tracked resources may take.
+		uint64_t GetBudget() const;
+		const ResidencyStats& GetStats() const { return mStats; }
+
+	private:
+		struct Entry
+		{
+			uint64_t mSize = 0;
+			uint64_t mLastUsedFrame = 0;
+			/// Fence of the last frame that used it.
+			uint64_t mFence = 0;
+			bool mResident = true;
+			/// Its place in mLru.
+			std::list<void*>::iterator mLruPosition;
+		};
+
+		void Touch(void* object, Entry& entry);
+
+		ResidencyBackend mBackend;
+		ResidencyDesc mDesc;
+		std::unordered_map<void*, Entry> mEntries;
+		/// Most recently used at the front.
+		std::list<void*> mLru;
+		/// Marked used this frame, they get the fence in EndFrame.
+		std::vector<void*> mUsed;
+		/// Used this frame but evicted, Commit pages them in.
+		std::vector<void*> mPageIn;
+		uint64_t mFrame = 1;
+		uint64_t mCompletedFence = 0;
+		mutable ResidencyStats mStats;
+	};
+
+	/// A video memory segment for the tests and benchmarks. Keeps track of
+	/// what's evicted, fails paging in when asked to, and lets the budget
+	/// change underneath the manager the way DXGI's does.
+	class SimulatedResidency
+	{
+	public:
+		explicit SimulatedResidency(uint64_t budget)
+		: mBudget(budget)
+		{
+		}
+
+		ResidencyBackend GetBackend();
+
+		void SetBudget(uint64_t budget) { mBudget = budget; }
+		bool IsEvicted(void* object) const { return mEvicted.contains(object); }
+
+		/// MakeResident fails while set.
+		bool mFailMakeResident = false;
+		uint64_t mMakeResidentCalls = 0;
+		uint64_t mEvictCalls = 0;
+
+	private:
+		uint64_t mBudget;
+		std::unordered_set<void*> mEvicted;
+	};
+} // namespace Graphics
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Graphics
+{
+	/// 32-bit reference to something in a ResourceRegistry<T>: a slot index
+	/// and the slot's generation. Copying one is free, no refcount, and a
+	/// handle to something that has been removed just resolves to null.
+	/// The default handle is null.
+	template <typename T>
+	class Handle
+	{
+	public:
+		static constexpr uint32_t INDEX_BITS = 20;
+		static constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+		static constexpr uint32_t MAX_INDEX = (1U << INDEX_BITS) - 1;
+		static constexpr uint32_t MAX_GENERATION = (1U << GENERATION_BITS) - 1;
+
+		Handle() = default;
+
+		/// Generation 0 is never handed out, that's what makes 0 null.
+		Handle(uint32_t index, uint32_t generation)
+		: mValue((generation << INDEX_BITS) | index)
+		{
+			assert(index <= MAX_INDEX && generation <= MAX_GENERATION);
+		}
+
+		/// Back from GetValue, for code that keys things by handle.
+		static Handle FromValue(uint32_t value)
+		{
+			Handle handle;
+			handle.mValue = value;
+			return handle;
+		}
+
+		uint32_t GetIndex() const { return mValue & MAX_INDEX; }
+		uint32_t GetGeneration() const { return mValue >> INDEX_BITS; }
+		uint32_t GetValue() const { return mValue; }
+
+		/// Not null, it can still be stale.
+		explicit operator bool() const { return mValue != 0; }
+		bool operator==(const Handle&) const = default;
+
+	private:
+		uint32_t mValue = 0;
+	};
+
+	/// Owns the Meshes or Textures the scene refers to by Handle. The
+	/// registry holds the only reference that matters, so refcounts only
+	/// move when something is added or removed and the draw loop just
+	/// indexes an array.
+	///
+	/// Remove makes the handle stale at once but keeps the object alive
+	/// until the GPU is past the fence it was last used with, same as the
+	/// other EndFrame/Retire users. Main thread only.
+	template <typename T>
+	class ResourceRegistry
+	{
+	public:
+		ResourceRegistry() = default;
+
+		ResourceRegistry(const ResourceRegistry&) = delete;
+		ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+		/// Adding something that's already in here gives back its handle.
+		Handle<T> Add(std::shared_ptr<T> object)
+		{
+			if (!object)
+			{
+				return {};
+			}
+
+			auto it = mIndexByObject.find(object.get());
+			if (it != mIndexByObject.end())
+			{
+				return {it->second, mSlots[it->second].mGeneration};
+			}
+
+			Handle<T> handle = Reserve();
+			Set(handle, std::move(object));
+			return handle;
+		}
+
+		/// A handle for something that doesn't exist yet, it resolves to
+		/// null until Set fills it in. Lets a material refer to a texture
+		/// that is still loading.
+		Handle<T> Reserve()
+		{
+			uint32_t index = 0;
+			if (!mFreeSlots.empty())
+			{
+				index = mFreeSlots.back();
+				mFreeSlots.pop_back();
+			}
+			else
+			{
+				assert(mSlots.size() <= Handle<T>::MAX_INDEX && "registry is full");
+				index = static_cast<uint32_t>(mSlots.size());
+				mSlots.emplace_back();
+			}
+
+			mCount++;
+			return {index, mSlots[index].mGeneration};
+		}
+
+		/// Fills in a reserved handle. The object may already be behind
+		/// another handle, both resolve to it then and Add/Find keep
+		/// giving back the first.
+		void Set(Handle<T> handle, std::shared_ptr<T> object)
+		{
+			if (!IsLive(handle) || mSlots[handle.GetIndex()].mObject || !object)
+			{
+				return;
+			}
+
+			Slot& slot = mSlots[handle.GetIndex()];
+			slot.mObject = std::move(object);
+			mIndexByObject.emplace(slot.mObject.get(), handle.GetIndex());
+		}
+
+		/// fence is the last one that might still use the object.
+		void Remove(Handle<T> handle, uint64_t fence)
+		{
+			if (!IsLive(handle))
+			{
+				return;
+			}
+
+			Slot& slot = mSlots[handle.GetIndex()];
+			auto it = mIndexByObject.find(slot.mObject.get());
+			if (it != mIndexByObject.end() && it->second == handle.GetIndex())
+			{
+				mIndexByObject.erase(it);
+			}
+			if (slot.mObject)
+			{
+				mPendingRelease.push_back({fence, std::move(slot.mObject)});
+			}
+
+			// Old handles stop resolving. After MAX_GENERATION reuses of
+			// one slot a very old handle could alias again, which is far
+			// beyond how long anything keeps a handle around.
+			slot.mGeneration =
+				slot.mGeneration == Handle<T>::MAX_GENERATION ? 1 : slot.mGeneration + 1;
+			mFreeSlots.push_back(handle.GetIndex());
+			mCount--;
+		}
+
+		/// Drops the removed objects the GPU is done with.
+		void Retire(uint64_t completedFence)
+		{
+			std::erase_if(mPendingRelease, [completedFence](const PendingRelease& pending) {
+				return pending.mFence <= completedFence;
+			});
+		}
+
+		/// Null for null and stale handles, and reserved ones not Set yet.
+		T* Get(Handle<T> handle) const
+		{
+			return IsLive(handle) ? mSlots[handle.GetIndex()].mObject.get() : nullptr;
+		}
+
+		/// For code that has to hold on to the object past a Remove.
+		std::shared_ptr<T> GetShared(Handle<T> handle) const
+		{
+			return Get(handle) ? mSlots[handle.GetIndex()].mObject : nullptr;
+		}
+
+		Handle<T> Find(const T* object) const
+		{
+			auto it = mIndexByObject.find(object);
+			if (it == mIndexByObject.end())
+			{
+				return {};
+			}
+			return {it->second, mSlots[it->second].mGeneration};
+		}
+
+		uint32_t GetCount() const { return mCount; }
+		size_t GetPendingReleaseCount() const { return mPendingRelease.size(); }
+
+	private:
+		/// Not null or stale, whether or not it has been Set.
+		bool IsLive(Handle<T> handle) const
+		{
+			uint32_t index = handle.GetIndex();
+			return handle && index < mSlots.size() &&
+				   mSlots[index].mGeneration == handle.GetGeneration();
+		}
+
+		struct Slot
+		{
+			std::shared_ptr<T> mObject;
+			uint32_t mGeneration = 1;
+		};
+
+		struct PendingRelease
+		{
+			uint64_t mFence;
+			std::shared_ptr<T> mObject;
+		};
+
+		std::vector<Slot> mSlots;
+		std::vector<uint32_t> mFreeSlots;
+		std::unordered_map<const T*, uint32_t> mIndexByObject;
+		std::vector<PendingRelease> mPendingRelease;
+		uint32_t mCount = 0;
+	};
+} // namespace Graphics
@@ -0,0 +1,165 @@
+#include "RingAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Graphics
+{
+	namespace
+	{
+		uint64_t AlignUp(uint64_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+		}
+	} // namespace
+
+	RingAllocator::RingAllocator(PageFactory factory, const RingAllocatorDesc& desc)
+	: mFactory(std::move(factory))
+	, mDesc(desc)
+	{
+	}
+
+	RingAllocation RingAllocator::Allocate(size_t size, size_t alignment)
+	{
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment not a power of 2");
+
+		if (size + alignment > mDesc.mPageSize)
+		{
+			return AllocateLarge(size);
+		}
+
+		// Align the GPU address, that's what the CBV rules care about. Any
+		// page base works this way, not just 64 KB aligned ones.
+		size_t padding = 0;
+		if (mHasCurrentPage)
+		{
+			uint64_t address = mCurrentPage.mGpuAddress + mOffset;
+			padding = static_cast<size_t>(AlignUp(address, alignment) - address);
+		}
+
+		if (!mHasCurrentPage || mOffset + padding + size > mCurrentPage.mSize)
+		{
+			if (!NextPage())
+			{
+				mStats.mFailedAllocations++;
+				return {};
+			}
+			uint64_t address = mCurrentPage.mGpuAddress;
+			padding = static_cast<size_t>(AlignUp(address, alignment) - address);
+		}
+
+		RingAllocation allocation;
+		allocation.mCpuAddress = mCurrentPage.mCpuAddress + mOffset + padding;
+		allocation.mGpuAddress = mCurrentPage.mGpuAddress + mOffset + padding;
+		allocation.mSize = size;
+
+		mOffset += padding + size;
+		mStats.mFrameBytes += padding + size;
+		mStats.mPeakFrameBytes = std::max(mStats.mPeakFrameBytes, mStats.mFrameBytes);
+		return allocation;
+	}
+
+	RingAllocation RingAllocator::AllocateLarge(size_t size)
+	{
+		if (mDesc.mMaxPages != 0 && mStats.mPageCount >= mDesc.mMaxPages)
+		{
+			mStats.mFailedAllocations++;
+			return {};
+		}
+
+		// Room to align inside the page whatever its base turns out to be.
+		const size_t alignment = 256;
+		RingPage page;
+		if (!mFactory(size + alignment, page))
+		{
+			mStats.mFailedAllocations++;
+			return {};
+		}
+		mStats.mPageCount++;
+		mStats.mPagesCreated++;
+		mStats.mLargePages++;
+
+		size_t padding = static_cast<size_t>(AlignUp(page.mGpuAddress, alignment) -
+											 page.mGpuAddress);
+
+		RingAllocation allocation;
+		allocation.mCpuAddress = page.mCpuAddress + padding;
+		allocation.mGpuAddress = page.mGpuAddress + padding;
+		allocation.mSize = size;
+
+		mStats.mFrameBytes += size;
+		mStats.mPeakFrameBytes = std::max(mStats.mPeakFrameBytes, mStats.mFrameBytes);
+
+		mFramePages.emplace_back(std::move(page), true);
+		return allocation;
+	}
+
+	bool RingAllocator::NextPage()
+	{
+		// The full page is done, it goes back into the pool with the fence
+		// of this frame. Even if no next page can be had, otherwise a
+		// capped allocator would hold on to it forever.
+		if (mHasCurrentPage)
+		{
+			mFramePages.emplace_back(std::move(mCurrentPage), false);
+			mCurrentPage = {};
+			mHasCurrentPage = false;
+		}
+
+		RingPage page;
+		if (!mFreePages.empty())
+		{
+			page = std::move(mFreePages.back());
+			mFreePages.pop_back();
+		}
+		else
+		{
+			if (mDesc.mMaxPages != 0 && mStats.mPageCount >= mDesc.mMaxPages)
+			{
+				return false;
+			}
+			if (!mFactory(mDesc.mPageSize, page))
+			{
+				return false;
+			}
+			mStats.mPageCount++;
+			mStats.mPagesCreated++;
+		}
+
+		mCurrentPage = std::move(page);
+		mHasCurrentPage = true;
+		mOffset = 0;
+		mStats.mFreePages = static_cast<uint32_t>(mFreePages.size());
+		return true;
+	}
+
+	void RingAllocator::EndFrame(uint64_t fence)
+	{
+		for (auto& [page, isLarge] : mFramePages)
+		{
+			mRetiredPages.push_back({fence, std::move(page), isLarge});
+		}
+		mFramePages.clear();
+		mStats.mFrameBytes = 0;
+	}
+
+	void RingAllocator::Retire(uint64_t completedFence)
+	{
+		size_t retiredCount = 0;
+		while (retiredCount < mRetiredPages.size() &&
+			   mRetiredPages[retiredCount].mFence <= completedFence)
+		{
+			RetiredPage& retired = mRetiredPages[retiredCount++];
+			if (retired.mIsLarge)
+			{
+				// One off, dropping the last reference releases it.
+				mStats.mPageCount--;
+			}
+			else
+			{
+				mFreePages.push_back(std::move(retired.mPage));
+			}
+		}
+		mRetiredPages.erase(mRetiredPages.begin(), mRetiredPages.begin() + retiredCount);
+		mStats.mFreePages = static_cast<uint32_t>(mFreePages.size());
+	}
+} // namespace Graphics
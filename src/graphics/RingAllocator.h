@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Graphics
+{
+	/// A block of CPU writable, GPU readable memory handed to the
+	/// RingAllocator. mResource keeps whatever owns it alive (an
+	/// UploadBuffer in the Renderer, a plain vector in the tests).
+	struct RingPage
+	{
+		uint8_t* mCpuAddress = nullptr;
+		uint64_t mGpuAddress = 0;
+		size_t mSize = 0;
+		std::shared_ptr<void> mResource;
+	};
+
+	struct RingAllocation
+	{
+		uint8_t* mCpuAddress = nullptr;
+		uint64_t mGpuAddress = 0;
+		size_t mSize = 0;
+
+		bool IsValid() const { return mCpuAddress != nullptr; }
+	};
+
+	struct RingAllocatorDesc
+	{
+		size_t mPageSize = 64 * 1024;
+		/// Pages the allocator may own at once, 0 for no limit. With 1 it
+		/// never chains a second page and behaves like a fixed buffer that
+		/// fails Allocate instead of overwriting what the GPU still reads.
+		uint32_t mMaxPages = 0;
+	};
+
+	struct RingAllocatorStats
+	{
+		uint32_t mPageCount = 0;
+		uint32_t mFreePages = 0;
+		uint32_t mPagesCreated = 0;
+		uint32_t mLargePages = 0;
+		uint32_t mFailedAllocations = 0;
+		size_t mFrameBytes = 0;
+		size_t mPeakFrameBytes = 0;
+	};
+
+	/// Hands out per-frame scratch memory (constants mostly) by bumping a
+	/// pointer through pages. The current page carries on across frames,
+	/// once it fills up it's tagged with the fence of the frame that
+	/// filled it and comes back around for reuse after Retire sees that
+	/// fence complete. So the pages cycle like a ring and the pool only
+	/// grows when more data is in flight. Allocations bigger than a page
+	/// get a page of their own that is released instead of pooled.
+	/// Not thread safe.
+	class RingAllocator
+	{
+	public:
+		/// Creates a page of the given size, false if it couldn't.
+		using PageFactory = std::function<bool(size_t size, RingPage& page)>;
+
+		explicit RingAllocator(PageFactory factory, const RingAllocatorDesc& desc = {});
+
+		RingAllocator(const RingAllocator&) = delete;
+		RingAllocator& operator=(const RingAllocator&) = delete;
+
+		/// alignment has to be a power of two. Returns an invalid
+		/// allocation when no page could be had.
+		RingAllocation Allocate(size_t size, size_t alignment = 256);
+
+		/// Allocate and copy data in.
+		template <typename T>
+		RingAllocation Push(const T& data, size_t alignment = 256)
+		{
+			RingAllocation allocation = Allocate(sizeof(T), alignment);
+			if (allocation.IsValid())
+			{
+				std::memcpy(allocation.mCpuAddress, &data, sizeof(T));
+			}
+			return allocation;
+		}
+
+		/// Everything allocated since the last EndFrame stays untouched
+		/// until fence has completed.
+		void EndFrame(uint64_t fence);
+
+		/// Recycles the pages of every frame at or below completedFence.
+		void Retire(uint64_t completedFence);
+
+		const RingAllocatorStats& GetStats() const { return mStats; }
+
+	private:
+		struct RetiredPage
+		{
+			uint64_t mFence;
+			RingPage mPage;
+			bool mIsLarge;
+		};
+
+		/// Makes a new current page, from the free list if possible.
+		bool NextPage();
+		RingAllocation AllocateLarge(size_t size);
+
+		PageFactory mFactory;
+		RingAllocatorDesc mDesc;
+
+		RingPage mCurrentPage;
+		bool mHasCurrentPage = false;
+		size_t mOffset = 0;
+
+		/// Pages finished this frame (full ones and large ones), they get
+		/// their fence in EndFrame.
+		std::vector<std::pair<RingPage, bool>> mFramePages;
+		/// Oldest first. A vector rather than a deque, it keeps its
+		/// capacity so steady frames don't allocate.
+		std::vector<RetiredPage> mRetiredPages;
+		std::vector<RingPage> mFreePages;
+
+		RingAllocatorStats mStats;
+	};
+} // namespace Graphics
@@ -1,5 +1,4 @@
 #include "ShaderCache.h"
-#include <functional>
 
 namespace Graphics
 {
@@ -26,10 +25,10 @@ namespace Graphics
 		mCache[key] = shader;
 	}
 
-	uint64_t ShaderCache::ComputeMRTKey(const std::string& shaderName, const DXGI_FORMAT* rtFormats,
+	uint64_t ShaderCache::ComputeMRTKey(Utils::StringId shaderName, const DXGI_FORMAT* rtFormats,
 										uint32_t numRenderTargets, DXGI_FORMAT depthFormat)
 	{
-		uint64_t hash = std::hash<std::string>{}(shaderName);
+		uint64_t hash = shaderName.GetHash();
 
 		hash ^= (static_cast<uint64_t>(numRenderTargets) << 32);
 
@@ -44,10 +43,10 @@ namespace Graphics
 		return hash;
 	}
 
-	uint64_t ShaderCache::ComputeKey(const std::string& shaderName, DXGI_FORMAT rtFormat,
+	uint64_t ShaderCache::ComputeKey(Utils::StringId shaderName, DXGI_FORMAT rtFormat,
 									 DXGI_FORMAT depthFormat)
 	{
-		uint64_t hash = std::hash<std::string>{}(shaderName);
+		uint64_t hash = shaderName.GetHash();
 
 		hash ^= (static_cast<uint64_t>(rtFormat) << 32);
 
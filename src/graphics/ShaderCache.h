@@ -2,7 +2,7 @@
 
 #include <d3d12.h>
 #include <wrl/client.h>
-#include <string>
+#include "../utils/StringId.h"
 #include <unordered_map>
 #include <cstdint>
 
@@ -26,13 +26,14 @@ namespace Graphics
 		void Store(uint64_t key, ID3D12RootSignature* rootSig, ID3D12PipelineState* pso);
 
 		/// Build hash key for MRT shaders based on the name,format, targets etc.
+		/// Starts from the name's precomputed hash.
 		/// It will generate a uint64_t from it and will use that as the key.
-		static uint64_t ComputeMRTKey(const std::string& shaderName, const DXGI_FORMAT* rtFormats,
+		static uint64_t ComputeMRTKey(Utils::StringId shaderName, const DXGI_FORMAT* rtFormats,
 									  uint32_t numRenderTargets, DXGI_FORMAT depthFormat);
 
 		/// Build hash key for non MRT shaders based on the name,format, targets etc.
 		/// It will generate a uint64_t from it and will use that as the key.
-		static uint64_t ComputeKey(const std::string& shaderName, DXGI_FORMAT rtFormat,
+		static uint64_t ComputeKey(Utils::StringId shaderName, DXGI_FORMAT rtFormat,
 								   DXGI_FORMAT depthFormat);
 
 		void Clear();
@@ -3,18 +3,29 @@
 #include "CommandContext.h"
 #include "CommandListManager.h"
 #include "DescriptorHeap.h"
+#include "ResidencyManager.h"
+#include "texture/ImageDecoder.h"
+#include "texture/Ktx2Transcoder.h"
+#include "../utils/FileUtils.h"
+#include "../utils/ThreadPool.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include <DDSTextureLoader.h>
+#include <DirectXPackedVector.h>
+#include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <d3dx12/d3dx12.h>
+#include <mutex>
 #include <vector>
 
 std::shared_ptr<spdlog::logger> Texture::sLogger = nullptr;
 
 void Texture::InitLogger()
 {
-	if (!sLogger)
-	{
+	// Textures can be loaded from the worker threads, only set it up once.
+	static std::once_flag sLoggerFlag;
+	std::call_once(sLoggerFlag, []() {
 		sLogger = spdlog::get("Texture");
 		if (!sLogger)
 		{
@@ -22,7 +33,7 @@ void Texture::InitLogger()
 			sLogger->set_pattern("[%H:%M:%S] [%^%l%$] [%n] %v");
 			sLogger->set_level(spdlog::level::debug);
 		}
-	}
+	});
 }
 
 Texture::Texture()
@@ -43,22 +54,63 @@ Texture::~Texture()
 
 		mSrvAllocation.Reset();
 	}
+
+	if (mResidencyTracked && Graphics::gResidencyManager)
+	{
+		Graphics::gResidencyManager->Untrack(static_cast<ID3D12Pageable*>(mResource.Get()));
+	}
 }
 
-bool Texture::LoadFromFile(const std::wstring& filepath)
+bool Texture::LoadFromFile(const std::wstring& filepath, const TextureTools::MipDesc& mipDesc)
+{
+	InitLogger();
+
+	TextureSource source;
+	if (!ReadSource(filepath, source))
+	{
+		sLogger->error("Failed to read texture file: {}",
+					   std::string(filepath.begin(), filepath.end()));
+		return false;
+	}
+
+	return LoadFromSource(std::move(source), mipDesc);
+}
+
+bool Texture::ReadSource(const std::wstring& filepath, TextureSource& source)
+{
+	source.mPath = filepath;
+	return Utils::ReadBinaryFile(filepath, source.mData, source.mContentHash);
+}
+
+bool Texture::LoadFromSource(TextureSource&& source, const TextureTools::MipDesc& mipDesc)
 {
 	InitLogger();
 	using namespace DirectX;
 
-	sLogger->info("Loading texture from: {}", std::string(filepath.begin(), filepath.end()));
+	sLogger->info("Loading texture from: {}",
+				  std::string(source.mPath.begin(), source.mPath.end()));
+
+	if (TextureTools::GetImageFormat(source.mPath) != TextureTools::ImageFormat::Unknown)
+	{
+		return LoadFromImageData(source.mData, mipDesc);
+	}
+
+	if (TextureTools::IsKtx2File(source.mPath))
+	{
+		return LoadFromKtx2Data(source.mData);
+	}
 
-	// Deferred the texture upload until we need it.
+	// Deferred the texture upload until we need it. The subresources point
+	// into the file data so it has to live as long as they do.
 	mDeferredUploadData = std::make_unique<DeferredUploadData>();
+	mDeferredUploadData->sourceData = std::move(source.mData);
+	mDeferredUploadData->cpuCharge.Set(mDeferredUploadData->sourceData.size());
 	DDS_ALPHA_MODE alphaMode = DDS_ALPHA_MODE_UNKNOWN;
 
-	HRESULT hr = LoadDDSTextureFromFileEx(
-		Graphics::gDevice, filepath.c_str(), 0, D3D12_RESOURCE_FLAG_NONE, DDS_LOADER_DEFAULT,
-		&mResource, mDeferredUploadData->ddsData, mDeferredUploadData->subresources, &alphaMode);
+	HRESULT hr = LoadDDSTextureFromMemoryEx(
+		Graphics::gDevice, mDeferredUploadData->sourceData.data(),
+		mDeferredUploadData->sourceData.size(), 0, D3D12_RESOURCE_FLAG_NONE, DDS_LOADER_DEFAULT,
+		&mResource, mDeferredUploadData->subresources, &alphaMode);
 
 	if (FAILED(hr))
 	{
@@ -86,6 +138,249 @@ bool Texture::LoadFromFile(const std::wstring& filepath)
 	return true;
 }
 
+bool Texture::LoadFromImageData(const std::vector<uint8_t>& data,
+								const TextureTools::MipDesc& mipDesc)
+{
+	TextureTools::StagingPool& staging = TextureTools::StagingPool::GetDefault();
+
+	TextureTools::Image image;
+	std::string error;
+	if (!TextureTools::DecodeImage(data.data(), data.size(), image, &staging, &error))
+	{
+		sLogger->error("Failed to decode image: {}", error);
+		return false;
+	}
+
+	TextureTools::MipChain mips = TextureTools::GenerateMips(image, mipDesc);
+
+	// The mip chain has its own copy of the top level by now.
+	staging.Release(std::move(image.mPixels));
+
+	return LoadFromMipChain(mips);
+}
+
+bool Texture::LoadFromKtx2Data(const std::vector<uint8_t>& data)
+{
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point start = Clock::now();
+
+	TextureTools::TranscodedTexture transcoded;
+	std::string error;
+	if (!TextureTools::TranscodeKtx2(data.data(), data.size(), transcoded,
+									 Utils::ThreadPool::GetDefault(), &error))
+	{
+		sLogger->error("Failed to transcode KTX2 file: {}", error);
+		return false;
+	}
+	double transcodeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	mFormat = transcoded.mIsSRGB ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+	mWidth = transcoded.mWidth;
+	mHeight = transcoded.mHeight;
+	mMipLevels = static_cast<uint32_t>(transcoded.mLevels.size());
+
+	if (!CreateResource())
+	{
+		return false;
+	}
+
+	// The blocks were transcoded in their final layout, the upload data
+	// just takes over the buffer.
+	mDeferredUploadData = std::make_unique<DeferredUploadData>();
+	mDeferredUploadData->ddsData = std::move(transcoded.mData);
+	mDeferredUploadData->cpuCharge.Set(transcoded.mDataSize);
+	mDeferredUploadData->subresources.reserve(transcoded.mLevels.size());
+	for (const TextureTools::BlockLevel& level : transcoded.mLevels)
+	{
+		D3D12_SUBRESOURCE_DATA subresource = {};
+		subresource.pData = mDeferredUploadData->ddsData.get() + level.mOffset;
+		subresource.RowPitch = static_cast<LONG_PTR>(level.mRowPitch);
+		subresource.SlicePitch = static_cast<LONG_PTR>(level.mSlicePitch);
+		mDeferredUploadData->subresources.push_back(subresource);
+	}
+
+	sLogger->info("KTX2 {} {}x{}, {} mips: read {} KB, transcoded {} KB in {:.2f} ms",
+				  transcoded.mIsUASTC ? "UASTC" : "ETC1S", mWidth, mHeight, mMipLevels,
+				  data.size() / 1024, transcoded.mDataSize / 1024, transcodeMs);
+
+	mUsageState = D3D12_RESOURCE_STATE_COPY_DEST;
+	mGpuVirtualAddress = 0;
+	return true;
+}
+
+bool Texture::CreateResource(uint16_t arraySize)
+{
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+	CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(mFormat, mWidth, mHeight, arraySize,
+															  static_cast<UINT16>(mMipLevels));
+
+	HRESULT hr = Graphics::gDevice->CreateCommittedResource(
+		&heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+		IID_PPV_ARGS(&mResource));
+
+	if (FAILED(hr))
+	{
+		sLogger->error("Failed to create texture resource. HRESULT: 0x{:08X}",
+					   static_cast<unsigned int>(hr));
+		return false;
+	}
+	return true;
+}
+
+bool Texture::LoadFromMipChain(const TextureTools::MipChain& mips)
+{
+	InitLogger();
+
+	if (mips.mLevels.empty() || mips.mLevels[0].IsEmpty())
+	{
+		sLogger->error("Cannot create texture from an empty mip chain");
+		return false;
+	}
+
+	const TextureTools::Image& top = mips.mLevels[0];
+	mFormat = mips.mIsSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	mWidth = top.mWidth;
+	mHeight = top.mHeight;
+	mMipLevels = static_cast<uint32_t>(mips.mLevels.size());
+
+	if (!CreateResource())
+	{
+		return false;
+	}
+
+	// Same layout the DDS loader gives us, one contiguous block with a
+	// subresource per mip pointing into it.
+	size_t totalSize = 0;
+	for (const TextureTools::Image& level : mips.mLevels)
+	{
+		totalSize += level.GetSizeInBytes();
+	}
+
+	mDeferredUploadData = std::make_unique<DeferredUploadData>();
+	mDeferredUploadData->ddsData = std::make_unique<uint8_t[]>(totalSize);
+	mDeferredUploadData->cpuCharge.Set(totalSize);
+	mDeferredUploadData->subresources.reserve(mips.mLevels.size());
+
+	uint8_t* dst = mDeferredUploadData->ddsData.get();
+	for (const TextureTools::Image& level : mips.mLevels)
+	{
+		std::memcpy(dst, level.mPixels.data(), level.GetSizeInBytes());
+
+		D3D12_SUBRESOURCE_DATA subresource = {};
+		subresource.pData = dst;
+		subresource.RowPitch = static_cast<LONG_PTR>(level.GetRowPitch());
+		subresource.SlicePitch = static_cast<LONG_PTR>(level.GetSizeInBytes());
+		mDeferredUploadData->subresources.push_back(subresource);
+
+		dst += level.GetSizeInBytes();
+	}
+
+	sLogger->info("Created texture from mip chain: {}x{}, {} mips", mWidth, mHeight, mMipLevels);
+
+	mUsageState = D3D12_RESOURCE_STATE_COPY_DEST;
+	mGpuVirtualAddress = 0;
+	return true;
+}
+
+void Texture::AppendHalfSubresource(const float* src, uint32_t width, uint32_t height,
+									uint32_t channels, uint8_t*& dst)
+{
+	const size_t count = static_cast<size_t>(width) * height * channels;
+	DirectX::PackedVector::XMConvertFloatToHalfStream(
+		reinterpret_cast<DirectX::PackedVector::HALF*>(dst), sizeof(uint16_t), src, sizeof(float),
+		count);
+
+	D3D12_SUBRESOURCE_DATA subresource = {};
+	subresource.pData = dst;
+	subresource.RowPitch = static_cast<LONG_PTR>(width * channels * sizeof(uint16_t));
+	subresource.SlicePitch = static_cast<LONG_PTR>(count * sizeof(uint16_t));
+	mDeferredUploadData->subresources.push_back(subresource);
+
+	dst += count * sizeof(uint16_t);
+}
+
+bool Texture::LoadFromCubeMap(const TextureTools::CubeMap& cube)
+{
+	InitLogger();
+
+	if (cube.mLevels.empty() || cube.mSize == 0)
+	{
+		sLogger->error("Cannot create texture from an empty cube map");
+		return false;
+	}
+
+	mFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+	mWidth = cube.mSize;
+	mHeight = cube.mSize;
+	mMipLevels = static_cast<uint32_t>(cube.mLevels.size());
+	mIsCube = true;
+
+	if (!CreateResource(6))
+	{
+		return false;
+	}
+
+	size_t totalSize = 0;
+	for (const std::array<TextureTools::ImageF, 6>& faces : cube.mLevels)
+	{
+		totalSize += faces[0].mPixels.size() * 6 * sizeof(uint16_t);
+	}
+
+	mDeferredUploadData = std::make_unique<DeferredUploadData>();
+	mDeferredUploadData->ddsData = std::make_unique<uint8_t[]>(totalSize);
+	mDeferredUploadData->cpuCharge.Set(totalSize);
+	mDeferredUploadData->subresources.reserve(mMipLevels * 6);
+
+	// Subresources go mip first within each array slice (face).
+	uint8_t* dst = mDeferredUploadData->ddsData.get();
+	for (uint32_t face = 0; face < 6; ++face)
+	{
+		for (const std::array<TextureTools::ImageF, 6>& faces : cube.mLevels)
+		{
+			const TextureTools::ImageF& image = faces[face];
+			AppendHalfSubresource(image.mPixels.data(), image.mWidth, image.mHeight, 4, dst);
+		}
+	}
+
+	sLogger->info("Created cube texture: {}x{}, {} mips", mWidth, mHeight, mMipLevels);
+
+	mUsageState = D3D12_RESOURCE_STATE_COPY_DEST;
+	mGpuVirtualAddress = 0;
+	return true;
+}
+
+bool Texture::LoadFromBrdfLut(const TextureTools::BrdfLut& lut)
+{
+	InitLogger();
+
+	if (lut.mSize == 0 || lut.mData.size() != static_cast<size_t>(lut.mSize) * lut.mSize * 2)
+	{
+		sLogger->error("Cannot create texture from an empty BRDF LUT");
+		return false;
+	}
+
+	mFormat = DXGI_FORMAT_R16G16_FLOAT;
+	mWidth = lut.mSize;
+	mHeight = lut.mSize;
+	mMipLevels = 1;
+
+	if (!CreateResource())
+	{
+		return false;
+	}
+
+	mDeferredUploadData = std::make_unique<DeferredUploadData>();
+	mDeferredUploadData->ddsData = std::make_unique<uint8_t[]>(lut.mData.size() * sizeof(uint16_t));
+	mDeferredUploadData->cpuCharge.Set(lut.mData.size() * sizeof(uint16_t));
+
+	uint8_t* dst = mDeferredUploadData->ddsData.get();
+	AppendHalfSubresource(lut.mData.data(), lut.mSize, lut.mSize, 2, dst);
+
+	mUsageState = D3D12_RESOURCE_STATE_COPY_DEST;
+	mGpuVirtualAddress = 0;
+	return true;
+}
+
 void Texture::CreateSRV(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle)
 {
 	mSrvAllocation = Graphics::gBindlessAllocator->Allocate(1);
@@ -99,20 +394,42 @@ void Texture::CreateSRV(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle)
 
 	SetSRVHandles(handle.GetCpuHandle(), handle.GetGpuHandle());
 
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Format = mFormat;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = mMipLevels;
-	srvDesc.Texture2D.PlaneSlice = 0;
-	srvDesc.Texture2D.ResourceMinLODClamp = 0.0F;
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = GetSRVDesc();
 
 	// Deprecated, moving to Bindless
 	// Graphics::gDevice->CreateShaderResourceView(mResource.Get(), &srvDesc, cpuHandle);
 	Graphics::gDevice->CreateShaderResourceView(mResource.Get(), &srvDesc, handle.GetCpuHandle());
 }
 
+void Texture::WriteSRV(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle) const
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = GetSRVDesc();
+	Graphics::gDevice->CreateShaderResourceView(mResource.Get(), &srvDesc, cpuHandle);
+}
+
+D3D12_SHADER_RESOURCE_VIEW_DESC Texture::GetSRVDesc() const
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = mFormat;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	if (mIsCube)
+	{
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MostDetailedMip = 0;
+		srvDesc.TextureCube.MipLevels = mMipLevels;
+		srvDesc.TextureCube.ResourceMinLODClamp = 0.0F;
+	}
+	else
+	{
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = mMipLevels;
+		srvDesc.Texture2D.PlaneSlice = 0;
+		srvDesc.Texture2D.ResourceMinLODClamp = 0.0F;
+	}
+	return srvDesc;
+}
+
 void Texture::SetSRVHandles(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle,
 							D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle)
 {
@@ -127,33 +444,70 @@ bool Texture::UploadDeferredData(Graphics::GraphicsContext& context)
 		return true;
 	}
 
-	sLogger->debug("Uploading deferred texture data");
+	// Whatever an earlier sliced upload left over.
+	uint32_t first = mDeferredUploadData->uploadedSubresources;
+	return UploadDeferredData(context, first, GetDeferredSubresourceCount() - first);
+}
+
+bool Texture::UploadDeferredData(Graphics::GraphicsContext& context, uint32_t firstSubresource,
+								 uint32_t count)
+{
+	if (!mDeferredUploadData || count == 0)
+	{
+		return true;
+	}
+
+	DeferredUploadData& data = *mDeferredUploadData;
+	assert(firstSubresource + count <= data.subresources.size());
 
-	const UINT64 UPLOAD_BUFFER_SIZE = GetRequiredIntermediateSize(
-		mResource.Get(), 0, static_cast<UINT>(mDeferredUploadData->subresources.size()));
+	sLogger->debug("Uploading deferred texture data, subresources {}-{} of {}", firstSubresource,
+				   firstSubresource + count - 1, data.subresources.size());
+
+	const UINT64 UPLOAD_BUFFER_SIZE =
+		GetRequiredIntermediateSize(mResource.Get(), firstSubresource, count);
 
 	CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
 	CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(UPLOAD_BUFFER_SIZE);
 
 	//BUG use memory allocator
+	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
 	HRESULT hr = Graphics::gDevice->CreateCommittedResource(
 		&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadBufferDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-		IID_PPV_ARGS(&mDeferredUploadData->uploadBuffer));
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer));
 
 	if (FAILED(hr))
 	{
 		sLogger->error("Failed to create upload buffer");
 		return false;
 	}
+	data.stagingCharge.Set(data.stagingCharge.GetBytes() + UPLOAD_BUFFER_SIZE);
+
+	UpdateSubresources(context.GetCommandList(), mResource.Get(), uploadBuffer.Get(), 0,
+					   firstSubresource, count, data.subresources.data() + firstSubresource);
+	data.uploadBuffers.push_back(std::move(uploadBuffer));
+	data.uploadedSubresources = firstSubresource + count;
 
-	UpdateSubresources(context.GetCommandList(), mResource.Get(),
-					   mDeferredUploadData->uploadBuffer.Get(), 0, 0,
-					   static_cast<UINT>(mDeferredUploadData->subresources.size()),
-					   mDeferredUploadData->subresources.data());
+	// More slices to come, it stays a copy destination until the last.
+	if (data.uploadedSubresources < data.subresources.size())
+	{
+		return true;
+	}
 
+	// On a copy context this leaves it in COMMON, see TransitionResource.
 	context.TransitionResource(*this, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-	mUsageState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+	// Uploads happen on the main thread, so this is where the residency
+	// manager gets to know the texture.
+	if (!mResidencyTracked && Graphics::gResidencyManager)
+	{
+		D3D12_RESOURCE_DESC desc = mResource->GetDesc();
+		D3D12_RESOURCE_ALLOCATION_INFO info =
+			Graphics::gDevice->GetResourceAllocationInfo(0, 1, &desc);
+		Graphics::gResidencyManager->Track(static_cast<ID3D12Pageable*>(mResource.Get()),
+										   info.SizeInBytes);
+		mResidencyTracked = true;
+		mGpuCharge.Set(info.SizeInBytes);
+	}
 
 	// Don't clear the deferred data just yet
 	sLogger->debug("Texture data uploaded successfully");
@@ -193,6 +547,21 @@ void Texture::UploadToGPU()
 	sLogger->info("GPU upload complete");
 }
 
+size_t Texture::GetDeferredDataSize() const
+{
+	if (!mDeferredUploadData)
+	{
+		return 0;
+	}
+
+	size_t bytes = 0;
+	for (const D3D12_SUBRESOURCE_DATA& subresource : mDeferredUploadData->subresources)
+	{
+		bytes += static_cast<size_t>(subresource.SlicePitch);
+	}
+	return bytes;
+}
+
 void Texture::ClearUploadBuffer()
 {
 	if (mDeferredUploadData)
@@ -2,6 +2,9 @@
 
 #include "BindlessAllocator.h"
 #include "GpuResource.h"
+#include "texture/IBLBaker.h"
+#include "texture/MipGenerator.h"
+#include "../utils/MemoryTracker.h"
 #include <d3d12.h>
 #include <string>
 #include <memory>
@@ -15,15 +18,48 @@ namespace Graphics
 	extern BindlessAllocator* gBindlessAllocator;
 }
 
+/// Raw file bytes plus a hash of them, read in a single pass. Lets the
+/// Renderer spot the same texture saved under different paths before
+/// anything gets decoded or created on the GPU.
+struct TextureSource
+{
+	std::wstring mPath;
+	std::vector<uint8_t> mData;
+	uint64_t mContentHash = 0;
+};
+
 class Texture : public GpuResource
 {
 public:
 	Texture();
 	~Texture() override;
 
-	/// Loads a DDS file from the file path. Currently not supporting
-	/// .png or .tga though probably should TODO support png, tga
-	bool LoadFromFile(const std::wstring& filepath);
+	/// Loads a DDS, KTX2, PNG, JPEG or TGA file from the file path. DDS
+	/// files are used as is and KTX2 (Basis ETC1S/UASTC) gets transcoded
+	/// to BC7. The others get decoded and a mip chain generated with
+	/// mipDesc (sRGB, normal map...) since they only have the top mip.
+	/// Safe to call from worker threads, the upload still has to happen
+	/// on the main thread.
+	bool LoadFromFile(const std::wstring& filepath, const TextureTools::MipDesc& mipDesc = {});
+
+	/// LoadFromFile split in two, read (and hash) first and create the
+	/// texture later. LoadFromSource may take over the source's data.
+	static bool ReadSource(const std::wstring& filepath, TextureSource& source);
+	bool LoadFromSource(TextureSource&& source, const TextureTools::MipDesc& mipDesc = {});
+
+	/// Creates an RGBA8 texture from a mip chain built on the CPU (see
+	/// TextureTools::GenerateMips). Same as LoadFromFile the pixels are
+	/// kept as deferred upload data until UploadDeferredData/UploadToGPU.
+	bool LoadFromMipChain(const TextureTools::MipChain& mips);
+
+	/// Creates an R16G16B16A16_FLOAT cube from a baked cube map, every
+	/// level of every face becomes a subresource. The SRV is a TextureCube.
+	bool LoadFromCubeMap(const TextureTools::CubeMap& cube);
+
+	/// Creates an R16G16_FLOAT texture from the split sum BRDF table.
+	bool LoadFromBrdfLut(const TextureTools::BrdfLut& lut);
+
+	bool IsCube() const { return mIsCube; }
 
 	DXGI_FORMAT GetFormat() const { return mFormat; }
 	uint32_t GetWidth() const { return mWidth; }
@@ -34,6 +70,10 @@ public:
 	/// CPU handle variable.
 	void CreateSRV(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle);
 
+	/// Writes the same view into cpuHandle, a table of the non-bindless
+	/// path, without touching the bindless allocation.
+	void WriteSRV(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle) const;
+
 	D3D12_CPU_DESCRIPTOR_HANDLE GetSRV() const { return mSrvCpuHandle; }
 	D3D12_GPU_DESCRIPTOR_HANDLE GetSRVGpu() const { return mSrvGpuHandle; }
 
@@ -51,16 +91,35 @@ public:
 	/// Needs the memory to be managed.
 	bool UploadDeferredData(Graphics::GraphicsContext& context);
 
+	/// Records the copies of count subresources from firstSubresource on,
+	/// with a staging buffer of their own, so a big texture can go over a
+	/// few frames. Ranges go in order, the texture leaves COPY_DEST with
+	/// the last one.
+	bool UploadDeferredData(Graphics::GraphicsContext& context, uint32_t firstSubresource,
+							uint32_t count);
+
 	/// Checks if either UploadToGpu or UploadDeferredData has been
-	/// used, or checks if it failed to upload.
+	/// used, or checks if it failed to upload. Also true while only some
+	/// of the subresources have been recorded.
 	bool NeedsUpload() const
 	{
-		return mDeferredUploadData != nullptr && (mDeferredUploadData->uploadBuffer == nullptr);
+		return mDeferredUploadData != nullptr &&
+			   mDeferredUploadData->uploadedSubresources < mDeferredUploadData->subresources.size();
+	}
+
+	uint32_t GetDeferredSubresourceCount() const
+	{
+		return mDeferredUploadData
+				   ? static_cast<uint32_t>(mDeferredUploadData->subresources.size())
+				   : 0;
 	}
 
 	/// Clears the buffer from the deferred upload texture data.
 	void ClearUploadBuffer();
 
+	/// Bytes of texel data waiting for upload, 0 once it's cleared.
+	size_t GetDeferredDataSize() const;
+
 	/// Bindless Allocation
 	uint32_t GetSRVIndex() const
 	{
@@ -72,11 +131,29 @@ public:
 
 private:
 	void InitLogger();
+	D3D12_SHADER_RESOURCE_VIEW_DESC GetSRVDesc() const;
+	bool LoadFromImageData(const std::vector<uint8_t>& data, const TextureTools::MipDesc& mipDesc);
+	bool LoadFromKtx2Data(const std::vector<uint8_t>& data);
+
+	/// Committed texture in COPY_DEST from mFormat, mWidth, mHeight and
+	/// mMipLevels. Cubes pass 6 array slices.
+	bool CreateResource(uint16_t arraySize = 1);
+
+	/// Converts float texels to half floats and appends them as one
+	/// subresource of the deferred upload data.
+	void AppendHalfSubresource(const float* src, uint32_t width, uint32_t height,
+							   uint32_t channels, uint8_t*& dst);
+
 	static std::shared_ptr<spdlog::logger> sLogger;
 	DXGI_FORMAT mFormat;
 	uint32_t mWidth;
 	uint32_t mHeight;
 	uint32_t mMipLevels;
+	bool mIsCube = false;
+	/// Registered with gResidencyManager once uploaded.
+	bool mResidencyTracked = false;
+	/// The committed resource, charged once uploaded.
+	Utils::MemoryCharge mGpuCharge{Utils::MemoryTag::TEXTURE_GPU};
 
 	D3D12_CPU_DESCRIPTOR_HANDLE mSrvCpuHandle = {};
 	D3D12_GPU_DESCRIPTOR_HANDLE mSrvGpuHandle = {};
@@ -85,8 +162,15 @@ private:
 	{
 		// NOTE will most likely change the param name later
 		std::unique_ptr<uint8_t[]> ddsData;
+		/// DDS files are used in place, the subresources point in here.
+		std::vector<uint8_t> sourceData;
 		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
-		Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
+		/// One per UploadDeferredData call, kept until ClearUploadBuffer.
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploadBuffers;
+		uint32_t uploadedSubresources = 0;
+		/// Whichever of ddsData and sourceData holds the texels.
+		Utils::MemoryCharge cpuCharge{Utils::MemoryTag::TEXTURE_CPU};
+		Utils::MemoryCharge stagingCharge{Utils::MemoryTag::TEXTURE_STAGING};
 	};
 
 	std::unique_ptr<DeferredUploadData> mDeferredUploadData;
@@ -0,0 +1,139 @@
+#include "TransientAliasing.h"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace Graphics
+{
+	namespace
+	{
+		uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		bool IsPowerOfTwo(uint64_t value)
+		{
+			return value != 0 && (value & (value - 1)) == 0;
+		}
+	} // namespace
+
+	bool LifetimesOverlap(const TransientResource& a, const TransientResource& b)
+	{
+		return a.mFirstPass <= b.mLastPass && b.mFirstPass <= a.mLastPass;
+	}
+
+	AliasingPlan PlanTransientAliasing(const std::vector<TransientResource>& resources)
+	{
+		AliasingPlan plan;
+		plan.mOffsets.resize(resources.size(), 0);
+
+		std::vector<size_t> order(resources.size());
+		std::iota(order.begin(), order.end(), 0);
+		// Big ones first leave the small ones to fill the gaps. Ties go to
+		// the earlier pass so the result doesn't depend on input order much.
+		std::stable_sort(order.begin(), order.end(), [&resources](size_t a, size_t b) {
+			if (resources[a].mSize != resources[b].mSize)
+			{
+				return resources[a].mSize > resources[b].mSize;
+			}
+			return resources[a].mFirstPass < resources[b].mFirstPass;
+		});
+
+		struct Range
+		{
+			uint64_t mBegin;
+			uint64_t mEnd;
+		};
+
+		std::vector<size_t> placed;
+		std::vector<Range> conflicts;
+		for (size_t index : order)
+		{
+			const TransientResource& resource = resources[index];
+			assert(IsPowerOfTwo(resource.mAlignment) && "Alignment has to be a power of two");
+			plan.mUnaliasedSize += AlignUp(resource.mSize, resource.mAlignment);
+
+			// Memory taken by the resources this one is alive alongside.
+			conflicts.clear();
+			for (size_t other : placed)
+			{
+				if (resources[other].mHeap == resource.mHeap &&
+					LifetimesOverlap(resources[other], resource))
+				{
+					conflicts.push_back(
+						{plan.mOffsets[other], plan.mOffsets[other] + resources[other].mSize});
+				}
+			}
+			std::sort(conflicts.begin(), conflicts.end(),
+					  [](const Range& a, const Range& b) { return a.mBegin < b.mBegin; });
+
+			// Lowest aligned gap it fits in.
+			uint64_t offset = 0;
+			for (const Range& range : conflicts)
+			{
+				if (offset + resource.mSize <= range.mBegin)
+				{
+					break;
+				}
+				offset = std::max(offset, AlignUp(range.mEnd, resource.mAlignment));
+			}
+
+			plan.mOffsets[index] = offset;
+			placed.push_back(index);
+
+			if (plan.mHeapSizes.size() <= resource.mHeap)
+			{
+				plan.mHeapSizes.resize(resource.mHeap + 1, 0);
+			}
+			plan.mHeapSizes[resource.mHeap] =
+				std::max(plan.mHeapSizes[resource.mHeap], offset + resource.mSize);
+		}
+
+		// Heaps are made whole pages at a time too.
+		for (uint64_t& size : plan.mHeapSizes)
+		{
+			size = AlignUp(size, DEFAULT_PLACEMENT_ALIGNMENT);
+			plan.mAliasedSize += size;
+		}
+		return plan;
+	}
+
+	bool ValidateAliasingPlan(const std::vector<TransientResource>& resources,
+							  const AliasingPlan& plan)
+	{
+		if (plan.mOffsets.size() != resources.size())
+		{
+			return false;
+		}
+
+		for (size_t a = 0; a < resources.size(); ++a)
+		{
+			if (plan.mOffsets[a] % resources[a].mAlignment != 0)
+			{
+				return false;
+			}
+			if (resources[a].mHeap >= plan.mHeapSizes.size() ||
+				plan.mOffsets[a] + resources[a].mSize > plan.mHeapSizes[resources[a].mHeap])
+			{
+				return false;
+			}
+
+			for (size_t b = a + 1; b < resources.size(); ++b)
+			{
+				if (resources[a].mHeap != resources[b].mHeap ||
+					!LifetimesOverlap(resources[a], resources[b]))
+				{
+					continue;
+				}
+				uint64_t aEnd = plan.mOffsets[a] + resources[a].mSize;
+				uint64_t bEnd = plan.mOffsets[b] + resources[b].mSize;
+				if (plan.mOffsets[a] < bEnd && plan.mOffsets[b] < aEnd)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+} // namespace Graphics
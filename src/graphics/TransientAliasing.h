@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Graphics
+{
+	/// D3D12's default placement alignment for textures and buffers.
+	constexpr uint64_t DEFAULT_PLACEMENT_ALIGNMENT = 64 * 1024;
+
+	/// A target only needed for part of the frame. Passes are numbered in
+	/// the order they run, the resource is live from the first pass that
+	/// writes it through the last one that reads it (both included).
+	struct TransientResource
+	{
+		std::string mName;
+		/// What GetResourceAllocationInfo says, size and alignment.
+		uint64_t mSize = 0;
+		uint64_t mAlignment = DEFAULT_PLACEMENT_ALIGNMENT;
+		uint32_t mFirstPass = 0;
+		uint32_t mLastPass = 0;
+		/// Which heap it has to go in. Resource heap tier 1 can't mix
+		/// render targets with buffers, the caller numbers the kinds.
+		uint32_t mHeap = 0;
+	};
+
+	struct AliasingPlan
+	{
+		/// Per resource, in input order. Offsets are into its mHeap.
+		std::vector<uint64_t> mOffsets;
+		/// Bytes each heap needs, indexed by mHeap.
+		std::vector<uint64_t> mHeapSizes;
+		/// Every heap together.
+		uint64_t mAliasedSize = 0;
+		/// What the resources take with memory of their own.
+		uint64_t mUnaliasedSize = 0;
+
+		/// 0 when alignment padding makes the heaps bigger than the
+		/// resources on their own.
+		uint64_t GetSavedBytes() const
+		{
+			return mUnaliasedSize > mAliasedSize ? mUnaliasedSize - mAliasedSize : 0;
+		}
+	};
+
+	bool LifetimesOverlap(const TransientResource& a, const TransientResource& b);
+
+	/// Gives every resource an offset in its heap so that ones alive at the
+	/// same time never share memory and ones that aren't can. The lifetimes
+	/// form an interval graph, this colours it greedily with byte ranges
+	/// for colours: biggest first, each at the lowest aligned offset that
+	/// doesn't overlap something already placed whose lifetime it meets.
+	/// Alignments have to be powers of two.
+	AliasingPlan PlanTransientAliasing(const std::vector<TransientResource>& resources);
+
+	/// True if no two resources with overlapping lifetimes overlap in
+	/// memory and every offset is aligned.
+	bool ValidateAliasingPlan(const std::vector<TransientResource>& resources,
+							  const AliasingPlan& plan);
+} // namespace Graphics
@@ -0,0 +1,75 @@
+#include "UploadBatch.h"
+#include <cassert>
+
+namespace Graphics
+{
+	UploadBatch::UploadBatch(UploadBatchQueue queue)
+	: mQueue(std::move(queue))
+	{
+	}
+
+	void UploadBatch::Begin()
+	{
+		assert(!mRecording && "UploadBatch::Begin called twice");
+		mQueue.mBegin();
+		mRecording = true;
+		mRecordedItems = 0;
+	}
+
+	void UploadBatch::Add(size_t bytes, std::function<void()> onRetired)
+	{
+		assert(mRecording && "UploadBatch::Add outside Begin/Submit");
+		mRecordedItems++;
+		mStats.mItems++;
+		mStats.mBytes += bytes;
+		if (onRetired)
+		{
+			mRecordedRetires.push_back(std::move(onRetired));
+		}
+	}
+
+	uint64_t UploadBatch::Submit()
+	{
+		assert(mRecording && "UploadBatch::Submit without Begin");
+		mRecording = false;
+
+		// The list still has to be closed and executed, an empty one is
+		// cheap but there's no point in fencing or waiting on it.
+		uint64_t fence = mQueue.mSubmit();
+		if (mRecordedItems == 0)
+		{
+			return mLastFence;
+		}
+
+		mLastFence = fence;
+		mStats.mBatches++;
+
+		// One GPU side wait per batch, whatever the number of copies in it.
+		mQueue.mGraphicsWait(fence);
+		mStats.mGraphicsWaits++;
+
+		mPending.push_back({fence, std::move(mRecordedRetires)});
+		mRecordedRetires.clear();
+		mStats.mPendingBatches = static_cast<uint32_t>(mPending.size());
+		return fence;
+	}
+
+	void UploadBatch::Retire()
+	{
+		if (mPending.empty())
+		{
+			return;
+		}
+
+		uint64_t completed = mQueue.mGetCompletedFence();
+		while (!mPending.empty() && mPending.front().mFence <= completed)
+		{
+			for (std::function<void()>& onRetired : mPending.front().mOnRetired)
+			{
+				onRetired();
+			}
+			mPending.pop_front();
+		}
+		mStats.mPendingBatches = static_cast<uint32_t>(mPending.size());
+	}
+} // namespace Graphics
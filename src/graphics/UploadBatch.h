@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace Graphics
+{
+	/// The queue work behind an UploadBatch. The Renderer plugs in the copy
+	/// queue and its context, the tests a fake one.
+	struct UploadBatchQueue
+	{
+		/// Gets the copy context ready for recording. Its allocator may
+		/// still be in use by the previous batch, this is where to wait.
+		std::function<void()> mBegin;
+		/// Closes and executes what was recorded, returns the fence the
+		/// copy queue signals when it's done.
+		std::function<uint64_t()> mSubmit;
+		std::function<uint64_t()> mGetCompletedFence;
+		/// Makes the graphics queue wait for fence on the GPU.
+		std::function<void(uint64_t)> mGraphicsWait;
+	};
+
+	struct UploadBatchStats
+	{
+		uint32_t mBatches = 0;
+		uint32_t mItems = 0;
+		uint64_t mBytes = 0;
+		uint32_t mGraphicsWaits = 0;
+		/// Batches submitted whose copies haven't been retired yet.
+		uint32_t mPendingBatches = 0;
+	};
+
+	/// Groups many mesh and texture copies into one command list on the
+	/// copy queue. Begin, record the copies and Add each one, then Submit
+	/// executes them all behind a single fence and has the graphics queue
+	/// wait for it on the GPU, so nothing on the CPU blocks. The staging
+	/// memory stays alive until Retire sees the fence, that's when the
+	/// items' onRetired callbacks run.
+	class UploadBatch
+	{
+	public:
+		explicit UploadBatch(UploadBatchQueue queue);
+
+		UploadBatch(const UploadBatch&) = delete;
+		UploadBatch& operator=(const UploadBatch&) = delete;
+
+		void Begin();
+
+		/// One copy recorded since Begin. onRetired frees its staging
+		/// (ClearUploadBuffer and friends).
+		void Add(size_t bytes, std::function<void()> onRetired = {});
+
+		bool IsRecording() const { return mRecording; }
+
+		/// Executes everything since Begin. Returns the fence, or the last
+		/// one if nothing was added. Begin opened the list, so an empty one
+		/// is still closed and executed, it just isn't fenced or waited on.
+		uint64_t Submit();
+
+		/// Runs onRetired for every batch the copy queue has finished.
+		void Retire();
+
+		uint64_t GetLastFence() const { return mLastFence; }
+		const UploadBatchStats& GetStats() const { return mStats; }
+
+	private:
+		struct PendingBatch
+		{
+			uint64_t mFence;
+			std::vector<std::function<void()>> mOnRetired;
+		};
+
+		UploadBatchQueue mQueue;
+		bool mRecording = false;
+		uint32_t mRecordedItems = 0;
+		std::vector<std::function<void()>> mRecordedRetires;
+		std::deque<PendingBatch> mPending;
+		uint64_t mLastFence = 0;
+		UploadBatchStats mStats;
+	};
+} // namespace Graphics
@@ -0,0 +1,177 @@
+#include "UploadScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace Graphics
+{
+	void UploadHitchHistogram::Add(double milliseconds)
+	{
+		size_t bucket = 0;
+		while (bucket < BUCKET_BOUNDS_MS.size() && milliseconds > BUCKET_BOUNDS_MS[bucket])
+		{
+			bucket++;
+		}
+		mCounts[bucket]++;
+		mWorstMs = std::max(mWorstMs, milliseconds);
+	}
+
+	uint32_t UploadHitchHistogram::GetTotal() const
+	{
+		return std::accumulate(mCounts.begin(), mCounts.end(), 0U);
+	}
+
+	UploadScheduler::UploadScheduler(const UploadSchedulerDesc& desc)
+	: mDesc(desc)
+	{
+	}
+
+	double UploadScheduler::Now() const
+	{
+		if (mDesc.mNow)
+		{
+			return mDesc.mNow();
+		}
+		using Clock = std::chrono::steady_clock;
+		return std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch()).count();
+	}
+
+	void UploadScheduler::Enqueue(UploadJob job)
+	{
+		if (job.mSliceBytes.empty() || !job.mRecord)
+		{
+			return;
+		}
+
+		mStats.mJobsQueued++;
+		for (size_t bytes : job.mSliceBytes)
+		{
+			mStats.mPendingBytes += bytes;
+		}
+
+		PendingJob& pending = mJobs.emplace_back();
+		pending.mJob = std::move(job);
+		pending.mSequence = mNextSequence++;
+		if (pending.mJob.mKey)
+		{
+			mIndex[pending.mJob.mKey] = mJobs.size() - 1;
+		}
+		mStats.mPendingJobs = static_cast<uint32_t>(mJobs.size());
+	}
+
+	void UploadScheduler::MarkVisible(const void* key)
+	{
+		auto it = mIndex.find(key);
+		if (it != mIndex.end())
+		{
+			mJobs[it->second].mVisible = true;
+		}
+	}
+
+	uint32_t UploadScheduler::Pump()
+	{
+		mStats.mFrames++;
+		mStats.mLastFrameSlices = 0;
+		mStats.mLastFrameBytes = 0;
+		mStats.mLastFrameMs = 0.0;
+		if (mJobs.empty())
+		{
+			return 0;
+		}
+
+		double start = Now();
+
+		std::sort(mJobs.begin(), mJobs.end(), [](const PendingJob& a, const PendingJob& b) {
+			if (a.mVisible != b.mVisible)
+			{
+				return a.mVisible;
+			}
+			if (a.mJob.mPriority != b.mJob.mPriority)
+			{
+				return a.mJob.mPriority > b.mJob.mPriority;
+			}
+			return a.mSequence < b.mSequence;
+		});
+
+		uint32_t slices = 0;
+		uint64_t bytes = 0;
+		bool outOfBudget = false;
+		for (PendingJob& pending : mJobs)
+		{
+			const UploadJob& job = pending.mJob;
+			while (pending.mNextSlice < job.mSliceBytes.size())
+			{
+				size_t sliceBytes = job.mSliceBytes[pending.mNextSlice];
+
+				// Something always goes, otherwise a slice bigger than the
+				// budget would never get recorded.
+				if (slices > 0 && (bytes + sliceBytes > mDesc.mBytesPerFrame ||
+								   Now() - start >= mDesc.mMillisecondsPerFrame))
+				{
+					outOfBudget = true;
+					break;
+				}
+
+				bool recorded = job.mRecord(pending.mNextSlice);
+				slices++;
+				bytes += sliceBytes;
+				pending.mNextSlice++;
+				if (!recorded)
+				{
+					mStats.mJobsFailed++;
+					pending.mDone = true;
+					break;
+				}
+			}
+
+			if (outOfBudget)
+			{
+				break;
+			}
+			if (!pending.mDone)
+			{
+				mStats.mJobsCompleted++;
+				pending.mDone = true;
+			}
+		}
+
+		uint64_t pendingBytes = 0;
+		std::erase_if(mJobs, [](const PendingJob& pending) { return pending.mDone; });
+		for (PendingJob& pending : mJobs)
+		{
+			pending.mVisible = false;
+			for (size_t i = pending.mNextSlice; i < pending.mJob.mSliceBytes.size(); ++i)
+			{
+				pendingBytes += pending.mJob.mSliceBytes[i];
+			}
+		}
+		RebuildIndex();
+
+		double elapsed = Now() - start;
+		mStats.mSlices += slices;
+		mStats.mBytes += bytes;
+		mStats.mPendingJobs = static_cast<uint32_t>(mJobs.size());
+		mStats.mPendingBytes = pendingBytes;
+		mStats.mLastFrameSlices = slices;
+		mStats.mLastFrameBytes = bytes;
+		mStats.mLastFrameMs = elapsed;
+		if (elapsed > mDesc.mMillisecondsPerFrame)
+		{
+			mStats.mOverBudgetFrames++;
+		}
+		mHistogram.Add(elapsed);
+		return slices;
+	}
+
+	void UploadScheduler::RebuildIndex()
+	{
+		mIndex.clear();
+		for (size_t i = 0; i < mJobs.size(); ++i)
+		{
+			if (mJobs[i].mJob.mKey)
+			{
+				mIndex[mJobs[i].mJob.mKey] = i;
+			}
+		}
+	}
+} // namespace Graphics
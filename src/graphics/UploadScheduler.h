@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics
+{
+	struct UploadSchedulerDesc
+	{
+		/// Copy bytes recorded per frame. A single slice bigger than this
+		/// still goes, on a frame of its own.
+		size_t mBytesPerFrame = 16ULL * 1024 * 1024;
+		/// CPU time spent recording per frame (UpdateSubresources memcpys
+		/// into the staging buffers), checked between slices.
+		double mMillisecondsPerFrame = 2.0;
+		/// Current time in milliseconds, steady_clock when empty. The tests
+		/// plug in a simulated frame clock.
+		std::function<double()> mNow;
+	};
+
+	/// One mesh or texture waiting to be copied, recorded a slice at a time
+	/// so a big texture can spread over several frames.
+	struct UploadJob
+	{
+		/// What MarkVisible is called with, the Mesh or Texture.
+		const void* mKey = nullptr;
+		/// Higher goes first among jobs that are equally visible.
+		int32_t mPriority = 0;
+		/// Bytes of each slice, in the order they get recorded.
+		std::vector<size_t> mSliceBytes;
+		/// Records one slice into the open copy batch. False drops the
+		/// rest of the job.
+		std::function<bool(uint32_t slice)> mRecord;
+	};
+
+	/// Frames that recorded uploads, by how long the recording took.
+	struct UploadHitchHistogram
+	{
+		/// Upper bounds in milliseconds, the last bucket is everything
+		/// above the last bound.
+		static constexpr std::array<double, 7> BUCKET_BOUNDS_MS = {0.5, 1.0,  2.0, 4.0,
+																   8.0, 16.0, 33.0};
+
+		std::array<uint32_t, BUCKET_BOUNDS_MS.size() + 1> mCounts = {};
+		double mWorstMs = 0.0;
+
+		void Add(double milliseconds);
+		uint32_t GetTotal() const;
+	};
+
+	struct UploadSchedulerStats
+	{
+		uint64_t mFrames = 0;
+		uint32_t mJobsQueued = 0;
+		uint32_t mJobsCompleted = 0;
+		uint32_t mJobsFailed = 0;
+		uint64_t mSlices = 0;
+		uint64_t mBytes = 0;
+		uint32_t mPendingJobs = 0;
+		uint64_t mPendingBytes = 0;
+		uint32_t mLastFrameSlices = 0;
+		uint64_t mLastFrameBytes = 0;
+		double mLastFrameMs = 0.0;
+		/// Frames whose recording went over mMillisecondsPerFrame.
+		uint32_t mOverBudgetFrames = 0;
+	};
+
+	/// Spreads mesh and texture uploads over frames so loading a scene
+	/// doesn't stall the first one for seconds. Jobs queue up and each Pump
+	/// records slices until the frame's byte or time budget runs out.
+	/// Whatever was drawn since the last Pump (MarkVisible) goes first,
+	/// then higher priority, then the order they were queued in. The
+	/// caller wraps Pump in an UploadBatch Begin/Submit.
+	/// Not thread safe.
+	class UploadScheduler
+	{
+	public:
+		explicit UploadScheduler(const UploadSchedulerDesc& desc = {});
+
+		UploadScheduler(const UploadScheduler&) = delete;
+		UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+		void Enqueue(UploadJob job);
+
+		/// The renderer wanted to draw with key this frame. Does nothing
+		/// if it isn't waiting.
+		void MarkVisible(const void* key);
+
+		/// Once a frame. Returns the slices recorded.
+		uint32_t Pump();
+
+		bool HasPending() const { return !mJobs.empty(); }
+		bool IsPending(const void* key) const { return mIndex.contains(key); }
+
+		const UploadSchedulerStats& GetStats() const { return mStats; }
+		const UploadHitchHistogram& GetHitchHistogram() const { return mHistogram; }
+
+	private:
+		struct PendingJob
+		{
+			UploadJob mJob;
+			uint64_t mSequence = 0;
+			uint32_t mNextSlice = 0;
+			bool mVisible = false;
+			bool mDone = false;
+		};
+
+		double Now() const;
+		void RebuildIndex();
+
+		UploadSchedulerDesc mDesc;
+		std::vector<PendingJob> mJobs;
+		/// Key to position in mJobs.
+		std::unordered_map<const void*, size_t> mIndex;
+		uint64_t mNextSequence = 0;
+		UploadSchedulerStats mStats;
+		UploadHitchHistogram mHistogram;
+	};
+} // namespace Graphics
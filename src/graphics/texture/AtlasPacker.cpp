@@ -0,0 +1,413 @@
+#include "AtlasPacker.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace TextureTools
+{
+	namespace
+	{
+		bool Contains(const PackRect& outer, const PackRect& inner)
+		{
+			return inner.mX >= outer.mX && inner.mY >= outer.mY &&
+				   inner.mX + inner.mWidth <= outer.mX + outer.mWidth &&
+				   inner.mY + inner.mHeight <= outer.mY + outer.mHeight;
+		}
+
+		bool Overlaps(const PackRect& a, const PackRect& b)
+		{
+			return a.mX < b.mX + b.mWidth && b.mX < a.mX + a.mWidth && a.mY < b.mY + b.mHeight &&
+				   b.mY < a.mY + a.mHeight;
+		}
+
+		uint32_t AlignUp(uint32_t value, uint32_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		uint32_t WrapCoord(int64_t value, uint32_t size, bool wrap)
+		{
+			if (wrap)
+			{
+				int64_t m = value % static_cast<int64_t>(size);
+				return static_cast<uint32_t>(m < 0 ? m + size : m);
+			}
+			return static_cast<uint32_t>(std::clamp<int64_t>(value, 0, size - 1));
+		}
+
+		/// Copies the image into the page at (x, y) and fills padding
+		/// texels around it from the image edges.
+		void BlitWithGutter(const Image& src, Image& page, uint32_t x, uint32_t y, uint32_t padding,
+							bool wrap)
+		{
+			const uint32_t rowBytes = src.GetRowPitch();
+			for (uint32_t row = 0; row < src.mHeight; ++row)
+			{
+				std::memcpy(page.GetPixel(x, y + row), src.GetPixel(0, row), rowBytes);
+			}
+
+			if (padding == 0)
+			{
+				return;
+			}
+
+			const int64_t pad = padding;
+			for (int64_t row = -pad; row < static_cast<int64_t>(src.mHeight) + pad; ++row)
+			{
+				const bool insideRow = row >= 0 && row < static_cast<int64_t>(src.mHeight);
+				const uint32_t srcRow = WrapCoord(row, src.mHeight, wrap);
+				for (int64_t col = -pad; col < static_cast<int64_t>(src.mWidth) + pad; ++col)
+				{
+					if (insideRow && col >= 0 && col < static_cast<int64_t>(src.mWidth))
+					{
+						// Already copied, skip to the right gutter.
+						col = src.mWidth - 1;
+						continue;
+					}
+
+					const uint32_t srcCol = WrapCoord(col, src.mWidth, wrap);
+					std::memcpy(page.GetPixel(static_cast<uint32_t>(x + col),
+											  static_cast<uint32_t>(y + row)),
+								src.GetPixel(srcCol, srcRow), 4);
+				}
+			}
+		}
+
+		struct Cell
+		{
+			uint32_t mIndex;
+			uint32_t mWidth;
+			uint32_t mHeight;
+		};
+
+		/// Packs as many of the cells as fit into a size x size page, in
+		/// order. Returns how many made it.
+		uint32_t PackPage(const std::vector<Cell>& cells, uint32_t size, std::vector<PackRect>& rects,
+						  std::vector<uint8_t>& placed)
+		{
+			MaxRectsPacker packer(size, size);
+			rects.assign(cells.size(), {});
+			placed.assign(cells.size(), 0);
+
+			uint32_t count = 0;
+			for (size_t i = 0; i < cells.size(); ++i)
+			{
+				if (packer.Insert(cells[i].mWidth, cells[i].mHeight, rects[i]))
+				{
+					placed[i] = 1;
+					count++;
+				}
+			}
+			return count;
+		}
+	} // namespace
+
+	MaxRectsPacker::MaxRectsPacker(uint32_t width, uint32_t height)
+	: mWidth(width)
+	, mHeight(height)
+	{
+		mFreeRects.push_back({0, 0, width, height});
+	}
+
+	bool MaxRectsPacker::Insert(uint32_t width, uint32_t height, PackRect& out)
+	{
+		if (width == 0 || height == 0)
+		{
+			return false;
+		}
+
+		uint32_t bestShortSide = std::numeric_limits<uint32_t>::max();
+		uint32_t bestLongSide = std::numeric_limits<uint32_t>::max();
+		const PackRect* best = nullptr;
+
+		for (const PackRect& free : mFreeRects)
+		{
+			if (free.mWidth < width || free.mHeight < height)
+			{
+				continue;
+			}
+
+			uint32_t leftoverX = free.mWidth - width;
+			uint32_t leftoverY = free.mHeight - height;
+			uint32_t shortSide = std::min(leftoverX, leftoverY);
+			uint32_t longSide = std::max(leftoverX, leftoverY);
+			if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+			{
+				bestShortSide = shortSide;
+				bestLongSide = longSide;
+				best = &free;
+			}
+		}
+
+		if (!best)
+		{
+			return false;
+		}
+
+		out = {best->mX, best->mY, width, height};
+		SplitFreeRects(out);
+		PruneFreeRects();
+		mUsedArea += static_cast<uint64_t>(width) * height;
+		return true;
+	}
+
+	float MaxRectsPacker::GetOccupancy() const
+	{
+		const uint64_t area = static_cast<uint64_t>(mWidth) * mHeight;
+		return area > 0 ? static_cast<float>(mUsedArea) / static_cast<float>(area) : 0.0F;
+	}
+
+	void MaxRectsPacker::SplitFreeRects(const PackRect& used)
+	{
+		// Every free rect the new one overlaps gets replaced by up to four
+		// maximal rects around it, they overlap each other on purpose.
+		std::vector<PackRect> split;
+		for (size_t i = 0; i < mFreeRects.size();)
+		{
+			const PackRect free = mFreeRects[i];
+			if (!Overlaps(free, used))
+			{
+				++i;
+				continue;
+			}
+
+			if (used.mX > free.mX)
+			{
+				split.push_back({free.mX, free.mY, used.mX - free.mX, free.mHeight});
+			}
+			if (used.mX + used.mWidth < free.mX + free.mWidth)
+			{
+				uint32_t x = used.mX + used.mWidth;
+				split.push_back({x, free.mY, free.mX + free.mWidth - x, free.mHeight});
+			}
+			if (used.mY > free.mY)
+			{
+				split.push_back({free.mX, free.mY, free.mWidth, used.mY - free.mY});
+			}
+			if (used.mY + used.mHeight < free.mY + free.mHeight)
+			{
+				uint32_t y = used.mY + used.mHeight;
+				split.push_back({free.mX, y, free.mWidth, free.mY + free.mHeight - y});
+			}
+
+			mFreeRects[i] = mFreeRects.back();
+			mFreeRects.pop_back();
+		}
+
+		mFreeRects.insert(mFreeRects.end(), split.begin(), split.end());
+	}
+
+	void MaxRectsPacker::PruneFreeRects()
+	{
+		// Drop free rects fully inside another one, they'd never be a
+		// better fit.
+		for (size_t i = 0; i < mFreeRects.size(); ++i)
+		{
+			for (size_t j = i + 1; j < mFreeRects.size();)
+			{
+				if (Contains(mFreeRects[j], mFreeRects[i]))
+				{
+					mFreeRects[i] = mFreeRects[j];
+					mFreeRects.erase(mFreeRects.begin() + static_cast<ptrdiff_t>(j));
+					j = i + 1;
+				}
+				else if (Contains(mFreeRects[i], mFreeRects[j]))
+				{
+					mFreeRects.erase(mFreeRects.begin() + static_cast<ptrdiff_t>(j));
+				}
+				else
+				{
+					++j;
+				}
+			}
+		}
+	}
+
+	uint32_t AtlasResult::GetPackedCount() const
+	{
+		return static_cast<uint32_t>(std::count_if(mPlacements.begin(), mPlacements.end(),
+												   [](const AtlasPlacement& p) { return p.mPacked; }));
+	}
+
+	float AtlasResult::GetEfficiency() const
+	{
+		uint64_t imageArea = 0;
+		uint64_t pageArea = 0;
+		for (const AtlasPage& page : mPages)
+		{
+			imageArea += page.mImageArea;
+			pageArea += static_cast<uint64_t>(page.mImage.mWidth) * page.mImage.mHeight;
+		}
+		return pageArea > 0 ? static_cast<float>(imageArea) / static_cast<float>(pageArea) : 0.0F;
+	}
+
+	uint32_t GetAtlasMipLevels(const AtlasDesc& desc)
+	{
+		// Every level halves the gutter, stop at the level where it is one
+		// texel wide.
+		return desc.mPadding > 0 ? static_cast<uint32_t>(std::bit_width(desc.mPadding)) : 1;
+	}
+
+	AtlasResult BuildAtlases(const std::vector<const Image*>& images, const AtlasDesc& desc)
+	{
+		AtlasResult result;
+		result.mPlacements.resize(images.size());
+
+		// Cells are aligned to the padding so each image starts on a whole
+		// texel in every mip level we keep.
+		const uint32_t alignment = std::max<uint32_t>(std::bit_ceil(desc.mPadding), 1);
+		const uint32_t pageSize = std::bit_floor(desc.mMaxPageSize);
+
+		std::vector<uint32_t> order;
+		for (uint32_t i = 0; i < images.size(); ++i)
+		{
+			const Image* image = images[i];
+			if (image && !image->IsEmpty() && image->mWidth <= desc.mMaxInputSize &&
+				image->mHeight <= desc.mMaxInputSize &&
+				AlignUp(image->mWidth + 2 * desc.mPadding, alignment) <= pageSize &&
+				AlignUp(image->mHeight + 2 * desc.mPadding, alignment) <= pageSize)
+			{
+				order.push_back(i);
+			}
+		}
+
+		// Largest first packs tighter, ties broken by index so the output
+		// doesn't depend on the sort implementation.
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			uint32_t sideA = std::max(images[a]->mWidth, images[a]->mHeight);
+			uint32_t sideB = std::max(images[b]->mWidth, images[b]->mHeight);
+			if (sideA != sideB)
+			{
+				return sideA > sideB;
+			}
+			uint64_t areaA = static_cast<uint64_t>(images[a]->mWidth) * images[a]->mHeight;
+			uint64_t areaB = static_cast<uint64_t>(images[b]->mWidth) * images[b]->mHeight;
+			return areaA != areaB ? areaA > areaB : a < b;
+		});
+
+		std::vector<Cell> remaining;
+		for (uint32_t index : order)
+		{
+			remaining.push_back({index,
+								 AlignUp(images[index]->mWidth + 2 * desc.mPadding, alignment),
+								 AlignUp(images[index]->mHeight + 2 * desc.mPadding, alignment)});
+		}
+
+		// One page at a time. Whatever doesn't fit a full page goes to the
+		// next one, and once the rest fits we search for the smallest page
+		// that still holds it, a big page with few cells gets them spread
+		// all over by the packer.
+		uint32_t pageCount = 0;
+		while (!remaining.empty())
+		{
+			std::vector<PackRect> rects;
+			std::vector<uint8_t> placed;
+			uint32_t count = PackPage(remaining, pageSize, rects, placed);
+			if (count == 0)
+			{
+				break;
+			}
+
+			if (count == remaining.size())
+			{
+				uint64_t area = 0;
+				uint32_t largest = 0;
+				for (const Cell& cell : remaining)
+				{
+					area += static_cast<uint64_t>(cell.mWidth) * cell.mHeight;
+					largest = std::max({largest, cell.mWidth, cell.mHeight});
+				}
+
+				uint32_t low = std::max(
+					AlignUp(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(area)))),
+							alignment),
+					largest) / alignment;
+				uint32_t high = pageSize / alignment;
+				while (low < high)
+				{
+					uint32_t mid = (low + high) / 2;
+					if (PackPage(remaining, mid * alignment, rects, placed) == remaining.size())
+					{
+						high = mid;
+					}
+					else
+					{
+						low = mid + 1;
+					}
+				}
+				PackPage(remaining, high * alignment, rects, placed);
+			}
+
+			std::vector<Cell> next;
+			for (size_t i = 0; i < remaining.size(); ++i)
+			{
+				if (!placed[i])
+				{
+					next.push_back(remaining[i]);
+					continue;
+				}
+
+				AtlasPlacement& placement = result.mPlacements[remaining[i].mIndex];
+				placement.mPacked = true;
+				placement.mPage = pageCount;
+				placement.mRect = {rects[i].mX + desc.mPadding, rects[i].mY + desc.mPadding,
+								   images[remaining[i].mIndex]->mWidth,
+								   images[remaining[i].mIndex]->mHeight};
+			}
+			remaining = std::move(next);
+			pageCount++;
+		}
+
+		// Crop every page to its cells, mostly matters for the last one. The
+		// size stays a multiple of the alignment so the kept mips divide
+		// evenly.
+		result.mPages.resize(pageCount);
+		std::vector<uint32_t> pageRight(pageCount, 1);
+		std::vector<uint32_t> pageBottom(pageCount, 1);
+		for (uint32_t index : order)
+		{
+			const AtlasPlacement& placement = result.mPlacements[index];
+			if (!placement.mPacked)
+			{
+				continue;
+			}
+
+			const uint32_t right = placement.mRect.mX + placement.mRect.mWidth + desc.mPadding;
+			const uint32_t bottom = placement.mRect.mY + placement.mRect.mHeight + desc.mPadding;
+			pageRight[placement.mPage] = std::max(pageRight[placement.mPage], right);
+			pageBottom[placement.mPage] = std::max(pageBottom[placement.mPage], bottom);
+		}
+
+		for (uint32_t page = 0; page < pageCount; ++page)
+		{
+			result.mPages[page].mImage =
+				Image(AlignUp(pageRight[page], alignment), AlignUp(pageBottom[page], alignment));
+		}
+
+		for (uint32_t index : order)
+		{
+			AtlasPlacement& placement = result.mPlacements[index];
+			if (!placement.mPacked)
+			{
+				continue;
+			}
+
+			AtlasPage& page = result.mPages[placement.mPage];
+			const float pageWidth = static_cast<float>(page.mImage.mWidth);
+			const float pageHeight = static_cast<float>(page.mImage.mHeight);
+
+			BlitWithGutter(*images[index], page.mImage, placement.mRect.mX, placement.mRect.mY,
+						   desc.mPadding, desc.mWrap);
+			page.mImageArea += static_cast<uint64_t>(placement.mRect.mWidth) * placement.mRect.mHeight;
+
+			placement.mUVScale[0] = static_cast<float>(placement.mRect.mWidth) / pageWidth;
+			placement.mUVScale[1] = static_cast<float>(placement.mRect.mHeight) / pageHeight;
+			placement.mUVOffset[0] = static_cast<float>(placement.mRect.mX) / pageWidth;
+			placement.mUVOffset[1] = static_cast<float>(placement.mRect.mY) / pageHeight;
+		}
+
+		return result;
+	}
+} // namespace TextureTools
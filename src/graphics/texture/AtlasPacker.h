@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Image.h"
+#include <cstdint>
+#include <vector>
+
+namespace TextureTools
+{
+	struct PackRect
+	{
+		uint32_t mX = 0;
+		uint32_t mY = 0;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+	};
+
+	/// MaxRects bin packer using the best short side fit heuristic. Keeps
+	/// a list of maximal free rectangles, which wastes a lot less space
+	/// than a skyline on mixed sizes at the cost of a slower insert (fine
+	/// for the few hundred rects a cook produces).
+	class MaxRectsPacker
+	{
+	public:
+		MaxRectsPacker(uint32_t width, uint32_t height);
+
+		/// Places a width x height rect, returns false if it doesn't fit.
+		/// Rects are never rotated since the textures can't be either.
+		bool Insert(uint32_t width, uint32_t height, PackRect& out);
+
+		uint32_t GetWidth() const { return mWidth; }
+		uint32_t GetHeight() const { return mHeight; }
+		uint64_t GetUsedArea() const { return mUsedArea; }
+
+		/// Used area over the bin area.
+		float GetOccupancy() const;
+
+		const std::vector<PackRect>& GetFreeRects() const { return mFreeRects; }
+
+	private:
+		void SplitFreeRects(const PackRect& used);
+		void PruneFreeRects();
+
+		uint32_t mWidth;
+		uint32_t mHeight;
+		uint64_t mUsedArea = 0;
+		std::vector<PackRect> mFreeRects;
+	};
+
+	struct AtlasDesc
+	{
+		/// Largest page side. Pages get cropped to their contents afterwards
+		/// so the last one isn't mostly empty.
+		uint32_t mMaxPageSize = 2048;
+
+		/// Only images up to this size (both sides) get packed, bigger
+		/// ones stay standalone textures.
+		uint32_t mMaxInputSize = 256;
+
+		/// Gutter around each image, filled from the image itself so
+		/// bilinear filtering and the lower mips don't pick up the
+		/// neighbours. Has to be a power of two, cells are aligned to it.
+		uint32_t mPadding = 4;
+
+		/// Fill the gutter with the opposite edge (tiling textures) instead
+		/// of repeating the edge texel.
+		bool mWrap = true;
+	};
+
+	/// Where an input image ended up. The UV transform maps the image's
+	/// own [0,1] range into the page: uv * scale + offset.
+	struct AtlasPlacement
+	{
+		bool mPacked = false;
+		uint32_t mPage = 0;
+		PackRect mRect;
+		float mUVScale[2] = {1.0F, 1.0F};
+		float mUVOffset[2] = {0.0F, 0.0F};
+	};
+
+	struct AtlasPage
+	{
+		Image mImage;
+		/// Area of the input images on this page, gutters excluded.
+		uint64_t mImageArea = 0;
+	};
+
+	struct AtlasResult
+	{
+		std::vector<AtlasPage> mPages;
+		/// Same order as the input images.
+		std::vector<AtlasPlacement> mPlacements;
+
+		uint32_t GetPackedCount() const;
+
+		/// Image texels over page texels across all the pages, 1.0 means
+		/// no gutters and no holes.
+		float GetEfficiency() const;
+	};
+
+	/// Packs the images that are small enough into as few pages as
+	/// possible. All images are assumed to be the same format (same
+	/// colour space, same kind of map), group them before calling this.
+	AtlasResult BuildAtlases(const std::vector<const Image*>& images, const AtlasDesc& desc);
+
+	/// Mip levels an atlas page can have before the gutters shrink below
+	/// a texel and neighbouring images start to bleed into each other.
+	uint32_t GetAtlasMipLevels(const AtlasDesc& desc);
+} // namespace TextureTools
@@ -0,0 +1,203 @@
+#include "ChannelPacker.h"
+#include "ImageDecoder.h"
+#include "../../utils/FileUtils.h"
+#include "../../utils/Hash.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+namespace TextureTools
+{
+	namespace
+	{
+		/// Bump when the packing changes so old cooked files get replaced.
+		constexpr uint32_t ORM_COOK_VERSION = 1;
+
+		enum class ChannelRead
+		{
+			Red,
+			MaxRGB
+		};
+
+		uint8_t ReadTexel(const Image& image, uint32_t x, uint32_t y, ChannelRead read)
+		{
+			const uint8_t* px = image.GetPixel(x, y);
+			if (read == ChannelRead::MaxRGB)
+			{
+				return std::max({px[0], px[1], px[2]});
+			}
+			return px[0];
+		}
+
+		/// Writes one channel of out from image, resampling when the sizes
+		/// differ. Texel centres line up, edges clamp.
+		void FillChannel(Image& out, uint32_t channel, const Image* image, ChannelRead read)
+		{
+			if (!image || image->IsEmpty())
+			{
+				for (size_t i = channel; i < out.mPixels.size(); i += 4)
+				{
+					out.mPixels[i] = 255;
+				}
+				return;
+			}
+
+			if (image->mWidth == out.mWidth && image->mHeight == out.mHeight)
+			{
+				for (uint32_t y = 0; y < out.mHeight; ++y)
+				{
+					for (uint32_t x = 0; x < out.mWidth; ++x)
+					{
+						out.GetPixel(x, y)[channel] = ReadTexel(*image, x, y, read);
+					}
+				}
+				return;
+			}
+
+			const float scaleX = static_cast<float>(image->mWidth) / static_cast<float>(out.mWidth);
+			const float scaleY =
+				static_cast<float>(image->mHeight) / static_cast<float>(out.mHeight);
+			const float maxX = static_cast<float>(image->mWidth - 1);
+			const float maxY = static_cast<float>(image->mHeight - 1);
+			auto texel = [&](uint32_t x, uint32_t y) {
+				return static_cast<float>(ReadTexel(*image, x, y, read));
+			};
+
+			for (uint32_t y = 0; y < out.mHeight; ++y)
+			{
+				const float v =
+					std::clamp((static_cast<float>(y) + 0.5F) * scaleY - 0.5F, 0.0F, maxY);
+				const uint32_t y0 = static_cast<uint32_t>(v);
+				const uint32_t y1 = std::min(y0 + 1, image->mHeight - 1);
+				const float fy = v - static_cast<float>(y0);
+
+				for (uint32_t x = 0; x < out.mWidth; ++x)
+				{
+					const float u =
+						std::clamp((static_cast<float>(x) + 0.5F) * scaleX - 0.5F, 0.0F, maxX);
+					const uint32_t x0 = static_cast<uint32_t>(u);
+					const uint32_t x1 = std::min(x0 + 1, image->mWidth - 1);
+					const float fx = u - static_cast<float>(x0);
+
+					const float top = texel(x0, y0) * (1.0F - fx) + texel(x1, y0) * fx;
+					const float bottom = texel(x0, y1) * (1.0F - fx) + texel(x1, y1) * fx;
+					out.GetPixel(x, y)[channel] =
+						static_cast<uint8_t>(top * (1.0F - fy) + bottom * fy + 0.5F);
+				}
+			}
+		}
+
+		void SetError(std::string* error, const std::string& message)
+		{
+			if (error)
+			{
+				*error = message;
+			}
+		}
+	} // namespace
+
+	Image PackORM(const ORMImages& images)
+	{
+		uint32_t width = 1;
+		uint32_t height = 1;
+		for (const Image* image : {images.mOcclusion, images.mRoughness, images.mMetallic})
+		{
+			if (image && !image->IsEmpty())
+			{
+				width = std::max(width, image->mWidth);
+				height = std::max(height, image->mHeight);
+			}
+		}
+
+		Image out(width, height);
+		FillChannel(out, 0, images.mOcclusion, ChannelRead::Red);
+		FillChannel(out, 1, images.mRoughness, ChannelRead::Red);
+		FillChannel(out, 2, images.mMetallic, ChannelRead::MaxRGB);
+		FillChannel(out, 3, nullptr, ChannelRead::Red);
+		return out;
+	}
+
+	bool CookORM(const ORMSources& sources, const std::filesystem::path& cacheDir,
+				 std::filesystem::path& outPath, std::string* error)
+	{
+		if (sources.IsEmpty())
+		{
+			SetError(error, "no maps to pack");
+			return false;
+		}
+
+		const std::array<const std::filesystem::path*, 3> paths = {
+			&sources.mOcclusion, &sources.mRoughness, &sources.mMetallic};
+
+		// The key covers which maps are present and what is in them, so
+		// editing a map or swapping two of them cooks a new file.
+		std::array<std::vector<uint8_t>, 3> fileData;
+		Utils::Hasher64 hasher;
+		hasher.Update(&ORM_COOK_VERSION, sizeof(ORM_COOK_VERSION));
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			uint64_t contentHash = 0;
+			if (!paths[i]->empty())
+			{
+				if (GetImageFormat(*paths[i]) == ImageFormat::Unknown)
+				{
+					SetError(error, "unsupported image format: " + paths[i]->string());
+					return false;
+				}
+				if (!Utils::ReadBinaryFile(*paths[i], fileData[i], contentHash))
+				{
+					SetError(error, "failed to read " + paths[i]->string());
+					return false;
+				}
+			}
+
+			const uint8_t present = paths[i]->empty() ? 0 : 1;
+			hasher.Update(&present, sizeof(present));
+			hasher.Update(&contentHash, sizeof(contentHash));
+		}
+
+		char fileName[32];
+		std::snprintf(fileName, sizeof(fileName), "%016llx.tga",
+					  static_cast<unsigned long long>(hasher.Finalize()));
+		outPath = cacheDir / fileName;
+
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(outPath, ec))
+		{
+			return true;
+		}
+
+		std::array<Image, 3> decoded;
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			std::string decodeError;
+			if (!fileData[i].empty() &&
+				!DecodeImage(fileData[i].data(), fileData[i].size(), decoded[i], nullptr,
+							 &decodeError))
+			{
+				SetError(error, paths[i]->string() + ": " + decodeError);
+				return false;
+			}
+		}
+
+		ORMImages images;
+		images.mOcclusion = decoded[0].IsEmpty() ? nullptr : &decoded[0];
+		images.mRoughness = decoded[1].IsEmpty() ? nullptr : &decoded[1];
+		images.mMetallic = decoded[2].IsEmpty() ? nullptr : &decoded[2];
+
+		std::vector<uint8_t> encoded;
+		if (!EncodeTGA(PackORM(images), encoded))
+		{
+			SetError(error, "packed map is too large for TGA");
+			return false;
+		}
+
+		if (!Utils::WriteBinaryFile(outPath, encoded.data(), encoded.size()))
+		{
+			SetError(error, "failed to write " + outPath.string());
+			return false;
+		}
+		return true;
+	}
+} // namespace TextureTools
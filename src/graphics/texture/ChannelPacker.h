@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Image.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+/// Cook step that merges single channel material maps into one texture so
+/// the geometry pass does one fetch (and binds one descriptor) for all of
+/// them.
+namespace TextureTools
+{
+	/// Greyscale maps of a material, any of them may be null.
+	struct ORMImages
+	{
+		const Image* mOcclusion = nullptr;
+		const Image* mRoughness = nullptr;
+		const Image* mMetallic = nullptr;
+	};
+
+	/// Packs occlusion into R, roughness into G and metallic into B (the
+	/// glTF layout), alpha is 255. The output takes the largest input size
+	/// and smaller maps are bilinearly resampled to it. Occlusion and
+	/// roughness come from the red channel, metallic from max(r, g, b)
+	/// since some metallic maps are authored tinted. Missing maps are
+	/// white so the material factors apply unchanged.
+	Image PackORM(const ORMImages& images);
+
+	struct ORMSources
+	{
+		std::filesystem::path mOcclusion;
+		std::filesystem::path mRoughness;
+		std::filesystem::path mMetallic;
+
+		bool IsEmpty() const
+		{
+			return mOcclusion.empty() && mRoughness.empty() && mMetallic.empty();
+		}
+	};
+
+	/// Packs the maps at sources (PNG/JPEG/TGA, empty paths are skipped)
+	/// and writes the result as a TGA in cacheDir, named after the hash of
+	/// the source files. Later calls with unchanged sources only hash the
+	/// files and return the existing cooked file. outPath is the file to
+	/// load in place of the separate maps.
+	bool CookORM(const ORMSources& sources, const std::filesystem::path& cacheDir,
+				 std::filesystem::path& outPath, std::string* error = nullptr);
+} // namespace TextureTools
@@ -0,0 +1,770 @@
+#include "IBLBaker.h"
+#include "../../utils/FileUtils.h"
+#include "../../utils/Hash.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define JAR_IBL_SSE 1
+#endif
+
+namespace TextureTools
+{
+	namespace
+	{
+		constexpr float PI = 3.14159265358979F;
+
+		/// Bumped whenever the baked data changes meaning, old caches are
+		/// then ignored.
+		constexpr uint32_t IBL_CACHE_VERSION = 1;
+		constexpr char IBL_CACHE_MAGIC[4] = {'J', 'I', 'B', 'L'};
+
+		/// Rows of a cube face per job.
+		constexpr uint32_t TILE_ROWS = 8;
+
+		/// Real SH basis for a unit direction.
+		void EvaluateBasis(float x, float y, float z, float* basis)
+		{
+			basis[0] = 0.282095F;
+			basis[1] = 0.488603F * y;
+			basis[2] = 0.488603F * z;
+			basis[3] = 0.488603F * x;
+			basis[4] = 1.092548F * x * y;
+			basis[5] = 1.092548F * y * z;
+			basis[6] = 0.315392F * (3.0F * z * z - 1.0F);
+			basis[7] = 1.092548F * x * z;
+			basis[8] = 0.546274F * (x * x - y * y);
+		}
+
+		/// acc += pixel * weight on one float4.
+		void MulAdd4(float* acc, const float* pixel, float weight)
+		{
+#ifdef JAR_IBL_SSE
+			__m128 sum = _mm_loadu_ps(acc);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weight)));
+			_mm_storeu_ps(acc, sum);
+#else
+			for (int c = 0; c < 4; ++c)
+			{
+				acc[c] += pixel[c] * weight;
+			}
+#endif
+		}
+
+		/// Bilinear fetch with clamped edges, adds weight * texel to acc.
+		void AccumulateBilinear(const ImageF& image, float u, float v, float weight, float* acc,
+								bool wrapU)
+		{
+			const float fx = u * static_cast<float>(image.mWidth) - 0.5F;
+			const float fy = v * static_cast<float>(image.mHeight) - 0.5F;
+			const float x0f = std::floor(fx);
+			const float y0f = std::floor(fy);
+			const float tx = fx - x0f;
+			const float ty = fy - y0f;
+
+			const int32_t w = static_cast<int32_t>(image.mWidth);
+			const int32_t h = static_cast<int32_t>(image.mHeight);
+			int32_t x0 = static_cast<int32_t>(x0f);
+			int32_t x1 = x0 + 1;
+			if (wrapU)
+			{
+				x0 = ((x0 % w) + w) % w;
+				x1 = ((x1 % w) + w) % w;
+			}
+			else
+			{
+				x0 = std::clamp(x0, 0, w - 1);
+				x1 = std::clamp(x1, 0, w - 1);
+			}
+			const int32_t y0 = std::clamp(static_cast<int32_t>(y0f), 0, h - 1);
+			const int32_t y1 = std::clamp(static_cast<int32_t>(y0f) + 1, 0, h - 1);
+
+			MulAdd4(acc, image.GetPixel(x0, y0), weight * (1.0F - tx) * (1.0F - ty));
+			MulAdd4(acc, image.GetPixel(x1, y0), weight * tx * (1.0F - ty));
+			MulAdd4(acc, image.GetPixel(x0, y1), weight * (1.0F - tx) * ty);
+			MulAdd4(acc, image.GetPixel(x1, y1), weight * tx * ty);
+		}
+
+		/// Direction through a face texel, u and v in [-1, 1] with v going
+		/// down the face like D3D does.
+		void CubeDirection(uint32_t face, float u, float v, float* dir)
+		{
+			switch (face)
+			{
+			case 0:
+				dir[0] = 1.0F;
+				dir[1] = -v;
+				dir[2] = -u;
+				break;
+			case 1:
+				dir[0] = -1.0F;
+				dir[1] = -v;
+				dir[2] = u;
+				break;
+			case 2:
+				dir[0] = u;
+				dir[1] = 1.0F;
+				dir[2] = v;
+				break;
+			case 3:
+				dir[0] = u;
+				dir[1] = -1.0F;
+				dir[2] = -v;
+				break;
+			case 4:
+				dir[0] = u;
+				dir[1] = -v;
+				dir[2] = 1.0F;
+				break;
+			default:
+				dir[0] = -u;
+				dir[1] = -v;
+				dir[2] = -1.0F;
+				break;
+			}
+
+			const float invLength =
+				1.0F / std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+			dir[0] *= invLength;
+			dir[1] *= invLength;
+			dir[2] *= invLength;
+		}
+
+		/// Inverse of CubeDirection, u and v come out in [0, 1].
+		uint32_t DirectionToCube(const float* dir, float& u, float& v)
+		{
+			const float ax = std::abs(dir[0]);
+			const float ay = std::abs(dir[1]);
+			const float az = std::abs(dir[2]);
+
+			uint32_t face;
+			float sc;
+			float tc;
+			float ma;
+			if (ax >= ay && ax >= az)
+			{
+				face = dir[0] > 0.0F ? 0 : 1;
+				sc = dir[0] > 0.0F ? -dir[2] : dir[2];
+				tc = -dir[1];
+				ma = ax;
+			}
+			else if (ay >= az)
+			{
+				face = dir[1] > 0.0F ? 2 : 3;
+				sc = dir[0];
+				tc = dir[1] > 0.0F ? dir[2] : -dir[2];
+				ma = ay;
+			}
+			else
+			{
+				face = dir[2] > 0.0F ? 4 : 5;
+				sc = dir[2] > 0.0F ? dir[0] : -dir[0];
+				tc = -dir[1];
+				ma = az;
+			}
+
+			u = 0.5F * (sc / ma + 1.0F);
+			v = 0.5F * (tc / ma + 1.0F);
+			return face;
+		}
+
+		void SampleEquirect(const ImageF& equirect, const float* dir, float weight, float* acc)
+		{
+			const float phi = std::atan2(dir[2], dir[0]);
+			const float theta = std::acos(std::clamp(dir[1], -1.0F, 1.0F));
+			AccumulateBilinear(equirect, (phi + PI) / (2.0F * PI), theta / PI, weight, acc, true);
+		}
+
+		/// Trilinear fetch, lod is clamped to the chain.
+		void SampleCube(const CubeMap& cube, const float* dir, float lod, float weight, float* acc)
+		{
+			float u = 0.0F;
+			float v = 0.0F;
+			const uint32_t face = DirectionToCube(dir, u, v);
+
+			const float maxLod = static_cast<float>(cube.mLevels.size() - 1);
+			lod = std::clamp(lod, 0.0F, maxLod);
+			const uint32_t level0 = static_cast<uint32_t>(lod);
+			const uint32_t level1 = std::min(level0 + 1, static_cast<uint32_t>(maxLod));
+			const float t = lod - static_cast<float>(level0);
+
+			AccumulateBilinear(cube.mLevels[level0][face], u, v, weight * (1.0F - t), acc, false);
+			if (t > 0.0F)
+			{
+				AccumulateBilinear(cube.mLevels[level1][face], u, v, weight * t, acc, false);
+			}
+		}
+
+		float RadicalInverse(uint32_t bits)
+		{
+			bits = (bits << 16U) | (bits >> 16U);
+			bits = ((bits & 0x55555555U) << 1U) | ((bits & 0xAAAAAAAAU) >> 1U);
+			bits = ((bits & 0x33333333U) << 2U) | ((bits & 0xCCCCCCCCU) >> 2U);
+			bits = ((bits & 0x0F0F0F0FU) << 4U) | ((bits & 0xF0F0F0F0U) >> 4U);
+			bits = ((bits & 0x00FF00FFU) << 8U) | ((bits & 0xFF00FF00U) >> 8U);
+			return static_cast<float>(bits) * 2.3283064365386963e-10F;
+		}
+
+		/// GGX half vector around +z for the Hammersley point i of count.
+		void ImportanceSampleGGX(uint32_t i, uint32_t count, float alpha, float* h)
+		{
+			const float e1 = static_cast<float>(i) / static_cast<float>(count);
+			const float e2 = RadicalInverse(i);
+			const float phi = 2.0F * PI * e1;
+			const float cosTheta =
+				std::sqrt((1.0F - e2) / (1.0F + (alpha * alpha - 1.0F) * e2));
+			const float sinTheta = std::sqrt(std::max(0.0F, 1.0F - cosTheta * cosTheta));
+			h[0] = sinTheta * std::cos(phi);
+			h[1] = sinTheta * std::sin(phi);
+			h[2] = cosTheta;
+		}
+
+		/// Light direction in tangent space (N = V = +z) with its weight and
+		/// the source mip to read it from. Same for every texel of a level.
+		struct GGXSample
+		{
+			float mL[3];
+			float mNdotL;
+			float mLod;
+		};
+
+		std::vector<GGXSample> BuildGGXSamples(float roughness, uint32_t sampleCount,
+											   uint32_t sourceSize, uint32_t sourceLevels)
+		{
+			const float alpha = roughness * roughness;
+			const float texelSolidAngle =
+				4.0F * PI / (6.0F * static_cast<float>(sourceSize) * static_cast<float>(sourceSize));
+
+			std::vector<GGXSample> samples;
+			samples.reserve(sampleCount);
+			for (uint32_t i = 0; i < sampleCount; ++i)
+			{
+				float h[3];
+				ImportanceSampleGGX(i, sampleCount, alpha, h);
+
+				// L = reflect(-V, H) with V = N = +z.
+				GGXSample sample{};
+				sample.mL[0] = 2.0F * h[2] * h[0];
+				sample.mL[1] = 2.0F * h[2] * h[1];
+				sample.mL[2] = 2.0F * h[2] * h[2] - 1.0F;
+				sample.mNdotL = sample.mL[2];
+				if (sample.mNdotL <= 0.0F)
+				{
+					continue;
+				}
+
+				// pdf of L is D * NdotH / (4 * VdotH), which is D / 4 here.
+				const float a2 = alpha * alpha;
+				const float denom = h[2] * h[2] * (a2 - 1.0F) + 1.0F;
+				const float d = a2 / (PI * denom * denom);
+				const float pdf = d * 0.25F;
+				const float sampleSolidAngle =
+					1.0F / (static_cast<float>(sampleCount) * pdf + 0.0001F);
+
+				// Read the mip whose texels cover about as much of the sphere
+				// as the sample does, +1 for a bit of extra smoothing.
+				sample.mLod = roughness == 0.0F
+								  ? 0.0F
+								  : std::clamp(0.5F * std::log2(sampleSolidAngle / texelSolidAngle) +
+												   1.0F,
+											   0.0F, static_cast<float>(sourceLevels - 1));
+				samples.push_back(sample);
+			}
+			return samples;
+		}
+
+		void DownsampleFace(const ImageF& src, ImageF& dst)
+		{
+			for (uint32_t y = 0; y < dst.mHeight; ++y)
+			{
+				for (uint32_t x = 0; x < dst.mWidth; ++x)
+				{
+					float acc[4] = {};
+					MulAdd4(acc, src.GetPixel(x * 2, y * 2), 0.25F);
+					MulAdd4(acc, src.GetPixel(x * 2 + 1, y * 2), 0.25F);
+					MulAdd4(acc, src.GetPixel(x * 2, y * 2 + 1), 0.25F);
+					MulAdd4(acc, src.GetPixel(x * 2 + 1, y * 2 + 1), 0.25F);
+					std::memcpy(dst.GetPixel(x, y), acc, sizeof(acc));
+				}
+			}
+		}
+
+		template <typename T>
+		void Append(std::vector<uint8_t>& out, const T& value)
+		{
+			const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+			out.insert(out.end(), bytes, bytes + sizeof(T));
+		}
+
+		void AppendFloats(std::vector<uint8_t>& out, const std::vector<float>& values)
+		{
+			const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+			out.insert(out.end(), bytes, bytes + values.size() * sizeof(float));
+		}
+
+		/// Bounds checked reads over the cache file.
+		struct Reader
+		{
+			const std::vector<uint8_t>& mData;
+			size_t mOffset = 0;
+
+			template <typename T>
+			bool Read(T& value)
+			{
+				return ReadBytes(&value, sizeof(T));
+			}
+
+			bool ReadBytes(void* dst, size_t size)
+			{
+				if (mData.size() - mOffset < size)
+				{
+					return false;
+				}
+				std::memcpy(dst, mData.data() + mOffset, size);
+				mOffset += size;
+				return true;
+			}
+		};
+	} // namespace
+
+	SHCoefficients ProjectToSH(const ImageF& equirect, Utils::ThreadPool& pool)
+	{
+		SHCoefficients result;
+		if (equirect.mWidth == 0 || equirect.mHeight == 0)
+		{
+			return result;
+		}
+
+		// Every row sums into its own slot so the reduction below always
+		// adds in the same order, no matter how the rows got scheduled.
+		std::vector<std::array<float, 9 * 4>> rowSums(equirect.mHeight);
+
+		std::vector<float> cosPhi(equirect.mWidth);
+		std::vector<float> sinPhi(equirect.mWidth);
+		for (uint32_t x = 0; x < equirect.mWidth; ++x)
+		{
+			const float phi =
+				(static_cast<float>(x) + 0.5F) / static_cast<float>(equirect.mWidth) * 2.0F * PI -
+				PI;
+			cosPhi[x] = std::cos(phi);
+			sinPhi[x] = std::sin(phi);
+		}
+
+		pool.ParallelFor(equirect.mHeight, [&](uint32_t y) {
+			const float theta =
+				(static_cast<float>(y) + 0.5F) / static_cast<float>(equirect.mHeight) * PI;
+			const float sinTheta = std::sin(theta);
+			const float cosTheta = std::cos(theta);
+
+			// Solid angle of a texel in this row.
+			const float weight = (2.0F * PI / static_cast<float>(equirect.mWidth)) *
+								 (PI / static_cast<float>(equirect.mHeight)) * sinTheta;
+
+			std::array<float, 9 * 4>& acc = rowSums[y];
+			acc.fill(0.0F);
+			float basis[9];
+			for (uint32_t x = 0; x < equirect.mWidth; ++x)
+			{
+				EvaluateBasis(sinTheta * cosPhi[x], cosTheta, sinTheta * sinPhi[x], basis);
+				const float* pixel = equirect.GetPixel(x, y);
+				for (uint32_t k = 0; k < 9; ++k)
+				{
+					MulAdd4(acc.data() + k * 4, pixel, basis[k] * weight);
+				}
+			}
+		});
+
+		for (const auto& acc : rowSums)
+		{
+			for (uint32_t k = 0; k < 9; ++k)
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					result.mCoefficients[k][c] += acc[k * 4 + c];
+				}
+			}
+		}
+		return result;
+	}
+
+	SHCoefficients ConvolveIrradiance(const SHCoefficients& radiance)
+	{
+		// Clamped cosine lobe per band (pi, 2pi/3, pi/4), divided by pi.
+		constexpr float BAND_SCALE[9] = {1.0F,		   2.0F / 3.0F, 2.0F / 3.0F,
+										 2.0F / 3.0F, 0.25F,	   0.25F,
+										 0.25F,		   0.25F,	   0.25F};
+
+		SHCoefficients irradiance;
+		for (uint32_t k = 0; k < 9; ++k)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				irradiance.mCoefficients[k][c] = radiance.mCoefficients[k][c] * BAND_SCALE[k];
+			}
+		}
+		return irradiance;
+	}
+
+	std::array<float, 3> EvaluateSH(const SHCoefficients& sh, float x, float y, float z)
+	{
+		float basis[9];
+		EvaluateBasis(x, y, z, basis);
+
+		std::array<float, 3> result{};
+		for (uint32_t k = 0; k < 9; ++k)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				result[c] += sh.mCoefficients[k][c] * basis[k];
+			}
+		}
+		return result;
+	}
+
+	CubeMap EquirectToCube(const ImageF& equirect, uint32_t size, Utils::ThreadPool& pool)
+	{
+		CubeMap cube;
+		cube.mSize = std::bit_floor(std::max(size, 1U));
+
+		const uint32_t levelCount = static_cast<uint32_t>(std::bit_width(cube.mSize));
+		cube.mLevels.resize(levelCount);
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			const uint32_t levelSize = cube.mSize >> level;
+			for (ImageF& face : cube.mLevels[level])
+			{
+				face = ImageF(levelSize, levelSize);
+			}
+		}
+
+		// 2x2 samples per texel, the source is usually a lot bigger than a
+		// face.
+		const uint32_t tilesPerFace = (cube.mSize + TILE_ROWS - 1) / TILE_ROWS;
+		pool.ParallelFor(6 * tilesPerFace, [&](uint32_t job) {
+			const uint32_t face = job / tilesPerFace;
+			const uint32_t rowBegin = (job % tilesPerFace) * TILE_ROWS;
+			const uint32_t rowEnd = std::min(rowBegin + TILE_ROWS, cube.mSize);
+			ImageF& dst = cube.mLevels[0][face];
+			const float invSize = 1.0F / static_cast<float>(cube.mSize);
+
+			for (uint32_t y = rowBegin; y < rowEnd; ++y)
+			{
+				for (uint32_t x = 0; x < cube.mSize; ++x)
+				{
+					float acc[4] = {};
+					for (uint32_t s = 0; s < 4; ++s)
+					{
+						const float u = (static_cast<float>(x) + 0.25F + 0.5F * (s & 1)) * invSize;
+						const float v = (static_cast<float>(y) + 0.25F + 0.5F * (s >> 1)) * invSize;
+						float dir[3];
+						CubeDirection(face, u * 2.0F - 1.0F, v * 2.0F - 1.0F, dir);
+						SampleEquirect(equirect, dir, 0.25F, acc);
+					}
+					std::memcpy(dst.GetPixel(x, y), acc, sizeof(acc));
+				}
+			}
+		});
+
+		for (uint32_t level = 1; level < levelCount; ++level)
+		{
+			pool.ParallelFor(6, [&](uint32_t face) {
+				DownsampleFace(cube.mLevels[level - 1][face], cube.mLevels[level][face]);
+			});
+		}
+		return cube;
+	}
+
+	CubeMap PrefilterGGX(const CubeMap& source, uint32_t mipLevels, uint32_t sampleCount,
+						 Utils::ThreadPool& pool)
+	{
+		CubeMap result;
+		if (source.mLevels.empty())
+		{
+			return result;
+		}
+
+		result.mSize = source.mSize;
+		const uint32_t levelCount = std::clamp<uint32_t>(
+			mipLevels, 1, static_cast<uint32_t>(std::bit_width(source.mSize)));
+		result.mLevels.resize(levelCount);
+
+		// Mirror-like, just the source.
+		result.mLevels[0] = source.mLevels[0];
+
+		for (uint32_t level = 1; level < levelCount; ++level)
+		{
+			const float roughness =
+				static_cast<float>(level) / static_cast<float>(levelCount - 1);
+			const std::vector<GGXSample> samples =
+				BuildGGXSamples(roughness, sampleCount, source.mSize,
+								static_cast<uint32_t>(source.mLevels.size()));
+
+			const uint32_t levelSize = source.mSize >> level;
+			for (ImageF& face : result.mLevels[level])
+			{
+				face = ImageF(levelSize, levelSize);
+			}
+
+			const uint32_t tilesPerFace = (levelSize + TILE_ROWS - 1) / TILE_ROWS;
+			pool.ParallelFor(6 * tilesPerFace, [&](uint32_t job) {
+				const uint32_t face = job / tilesPerFace;
+				const uint32_t rowBegin = (job % tilesPerFace) * TILE_ROWS;
+				const uint32_t rowEnd = std::min(rowBegin + TILE_ROWS, levelSize);
+				ImageF& dst = result.mLevels[level][face];
+				const float invSize = 1.0F / static_cast<float>(levelSize);
+
+				for (uint32_t y = rowBegin; y < rowEnd; ++y)
+				{
+					for (uint32_t x = 0; x < levelSize; ++x)
+					{
+						float n[3];
+						CubeDirection(face, (static_cast<float>(x) + 0.5F) * invSize * 2.0F - 1.0F,
+									  (static_cast<float>(y) + 0.5F) * invSize * 2.0F - 1.0F, n);
+
+						// Tangent frame around the texel's direction.
+						const float up[3] = {std::abs(n[2]) < 0.999F ? 0.0F : 1.0F, 0.0F,
+											 std::abs(n[2]) < 0.999F ? 1.0F : 0.0F};
+						float t[3] = {up[1] * n[2] - up[2] * n[1], up[2] * n[0] - up[0] * n[2],
+									  up[0] * n[1] - up[1] * n[0]};
+						const float invT = 1.0F / std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+						t[0] *= invT;
+						t[1] *= invT;
+						t[2] *= invT;
+						const float b[3] = {n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2],
+											n[0] * t[1] - n[1] * t[0]};
+
+						float acc[4] = {};
+						float totalWeight = 0.0F;
+						for (const GGXSample& sample : samples)
+						{
+							float l[3];
+							for (uint32_t c = 0; c < 3; ++c)
+							{
+								l[c] = t[c] * sample.mL[0] + b[c] * sample.mL[1] +
+									   n[c] * sample.mL[2];
+							}
+							SampleCube(source, l, sample.mLod, sample.mNdotL, acc);
+							totalWeight += sample.mNdotL;
+						}
+
+						float* out = dst.GetPixel(x, y);
+						const float invWeight = totalWeight > 0.0F ? 1.0F / totalWeight : 0.0F;
+						out[0] = acc[0] * invWeight;
+						out[1] = acc[1] * invWeight;
+						out[2] = acc[2] * invWeight;
+						out[3] = 1.0F;
+					}
+				}
+			});
+		}
+		return result;
+	}
+
+	BrdfLut IntegrateBrdfLut(uint32_t size, uint32_t sampleCount, Utils::ThreadPool& pool)
+	{
+		BrdfLut lut;
+		lut.mSize = size;
+		lut.mData.assign(static_cast<size_t>(size) * size * 2, 0.0F);
+
+		// Four samples per step, round the count up so there is no tail.
+		const uint32_t count = (std::max(sampleCount, 4U) + 3) & ~3U;
+
+		pool.ParallelFor(size, [&](uint32_t row) {
+			const float roughness = (static_cast<float>(row) + 0.5F) / static_cast<float>(size);
+			const float alpha = roughness * roughness;
+			const float k = alpha * 0.5F;
+
+			// V lies in the xz plane so only H.x and H.z matter, and they only
+			// depend on the roughness, not on NdotV.
+			std::vector<float> hx(count);
+			std::vector<float> hz(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				float h[3];
+				ImportanceSampleGGX(i, count, alpha, h);
+				hx[i] = h[0];
+				hz[i] = h[2];
+			}
+
+			for (uint32_t column = 0; column < size; ++column)
+			{
+				const float nDotV = (static_cast<float>(column) + 0.5F) / static_cast<float>(size);
+				const float vx = std::sqrt(1.0F - nDotV * nDotV);
+				const float vz = nDotV;
+				const float g1V = nDotV / (nDotV * (1.0F - k) + k);
+
+				float scale = 0.0F;
+				float bias = 0.0F;
+#ifdef JAR_IBL_SSE
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0F);
+				const __m128 two = _mm_set1_ps(2.0F);
+				const __m128 kv = _mm_set1_ps(k);
+				const __m128 oneMinusK = _mm_set1_ps(1.0F - k);
+				const __m128 vxv = _mm_set1_ps(vx);
+				const __m128 vzv = _mm_set1_ps(vz);
+				// G1(V) / NdotV, the NdotV of the visibility term cancels out.
+				const __m128 g1VOverNdotV = _mm_set1_ps(g1V / nDotV);
+				__m128 scaleAcc = zero;
+				__m128 biasAcc = zero;
+				for (uint32_t i = 0; i < count; i += 4)
+				{
+					const __m128 hxv = _mm_loadu_ps(hx.data() + i);
+					const __m128 hzv = _mm_loadu_ps(hz.data() + i);
+					const __m128 vDotH = _mm_add_ps(_mm_mul_ps(vxv, hxv), _mm_mul_ps(vzv, hzv));
+					const __m128 nDotL = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(two, vDotH), hzv), vzv);
+					const __m128 valid = _mm_cmpgt_ps(nDotL, zero);
+
+					const __m128 safeNdotL = _mm_max_ps(nDotL, _mm_set1_ps(1e-6F));
+					const __m128 g1L =
+						_mm_div_ps(safeNdotL, _mm_add_ps(_mm_mul_ps(safeNdotL, oneMinusK), kv));
+					const __m128 safeNdotH = _mm_max_ps(hzv, _mm_set1_ps(1e-6F));
+					const __m128 gVis = _mm_div_ps(
+						_mm_mul_ps(_mm_mul_ps(g1L, g1VOverNdotV), _mm_max_ps(vDotH, zero)),
+						safeNdotH);
+
+					const __m128 oneMinusVdotH = _mm_max_ps(_mm_sub_ps(one, vDotH), zero);
+					const __m128 sq = _mm_mul_ps(oneMinusVdotH, oneMinusVdotH);
+					const __m128 fc = _mm_mul_ps(_mm_mul_ps(sq, sq), oneMinusVdotH);
+
+					const __m128 maskedVis = _mm_and_ps(gVis, valid);
+					scaleAcc = _mm_add_ps(scaleAcc, _mm_mul_ps(_mm_sub_ps(one, fc), maskedVis));
+					biasAcc = _mm_add_ps(biasAcc, _mm_mul_ps(fc, maskedVis));
+				}
+
+				float lanes[4];
+				_mm_storeu_ps(lanes, scaleAcc);
+				scale = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+				_mm_storeu_ps(lanes, biasAcc);
+				bias = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const float vDotH = vx * hx[i] + vz * hz[i];
+					const float nDotL = 2.0F * vDotH * hz[i] - vz;
+					if (nDotL <= 0.0F)
+					{
+						continue;
+					}
+
+					const float g1L = nDotL / (nDotL * (1.0F - k) + k);
+					const float gVis = g1L * (g1V / nDotV) * vDotH / hz[i];
+					const float fc = std::pow(1.0F - vDotH, 5.0F);
+					scale += (1.0F - fc) * gVis;
+					bias += fc * gVis;
+				}
+#endif
+				float* out = lut.mData.data() + (static_cast<size_t>(row) * size + column) * 2;
+				out[0] = scale / static_cast<float>(count);
+				out[1] = bias / static_cast<float>(count);
+			}
+		});
+		return lut;
+	}
+
+	IBLData BakeIBL(const ImageF& equirect, const IBLDesc& desc, Utils::ThreadPool& pool)
+	{
+		IBLData data;
+		data.mIrradiance = ConvolveIrradiance(ProjectToSH(equirect, pool));
+
+		CubeMap source = EquirectToCube(equirect, desc.mCubeSize, pool);
+		data.mPrefiltered = PrefilterGGX(source, desc.mMipLevels, desc.mSampleCount, pool);
+		data.mBrdfLut = IntegrateBrdfLut(desc.mLutSize, desc.mLutSampleCount, pool);
+		return data;
+	}
+
+	uint64_t ComputeIBLKey(uint64_t sourceHash, const IBLDesc& desc)
+	{
+		Utils::Hasher64 hasher;
+		hasher.Update(&sourceHash, sizeof(sourceHash));
+		hasher.Update(&IBL_CACHE_VERSION, sizeof(IBL_CACHE_VERSION));
+		const uint32_t settings[] = {desc.mCubeSize, desc.mMipLevels, desc.mSampleCount,
+									 desc.mLutSize, desc.mLutSampleCount};
+		hasher.Update(settings, sizeof(settings));
+		return hasher.Finalize();
+	}
+
+	bool SaveIBLCache(const std::filesystem::path& path, uint64_t key, const IBLData& data)
+	{
+		std::vector<uint8_t> out;
+		out.insert(out.end(), IBL_CACHE_MAGIC, IBL_CACHE_MAGIC + 4);
+		Append(out, IBL_CACHE_VERSION);
+		Append(out, key);
+		Append(out, data.mIrradiance);
+		Append(out, data.mPrefiltered.mSize);
+		Append(out, static_cast<uint32_t>(data.mPrefiltered.mLevels.size()));
+		for (const auto& level : data.mPrefiltered.mLevels)
+		{
+			for (const ImageF& face : level)
+			{
+				AppendFloats(out, face.mPixels);
+			}
+		}
+		Append(out, data.mBrdfLut.mSize);
+		AppendFloats(out, data.mBrdfLut.mData);
+
+		return Utils::WriteBinaryFile(path, out.data(), out.size());
+	}
+
+	bool LoadIBLCache(const std::filesystem::path& path, uint64_t key, IBLData& data)
+	{
+		std::vector<uint8_t> bytes;
+		if (!Utils::ReadBinaryFile(path, bytes))
+		{
+			return false;
+		}
+
+		Reader reader{bytes};
+		char magic[4] = {};
+		uint32_t version = 0;
+		uint64_t storedKey = 0;
+		if (!reader.ReadBytes(magic, sizeof(magic)) ||
+			std::memcmp(magic, IBL_CACHE_MAGIC, sizeof(magic)) != 0 || !reader.Read(version) ||
+			version != IBL_CACHE_VERSION || !reader.Read(storedKey) || storedKey != key)
+		{
+			return false;
+		}
+
+		IBLData loaded;
+		uint32_t levelCount = 0;
+		if (!reader.Read(loaded.mIrradiance) || !reader.Read(loaded.mPrefiltered.mSize) ||
+			!reader.Read(levelCount) || loaded.mPrefiltered.mSize == 0 ||
+			levelCount > static_cast<uint32_t>(std::bit_width(loaded.mPrefiltered.mSize)))
+		{
+			return false;
+		}
+
+		loaded.mPrefiltered.mLevels.resize(levelCount);
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			const uint32_t levelSize = loaded.mPrefiltered.mSize >> level;
+			for (ImageF& face : loaded.mPrefiltered.mLevels[level])
+			{
+				face = ImageF(levelSize, levelSize);
+				if (!reader.ReadBytes(face.mPixels.data(), face.mPixels.size() * sizeof(float)))
+				{
+					return false;
+				}
+			}
+		}
+
+		if (!reader.Read(loaded.mBrdfLut.mSize) || loaded.mBrdfLut.mSize > 4096)
+		{
+			return false;
+		}
+		loaded.mBrdfLut.mData.resize(static_cast<size_t>(loaded.mBrdfLut.mSize) *
+									 loaded.mBrdfLut.mSize * 2);
+		if (!reader.ReadBytes(loaded.mBrdfLut.mData.data(),
+							  loaded.mBrdfLut.mData.size() * sizeof(float)))
+		{
+			return false;
+		}
+
+		data = std::move(loaded);
+		return true;
+	}
+} // namespace TextureTools
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Image.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+/// CPU side image based lighting precompute: diffuse irradiance as
+/// spherical harmonics, a GGX prefiltered cubemap for specular and the
+/// split sum BRDF lookup table.
+namespace TextureTools
+{
+	/// 9 coefficient (3 band) SH with rgb per coefficient, in the usual
+	/// real basis order Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22.
+	struct SHCoefficients
+	{
+		std::array<std::array<float, 3>, 9> mCoefficients{};
+	};
+
+	/// Faces in D3D order: +X, -X, +Y, -Y, +Z, -Z.
+	struct CubeMap
+	{
+		uint32_t mSize = 0;
+		/// mLevels[mip][face], level n is mSize >> n wide.
+		std::vector<std::array<ImageF, 6>> mLevels;
+	};
+
+	/// Scale and bias to F0 for the split sum, x is NdotV and y is
+	/// roughness. Two floats per texel.
+	struct BrdfLut
+	{
+		uint32_t mSize = 0;
+		std::vector<float> mData;
+	};
+
+	struct IBLDesc
+	{
+		/// Size of the prefiltered cube's top level.
+		uint32_t mCubeSize = 256;
+		/// Roughness goes from 0 at the top level to 1 at the last one.
+		uint32_t mMipLevels = 6;
+		uint32_t mSampleCount = 256;
+
+		uint32_t mLutSize = 128;
+		uint32_t mLutSampleCount = 512;
+	};
+
+	struct IBLData
+	{
+		/// Already convolved with the cosine lobe and divided by pi, so the
+		/// diffuse term is just albedo * EvaluateSH(irradiance, n).
+		SHCoefficients mIrradiance;
+		CubeMap mPrefiltered;
+		BrdfLut mBrdfLut;
+	};
+
+	/// Projects the radiance of a lat-long (equirectangular) HDR image onto
+	/// SH. Rows run on the pool and the accumulation is done with SSE.
+	SHCoefficients ProjectToSH(const ImageF& equirect, Utils::ThreadPool& pool);
+
+	/// Radiance SH to irradiance / pi (Ramamoorthi and Hanrahan).
+	SHCoefficients ConvolveIrradiance(const SHCoefficients& radiance);
+
+	std::array<float, 3> EvaluateSH(const SHCoefficients& sh, float x, float y, float z);
+
+	/// Resamples a lat-long image into a cube with a box filtered mip chain
+	/// down to 1x1.
+	CubeMap EquirectToCube(const ImageF& equirect, uint32_t size, Utils::ThreadPool& pool);
+
+	/// GGX prefiltered chain with N = V = R. Every sample reads the source
+	/// mip that matches its solid angle (filtered importance sampling), so
+	/// few samples are enough and the result doesn't sparkle. The source
+	/// needs its full mip chain (see EquirectToCube).
+	CubeMap PrefilterGGX(const CubeMap& source, uint32_t mipLevels, uint32_t sampleCount,
+						 Utils::ThreadPool& pool);
+
+	/// Split sum scale/bias table. The samples of a row share the same
+	/// roughness and get evaluated four at a time with SSE.
+	BrdfLut IntegrateBrdfLut(uint32_t size, uint32_t sampleCount, Utils::ThreadPool& pool);
+
+	/// All three of the above from a lat-long HDR image.
+	IBLData BakeIBL(const ImageF& equirect, const IBLDesc& desc, Utils::ThreadPool& pool);
+
+	/// Key for the disk cache from the hash of the source file and the
+	/// settings it was baked with.
+	uint64_t ComputeIBLKey(uint64_t sourceHash, const IBLDesc& desc);
+
+	/// Raw dump of IBLData. Loading fails on a missing file, a different
+	/// key or version, or a truncated file.
+	bool SaveIBLCache(const std::filesystem::path& path, uint64_t key, const IBLData& data);
+	bool LoadIBLCache(const std::filesystem::path& path, uint64_t key, IBLData& data);
+} // namespace TextureTools
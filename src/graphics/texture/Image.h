@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// CPU side image containers for the texture cook path. These do not
+/// depend on D3D12 so the cooking code can be tested on any platform.
+namespace TextureTools
+{
+	/// 8 bit per channel RGBA image with tightly packed rows. This is the
+	/// layout handed to Texture for uploading.
+	struct Image
+	{
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		std::vector<uint8_t> mPixels;
+
+		Image() = default;
+		Image(uint32_t width, uint32_t height)
+		: mWidth(width)
+		, mHeight(height)
+		, mPixels(static_cast<size_t>(width) * height * 4)
+		{
+		}
+
+		uint32_t GetRowPitch() const { return mWidth * 4; }
+		size_t GetSizeInBytes() const { return mPixels.size(); }
+		bool IsEmpty() const { return mWidth == 0 || mHeight == 0; }
+
+		uint8_t* GetPixel(uint32_t x, uint32_t y)
+		{
+			return mPixels.data() + ((static_cast<size_t>(y) * mWidth + x) * 4);
+		}
+		const uint8_t* GetPixel(uint32_t x, uint32_t y) const
+		{
+			return mPixels.data() + ((static_cast<size_t>(y) * mWidth + x) * 4);
+		}
+	};
+
+	/// 32 bit float RGBA image, always in linear space. Intermediate format
+	/// used while filtering so we don't lose precision between mip levels.
+	struct ImageF
+	{
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		std::vector<float> mPixels;
+
+		ImageF() = default;
+		ImageF(uint32_t width, uint32_t height)
+		: mWidth(width)
+		, mHeight(height)
+		, mPixels(static_cast<size_t>(width) * height * 4)
+		{
+		}
+
+		float* GetPixel(uint32_t x, uint32_t y)
+		{
+			return mPixels.data() + ((static_cast<size_t>(y) * mWidth + x) * 4);
+		}
+		const float* GetPixel(uint32_t x, uint32_t y) const
+		{
+			return mPixels.data() + ((static_cast<size_t>(y) * mWidth + x) * 4);
+		}
+	};
+} // namespace TextureTools
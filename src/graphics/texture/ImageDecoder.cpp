@@ -0,0 +1,356 @@
+#include "ImageDecoder.h"
+#include "../../utils/FileUtils.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSSE3__)
+#include <tmmintrin.h>
+#define JAR_DECODE_SSSE3 1
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_TGA
+#define STBI_ONLY_HDR
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include <stb_image.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace TextureTools
+{
+	namespace
+	{
+		void SetError(std::string* error, const std::string& message)
+		{
+			if (error)
+			{
+				*error = message;
+			}
+		}
+	} // namespace
+
+	ImageFormat GetImageFormat(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		});
+
+		if (extension == ".png")
+		{
+			return ImageFormat::PNG;
+		}
+		if (extension == ".jpg" || extension == ".jpeg")
+		{
+			return ImageFormat::JPEG;
+		}
+		if (extension == ".tga")
+		{
+			return ImageFormat::TGA;
+		}
+		return ImageFormat::Unknown;
+	}
+
+	StagingPool::StagingPool(size_t maxPooledBytes)
+	: mMaxPooledBytes(maxPooledBytes)
+	{
+	}
+
+	std::vector<uint8_t> StagingPool::Acquire(size_t size)
+	{
+		std::vector<uint8_t> buffer;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			auto best = mBuffers.end();
+			for (auto it = mBuffers.begin(); it != mBuffers.end(); ++it)
+			{
+				if (it->capacity() >= size &&
+					(best == mBuffers.end() || it->capacity() < best->capacity()))
+				{
+					best = it;
+				}
+			}
+
+			if (best != mBuffers.end())
+			{
+				buffer = std::move(*best);
+				mBuffers.erase(best);
+				mPooledBytes -= buffer.capacity();
+				mReuseCount++;
+			}
+		}
+
+		buffer.resize(size);
+		return buffer;
+	}
+
+	void StagingPool::Release(std::vector<uint8_t>&& buffer)
+	{
+		if (buffer.capacity() == 0)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mPooledBytes + buffer.capacity() > mMaxPooledBytes)
+		{
+			return;
+		}
+
+		mPooledBytes += buffer.capacity();
+		buffer.clear();
+		mBuffers.push_back(std::move(buffer));
+	}
+
+	size_t StagingPool::GetPooledBytes() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mPooledBytes;
+	}
+
+	uint64_t StagingPool::GetReuseCount() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mReuseCount;
+	}
+
+	StagingPool& StagingPool::GetDefault()
+	{
+		static StagingPool sPool;
+		return sPool;
+	}
+
+	void ExpandToRGBA(const uint8_t* src, size_t pixelCount, uint32_t channels, uint8_t* dst)
+	{
+		if (channels == 4)
+		{
+			std::memcpy(dst, src, pixelCount * 4);
+			return;
+		}
+
+		size_t i = 0;
+
+#ifdef JAR_DECODE_SSSE3
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		if (channels == 3)
+		{
+			// 16 pixels per loop, 48 bytes in and 64 out. alignr lines each
+			// group of 4 pixels up at the start of a register.
+			const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			for (; i + 16 <= pixelCount; i += 16)
+			{
+				const uint8_t* s = src + i * 3;
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+				__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+
+				__m128i p0 = _mm_shuffle_epi8(a, mask);
+				__m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), mask);
+				__m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), mask);
+				__m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(c, 4), mask);
+
+				__m128i* d = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(d, _mm_or_si128(p0, alpha));
+				_mm_storeu_si128(d + 1, _mm_or_si128(p1, alpha));
+				_mm_storeu_si128(d + 2, _mm_or_si128(p2, alpha));
+				_mm_storeu_si128(d + 3, _mm_or_si128(p3, alpha));
+			}
+		}
+		else if (channels == 1)
+		{
+			for (; i + 16 <= pixelCount; i += 16)
+			{
+				__m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				__m128i lo = _mm_unpacklo_epi8(g, g);
+				__m128i hi = _mm_unpackhi_epi8(g, g);
+
+				__m128i* d = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(d, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+				_mm_storeu_si128(d + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+				_mm_storeu_si128(d + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+				_mm_storeu_si128(d + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+			}
+		}
+		else if (channels == 2)
+		{
+			const __m128i maskLo = _mm_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7);
+			const __m128i maskHi =
+				_mm_setr_epi8(8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15);
+			for (; i + 8 <= pixelCount; i += 8)
+			{
+				__m128i ga = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+
+				__m128i* d = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(d, _mm_shuffle_epi8(ga, maskLo));
+				_mm_storeu_si128(d + 1, _mm_shuffle_epi8(ga, maskHi));
+			}
+		}
+#endif
+
+		for (; i < pixelCount; ++i)
+		{
+			const uint8_t* s = src + i * channels;
+			uint8_t* d = dst + i * 4;
+			switch (channels)
+			{
+			case 1:
+				d[0] = d[1] = d[2] = s[0];
+				d[3] = 255;
+				break;
+			case 2:
+				d[0] = d[1] = d[2] = s[0];
+				d[3] = s[1];
+				break;
+			default:
+				d[0] = s[0];
+				d[1] = s[1];
+				d[2] = s[2];
+				d[3] = 255;
+				break;
+			}
+		}
+	}
+
+	bool DecodeImage(const uint8_t* data, size_t size, Image& out, StagingPool* staging,
+					 std::string* error)
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+
+		// Ask for the native channel count, the expansion to RGBA below is
+		// faster than stb's scalar conversion.
+		stbi_uc* decoded =
+			stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 0);
+		if (!decoded)
+		{
+			SetError(error, stbi_failure_reason() ? stbi_failure_reason() : "unknown error");
+			return false;
+		}
+
+		out.mWidth = static_cast<uint32_t>(width);
+		out.mHeight = static_cast<uint32_t>(height);
+
+		size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+		if (staging)
+		{
+			out.mPixels = staging->Acquire(pixelCount * 4);
+		}
+		else
+		{
+			out.mPixels.resize(pixelCount * 4);
+		}
+
+		ExpandToRGBA(decoded, pixelCount, static_cast<uint32_t>(channels), out.mPixels.data());
+		stbi_image_free(decoded);
+		return true;
+	}
+
+	bool DecodeHDRImage(const uint8_t* data, size_t size, ImageF& out, std::string* error)
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		float* decoded =
+			stbi_loadf_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4);
+		if (!decoded)
+		{
+			SetError(error, stbi_failure_reason() ? stbi_failure_reason() : "unknown error");
+			return false;
+		}
+
+		out = ImageF(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+		std::memcpy(out.mPixels.data(), decoded, out.mPixels.size() * sizeof(float));
+		stbi_image_free(decoded);
+		return true;
+	}
+
+	bool GetImageInfo(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height)
+	{
+		int w = 0;
+		int h = 0;
+		int channels = 0;
+		if (!stbi_info_from_memory(data, static_cast<int>(size), &w, &h, &channels))
+		{
+			return false;
+		}
+
+		width = static_cast<uint32_t>(w);
+		height = static_cast<uint32_t>(h);
+		return true;
+	}
+
+	bool EncodeTGA(const Image& image, std::vector<uint8_t>& out)
+	{
+		if (image.IsEmpty() || image.mWidth > 0xFFFF || image.mHeight > 0xFFFF)
+		{
+			return false;
+		}
+
+		const size_t TGA_HEADER_SIZE = 18;
+		out.assign(TGA_HEADER_SIZE + image.GetSizeInBytes(), 0);
+
+		// Uncompressed true colour, 8 alpha bits, origin at the top left.
+		out[2] = 2;
+		out[12] = static_cast<uint8_t>(image.mWidth & 0xFF);
+		out[13] = static_cast<uint8_t>(image.mWidth >> 8);
+		out[14] = static_cast<uint8_t>(image.mHeight & 0xFF);
+		out[15] = static_cast<uint8_t>(image.mHeight >> 8);
+		out[16] = 32;
+		out[17] = 0x28;
+
+		// TGA stores BGRA.
+		uint8_t* dst = out.data() + TGA_HEADER_SIZE;
+		const uint8_t* src = image.mPixels.data();
+		const size_t pixelCount = static_cast<size_t>(image.mWidth) * image.mHeight;
+		for (size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4)
+		{
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+			dst[3] = src[3];
+		}
+		return true;
+	}
+
+	bool DecodeImageFile(const std::filesystem::path& path, Image& out, StagingPool* staging,
+						 std::string* error)
+	{
+		if (GetImageFormat(path) == ImageFormat::Unknown)
+		{
+			SetError(error, "unsupported image format");
+			return false;
+		}
+
+		// Compressed bytes only live until the decode is done, so every
+		// thread keeps one buffer around instead of allocating per file.
+		thread_local std::vector<uint8_t> sFileBuffer;
+		if (!Utils::ReadBinaryFile(path, sFileBuffer))
+		{
+			SetError(error, "failed to read file");
+			return false;
+		}
+
+		return DecodeImage(sFileBuffer.data(), sFileBuffer.size(), out, staging, error);
+	}
+
+	std::vector<DecodeResult> DecodeImageFiles(const std::vector<std::filesystem::path>& paths,
+											   Utils::ThreadPool& pool, StagingPool* staging)
+	{
+		std::vector<DecodeResult> results(paths.size());
+		pool.ParallelFor(static_cast<uint32_t>(paths.size()), [&](uint32_t i) {
+			results[i].mSuccess =
+				DecodeImageFile(paths[i], results[i].mImage, staging, &results[i].mError);
+		});
+		return results;
+	}
+} // namespace TextureTools
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Image.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+namespace TextureTools
+{
+	enum class ImageFormat
+	{
+		Unknown,
+		PNG,
+		JPEG,
+		TGA
+	};
+
+	/// Picks the decoder from the file extension. DDS and anything else
+	/// we can't decode returns Unknown.
+	ImageFormat GetImageFormat(const std::filesystem::path& path);
+
+	/// Keeps pixel buffers from previous decodes around so loading a
+	/// burst of textures doesn't hit the allocator for every image.
+	/// Buffers go back in with Release once the pixels are copied out.
+	class StagingPool
+	{
+	public:
+		explicit StagingPool(size_t maxPooledBytes = 256ULL * 1024 * 1024);
+
+		/// Returns a buffer of exactly size bytes, reusing the smallest
+		/// pooled buffer that is big enough.
+		std::vector<uint8_t> Acquire(size_t size);
+		void Release(std::vector<uint8_t>&& buffer);
+
+		size_t GetPooledBytes() const;
+		uint64_t GetReuseCount() const;
+
+		static StagingPool& GetDefault();
+
+	private:
+		mutable std::mutex mMutex;
+		std::vector<std::vector<uint8_t>> mBuffers;
+		size_t mPooledBytes = 0;
+		size_t mMaxPooledBytes;
+		uint64_t mReuseCount = 0;
+	};
+
+	/// Decodes a PNG, JPEG or TGA in memory into an RGBA8 image. Greyscale
+	/// and RGB sources are expanded to RGBA with SIMD. Pixel memory comes
+	/// from the staging pool when one is passed in.
+	bool DecodeImage(const uint8_t* data, size_t size, Image& out, StagingPool* staging = nullptr,
+					 std::string* error = nullptr);
+
+	/// Decodes a Radiance .hdr into a linear float RGBA image (alpha is 1).
+	/// Used for the environment maps the IBL baker works from.
+	bool DecodeHDRImage(const uint8_t* data, size_t size, ImageF& out,
+						std::string* error = nullptr);
+
+	/// Reads the size from the header without decoding the pixels.
+	bool GetImageInfo(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height);
+
+	bool DecodeImageFile(const std::filesystem::path& path, Image& out,
+						 StagingPool* staging = nullptr, std::string* error = nullptr);
+
+	struct DecodeResult
+	{
+		Image mImage;
+		bool mSuccess = false;
+		std::string mError;
+	};
+
+	/// Decodes all the files on the pool, one job per file. Results are in
+	/// the same order as the paths.
+	std::vector<DecodeResult> DecodeImageFiles(const std::vector<std::filesystem::path>& paths,
+											   Utils::ThreadPool& pool,
+											   StagingPool* staging = nullptr);
+
+	/// Writes an uncompressed 32 bit top-down TGA. Used for cooked textures
+	/// so they load back through DecodeImage like any other file.
+	bool EncodeTGA(const Image& image, std::vector<uint8_t>& out);
+
+	/// Expands 1 (grey), 2 (grey + alpha), 3 (RGB) or 4 channel pixels to
+	/// RGBA8. Uses SSSE3 shuffles when available.
+	void ExpandToRGBA(const uint8_t* src, size_t pixelCount, uint32_t channels, uint8_t* dst);
+} // namespace TextureTools
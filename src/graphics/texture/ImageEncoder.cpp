@@ -0,0 +1,405 @@
+#include "ImageEncoder.h"
+#include "MipGenerator.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_STATIC
+#define STBI_WRITE_NO_STDIO
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include <stb_image_write.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace TextureTools
+{
+	namespace
+	{
+		void SetError(std::string* error, const std::string& message)
+		{
+			if (error)
+			{
+				*error = message;
+			}
+		}
+
+		void AppendBytes(void* context, void* data, int size)
+		{
+			auto* out = static_cast<std::vector<uint8_t>*>(context);
+			const auto* bytes = static_cast<const uint8_t*>(data);
+			out->insert(out->end(), bytes, bytes + size);
+		}
+
+		void PutBigEndian32(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		template <typename T> void PutLittleEndian(std::vector<uint8_t>& out, T value)
+		{
+			auto bits = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				std::reverse(bits.begin(), bits.end());
+			}
+			out.insert(out.end(), bits.begin(), bits.end());
+		}
+
+		void PutString(std::vector<uint8_t>& out, const char* text)
+		{
+			out.insert(out.end(), text, text + std::strlen(text) + 1);
+		}
+
+		/// EXR attribute header, the value follows.
+		void PutAttribute(std::vector<uint8_t>& out, const char* name, const char* type,
+						  uint32_t size)
+		{
+			PutString(out, name);
+			PutString(out, type);
+			PutLittleEndian(out, size);
+		}
+
+		constexpr uint8_t QOI_OP_INDEX = 0x00;
+		constexpr uint8_t QOI_OP_DIFF = 0x40;
+		constexpr uint8_t QOI_OP_LUMA = 0x80;
+		constexpr uint8_t QOI_OP_RUN = 0xC0;
+		constexpr uint8_t QOI_OP_RGB = 0xFE;
+		constexpr uint8_t QOI_OP_RGBA = 0xFF;
+		constexpr uint32_t QOI_MAX_RUN = 62;
+
+		struct QoiPixel
+		{
+			uint8_t r = 0;
+			uint8_t g = 0;
+			uint8_t b = 0;
+			uint8_t a = 0;
+
+			bool operator==(const QoiPixel&) const = default;
+			uint32_t Hash() const { return (r * 3U + g * 5U + b * 7U + a * 11U) % 64U; }
+		};
+	} // namespace
+
+	EncodeFormat GetEncodeFormat(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		});
+
+		if (extension == ".png")
+		{
+			return EncodeFormat::PNG;
+		}
+		if (extension == ".qoi")
+		{
+			return EncodeFormat::QOI;
+		}
+		if (extension == ".exr")
+		{
+			return EncodeFormat::EXR;
+		}
+		return EncodeFormat::Unknown;
+	}
+
+	bool EncodePNG(const Image& image, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		if (image.IsEmpty())
+		{
+			return false;
+		}
+		return stbi_write_png_to_func(AppendBytes, &out, static_cast<int>(image.mWidth),
+									  static_cast<int>(image.mHeight), 4, image.mPixels.data(),
+									  static_cast<int>(image.GetRowPitch())) != 0;
+	}
+
+	bool EncodeQOI(const Image& image, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		if (image.IsEmpty())
+		{
+			return false;
+		}
+
+		size_t pixelCount = static_cast<size_t>(image.mWidth) * image.mHeight;
+		// Worst case every pixel is an RGBA op.
+		out.reserve(14 + (pixelCount * 5) + 8);
+
+		const char magic[] = {'q', 'o', 'i', 'f'};
+		out.insert(out.end(), std::begin(magic), std::end(magic));
+		PutBigEndian32(out, image.mWidth);
+		PutBigEndian32(out, image.mHeight);
+		out.push_back(4);
+		out.push_back(0);
+
+		std::array<QoiPixel, 64> index = {};
+		QoiPixel previous{0, 0, 0, 255};
+		uint32_t run = 0;
+
+		const uint8_t* pixels = image.mPixels.data();
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			const uint8_t* p = pixels + (i * 4);
+			QoiPixel pixel{p[0], p[1], p[2], p[3]};
+
+			if (pixel == previous)
+			{
+				run++;
+				if (run == QOI_MAX_RUN || i + 1 == pixelCount)
+				{
+					out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0)
+			{
+				out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+				run = 0;
+			}
+
+			uint32_t hash = pixel.Hash();
+			if (index[hash] == pixel)
+			{
+				out.push_back(static_cast<uint8_t>(QOI_OP_INDEX | hash));
+			}
+			else
+			{
+				index[hash] = pixel;
+				if (pixel.a == previous.a)
+				{
+					// Differences wrap around like the decoder's uint8 adds.
+					auto dr = static_cast<int8_t>(pixel.r - previous.r);
+					auto dg = static_cast<int8_t>(pixel.g - previous.g);
+					auto db = static_cast<int8_t>(pixel.b - previous.b);
+					int drg = dr - dg;
+					int dbg = db - dg;
+
+					if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+					{
+						out.push_back(static_cast<uint8_t>(QOI_OP_DIFF | ((dr + 2) << 4) |
+														   ((dg + 2) << 2) | (db + 2)));
+					}
+					else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 &&
+							 dbg <= 7)
+					{
+						out.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (dg + 32)));
+						out.push_back(static_cast<uint8_t>(((drg + 8) << 4) | (dbg + 8)));
+					}
+					else
+					{
+						out.insert(out.end(), {QOI_OP_RGB, pixel.r, pixel.g, pixel.b});
+					}
+				}
+				else
+				{
+					out.insert(out.end(), {QOI_OP_RGBA, pixel.r, pixel.g, pixel.b, pixel.a});
+				}
+			}
+			previous = pixel;
+		}
+
+		out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+		return true;
+	}
+
+	bool EncodeEXR(const ImageF& image, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		if (image.mWidth == 0 || image.mHeight == 0)
+		{
+			return false;
+		}
+
+		// Channels have to be listed, and stored, in alphabetical order.
+		constexpr std::array<const char*, 4> CHANNEL_NAMES = {"A", "B", "G", "R"};
+		constexpr std::array<uint32_t, 4> CHANNEL_OFFSETS = {3, 2, 1, 0};
+		constexpr int32_t PIXEL_TYPE_HALF = 1;
+
+		const uint32_t magic = 20000630;
+		PutLittleEndian(out, magic);
+		PutLittleEndian(out, uint32_t{2});
+
+		PutAttribute(out, "channels", "chlist", (4 * (2 + 16)) + 1);
+		for (const char* name : CHANNEL_NAMES)
+		{
+			PutString(out, name);
+			PutLittleEndian(out, PIXEL_TYPE_HALF);
+			// pLinear and three reserved bytes, then x and y sampling.
+			PutLittleEndian(out, uint32_t{0});
+			PutLittleEndian(out, int32_t{1});
+			PutLittleEndian(out, int32_t{1});
+		}
+		out.push_back(0);
+
+		PutAttribute(out, "compression", "compression", 1);
+		out.push_back(0);
+
+		auto maxX = static_cast<int32_t>(image.mWidth - 1);
+		auto maxY = static_cast<int32_t>(image.mHeight - 1);
+		for (const char* window : {"dataWindow", "displayWindow"})
+		{
+			PutAttribute(out, window, "box2i", 16);
+			PutLittleEndian(out, int32_t{0});
+			PutLittleEndian(out, int32_t{0});
+			PutLittleEndian(out, maxX);
+			PutLittleEndian(out, maxY);
+		}
+
+		PutAttribute(out, "lineOrder", "lineOrder", 1);
+		out.push_back(0);
+		PutAttribute(out, "pixelAspectRatio", "float", 4);
+		PutLittleEndian(out, 1.0F);
+		PutAttribute(out, "screenWindowCenter", "v2f", 8);
+		PutLittleEndian(out, 0.0F);
+		PutLittleEndian(out, 0.0F);
+		PutAttribute(out, "screenWindowWidth", "float", 4);
+		PutLittleEndian(out, 1.0F);
+		out.push_back(0);
+
+		// Without compression every block is one scanline of the same size,
+		// so the offset table can be written up front.
+		uint32_t lineBytes = image.mWidth * 4 * sizeof(uint16_t);
+		uint64_t blockBytes = (2 * sizeof(int32_t)) + lineBytes;
+		uint64_t firstBlock = out.size() + (static_cast<uint64_t>(image.mHeight) * 8);
+		out.reserve(firstBlock + (blockBytes * image.mHeight));
+		for (uint32_t y = 0; y < image.mHeight; ++y)
+		{
+			PutLittleEndian(out, firstBlock + (blockBytes * y));
+		}
+
+		for (uint32_t y = 0; y < image.mHeight; ++y)
+		{
+			PutLittleEndian(out, static_cast<int32_t>(y));
+			PutLittleEndian(out, lineBytes);
+			for (uint32_t offset : CHANNEL_OFFSETS)
+			{
+				const float* row = image.GetPixel(0, y);
+				for (uint32_t x = 0; x < image.mWidth; ++x)
+				{
+					PutLittleEndian(out, FloatToHalf(row[(x * 4) + offset]));
+				}
+			}
+		}
+		return true;
+	}
+
+	bool EncodeImage(const Image& image, EncodeFormat format, std::vector<uint8_t>& out,
+					 std::string* error)
+	{
+		if (image.IsEmpty())
+		{
+			SetError(error, "Image is empty");
+			return false;
+		}
+
+		bool encoded = false;
+		switch (format)
+		{
+		case EncodeFormat::PNG:
+			encoded = EncodePNG(image, out);
+			break;
+		case EncodeFormat::QOI:
+			encoded = EncodeQOI(image, out);
+			break;
+		case EncodeFormat::EXR:
+		{
+			ImageF linear(image.mWidth, image.mHeight);
+			for (size_t i = 0; i < image.mPixels.size(); i += 4)
+			{
+				linear.mPixels[i + 0] = SRGBToLinear(image.mPixels[i + 0]);
+				linear.mPixels[i + 1] = SRGBToLinear(image.mPixels[i + 1]);
+				linear.mPixels[i + 2] = SRGBToLinear(image.mPixels[i + 2]);
+				linear.mPixels[i + 3] = static_cast<float>(image.mPixels[i + 3]) / 255.0F;
+			}
+			encoded = EncodeEXR(linear, out);
+			break;
+		}
+		default:
+			SetError(error, "Unsupported encode format");
+			return false;
+		}
+
+		if (!encoded)
+		{
+			SetError(error, "Encoding failed");
+		}
+		return encoded;
+	}
+
+	uint16_t FloatToHalf(float value)
+	{
+		auto bits = std::bit_cast<uint32_t>(value);
+		auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		uint32_t exponent = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (exponent == 0xFF)
+		{
+			return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+		}
+
+		int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+		if (halfExponent >= 31)
+		{
+			return static_cast<uint16_t>(sign | 0x7C00);
+		}
+
+		uint32_t shift = 13;
+		uint32_t half = 0;
+		if (halfExponent <= 0)
+		{
+			// Subnormal, anything below half the smallest one is zero.
+			if (halfExponent < -10)
+			{
+				return sign;
+			}
+			mantissa |= 0x800000;
+			shift = static_cast<uint32_t>(14 - halfExponent);
+			half = mantissa >> shift;
+		}
+		else
+		{
+			half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> shift);
+		}
+
+		// Round to nearest even. A carry out of the mantissa bumps the
+		// exponent, which is what we want, up to infinity.
+		uint32_t remainder = mantissa & ((1U << shift) - 1);
+		uint32_t halfway = 1U << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+		{
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	float HalfToFloat(uint16_t value)
+	{
+		uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		uint32_t exponent = (value >> 10) & 0x1F;
+		uint32_t mantissa = value & 0x3FF;
+
+		if (exponent == 0)
+		{
+			float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+			return sign != 0 ? -magnitude : magnitude;
+		}
+		if (exponent == 31)
+		{
+			return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+		}
+		return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+} // namespace TextureTools
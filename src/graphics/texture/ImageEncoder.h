@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Image.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace TextureTools
+{
+	enum class EncodeFormat
+	{
+		Unknown,
+		PNG,
+		QOI,
+		EXR
+	};
+
+	/// Picks the encoder from the file extension.
+	EncodeFormat GetEncodeFormat(const std::filesystem::path& path);
+
+	/// Lossless, compresses best but is the slowest of the three (zlib).
+	bool EncodePNG(const Image& image, std::vector<uint8_t>& out);
+
+	/// Lossless, a few times faster than PNG for a somewhat larger file.
+	/// Written as sRGB colour with linear alpha.
+	bool EncodeQOI(const Image& image, std::vector<uint8_t>& out);
+
+	/// Uncompressed scanline OpenEXR with half float RGBA channels.
+	bool EncodeEXR(const ImageF& image, std::vector<uint8_t>& out);
+
+	/// Encodes an RGBA8 image holding sRGB colour to any of the formats.
+	/// For EXR the colour is converted to linear first.
+	bool EncodeImage(const Image& image, EncodeFormat format, std::vector<uint8_t>& out,
+					 std::string* error = nullptr);
+
+	/// IEEE 754 binary16, rounded to nearest even. Overflow goes to
+	/// infinity, NaN stays NaN.
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+} // namespace TextureTools
@@ -0,0 +1,193 @@
+#include "Ktx2Transcoder.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
+
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include <basisu_transcoder.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace TextureTools
+{
+	namespace
+	{
+		void SetError(std::string* error, const std::string& message)
+		{
+			if (error)
+			{
+				*error = message;
+			}
+		}
+
+		basist::transcoder_texture_format ToBasisFormat(BlockFormat format)
+		{
+			switch (format)
+			{
+			case BlockFormat::BC7:
+			default:
+				return basist::transcoder_texture_format::cTFBC7_RGBA;
+			}
+		}
+
+		void InitBasis()
+		{
+			static std::once_flag sInitFlag;
+			std::call_once(sInitFlag, []() {
+				basist::basisu_transcoder_init();
+			});
+		}
+	} // namespace
+
+	uint32_t GetBytesPerBlock(BlockFormat format)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC7:
+		default:
+			return 16;
+		}
+	}
+
+	size_t ComputeBlockLevels(uint32_t width, uint32_t height, uint32_t levelCount,
+							  uint32_t bytesPerBlock, std::vector<BlockLevel>& levels)
+	{
+		levels.resize(levelCount);
+
+		size_t offset = 0;
+		for (uint32_t i = 0; i < levelCount; ++i)
+		{
+			BlockLevel& level = levels[i];
+			level.mWidth = std::max(width >> i, 1U);
+			level.mHeight = std::max(height >> i, 1U);
+			level.mBlocksX = (level.mWidth + 3) / 4;
+			level.mBlocksY = (level.mHeight + 3) / 4;
+			level.mOffset = offset;
+			level.mRowPitch = level.mBlocksX * bytesPerBlock;
+			level.mSlicePitch = static_cast<size_t>(level.mRowPitch) * level.mBlocksY;
+			offset += level.mSlicePitch;
+		}
+		return offset;
+	}
+
+	bool IsKtx2File(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		});
+		return extension == ".ktx2";
+	}
+
+	namespace
+	{
+		/// Null pool transcodes the levels one after the other on the
+		/// calling thread.
+		bool Transcode(const uint8_t* data, size_t size, TranscodedTexture& out,
+					   Utils::ThreadPool* pool, std::string* error)
+		{
+			InitBasis();
+
+			basist::ktx2_transcoder transcoder;
+			if (!transcoder.init(data, static_cast<uint32_t>(size)))
+			{
+				SetError(error, "not a valid KTX2 file");
+				return false;
+			}
+
+			if (!transcoder.is_etc1s() && !transcoder.is_uastc())
+			{
+				SetError(error, "KTX2 file is not Basis Universal (ETC1S or UASTC)");
+				return false;
+			}
+
+			if (transcoder.get_layers() > 1 || transcoder.get_faces() > 1)
+			{
+				SetError(error, "KTX2 arrays and cubemaps are not supported");
+				return false;
+			}
+
+			// D3D12 wants the top level of a BC texture in whole blocks.
+			if ((transcoder.get_width() % 4) != 0 || (transcoder.get_height() % 4) != 0)
+			{
+				SetError(error, "KTX2 dimensions must be a multiple of 4");
+				return false;
+			}
+
+			if (!transcoder.start_transcoding())
+			{
+				SetError(error, "failed to start transcoding");
+				return false;
+			}
+
+			out.mWidth = transcoder.get_width();
+			out.mHeight = transcoder.get_height();
+			out.mFormat = BlockFormat::BC7;
+			out.mIsSRGB = transcoder.get_dfd_transfer_func() == basist::KTX2_KHR_DF_TRANSFER_SRGB;
+			out.mIsUASTC = transcoder.is_uastc();
+
+			uint32_t bytesPerBlock = GetBytesPerBlock(out.mFormat);
+			out.mDataSize = ComputeBlockLevels(out.mWidth, out.mHeight,
+											   std::max(transcoder.get_levels(), 1U), bytesPerBlock,
+											   out.mLevels);
+			out.mData = std::make_unique<uint8_t[]>(out.mDataSize);
+
+			// The transcoder itself is read only once started, each job just
+			// needs its own scratch state.
+			std::atomic<bool> failed{false};
+			auto transcodeLevel = [&](uint32_t levelIndex) {
+				const BlockLevel& level = out.mLevels[levelIndex];
+				basist::ktx2_transcoder_state state;
+
+				bool ok = transcoder.transcode_image_level(
+					levelIndex, 0, 0, out.mData.get() + level.mOffset,
+					level.mBlocksX * level.mBlocksY, ToBasisFormat(out.mFormat), 0, level.mBlocksX,
+					0, -1, -1, &state);
+				if (!ok)
+				{
+					failed = true;
+				}
+			};
+
+			uint32_t levelCount = static_cast<uint32_t>(out.mLevels.size());
+			if (pool)
+			{
+				pool->ParallelFor(levelCount, transcodeLevel);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < levelCount; ++i)
+				{
+					transcodeLevel(i);
+				}
+			}
+
+			if (failed)
+			{
+				SetError(error, "failed to transcode KTX2 level");
+				out.mData.reset();
+				out.mLevels.clear();
+				return false;
+			}
+
+			return true;
+		}
+	} // namespace
+
+	bool TranscodeKtx2(const uint8_t* data, size_t size, TranscodedTexture& out,
+					   Utils::ThreadPool& pool, std::string* error)
+	{
+		return Transcode(data, size, out, &pool, error);
+	}
+
+	bool TranscodeKtx2(const uint8_t* data, size_t size, TranscodedTexture& out,
+					   std::string* error)
+	{
+		return Transcode(data, size, out, nullptr, error);
+	}
+} // namespace TextureTools
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+namespace TextureTools
+{
+	/// GPU block formats we transcode KTX2 into. BC7 is the only one every
+	/// D3D12 GPU supports that keeps UASTC close to lossless.
+	enum class BlockFormat
+	{
+		BC7
+	};
+
+	uint32_t GetBytesPerBlock(BlockFormat format);
+
+	struct BlockLevel
+	{
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		uint32_t mBlocksX = 0;
+		uint32_t mBlocksY = 0;
+		size_t mOffset = 0;
+		uint32_t mRowPitch = 0;
+		size_t mSlicePitch = 0;
+	};
+
+	/// Tightly packed 4x4 block layout for a mip chain, all levels in one
+	/// allocation. Returns the total size in bytes.
+	size_t ComputeBlockLevels(uint32_t width, uint32_t height, uint32_t levelCount,
+							  uint32_t bytesPerBlock, std::vector<BlockLevel>& levels);
+
+	/// Transcoded mips ready to be pointed at by D3D12_SUBRESOURCE_DATA.
+	struct TranscodedTexture
+	{
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		BlockFormat mFormat = BlockFormat::BC7;
+		bool mIsSRGB = false;
+		bool mIsUASTC = false;
+
+		std::unique_ptr<uint8_t[]> mData;
+		size_t mDataSize = 0;
+		std::vector<BlockLevel> mLevels;
+	};
+
+	bool IsKtx2File(const std::filesystem::path& path);
+
+	/// Transcodes a KTX2 file with ETC1S (BasisLZ) or UASTC payload to BC
+	/// blocks. Every mip is its own job on the pool and writes straight
+	/// into its slot of mData. Only 2D textures (one layer, one face).
+	bool TranscodeKtx2(const uint8_t* data, size_t size, TranscodedTexture& out,
+					   Utils::ThreadPool& pool, std::string* error = nullptr);
+
+	/// Same, with every mip transcoded on the calling thread.
+	bool TranscodeKtx2(const uint8_t* data, size_t size, TranscodedTexture& out,
+					   std::string* error = nullptr);
+} // namespace TextureTools
@@ -0,0 +1,518 @@
+#include "MipGenerator.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define JAR_MIP_SSE 1
+#endif
+
+namespace TextureTools
+{
+	namespace
+	{
+		/// Rows per job when splitting a level across the pool. Small enough
+		/// to balance, big enough that the per job overhead doesn't matter.
+		constexpr uint32_t TILE_ROWS = 16;
+
+		/// Kaiser window radius in destination texels and its beta. Two
+		/// lobes of sinc is the usual sweet spot between sharpness and
+		/// ringing.
+		constexpr float KAISER_RADIUS = 2.0F;
+		constexpr float KAISER_BETA = 4.0F;
+
+		constexpr float PI = 3.14159265358979F;
+
+		float SRGBToLinearExact(float c)
+		{
+			return c <= 0.04045F ? c / 12.92F : std::pow((c + 0.055F) / 1.055F, 2.4F);
+		}
+
+		const std::array<float, 256>& GetSRGBToLinearTable()
+		{
+			static const std::array<float, 256> sTable = []() {
+				std::array<float, 256> table{};
+				for (uint32_t i = 0; i < 256; ++i)
+				{
+					table[i] = SRGBToLinearExact(static_cast<float>(i) / 255.0F);
+				}
+				return table;
+			}();
+			return sTable;
+		}
+
+		/// Linear value at the midpoint between each pair of neighbouring
+		/// sRGB codes, encoding becomes a binary search instead of a pow.
+		const std::array<float, 255>& GetLinearToSRGBThresholds()
+		{
+			static const std::array<float, 255> sThresholds = []() {
+				std::array<float, 255> thresholds{};
+				for (uint32_t i = 0; i < 255; ++i)
+				{
+					thresholds[i] = SRGBToLinearExact((static_cast<float>(i) + 0.5F) / 255.0F);
+				}
+				return thresholds;
+			}();
+			return sThresholds;
+		}
+
+		uint8_t FloatToUnorm(float value)
+		{
+			float clamped = std::clamp(value, 0.0F, 1.0F);
+			return static_cast<uint8_t>(clamped * 255.0F + 0.5F);
+		}
+
+		/// Precomputed taps for one axis. Every destination texel has the
+		/// same number of taps, indices are already wrapped or clamped.
+		struct AxisKernel
+		{
+			uint32_t mTapCount = 0;
+			std::vector<uint32_t> mIndices;
+			std::vector<float> mWeights;
+		};
+
+		float BesselI0(float x)
+		{
+			// Power series, converges quickly for the small arguments we use.
+			float sum = 1.0F;
+			float term = 1.0F;
+			float halfX = x * 0.5F;
+			for (uint32_t k = 1; k < 20; ++k)
+			{
+				term *= (halfX / static_cast<float>(k)) * (halfX / static_cast<float>(k));
+				sum += term;
+			}
+			return sum;
+		}
+
+		float KaiserSinc(float t)
+		{
+			float ratio = t / KAISER_RADIUS;
+			if (std::abs(ratio) >= 1.0F)
+			{
+				return 0.0F;
+			}
+
+			float window =
+				BesselI0(KAISER_BETA * std::sqrt(1.0F - ratio * ratio)) / BesselI0(KAISER_BETA);
+			float sinc = t == 0.0F ? 1.0F : std::sin(PI * t) / (PI * t);
+			return sinc * window;
+		}
+
+		uint32_t AddressTexel(int32_t index, uint32_t size, bool wrap)
+		{
+			int32_t n = static_cast<int32_t>(size);
+			if (wrap)
+			{
+				int32_t wrapped = index % n;
+				return static_cast<uint32_t>(wrapped < 0 ? wrapped + n : wrapped);
+			}
+			return static_cast<uint32_t>(std::clamp(index, 0, n - 1));
+		}
+
+		AxisKernel BuildAxisKernel(uint32_t srcSize, uint32_t dstSize, MipFilter filter, bool wrap)
+		{
+			AxisKernel kernel;
+
+			// Axis that isn't shrinking (the 1 pixel side of a non square
+			// texture) is a straight copy.
+			if (srcSize == dstSize)
+			{
+				kernel.mTapCount = 1;
+				kernel.mIndices.resize(dstSize);
+				kernel.mWeights.assign(dstSize, 1.0F);
+				for (uint32_t i = 0; i < dstSize; ++i)
+				{
+					kernel.mIndices[i] = i;
+				}
+				return kernel;
+			}
+
+			float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+			float radius = filter == MipFilter::Box ? scale * 0.5F : scale * KAISER_RADIUS;
+			kernel.mTapCount = static_cast<uint32_t>(std::ceil(radius * 2.0F)) + 1;
+			kernel.mIndices.resize(static_cast<size_t>(dstSize) * kernel.mTapCount);
+			kernel.mWeights.resize(static_cast<size_t>(dstSize) * kernel.mTapCount);
+
+			for (uint32_t dst = 0; dst < dstSize; ++dst)
+			{
+				float center = (static_cast<float>(dst) + 0.5F) * scale;
+				int32_t first = static_cast<int32_t>(std::floor(center - radius));
+				float total = 0.0F;
+
+				uint32_t* indices = kernel.mIndices.data() + static_cast<size_t>(dst) * kernel.mTapCount;
+				float* weights = kernel.mWeights.data() + static_cast<size_t>(dst) * kernel.mTapCount;
+				for (uint32_t tap = 0; tap < kernel.mTapCount; ++tap)
+				{
+					int32_t src = first + static_cast<int32_t>(tap);
+					float weight = 0.0F;
+					if (filter == MipFilter::Box)
+					{
+						// Overlap of the source texel with the destination footprint.
+						float lo = std::max(static_cast<float>(src), center - radius);
+						float hi = std::min(static_cast<float>(src) + 1.0F, center + radius);
+						weight = std::max(hi - lo, 0.0F);
+					}
+					else
+					{
+						float t = (static_cast<float>(src) + 0.5F - center) / scale;
+						weight = KaiserSinc(t);
+					}
+
+					indices[tap] = AddressTexel(src, srcSize, wrap);
+					weights[tap] = weight;
+					total += weight;
+				}
+
+				for (uint32_t tap = 0; tap < kernel.mTapCount; ++tap)
+				{
+					weights[tap] /= total;
+				}
+			}
+
+			return kernel;
+		}
+
+		/// dst[i] = sum(weights[k] * src[k][i]) over a run of float4 pixels.
+		void AccumulateRow(float* dst, const float* const* srcRows, const float* weights,
+						   uint32_t tapCount, uint32_t pixelCount)
+		{
+#ifdef JAR_MIP_SSE
+			for (uint32_t x = 0; x < pixelCount; ++x)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (uint32_t tap = 0; tap < tapCount; ++tap)
+				{
+					__m128 pixel = _mm_loadu_ps(srcRows[tap] + static_cast<size_t>(x) * 4);
+					acc = _mm_add_ps(acc, _mm_mul_ps(pixel, _mm_set1_ps(weights[tap])));
+				}
+				_mm_storeu_ps(dst + static_cast<size_t>(x) * 4, acc);
+			}
+#else
+			for (uint32_t x = 0; x < pixelCount * 4; ++x)
+			{
+				float acc = 0.0F;
+				for (uint32_t tap = 0; tap < tapCount; ++tap)
+				{
+					acc += srcRows[tap][x] * weights[tap];
+				}
+				dst[x] = acc;
+			}
+#endif
+		}
+
+		/// Horizontal filter for a range of rows, one destination pixel at a
+		/// time since the source pixels are scattered along the row.
+		void FilterRowsHorizontal(const ImageF& src, ImageF& dst, const AxisKernel& kernel,
+								  uint32_t rowBegin, uint32_t rowEnd)
+		{
+			std::vector<const float*> taps(kernel.mTapCount);
+			for (uint32_t y = rowBegin; y < rowEnd; ++y)
+			{
+				const float* srcRow = src.GetPixel(0, y);
+				float* dstRow = dst.GetPixel(0, y);
+				for (uint32_t x = 0; x < dst.mWidth; ++x)
+				{
+					const uint32_t* indices =
+						kernel.mIndices.data() + static_cast<size_t>(x) * kernel.mTapCount;
+					for (uint32_t tap = 0; tap < kernel.mTapCount; ++tap)
+					{
+						taps[tap] = srcRow + static_cast<size_t>(indices[tap]) * 4;
+					}
+					AccumulateRow(dstRow + static_cast<size_t>(x) * 4, taps.data(),
+								  kernel.mWeights.data() + static_cast<size_t>(x) * kernel.mTapCount,
+								  kernel.mTapCount, 1);
+				}
+			}
+		}
+
+		/// Vertical filter walks whole rows so the loads stay sequential.
+		void FilterRowsVertical(const ImageF& src, ImageF& dst, const AxisKernel& kernel,
+								uint32_t rowBegin, uint32_t rowEnd)
+		{
+			std::vector<const float*> taps(kernel.mTapCount);
+			for (uint32_t y = rowBegin; y < rowEnd; ++y)
+			{
+				const uint32_t* indices =
+					kernel.mIndices.data() + static_cast<size_t>(y) * kernel.mTapCount;
+				for (uint32_t tap = 0; tap < kernel.mTapCount; ++tap)
+				{
+					taps[tap] = src.GetPixel(0, indices[tap]);
+				}
+				AccumulateRow(dst.GetPixel(0, y), taps.data(),
+							  kernel.mWeights.data() + static_cast<size_t>(y) * kernel.mTapCount,
+							  kernel.mTapCount, dst.mWidth);
+			}
+		}
+
+		uint32_t GetTileCount(uint32_t rows)
+		{
+			return (rows + TILE_ROWS - 1) / TILE_ROWS;
+		}
+
+		template <typename Fn>
+		void ForEachTile(Utils::ThreadPool& pool, uint32_t rows, Fn&& fn)
+		{
+			pool.ParallelFor(GetTileCount(rows), [&](uint32_t tile) {
+				uint32_t begin = tile * TILE_ROWS;
+				uint32_t end = std::min(begin + TILE_ROWS, rows);
+				fn(begin, end);
+			});
+		}
+
+		ImageF Downsample(const ImageF& src, uint32_t width, uint32_t height, const MipDesc& desc,
+						  Utils::ThreadPool& pool)
+		{
+			AxisKernel horizontal = BuildAxisKernel(src.mWidth, width, desc.mFilter, desc.mWrap);
+			AxisKernel vertical = BuildAxisKernel(src.mHeight, height, desc.mFilter, desc.mWrap);
+
+			ImageF temp(width, src.mHeight);
+			ForEachTile(pool, src.mHeight, [&](uint32_t begin, uint32_t end) {
+				FilterRowsHorizontal(src, temp, horizontal, begin, end);
+			});
+
+			ImageF result(width, height);
+			ForEachTile(pool, height, [&](uint32_t begin, uint32_t end) {
+				FilterRowsVertical(temp, result, vertical, begin, end);
+			});
+			return result;
+		}
+
+		ImageF DecodeToLinear(const Image& source, const MipDesc& desc, Utils::ThreadPool& pool)
+		{
+			const std::array<float, 256>& srgbTable = GetSRGBToLinearTable();
+			ImageF result(source.mWidth, source.mHeight);
+
+			ForEachTile(pool, source.mHeight, [&](uint32_t begin, uint32_t end) {
+				for (uint32_t y = begin; y < end; ++y)
+				{
+					for (uint32_t x = 0; x < source.mWidth; ++x)
+					{
+						const uint8_t* in = source.GetPixel(x, y);
+						float* out = result.GetPixel(x, y);
+						out[3] = static_cast<float>(in[3]) / 255.0F;
+
+						if (desc.mIsNormalMap)
+						{
+							// Unpack to [-1,1] and normalize so the source
+							// lengths don't leak into the Toksvig factor.
+							float nx = static_cast<float>(in[0]) / 127.5F - 1.0F;
+							float ny = static_cast<float>(in[1]) / 127.5F - 1.0F;
+							float nz = static_cast<float>(in[2]) / 127.5F - 1.0F;
+							float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+							float inv = length > 0.0F ? 1.0F / length : 0.0F;
+							out[0] = nx * inv;
+							out[1] = ny * inv;
+							out[2] = length > 0.0F ? nz * inv : 1.0F;
+						}
+						else if (desc.mIsSRGB)
+						{
+							out[0] = srgbTable[in[0]];
+							out[1] = srgbTable[in[1]];
+							out[2] = srgbTable[in[2]];
+						}
+						else
+						{
+							out[0] = static_cast<float>(in[0]) / 255.0F;
+							out[1] = static_cast<float>(in[1]) / 255.0F;
+							out[2] = static_cast<float>(in[2]) / 255.0F;
+						}
+					}
+				}
+			});
+
+			return result;
+		}
+
+		void EncodeLevel(const ImageF& level, const MipDesc& desc, Image& out,
+						 std::vector<float>* normalLengths, Utils::ThreadPool& pool)
+		{
+			out = Image(level.mWidth, level.mHeight);
+			if (normalLengths)
+			{
+				normalLengths->resize(static_cast<size_t>(level.mWidth) * level.mHeight);
+			}
+
+			ForEachTile(pool, level.mHeight, [&](uint32_t begin, uint32_t end) {
+				for (uint32_t y = begin; y < end; ++y)
+				{
+					for (uint32_t x = 0; x < level.mWidth; ++x)
+					{
+						const float* in = level.GetPixel(x, y);
+						uint8_t* px = out.GetPixel(x, y);
+						px[3] = FloatToUnorm(in[3]);
+
+						if (desc.mIsNormalMap)
+						{
+							float length = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+							(*normalLengths)[static_cast<size_t>(y) * level.mWidth + x] = length;
+
+							float nx = 0.0F;
+							float ny = 0.0F;
+							float nz = 1.0F;
+							if (length > 1e-6F)
+							{
+								nx = in[0] / length;
+								ny = in[1] / length;
+								nz = in[2] / length;
+							}
+							px[0] = FloatToUnorm(nx * 0.5F + 0.5F);
+							px[1] = FloatToUnorm(ny * 0.5F + 0.5F);
+							px[2] = FloatToUnorm(nz * 0.5F + 0.5F);
+						}
+						else if (desc.mIsSRGB)
+						{
+							px[0] = LinearToSRGB(in[0]);
+							px[1] = LinearToSRGB(in[1]);
+							px[2] = LinearToSRGB(in[2]);
+						}
+						else
+						{
+							px[0] = FloatToUnorm(in[0]);
+							px[1] = FloatToUnorm(in[1]);
+							px[2] = FloatToUnorm(in[2]);
+						}
+					}
+				}
+			});
+		}
+	} // namespace
+
+	float SRGBToLinear(uint8_t value)
+	{
+		return GetSRGBToLinearTable()[value];
+	}
+
+	uint8_t LinearToSRGB(float value)
+	{
+		const std::array<float, 255>& thresholds = GetLinearToSRGBThresholds();
+		auto it = std::upper_bound(thresholds.begin(), thresholds.end(), value);
+		return static_cast<uint8_t>(it - thresholds.begin());
+	}
+
+	uint32_t CalculateMipCount(uint32_t width, uint32_t height)
+	{
+		uint32_t count = 1;
+		uint32_t size = std::max(width, height);
+		while (size > 1)
+		{
+			size >>= 1;
+			count++;
+		}
+		return count;
+	}
+
+	MipChain GenerateMips(const Image& source, const MipDesc& desc)
+	{
+		return GenerateMips(source, desc, Utils::ThreadPool::GetDefault());
+	}
+
+	MipChain GenerateMips(const Image& source, const MipDesc& desc, Utils::ThreadPool& pool)
+	{
+		MipChain chain;
+		chain.mIsSRGB = desc.mIsSRGB && !desc.mIsNormalMap;
+		if (source.IsEmpty())
+		{
+			return chain;
+		}
+
+		uint32_t levelCount = CalculateMipCount(source.mWidth, source.mHeight);
+		if (desc.mMaxLevels > 0)
+		{
+			levelCount = std::min(levelCount, desc.mMaxLevels);
+		}
+
+		chain.mLevels.resize(levelCount);
+		if (desc.mIsNormalMap)
+		{
+			chain.mNormalLengths.resize(levelCount);
+		}
+
+		// Each level is filtered from the previous float level, only two of
+		// them are alive at a time. Normal levels are kept unnormalized so
+		// the length keeps shrinking where the normals disagree.
+		ImageF current = DecodeToLinear(source, desc, pool);
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			if (level > 0)
+			{
+				uint32_t width = std::max(current.mWidth >> 1, 1U);
+				uint32_t height = std::max(current.mHeight >> 1, 1U);
+				current = Downsample(current, width, height, desc, pool);
+			}
+
+			std::vector<float>* lengths = desc.mIsNormalMap ? &chain.mNormalLengths[level] : nullptr;
+			EncodeLevel(current, desc, chain.mLevels[level], lengths, pool);
+		}
+
+		return chain;
+	}
+
+	std::vector<MipChain> GenerateMipsBatch(const std::vector<const Image*>& sources,
+											const std::vector<MipDesc>& descs,
+											Utils::ThreadPool& pool)
+	{
+		const MipDesc fallback = descs.empty() ? MipDesc{} : descs.back();
+		std::vector<MipChain> chains(sources.size());
+		pool.ParallelFor(static_cast<uint32_t>(sources.size()), [&](uint32_t i) {
+			const MipDesc& desc = i < descs.size() ? descs[i] : fallback;
+			chains[i] = GenerateMips(*sources[i], desc, pool);
+		});
+		return chains;
+	}
+
+	bool ApplyToksvig(const MipChain& normalMips, MipChain& roughnessMips, uint32_t channel)
+	{
+		if (normalMips.mNormalLengths.empty() || channel > 3)
+		{
+			return false;
+		}
+
+		size_t levelCount = std::min(normalMips.mLevels.size(), roughnessMips.mLevels.size());
+		for (size_t level = 0; level < levelCount; ++level)
+		{
+			if (normalMips.mLevels[level].mWidth != roughnessMips.mLevels[level].mWidth ||
+				normalMips.mLevels[level].mHeight != roughnessMips.mLevels[level].mHeight)
+			{
+				return false;
+			}
+		}
+
+		for (size_t level = 1; level < levelCount; ++level)
+		{
+			const std::vector<float>& lengths = normalMips.mNormalLengths[level];
+			Image& roughness = roughnessMips.mLevels[level];
+
+			for (size_t i = 0; i < lengths.size(); ++i)
+			{
+				float r = std::min(lengths[i], 1.0F);
+				if (r >= 0.9999F)
+				{
+					continue;
+				}
+
+				// Fit a vMF lobe to the averaged normal, its spread adds to
+				// the GGX alpha^2 (Han et al. 2007).
+				uint8_t& value = roughness.mPixels[i * 4 + channel];
+				float perceptual = static_cast<float>(value) / 255.0F;
+				float alpha = perceptual * perceptual;
+				float alpha2 = alpha * alpha;
+				if (r > 1e-4F)
+				{
+					float kappa = (3.0F * r - r * r * r) / (1.0F - r * r);
+					alpha2 = std::min(alpha2 + 1.0F / kappa, 1.0F);
+				}
+				else
+				{
+					alpha2 = 1.0F;
+				}
+
+				value = FloatToUnorm(std::sqrt(std::sqrt(alpha2)));
+			}
+		}
+
+		return true;
+	}
+} // namespace TextureTools
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Image.h"
+#include <cstdint>
+#include <vector>
+
+namespace Utils
+{
+	class ThreadPool;
+}
+
+namespace TextureTools
+{
+	enum class MipFilter
+	{
+		/// 2x2 average, cheap and what most tools do by default.
+		Box,
+		/// Kaiser windowed sinc, keeps more detail in the lower mips but
+		/// can ring slightly on hard edges.
+		Kaiser
+	};
+
+	struct MipDesc
+	{
+		MipFilter mFilter = MipFilter::Box;
+
+		/// Colour data stored as sRGB is converted to linear before filtering
+		/// and back after, otherwise the lower mips get darker.
+		bool mIsSRGB = true;
+
+		/// Treats rgb as a tangent space normal in [0,1]. Each level is
+		/// renormalized and the length of the averaged normal is kept
+		/// around for ApplyToksvig.
+		bool mIsNormalMap = false;
+
+		/// Wrap at the edges (tiling textures), otherwise clamp.
+		bool mWrap = true;
+
+		/// 0 generates the full chain down to 1x1.
+		uint32_t mMaxLevels = 0;
+	};
+
+	struct MipChain
+	{
+		std::vector<Image> mLevels;
+
+		/// Length of the filtered, not yet renormalized normal for each
+		/// texel of each level. Only filled for normal maps.
+		std::vector<std::vector<float>> mNormalLengths;
+
+		bool mIsSRGB = false;
+	};
+
+	uint32_t CalculateMipCount(uint32_t width, uint32_t height);
+
+	/// Builds the full mip chain for the source image. Each level is split
+	/// into row tiles that run on the thread pool, filtering is done on
+	/// float4 pixels with SSE.
+	MipChain GenerateMips(const Image& source, const MipDesc& desc, Utils::ThreadPool& pool);
+	MipChain GenerateMips(const Image& source, const MipDesc& desc);
+
+	/// Same as above for many textures at once, every texture is its own
+	/// job so small textures don't leave the pool idle. Sources past the
+	/// end of descs use the last one, or a default MipDesc if it's empty.
+	std::vector<MipChain> GenerateMipsBatch(const std::vector<const Image*>& sources,
+											const std::vector<MipDesc>& descs,
+											Utils::ThreadPool& pool);
+
+	/// Toksvig style specular anti-aliasing. Widens the roughness in the
+	/// lower mips where the normal map's normals disagree, so bumpy
+	/// surfaces don't sparkle in the distance. Both chains need matching
+	/// dimensions, channel picks which roughness channel to adjust.
+	bool ApplyToksvig(const MipChain& normalMips, MipChain& roughnessMips, uint32_t channel = 0);
+
+	float SRGBToLinear(uint8_t value);
+	uint8_t LinearToSRGB(float value);
+} // namespace TextureTools
@@ -0,0 +1,231 @@
+#include "TextureLoadPipeline.h"
+#include <algorithm>
+#include <limits>
+
+namespace TextureTools
+{
+	TextureLoadPipeline::TextureLoadPipeline(LoadStages stages, const LoadPipelineDesc& desc)
+	: mStages(std::move(stages))
+	, mDesc(desc)
+	, mRequests(std::numeric_limits<size_t>::max())
+	, mDecodeQueue(desc.mQueueDepth)
+	, mUploadQueue(desc.mQueueDepth)
+	{
+		mReadThread = std::thread([this]() { ReadLoop(); });
+
+		const uint32_t decodeThreads = std::max(desc.mDecodeThreads, 1U);
+		for (uint32_t i = 0; i < decodeThreads; ++i)
+		{
+			mDecodeThreads.emplace_back([this]() { DecodeLoop(); });
+		}
+	}
+
+	TextureLoadPipeline::~TextureLoadPipeline()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mStagingMutex);
+			mStopping = true;
+		}
+		mStagingFreed.notify_all();
+
+		mRequests.Close();
+		mDecodeQueue.Close();
+		mUploadQueue.Close();
+
+		mReadThread.join();
+		for (std::thread& thread : mDecodeThreads)
+		{
+			thread.join();
+		}
+	}
+
+	uint32_t TextureLoadPipeline::Enqueue(const std::filesystem::path& path,
+										  std::shared_ptr<void> userData)
+	{
+		auto item = std::make_unique<LoadItem>();
+		item->mId = mNextId++;
+		item->mPath = path;
+		item->mUserData = std::move(userData);
+
+		const uint32_t id = item->mId;
+		mOutstanding++;
+		mRequests.Push(std::move(item));
+		return id;
+	}
+
+	void TextureLoadPipeline::ReadLoop()
+	{
+		while (std::optional<ItemPtr> item = mRequests.Pop())
+		{
+			LoadItem& current = **item;
+			if (!mStages.mRead(current))
+			{
+				// Nothing was reserved for it, so there's nothing to release.
+				current.mFailed = true;
+				current.mStagingBytes = 0;
+			}
+
+			// Blocks while the decoders are behind, so only a few files
+			// worth of compressed bytes are ever held in memory.
+			if (!mDecodeQueue.Push(std::move(*item)))
+			{
+				return;
+			}
+		}
+	}
+
+	void TextureLoadPipeline::DecodeLoop()
+	{
+		while (std::optional<ItemPtr> item = mDecodeQueue.Pop())
+		{
+			LoadItem& current = **item;
+			if (!current.mFailed)
+			{
+				const size_t reserved = current.mStagingBytes;
+				if (!ReserveStaging(reserved))
+				{
+					return;
+				}
+
+				const bool decoded = mStages.mDecode(current);
+
+				// The compressed bytes aren't needed past this point.
+				current.mFileData.clear();
+				current.mFileData.shrink_to_fit();
+
+				if (!decoded)
+				{
+					current.mFailed = true;
+					current.mStagingBytes = 0;
+				}
+				AdjustStaging(reserved, current.mStagingBytes);
+			}
+
+			if (!mUploadQueue.Push(std::move(*item)))
+			{
+				return;
+			}
+		}
+	}
+
+	bool TextureLoadPipeline::ReserveStaging(size_t bytes)
+	{
+		std::unique_lock<std::mutex> lock(mStagingMutex);
+		mStagingFreed.wait(lock, [&]() {
+			return mStopping || mStagingBytes == 0 ||
+				   mStagingBytes + bytes <= mDesc.mMaxStagingBytes;
+		});
+		if (mStopping)
+		{
+			return false;
+		}
+
+		mStagingBytes += bytes;
+		mPeakStagingBytes = std::max(mPeakStagingBytes, mStagingBytes);
+		return true;
+	}
+
+	void TextureLoadPipeline::AdjustStaging(size_t reserved, size_t actual)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mStagingMutex);
+			mStagingBytes = mStagingBytes - reserved + actual;
+			mPeakStagingBytes = std::max(mPeakStagingBytes, mStagingBytes);
+		}
+
+		if (actual < reserved)
+		{
+			mStagingFreed.notify_all();
+		}
+	}
+
+	void TextureLoadPipeline::Complete(LoadItem& item)
+	{
+		AdjustStaging(item.mStagingBytes, 0);
+		item.mStagingBytes = 0;
+
+		if (mStages.mComplete)
+		{
+			mStages.mComplete(item);
+		}
+
+		if (item.mFailed)
+		{
+			mFailed++;
+		}
+		else
+		{
+			mCompleted++;
+		}
+		mOutstanding--;
+	}
+
+	uint32_t TextureLoadPipeline::Pump(uint64_t completedFence, uint32_t maxUploads)
+	{
+		uint32_t completed = 0;
+
+		// Retire first so the staging they free lets the decoders carry on
+		// while we record this round's uploads.
+		std::erase_if(mInFlight, [&](const ItemPtr& item) {
+			if (item->mFence > completedFence)
+			{
+				return false;
+			}
+
+			Complete(*item);
+			completed++;
+			return true;
+		});
+
+		std::vector<ItemPtr> submitted;
+		for (uint32_t i = 0; i < maxUploads; ++i)
+		{
+			std::optional<ItemPtr> item = mUploadQueue.TryPop();
+			if (!item)
+			{
+				break;
+			}
+
+			LoadItem& current = **item;
+			if (!current.mFailed && !mStages.mUpload(current))
+			{
+				current.mFailed = true;
+			}
+
+			if (current.mFailed)
+			{
+				Complete(current);
+				completed++;
+				continue;
+			}
+			submitted.push_back(std::move(*item));
+		}
+
+		if (!submitted.empty())
+		{
+			const uint64_t fence = mStages.mSubmit();
+			for (ItemPtr& item : submitted)
+			{
+				item->mFence = fence;
+				mInFlight.push_back(std::move(item));
+			}
+		}
+
+		return completed;
+	}
+
+	LoadPipelineStats TextureLoadPipeline::GetStats() const
+	{
+		LoadPipelineStats stats;
+		stats.mQueued = mNextId.load();
+		stats.mCompleted = mCompleted.load();
+		stats.mFailed = mFailed.load();
+		stats.mDecodeQueueHighWater = mDecodeQueue.GetHighWater();
+		stats.mUploadQueueHighWater = mUploadQueue.GetHighWater();
+
+		std::lock_guard<std::mutex> lock(mStagingMutex);
+		stats.mStagingBytes = mStagingBytes;
+		stats.mPeakStagingBytes = mPeakStagingBytes;
+		return stats;
+	}
+} // namespace TextureTools
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../../utils/BoundedQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TextureTools
+{
+	/// One texture moving through the pipeline. The stages fill it in as
+	/// it goes.
+	struct LoadItem
+	{
+		uint32_t mId = 0;
+		std::filesystem::path mPath;
+		/// Whatever the caller needs back in mComplete (mip settings,
+		/// where the texture goes...).
+		std::shared_ptr<void> mUserData;
+
+		std::vector<uint8_t> mFileData;
+		uint64_t mContentHash = 0;
+
+		/// Memory the item holds from decode until its upload retires. Read
+		/// can set a guess from the file header so decode waits for room
+		/// before allocating, decode sets the real size.
+		size_t mStagingBytes = 0;
+
+		/// Output of decode, normally the texture waiting for upload.
+		std::shared_ptr<void> mResult;
+
+		/// Fence value the upload completes at, set by Pump.
+		uint64_t mFence = 0;
+
+		bool mFailed = false;
+		std::string mError;
+	};
+
+	/// The work itself, plugged in by the Renderer (or by stubs in the
+	/// tests). A stage returning false marks the item failed and it skips
+	/// straight to mComplete.
+	struct LoadStages
+	{
+		/// I/O thread, fills mFileData.
+		std::function<bool(LoadItem&)> mRead;
+		/// Decode threads, fills mResult and mStagingBytes.
+		std::function<bool(LoadItem&)> mDecode;
+		/// Thread calling Pump, records the copy for one item.
+		std::function<bool(LoadItem&)> mUpload;
+		/// Thread calling Pump, after a round of mUpload calls. Kicks the
+		/// copies off and returns the fence value they are done at.
+		std::function<uint64_t()> mSubmit;
+		/// Thread calling Pump, once the item's fence has passed or it
+		/// failed. The texture can be used from here on.
+		std::function<void(LoadItem&)> mComplete;
+	};
+
+	struct LoadPipelineDesc
+	{
+		uint32_t mDecodeThreads = 2;
+		/// Capacity of the read -> decode and decode -> upload queues.
+		uint32_t mQueueDepth = 4;
+		/// Decoded data waiting for upload or still being copied never goes
+		/// over this, decode waits instead. A single item bigger than the
+		/// whole budget is let through on its own.
+		size_t mMaxStagingBytes = 128ULL * 1024 * 1024;
+	};
+
+	struct LoadPipelineStats
+	{
+		uint32_t mQueued = 0;
+		uint32_t mCompleted = 0;
+		uint32_t mFailed = 0;
+		size_t mStagingBytes = 0;
+		size_t mPeakStagingBytes = 0;
+		size_t mDecodeQueueHighWater = 0;
+		size_t mUploadQueueHighWater = 0;
+	};
+
+	/// Streams textures through read -> decode -> upload. Reading happens on
+	/// its own I/O thread, decoding on a few threads of its own (they block
+	/// on backpressure, so they stay off the shared ThreadPool), and the
+	/// upload on whoever calls Pump, which is the render thread. Bounded
+	/// queues between the stages and the staging budget keep a burst of
+	/// requests from decoding everything into memory at once.
+	class TextureLoadPipeline
+	{
+	public:
+		explicit TextureLoadPipeline(LoadStages stages, const LoadPipelineDesc& desc = {});
+		/// Stops the threads. Items that haven't completed are dropped
+		/// without calling mComplete.
+		~TextureLoadPipeline();
+
+		TextureLoadPipeline(const TextureLoadPipeline&) = delete;
+		TextureLoadPipeline& operator=(const TextureLoadPipeline&) = delete;
+
+		/// Never blocks. Returns the id that comes back in the item.
+		uint32_t Enqueue(const std::filesystem::path& path, std::shared_ptr<void> userData = {});
+
+		/// Call once a frame. Completes the uploads whose fence is at or
+		/// below completedFence, then uploads up to maxUploads decoded
+		/// items and submits them. Returns how many items completed.
+		uint32_t Pump(uint64_t completedFence, uint32_t maxUploads = UINT32_MAX);
+
+		/// Nothing queued, decoding or waiting on the GPU.
+		bool IsIdle() const { return mOutstanding.load() == 0; }
+
+		LoadPipelineStats GetStats() const;
+
+	private:
+		using ItemPtr = std::unique_ptr<LoadItem>;
+
+		void ReadLoop();
+		void DecodeLoop();
+
+		/// Waits until bytes fit in the staging budget. False when stopping.
+		bool ReserveStaging(size_t bytes);
+		void AdjustStaging(size_t reserved, size_t actual);
+
+		void Complete(LoadItem& item);
+
+		LoadStages mStages;
+		LoadPipelineDesc mDesc;
+
+		Utils::BoundedQueue<ItemPtr> mRequests;
+		Utils::BoundedQueue<ItemPtr> mDecodeQueue;
+		Utils::BoundedQueue<ItemPtr> mUploadQueue;
+
+		/// Only touched by the thread calling Pump.
+		std::vector<ItemPtr> mInFlight;
+
+		mutable std::mutex mStagingMutex;
+		std::condition_variable mStagingFreed;
+		size_t mStagingBytes = 0;
+		size_t mPeakStagingBytes = 0;
+		bool mStopping = false;
+
+		std::atomic<uint32_t> mNextId{0};
+		std::atomic<uint32_t> mOutstanding{0};
+		std::atomic<uint32_t> mCompleted{0};
+		std::atomic<uint32_t> mFailed{0};
+
+		std::thread mReadThread;
+		std::vector<std::thread> mDecodeThreads;
+	};
+} // namespace TextureTools
@@ -70,12 +70,8 @@ extern "C"
 
 		app->Update(deltaTime);
 
-		// The graphics context is a global that we need to make sure
-		// exists first before calling it to Render.
-		if (Graphics::gGraphicsContext != nullptr)
-		{
-			app->Render(*Graphics::gGraphicsContext);
-		}
+		// Records into whichever frame context the GPU is done with.
+		app->Render();
 
 		return SDL_APP_CONTINUE;
 	}
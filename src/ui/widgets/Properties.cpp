@@ -1,15 +1,58 @@
 #include "Properties.h"
 #include "../../Lighting.h"
+#include "../../utils/MemoryTracker.h"
 #include <imgui.h>
 #include <cmath>
 #include <numbers>
 
 namespace UI
 {
+	namespace
+	{
+		void ShowMemoryStats(const PropertiesCallbacks& callbacks)
+		{
+			constexpr double MB = 1024.0 * 1024.0;
+
+			ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+									ImGuiTableFlags_SizingStretchProp;
+			if (ImGui::BeginTable("##MemoryStats", 4, flags))
+			{
+				ImGui::TableSetupColumn("Tag");
+				ImGui::TableSetupColumn("MB");
+				ImGui::TableSetupColumn("Peak MB");
+				ImGui::TableSetupColumn("Allocs");
+				ImGui::TableHeadersRow();
+
+				for (const Utils::MemoryTagStats& stats : Utils::GetAllMemoryStats())
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(stats.mName);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", static_cast<double>(stats.mBytes) / MB);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f", static_cast<double>(stats.mPeakBytes) / MB);
+					ImGui::TableNextColumn();
+					ImGui::Text("%llu", static_cast<unsigned long long>(stats.mLiveAllocations));
+				}
+				ImGui::EndTable();
+			}
+
+			if (ImGui::Button("Reset Peaks"))
+			{
+				Utils::ResetMemoryPeaks();
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Dump JSON") && callbacks.onDumpMemoryStats)
+			{
+				callbacks.onDumpMemoryStats();
+			}
+		}
+	} // namespace
 
 	void ShowProperties(bool* pOpen, const char* selectedObjectName, TransformProperties& transform,
 						const PropertiesCallbacks& callbacks, SpotLight* spotLight,
-						float* blurIntensity)
+						float* blurIntensity, const FrameStats* frameStats)
 	{
 
 		if (!ImGui::Begin("Properties", pOpen))
@@ -72,6 +115,21 @@ namespace UI
 			ImGui::Text("Frame Time: %.3f ms",
 						static_cast<double>(1000.0F / ImGui::GetIO().Framerate));
 
+			if (frameStats)
+			{
+				constexpr double KB = 1024.0;
+				ImGui::Text("Heap Allocations: %llu per frame",
+							static_cast<unsigned long long>(frameStats->mHeapAllocations));
+				ImGui::Text("Frame Arena: %.1f / %.1f KB, %llu blocks",
+							static_cast<double>(frameStats->mArenaUsed) / KB,
+							static_cast<double>(frameStats->mArenaCapacity) / KB,
+							static_cast<unsigned long long>(frameStats->mArenaBlockAllocations));
+			}
+
+			ImGui::Spacing();
+			ImGui::Text("Memory");
+			ShowMemoryStats(callbacks);
+
 			ImGui::Unindent();
 			ImGui::Spacing();
 		}
@@ -2,6 +2,8 @@
 
 #include <SDL3/SDL.h>
 #include <imgui.h>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 
 // Forward declarations
@@ -18,15 +20,26 @@ namespace UI
 		float scale[3];
 	};
 
+	/// Per-frame memory numbers from the renderer for Render Stats.
+	struct FrameStats
+	{
+		uint64_t mHeapAllocations = 0;
+		size_t mArenaUsed = 0;
+		size_t mArenaCapacity = 0;
+		uint64_t mArenaBlockAllocations = 0;
+	};
+
 	struct PropertiesCallbacks
 	{
 		std::function<void(const TransformProperties&)> onTransformChanged;
 		std::function<void()> onSpotLightChanged;
 		std::function<void(float)> onBlurIntensityChanged;
+		/// The Dump JSON button under the memory counters.
+		std::function<void()> onDumpMemoryStats;
 	};
 
 	void ShowProperties(bool* pOpen, const char* selectedObjectName, TransformProperties& transform,
 						const PropertiesCallbacks& callbacks, SpotLight* spotLight = nullptr,
-						float* blurIntensity = nullptr);
+						float* blurIntensity = nullptr, const FrameStats* frameStats = nullptr);
 
 } // namespace UI
@@ -5,7 +5,7 @@
 namespace UI
 {
 
-	ViewportState ShowViewport(bool* pOpen, D3D12_GPU_DESCRIPTOR_HANDLE viewportSrv)
+	ViewportState ShowViewport(bool* pOpen, D3D12_GPU_DESCRIPTOR_HANDLE viewportSrv, ImVec2 uvMax)
 	{
 		ViewportState state = {};
 		state.size = ImVec2(0, 0);
@@ -30,7 +30,8 @@ namespace UI
 		if (viewportSrv.ptr != 0)
 		{
 			// Render the viewport texture.
-			ImGui::Image(static_cast<ImTextureID>(viewportSrv.ptr), state.size);
+			ImGui::Image(static_cast<ImTextureID>(viewportSrv.ptr), state.size, ImVec2(0.0F, 0.0F),
+						 uvMax);
 		}
 		else
 		{
@@ -13,6 +13,9 @@ namespace UI
 		bool isFocused;
 	};
 
-	ViewportState ShowViewport(bool* pOpen, D3D12_GPU_DESCRIPTOR_HANDLE viewportSrv);
+	/// uvMax is how much of the texture to show, the renderer's targets
+	/// can be bigger than what it rendered.
+	ViewportState ShowViewport(bool* pOpen, D3D12_GPU_DESCRIPTOR_HANDLE viewportSrv,
+							   ImVec2 uvMax = ImVec2(1.0F, 1.0F));
 
 } // namespace UI
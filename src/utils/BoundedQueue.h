@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace Utils
+{
+	/// Blocking FIFO with a fixed capacity for handing work between
+	/// pipeline stages. Push waits while the queue is full, which is what
+	/// slows a fast producer down to the speed of its consumer.
+	template <typename T>
+	class BoundedQueue
+	{
+	public:
+		explicit BoundedQueue(size_t capacity)
+		: mCapacity(capacity > 0 ? capacity : 1)
+		{
+		}
+
+		BoundedQueue(const BoundedQueue&) = delete;
+		BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+		/// Blocks until there is room. Returns false (and drops the item)
+		/// if the queue was closed in the meantime.
+		bool Push(T item)
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mNotFull.wait(lock, [this]() { return mClosed || mItems.size() < mCapacity; });
+			if (mClosed)
+			{
+				return false;
+			}
+
+			mItems.push_back(std::move(item));
+			if (mItems.size() > mHighWater)
+			{
+				mHighWater = mItems.size();
+			}
+			mNotEmpty.notify_one();
+			return true;
+		}
+
+		/// Blocks until an item is available. Returns nothing once the
+		/// queue is closed and drained.
+		std::optional<T> Pop()
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mNotEmpty.wait(lock, [this]() { return mClosed || !mItems.empty(); });
+			return PopLocked();
+		}
+
+		/// Non-blocking version of Pop for the main thread.
+		std::optional<T> TryPop()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return PopLocked();
+		}
+
+		/// Wakes everyone up, Push fails from now on and Pop returns what
+		/// is left before returning nothing.
+		void Close()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mClosed = true;
+			mNotFull.notify_all();
+			mNotEmpty.notify_all();
+		}
+
+		size_t GetSize() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mItems.size();
+		}
+
+		size_t GetCapacity() const { return mCapacity; }
+
+		/// Most items the queue ever held at once.
+		size_t GetHighWater() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mHighWater;
+		}
+
+	private:
+		std::optional<T> PopLocked()
+		{
+			if (mItems.empty())
+			{
+				return std::nullopt;
+			}
+
+			std::optional<T> item(std::move(mItems.front()));
+			mItems.pop_front();
+			mNotFull.notify_one();
+			return item;
+		}
+
+		const size_t mCapacity;
+		mutable std::mutex mMutex;
+		std::condition_variable mNotFull;
+		std::condition_variable mNotEmpty;
+		std::deque<T> mItems;
+		size_t mHighWater = 0;
+		bool mClosed = false;
+	};
+} // namespace Utils
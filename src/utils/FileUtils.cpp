@@ -0,0 +1,95 @@
+#include "FileUtils.h"
+#include "Hash.h"
+#include <algorithm>
+#include <fstream>
+
+namespace Utils
+{
+	bool ReadBinaryFile(const std::filesystem::path& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		std::streamsize size = file.tellg();
+		if (size <= 0)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(size));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+	}
+
+	bool ReadBinaryFile(const std::filesystem::path& path, std::vector<uint8_t>& data,
+						uint64_t& contentHash)
+	{
+		// Big enough to keep the reads efficient, small enough that the
+		// hashed chunk is still in cache.
+		constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		std::streamsize size = file.tellg();
+		if (size <= 0)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(size));
+		file.seekg(0, std::ios::beg);
+
+		Hasher64 hasher;
+		size_t offset = 0;
+		while (offset < data.size())
+		{
+			size_t chunk = std::min(CHUNK_SIZE, data.size() - offset);
+			if (!file.read(reinterpret_cast<char*>(data.data() + offset),
+						   static_cast<std::streamsize>(chunk)))
+			{
+				return false;
+			}
+
+			hasher.Update(data.data() + offset, chunk);
+			offset += chunk;
+		}
+
+		contentHash = hasher.Finalize();
+		return true;
+	}
+
+	bool WriteBinaryFile(const std::filesystem::path& path, const void* data, size_t size)
+	{
+		std::error_code ec;
+		if (path.has_parent_path())
+		{
+			std::filesystem::create_directories(path.parent_path(), ec);
+		}
+
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open() ||
+				!file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)))
+			{
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+		return true;
+	}
+} // namespace Utils
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Utils
+{
+	/// Reads the whole file into data, reusing its capacity. Returns false
+	/// if the file is missing or empty.
+	bool ReadBinaryFile(const std::filesystem::path& path, std::vector<uint8_t>& data);
+
+	/// Same as above but also hashes the bytes (XXH64) chunk by chunk as
+	/// they come in, so there is no second pass over the data.
+	bool ReadBinaryFile(const std::filesystem::path& path, std::vector<uint8_t>& data,
+						uint64_t& contentHash);
+
+	/// Writes to a temporary file next to path and renames it over path,
+	/// so a crash halfway never leaves a truncated file behind. Creates
+	/// the parent directories if needed.
+	bool WriteBinaryFile(const std::filesystem::path& path, const void* data, size_t size);
+} // namespace Utils
@@ -0,0 +1,152 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+
+namespace Utils
+{
+	namespace
+	{
+		std::atomic<uint64_t> sNextGeneration{1};
+
+		/// A thread's chunk in one arena for one frame.
+		struct ThreadChunk
+		{
+			uint64_t mGeneration = 0;
+			std::byte* mPosition = nullptr;
+			std::byte* mEnd = nullptr;
+		};
+
+		/// A few, so a thread going back and forth between two arenas
+		/// doesn't grab a new chunk on every switch.
+		constexpr size_t THREAD_CHUNKS = 4;
+		thread_local std::array<ThreadChunk, THREAD_CHUNKS> tChunks;
+		thread_local size_t tNextChunk = 0;
+
+		std::byte* AlignUp(std::byte* pointer, size_t alignment)
+		{
+			auto address = reinterpret_cast<uintptr_t>(pointer);
+			address = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+			return reinterpret_cast<std::byte*>(address);
+		}
+	} // namespace
+
+	FrameArena::FrameArena(size_t blockSize, size_t chunkSize)
+	: mBlockSize(std::max(blockSize, chunkSize))
+	, mChunkSize(chunkSize)
+	, mGeneration(sNextGeneration.fetch_add(1))
+	{
+	}
+
+	void* FrameArena::Allocate(size_t size, size_t alignment)
+	{
+		assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+		size = std::max<size_t>(size, 1);
+
+		ThreadChunk* chunk = nullptr;
+		for (ThreadChunk& candidate : tChunks)
+		{
+			if (candidate.mGeneration == mGeneration)
+			{
+				chunk = &candidate;
+				break;
+			}
+		}
+
+		if (chunk)
+		{
+			std::byte* aligned = AlignUp(chunk->mPosition, alignment);
+			if (aligned + size <= chunk->mEnd)
+			{
+				chunk->mPosition = aligned + size;
+				return aligned;
+			}
+		}
+
+		// Anything that would waste a good part of a chunk gets its own
+		// piece of the block.
+		if (size + alignment > mChunkSize / 4)
+		{
+			return Reserve(size, alignment);
+		}
+
+		if (!chunk)
+		{
+			chunk = &tChunks[tNextChunk++ % THREAD_CHUNKS];
+			chunk->mGeneration = mGeneration;
+		}
+		chunk->mPosition = Reserve(mChunkSize, alignof(std::max_align_t));
+		chunk->mEnd = chunk->mPosition + mChunkSize;
+
+		std::byte* aligned = AlignUp(chunk->mPosition, alignment);
+		chunk->mPosition = aligned + size;
+		return aligned;
+	}
+
+	std::byte* FrameArena::Reserve(size_t size, size_t alignment)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (!mBlocks.empty())
+		{
+			Block& block = mBlocks.back();
+			std::byte* aligned = AlignUp(block.mMemory.get() + mOffset, alignment);
+			size_t end = static_cast<size_t>(aligned - block.mMemory.get()) + size;
+			if (end <= block.mSize)
+			{
+				mReserved += end - mOffset;
+				mOffset = end;
+				return aligned;
+			}
+		}
+
+		Block block;
+		block.mSize = std::max(mBlockSize, size + alignment);
+		block.mMemory = std::make_unique_for_overwrite<std::byte[]>(block.mSize);
+		mStats.mBlockAllocations++;
+		mStats.mCapacity += block.mSize;
+		mMemory.Set(mStats.mCapacity);
+
+		std::byte* aligned = AlignUp(block.mMemory.get(), alignment);
+		mOffset = static_cast<size_t>(aligned - block.mMemory.get()) + size;
+		mReserved += mOffset;
+		mBlocks.push_back(std::move(block));
+		return aligned;
+	}
+
+	void FrameArena::Reset()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mStats.mFrames++;
+		mStats.mUsed = mReserved;
+		mStats.mHighWater = std::max(mStats.mHighWater, mReserved);
+
+		// Whatever spilled over gets merged into one block that holds it
+		// all, so the next frame like this one stays in a single block.
+		if (mBlocks.size() > 1)
+		{
+			size_t total = 0;
+			for (const Block& block : mBlocks)
+			{
+				total += block.mSize;
+			}
+			mBlocks.clear();
+
+			Block block;
+			block.mSize = total;
+			block.mMemory = std::make_unique_for_overwrite<std::byte[]>(total);
+			mBlocks.push_back(std::move(block));
+			mBlockSize = total;
+			mStats.mBlockAllocations++;
+			mStats.mCapacity = total;
+			mMemory.Set(total);
+		}
+
+		mOffset = 0;
+		mReserved = 0;
+		// Every thread's chunk is stale now.
+		mGeneration = sNextGeneration.fetch_add(1);
+	}
+} // namespace Utils
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "MemoryTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Utils
+{
+	struct FrameArenaStats
+	{
+		uint64_t mFrames = 0;
+		/// Bytes in the arena's blocks.
+		size_t mCapacity = 0;
+		/// Bytes handed out to threads last frame, chunks included whole.
+		size_t mUsed = 0;
+		size_t mHighWater = 0;
+		/// Times the arena itself went to the heap for a block. Stays put
+		/// once the arena has seen the biggest frame.
+		uint64_t mBlockAllocations = 0;
+	};
+
+	/// Linear allocator for data that only lives for one frame (draw lists,
+	/// culling results, sort keys). Nothing is freed on its own, Reset
+	/// takes everything back at once.
+	///
+	/// Each thread carves its allocations out of its own chunk, so threads
+	/// only meet on the mutex when they need a new chunk. A frame that
+	/// doesn't fit spills into more blocks and the next Reset merges them
+	/// into one, after that the frames of that size don't allocate at all.
+	///
+	/// Only trivially destructible things belong in here, destructors
+	/// never run.
+	class FrameArena
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+		static constexpr size_t DEFAULT_CHUNK_SIZE = 16 * 1024;
+
+		explicit FrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE,
+							size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/// Safe from any thread. Never returns null, the arena grows.
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		/// Uninitialized room for count Ts.
+		template <typename T>
+		T* AllocateArray(size_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "destructors never run");
+			return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+		}
+
+		/// Once per frame, when nothing allocated since the last Reset is
+		/// used anymore and no other thread is allocating.
+		void Reset();
+
+		const FrameArenaStats& GetStats() const { return mStats; }
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<std::byte[]> mMemory;
+			size_t mSize = 0;
+		};
+
+		/// Takes size bytes from the current block under the mutex, or a
+		/// new block if it doesn't fit.
+		std::byte* Reserve(size_t size, size_t alignment);
+
+		size_t mBlockSize;
+		size_t mChunkSize;
+
+		std::mutex mMutex;
+		/// The last one is the one being carved up.
+		std::vector<Block> mBlocks;
+		size_t mOffset = 0;
+		size_t mReserved = 0;
+
+		/// Unique across all arenas and resets, it's how a thread finds out
+		/// its chunk belongs to another arena or an older frame.
+		uint64_t mGeneration = 0;
+		FrameArenaStats mStats;
+		/// mStats.mCapacity, charged to the FrameArena tag.
+		MemoryCharge mMemory{MemoryTag::FRAME_ARENA};
+	};
+
+	/// Lets the standard containers live in a FrameArena. deallocate is a
+	/// no-op, so a vector that grows leaves its old storage behind until
+	/// Reset, reserve up front where the size is known.
+	template <typename T>
+	class FrameAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit FrameAllocator(FrameArena& arena)
+		: mArena(&arena)
+		{
+		}
+
+		template <typename U>
+		FrameAllocator(const FrameAllocator<U>& other)
+		: mArena(other.GetArena())
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(mArena->Allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* /*pointer*/, size_t /*count*/) {}
+
+		FrameArena* GetArena() const { return mArena; }
+
+		template <typename U>
+		bool operator==(const FrameAllocator<U>& other) const
+		{
+			return mArena == other.GetArena();
+		}
+
+	private:
+		FrameArena* mArena;
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+} // namespace Utils
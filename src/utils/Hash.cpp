@@ -0,0 +1,151 @@
+#include "Hash.h"
+#include <cstring>
+
+namespace Utils
+{
+	namespace
+	{
+		constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+		constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+		constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+		constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+		constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+		uint64_t RotateLeft(uint64_t value, uint32_t bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		uint64_t Read64(const uint8_t* p)
+		{
+			uint64_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint64_t Round(uint64_t accumulator, uint64_t input)
+		{
+			accumulator += input * PRIME2;
+			accumulator = RotateLeft(accumulator, 31);
+			return accumulator * PRIME1;
+		}
+
+		uint64_t MergeRound(uint64_t hash, uint64_t accumulator)
+		{
+			hash ^= Round(0, accumulator);
+			return hash * PRIME1 + PRIME4;
+		}
+	} // namespace
+
+	Hasher64::Hasher64(uint64_t seed)
+	: mSeed(seed)
+	{
+		mAccumulators[0] = seed + PRIME1 + PRIME2;
+		mAccumulators[1] = seed + PRIME2;
+		mAccumulators[2] = seed;
+		mAccumulators[3] = seed - PRIME1;
+	}
+
+	void Hasher64::Update(const void* data, size_t size)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* end = p + size;
+		mTotalSize += size;
+
+		// Top up the leftovers from the last call first.
+		if (mBufferSize + size < 32)
+		{
+			std::memcpy(mBuffer + mBufferSize, p, size);
+			mBufferSize += static_cast<uint32_t>(size);
+			return;
+		}
+
+		if (mBufferSize > 0)
+		{
+			uint32_t fill = 32 - mBufferSize;
+			std::memcpy(mBuffer + mBufferSize, p, fill);
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				mAccumulators[i] = Round(mAccumulators[i], Read64(mBuffer + i * 8));
+			}
+			p += fill;
+			mBufferSize = 0;
+		}
+
+		while (p + 32 <= end)
+		{
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				mAccumulators[i] = Round(mAccumulators[i], Read64(p + i * 8));
+			}
+			p += 32;
+		}
+
+		mBufferSize = static_cast<uint32_t>(end - p);
+		std::memcpy(mBuffer, p, mBufferSize);
+	}
+
+	uint64_t Hasher64::Finalize() const
+	{
+		uint64_t hash;
+		if (mTotalSize >= 32)
+		{
+			hash = RotateLeft(mAccumulators[0], 1) + RotateLeft(mAccumulators[1], 7) +
+				   RotateLeft(mAccumulators[2], 12) + RotateLeft(mAccumulators[3], 18);
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				hash = MergeRound(hash, mAccumulators[i]);
+			}
+		}
+		else
+		{
+			hash = mSeed + PRIME5;
+		}
+
+		hash += mTotalSize;
+
+		const uint8_t* p = mBuffer;
+		const uint8_t* end = mBuffer + mBufferSize;
+		while (p + 8 <= end)
+		{
+			hash ^= Round(0, Read64(p));
+			hash = RotateLeft(hash, 27) * PRIME1 + PRIME4;
+			p += 8;
+		}
+
+		if (p + 4 <= end)
+		{
+			hash ^= static_cast<uint64_t>(Read32(p)) * PRIME1;
+			hash = RotateLeft(hash, 23) * PRIME2 + PRIME3;
+			p += 4;
+		}
+
+		while (p < end)
+		{
+			hash ^= static_cast<uint64_t>(*p) * PRIME5;
+			hash = RotateLeft(hash, 11) * PRIME1;
+			p++;
+		}
+
+		hash ^= hash >> 33;
+		hash *= PRIME2;
+		hash ^= hash >> 29;
+		hash *= PRIME3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	uint64_t Hash64(const void* data, size_t size, uint64_t seed)
+	{
+		Hasher64 hasher(seed);
+		hasher.Update(data, size);
+		return hasher.Finalize();
+	}
+} // namespace Utils
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils
+{
+	/// Streaming XXH64. Feed it data as it comes in (e.g. while reading a
+	/// file in chunks) and the result is the same as hashing it all at once.
+	class Hasher64
+	{
+	public:
+		explicit Hasher64(uint64_t seed = 0);
+
+		void Update(const void* data, size_t size);
+		uint64_t Finalize() const;
+
+	private:
+		uint64_t mAccumulators[4];
+		uint8_t mBuffer[32];
+		uint32_t mBufferSize = 0;
+		uint64_t mTotalSize = 0;
+		uint64_t mSeed;
+	};
+
+	uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0);
+
+	/// Mixes value into an existing hash, for building keys out of a few
+	/// fields.
+	inline uint64_t HashCombine(uint64_t hash, uint64_t value)
+	{
+		return hash ^ (value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2));
+	}
+} // namespace Utils
@@ -0,0 +1,85 @@
+#include "HeapCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> sHeapAllocations{0};
+
+	void* CountedAlloc(std::size_t size)
+	{
+		sHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+		if (void* pointer = std::malloc(size == 0 ? 1 : size))
+		{
+			return pointer;
+		}
+		throw std::bad_alloc();
+	}
+
+	void* CountedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+	{
+		sHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+		size_t align = static_cast<size_t>(alignment);
+		// aligned_alloc wants a multiple of the alignment, MSVC has neither
+		// it nor that rule.
+#ifdef _WIN32
+		void* pointer = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+		void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+		if (pointer)
+		{
+			return pointer;
+		}
+		throw std::bad_alloc();
+	}
+
+	void AlignedFree(void* pointer)
+	{
+#ifdef _WIN32
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+} // namespace
+
+namespace Utils
+{
+	uint64_t GetHeapAllocationCount()
+	{
+		return sHeapAllocations.load(std::memory_order_relaxed);
+	}
+} // namespace Utils
+
+// The array and nothrow forms go through these by default.
+void* operator new(std::size_t size)
+{
+	return CountedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept
+{
+	AlignedFree(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+	AlignedFree(pointer);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Utils
+{
+	/// Calls to the global operator new since start up, from any thread.
+	/// Counted by the replacement operator new in HeapCounter.cpp, which
+	/// only the engine links, the tests bring their own. Plain malloc from
+	/// C libraries (ImGui, the D3D12 runtime) isn't seen.
+	uint64_t GetHeapAllocationCount();
+} // namespace Utils
@@ -0,0 +1,157 @@
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <nlohmann/json.hpp>
+
+namespace Utils
+{
+	namespace
+	{
+		struct TagInfo
+		{
+			const char* mName;
+			MemoryDomain mDomain;
+		};
+
+		constexpr std::array<TagInfo, MEMORY_TAG_COUNT> TAG_INFO = {{
+			{"Mesh.CPU", MemoryDomain::CPU},
+			{"Texture.CPU", MemoryDomain::CPU},
+			{"Texture.Staging", MemoryDomain::GPU},
+			{"Texture.GPU", MemoryDomain::GPU},
+			{"Descriptors", MemoryDomain::GPU},
+			{"FrameArena", MemoryDomain::CPU},
+			{"D3D12MA.Default", MemoryDomain::GPU},
+			{"D3D12MA.Upload", MemoryDomain::GPU},
+			{"D3D12MA.Readback", MemoryDomain::GPU},
+		}};
+
+		/// Own cache line each, the mesh and texture loaders bump
+		/// different tags from different workers at the same time.
+		struct alignas(64) TagCounters
+		{
+			std::atomic<uint64_t> mBytes{0};
+			std::atomic<uint64_t> mPeakBytes{0};
+			std::atomic<uint64_t> mLiveAllocations{0};
+			std::atomic<uint64_t> mTotalAllocations{0};
+		};
+
+		std::array<TagCounters, MEMORY_TAG_COUNT> sCounters;
+
+		TagCounters& GetCounters(MemoryTag tag)
+		{
+			return sCounters[static_cast<size_t>(tag)];
+		}
+
+		void RaisePeak(TagCounters& counters, uint64_t bytes)
+		{
+			uint64_t peak = counters.mPeakBytes.load(std::memory_order_relaxed);
+			while (bytes > peak && !counters.mPeakBytes.compare_exchange_weak(
+									   peak, bytes, std::memory_order_relaxed))
+			{
+			}
+		}
+	} // namespace
+
+	void TrackAllocation(MemoryTag tag, size_t bytes)
+	{
+		TagCounters& counters = GetCounters(tag);
+		uint64_t now = counters.mBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		counters.mLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		RaisePeak(counters, now);
+	}
+
+	void TrackFree(MemoryTag tag, size_t bytes)
+	{
+		TagCounters& counters = GetCounters(tag);
+		counters.mBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		counters.mLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void SetTrackedBytes(MemoryTag tag, uint64_t bytes, uint64_t allocations)
+	{
+		TagCounters& counters = GetCounters(tag);
+		counters.mBytes.store(bytes, std::memory_order_relaxed);
+		counters.mLiveAllocations.store(allocations, std::memory_order_relaxed);
+		// Only the live count is known, so the total can't go backwards
+		// but it can't count what came and went between two polls either.
+		uint64_t total = counters.mTotalAllocations.load(std::memory_order_relaxed);
+		while (allocations > total && !counters.mTotalAllocations.compare_exchange_weak(
+										  total, allocations, std::memory_order_relaxed))
+		{
+		}
+		RaisePeak(counters, bytes);
+	}
+
+	const char* GetMemoryTagName(MemoryTag tag)
+	{
+		return TAG_INFO[static_cast<size_t>(tag)].mName;
+	}
+
+	MemoryDomain GetMemoryTagDomain(MemoryTag tag)
+	{
+		return TAG_INFO[static_cast<size_t>(tag)].mDomain;
+	}
+
+	MemoryTagStats GetMemoryStats(MemoryTag tag)
+	{
+		const TagCounters& counters = GetCounters(tag);
+
+		MemoryTagStats stats;
+		stats.mName = GetMemoryTagName(tag);
+		stats.mDomain = GetMemoryTagDomain(tag);
+		stats.mBytes = counters.mBytes.load(std::memory_order_relaxed);
+		stats.mPeakBytes = counters.mPeakBytes.load(std::memory_order_relaxed);
+		stats.mLiveAllocations = counters.mLiveAllocations.load(std::memory_order_relaxed);
+		stats.mTotalAllocations = counters.mTotalAllocations.load(std::memory_order_relaxed);
+		// The counters are read one by one, a free racing the read could
+		// leave the peak a little behind.
+		stats.mPeakBytes = std::max(stats.mPeakBytes, stats.mBytes);
+		return stats;
+	}
+
+	std::array<MemoryTagStats, MEMORY_TAG_COUNT> GetAllMemoryStats()
+	{
+		std::array<MemoryTagStats, MEMORY_TAG_COUNT> all;
+		for (size_t i = 0; i < MEMORY_TAG_COUNT; ++i)
+		{
+			all[i] = GetMemoryStats(static_cast<MemoryTag>(i));
+		}
+		return all;
+	}
+
+	void ResetMemoryPeaks()
+	{
+		for (TagCounters& counters : sCounters)
+		{
+			counters.mPeakBytes.store(counters.mBytes.load(std::memory_order_relaxed),
+									  std::memory_order_relaxed);
+		}
+	}
+
+	std::string DumpMemoryStatsJson()
+	{
+		nlohmann::json tags = nlohmann::json::object();
+		uint64_t cpuBytes = 0;
+		uint64_t gpuBytes = 0;
+
+		for (const MemoryTagStats& stats : GetAllMemoryStats())
+		{
+			bool isCpu = stats.mDomain == MemoryDomain::CPU;
+			tags[stats.mName] = {
+				{"domain", isCpu ? "cpu" : "gpu"},
+				{"bytes", stats.mBytes},
+				{"peakBytes", stats.mPeakBytes},
+				{"liveAllocations", stats.mLiveAllocations},
+				{"totalAllocations", stats.mTotalAllocations},
+			};
+			(isCpu ? cpuBytes : gpuBytes) += stats.mBytes;
+		}
+
+		nlohmann::json root = {
+			{"tags", tags},
+			{"totals", {{"cpuBytes", cpuBytes}, {"gpuBytes", gpuBytes}}},
+		};
+		return root.dump(2);
+	}
+} // namespace Utils
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	/// What a tracked allocation belongs to. The D3D12MA tags aren't
+	/// tracked per allocation, UpdateMemoryStats in Core copies the
+	/// allocator's own statistics into them.
+	enum class MemoryTag : uint8_t
+	{
+		MESH_CPU,
+		TEXTURE_CPU,
+		TEXTURE_STAGING,
+		TEXTURE_GPU,
+		DESCRIPTORS,
+		FRAME_ARENA,
+		D3D12MA_DEFAULT,
+		D3D12MA_UPLOAD,
+		D3D12MA_READBACK,
+		COUNT
+	};
+
+	constexpr size_t MEMORY_TAG_COUNT = static_cast<size_t>(MemoryTag::COUNT);
+
+	enum class MemoryDomain : uint8_t
+	{
+		CPU,
+		GPU
+	};
+
+	struct MemoryTagStats
+	{
+		/// "Mesh.CPU", "Texture.Staging" and so on.
+		const char* mName = "";
+		MemoryDomain mDomain = MemoryDomain::CPU;
+		uint64_t mBytes = 0;
+		/// High-water mark of mBytes since start up or ResetMemoryPeaks.
+		uint64_t mPeakBytes = 0;
+		uint64_t mLiveAllocations = 0;
+		uint64_t mTotalAllocations = 0;
+	};
+
+	/// Counters are atomics, safe from any thread.
+	void TrackAllocation(MemoryTag tag, size_t bytes);
+	void TrackFree(MemoryTag tag, size_t bytes);
+
+	/// For tags filled from someone else's statistics rather than
+	/// allocation by allocation. Still moves the peak.
+	void SetTrackedBytes(MemoryTag tag, uint64_t bytes, uint64_t allocations);
+
+	const char* GetMemoryTagName(MemoryTag tag);
+	MemoryDomain GetMemoryTagDomain(MemoryTag tag);
+	MemoryTagStats GetMemoryStats(MemoryTag tag);
+	std::array<MemoryTagStats, MEMORY_TAG_COUNT> GetAllMemoryStats();
+
+	/// Drops every peak down to the current value.
+	void ResetMemoryPeaks();
+
+	/// Every tag plus CPU and GPU totals, for the monitoring scripts.
+	std::string DumpMemoryStatsJson();
+
+	/// STL allocator that charges what it hands out to Tag.
+	template <typename T, MemoryTag Tag>
+	class TaggedAllocator
+	{
+	public:
+		using value_type = T;
+
+		template <typename U>
+		struct rebind
+		{
+			using other = TaggedAllocator<U, Tag>;
+		};
+
+		TaggedAllocator() = default;
+
+		template <typename U>
+		TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			T* pointer = std::allocator<T>().allocate(count);
+			TrackAllocation(Tag, count * sizeof(T));
+			return pointer;
+		}
+
+		void deallocate(T* pointer, size_t count) noexcept
+		{
+			TrackFree(Tag, count * sizeof(T));
+			std::allocator<T>().deallocate(pointer, count);
+		}
+
+		template <typename U>
+		bool operator==(const TaggedAllocator<U, Tag>&) const noexcept
+		{
+			return true;
+		}
+	};
+
+	template <typename T, MemoryTag Tag>
+	using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+	/// Charges a byte count to a tag for as long as it lives, for memory
+	/// that doesn't come through a TaggedAllocator: buffers handed over
+	/// from elsewhere, D3D12 resources, descriptor heaps.
+	class MemoryCharge
+	{
+	public:
+		explicit MemoryCharge(MemoryTag tag)
+		: mTag(tag)
+		{
+		}
+
+		~MemoryCharge() { Set(0); }
+
+		MemoryCharge(const MemoryCharge&) = delete;
+		MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+		/// Replaces whatever was charged before, 0 gives it all back.
+		void Set(size_t bytes)
+		{
+			if (mBytes > 0)
+			{
+				TrackFree(mTag, mBytes);
+			}
+			mBytes = bytes;
+			if (mBytes > 0)
+			{
+				TrackAllocation(mTag, mBytes);
+			}
+		}
+
+		size_t GetBytes() const { return mBytes; }
+
+	private:
+		MemoryTag mTag;
+		size_t mBytes = 0;
+	};
+} // namespace Utils
@@ -0,0 +1,117 @@
+#include "StringId.h"
+#include "Hash.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Utils
+{
+	struct StringId::Entry
+	{
+		std::string mText;
+		std::wstring mWide;
+		uint64_t mHash = 0;
+		uint32_t mId = 0;
+	};
+
+	namespace
+	{
+		/// Looks entries up by their text without hashing it a second time.
+		struct EntryKey
+		{
+			std::string_view mText;
+			uint64_t mHash;
+
+			bool operator==(const EntryKey& other) const { return mText == other.mText; }
+		};
+
+		struct EntryKeyHash
+		{
+			size_t operator()(const EntryKey& key) const { return static_cast<size_t>(key.mHash); }
+		};
+
+		struct StringTable
+		{
+			std::shared_mutex mMutex;
+			/// A deque so entries never move, ids point straight at them.
+			std::deque<StringId::Entry> mEntries;
+			std::unordered_map<EntryKey, const StringId::Entry*, EntryKeyHash> mLookup;
+		};
+
+		/// Created on first use, so ids at namespace scope in other files
+		/// are fine.
+		StringTable& GetTable()
+		{
+			static StringTable sTable;
+			return sTable;
+		}
+	} // namespace
+
+	StringId::StringId(std::string_view text)
+	{
+		if (text.empty())
+		{
+			return;
+		}
+
+		EntryKey key{text, Hash64(text.data(), text.size())};
+		auto& table = GetTable();
+
+		{
+			std::shared_lock<std::shared_mutex> lock(table.mMutex);
+			auto it = table.mLookup.find(key);
+			if (it != table.mLookup.end())
+			{
+				mEntry = it->second;
+				return;
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> lock(table.mMutex);
+		// Someone else may have added it between the two locks.
+		auto it = table.mLookup.find(key);
+		if (it != table.mLookup.end())
+		{
+			mEntry = it->second;
+			return;
+		}
+
+		Entry& entry = table.mEntries.emplace_back();
+		entry.mText = text;
+		entry.mWide.assign(text.begin(), text.end());
+		entry.mHash = key.mHash;
+		entry.mId = static_cast<uint32_t>(table.mEntries.size());
+		table.mLookup.emplace(EntryKey{entry.mText, entry.mHash}, &entry);
+		mEntry = &entry;
+	}
+
+	uint32_t StringId::GetId() const
+	{
+		return mEntry ? mEntry->mId : 0;
+	}
+
+	uint64_t StringId::GetHash() const
+	{
+		return mEntry ? mEntry->mHash : 0;
+	}
+
+	const std::string& StringId::GetString() const
+	{
+		static const std::string sEmpty;
+		return mEntry ? mEntry->mText : sEmpty;
+	}
+
+	const std::wstring& StringId::GetWide() const
+	{
+		static const std::wstring sEmpty;
+		return mEntry ? mEntry->mWide : sEmpty;
+	}
+
+	size_t StringId::GetInternedCount()
+	{
+		auto& table = GetTable();
+		std::shared_lock<std::shared_mutex> lock(table.mMutex);
+		return table.mEntries.size();
+	}
+} // namespace Utils
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace Utils
+{
+	/// A name interned in the process wide string table: shader names,
+	/// asset paths, material names. Interning takes a lock and hashes the
+	/// text once, after that comparing two ids is a pointer compare and the
+	/// hash is a load, so ids are what the per-frame code passes around.
+	///
+	/// Ids are only stable within a run, don't save them. The empty string
+	/// is the null id.
+	class StringId
+	{
+	public:
+		StringId() = default;
+
+		/// Interns text. Safe from any thread.
+		explicit StringId(std::string_view text);
+
+		/// Sequential from 1, 0 for the null id.
+		uint32_t GetId() const;
+		/// XXH64 of the text, worked out once when it was interned.
+		uint64_t GetHash() const;
+
+		/// Lives as long as the process.
+		const std::string& GetString() const;
+		/// Widened byte by byte, for the paths the texture code takes as
+		/// wstrings. Also made once at intern time.
+		const std::wstring& GetWide() const;
+
+		explicit operator bool() const { return mEntry != nullptr; }
+		bool operator==(const StringId& other) const { return mEntry == other.mEntry; }
+
+		/// Distinct strings interned so far.
+		static size_t GetInternedCount();
+
+		/// Defined in StringId.cpp, only the table knows what's in it.
+		struct Entry;
+
+	private:
+		const Entry* mEntry = nullptr;
+	};
+} // namespace Utils
+
+template <>
+struct std::hash<Utils::StringId>
+{
+	size_t operator()(const Utils::StringId& id) const noexcept
+	{
+		return static_cast<size_t>(id.GetHash());
+	}
+};
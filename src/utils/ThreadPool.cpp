@@ -0,0 +1,138 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace Utils
+{
+	ThreadPool::ThreadPool(uint32_t numThreads)
+	{
+		if (numThreads == 0)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		mWorkers.reserve(numThreads);
+		for (uint32_t i = 0; i < numThreads; ++i)
+		{
+			mWorkers.emplace_back([this]() {
+				WorkerLoop();
+			});
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+		mCondition.notify_all();
+
+		for (auto& worker : mWorkers)
+		{
+			worker.join();
+		}
+	}
+
+	ThreadPool& ThreadPool::GetDefault()
+	{
+		static ThreadPool sPool;
+		return sPool;
+	}
+
+	void ThreadPool::Enqueue(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mJobs.push(std::move(job));
+		}
+		mCondition.notify_one();
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mCondition.wait(lock, [this]() {
+					return mStopping || !mJobs.empty();
+				});
+
+				if (mStopping && mJobs.empty())
+				{
+					return;
+				}
+
+				job = std::move(mJobs.front());
+				mJobs.pop();
+			}
+			job();
+		}
+	}
+
+	void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& fn)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		if (count == 1 || mWorkers.empty())
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				fn(i);
+			}
+			return;
+		}
+
+		// Helpers that start after all the work is taken just exit, so the
+		// shared state has to outlive this call.
+		struct ForState
+		{
+			std::atomic<uint32_t> mNext{0};
+			std::atomic<uint32_t> mDone{0};
+			uint32_t mCount = 0;
+			const std::function<void(uint32_t)>* mFn = nullptr;
+			std::mutex mMutex;
+			std::condition_variable mFinished;
+		};
+
+		auto state = std::make_shared<ForState>();
+		state->mCount = count;
+		state->mFn = &fn;
+
+		auto drain = [](ForState& s) {
+			uint32_t completed = 0;
+			for (uint32_t i = s.mNext.fetch_add(1); i < s.mCount; i = s.mNext.fetch_add(1))
+			{
+				(*s.mFn)(i);
+				completed++;
+			}
+
+			if (completed > 0 && s.mDone.fetch_add(completed) + completed == s.mCount)
+			{
+				std::lock_guard<std::mutex> lock(s.mMutex);
+				s.mFinished.notify_all();
+			}
+		};
+
+		uint32_t helpers = std::min(count - 1, GetThreadCount());
+		for (uint32_t i = 0; i < helpers; ++i)
+		{
+			Enqueue([state, drain]() {
+				drain(*state);
+			});
+		}
+
+		drain(*state);
+
+		std::unique_lock<std::mutex> lock(state->mMutex);
+		state->mFinished.wait(lock, [&state]() {
+			return state->mDone.load() == state->mCount;
+		});
+	}
+} // namespace Utils
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utils
+{
+	/// Fixed size pool of worker threads for CPU side work like texture
+	/// cooking and decoding. Nothing in here touches D3D12, so it can be
+	/// used from the tests as well.
+	class ThreadPool
+	{
+	public:
+		/// Zero threads means hardware concurrency minus one, since the
+		/// calling thread also helps out in ParallelFor.
+		explicit ThreadPool(uint32_t numThreads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// Queues a single job and returns a future for its result.
+		template <typename F>
+		auto Submit(F&& job) -> std::future<std::invoke_result_t<F>>
+		{
+			using Result = std::invoke_result_t<F>;
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+			std::future<Result> future = task->get_future();
+			Enqueue([task]() {
+				(*task)();
+			});
+			return future;
+		}
+
+		/// Runs fn(i) for every i in [0, count) and blocks until all of them
+		/// are done. The calling thread pulls work too, so nesting a
+		/// ParallelFor inside a job will not deadlock.
+		void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& fn);
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+		/// Shared pool for the whole process, created on first use.
+		static ThreadPool& GetDefault();
+
+	private:
+		void Enqueue(std::function<void()> job);
+		void WorkerLoop();
+
+		std::vector<std::thread> mWorkers;
+		std::queue<std::function<void()>> mJobs;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mStopping = false;
+	};
+} // namespace Utils
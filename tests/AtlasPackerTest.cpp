@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/AtlasPacker.h"
+#include <cstdio>
+#include <random>
+
+using namespace TextureTools;
+
+namespace
+{
+	bool Overlap(const PackRect& a, const PackRect& b)
+	{
+		return a.mX < b.mX + b.mWidth && b.mX < a.mX + a.mWidth && a.mY < b.mY + b.mHeight &&
+			   b.mY < a.mY + a.mHeight;
+	}
+
+	/// Every texel holds its image id and its own coordinates so tests can
+	/// tell where a texel in the atlas came from.
+	Image MakeTagged(uint32_t width, uint32_t height, uint8_t id)
+	{
+		Image image(width, height);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t* px = image.GetPixel(x, y);
+				px[0] = id;
+				px[1] = static_cast<uint8_t>(x);
+				px[2] = static_cast<uint8_t>(y);
+				px[3] = 255;
+			}
+		}
+		return image;
+	}
+
+	std::vector<const Image*> Pointers(const std::vector<Image>& images)
+	{
+		std::vector<const Image*> out;
+		for (const Image& image : images)
+		{
+			out.push_back(&image);
+		}
+		return out;
+	}
+} // namespace
+
+TEST(MaxRectsPackerTest, FillsBinExactly)
+{
+	MaxRectsPacker packer(256, 256);
+	std::vector<PackRect> rects;
+	for (int i = 0; i < 16; ++i)
+	{
+		PackRect rect;
+		ASSERT_TRUE(packer.Insert(64, 64, rect));
+		rects.push_back(rect);
+	}
+
+	PackRect extra;
+	EXPECT_FALSE(packer.Insert(1, 1, extra));
+	EXPECT_FLOAT_EQ(packer.GetOccupancy(), 1.0F);
+	EXPECT_TRUE(packer.GetFreeRects().empty());
+
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		for (size_t j = i + 1; j < rects.size(); ++j)
+		{
+			EXPECT_FALSE(Overlap(rects[i], rects[j]));
+		}
+	}
+}
+
+TEST(MaxRectsPackerTest, RandomRectsStayInBoundsWithoutOverlap)
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> size(8, 96);
+
+	MaxRectsPacker packer(1024, 1024);
+	std::vector<PackRect> rects;
+	for (int i = 0; i < 400; ++i)
+	{
+		PackRect rect;
+		if (packer.Insert(size(rng), size(rng), rect))
+		{
+			EXPECT_LE(rect.mX + rect.mWidth, 1024U);
+			EXPECT_LE(rect.mY + rect.mHeight, 1024U);
+			rects.push_back(rect);
+		}
+	}
+
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		for (size_t j = i + 1; j < rects.size(); ++j)
+		{
+			ASSERT_FALSE(Overlap(rects[i], rects[j]));
+		}
+	}
+
+	// MaxRects on random sizes normally lands around 85-95%.
+	EXPECT_GT(packer.GetOccupancy(), 0.8F);
+	std::printf("MaxRects occupancy with %zu random rects: %.1f%%\n", rects.size(),
+				packer.GetOccupancy() * 100.0F);
+}
+
+TEST(AtlasPackerTest, CopiesPixelsAndComputesUVs)
+{
+	std::vector<Image> images = {MakeTagged(64, 64, 1), MakeTagged(128, 64, 2),
+								 MakeTagged(32, 128, 3)};
+
+	AtlasDesc desc;
+	AtlasResult result = BuildAtlases(Pointers(images), desc);
+
+	ASSERT_EQ(result.mPages.size(), 1U);
+	ASSERT_EQ(result.GetPackedCount(), 3U);
+
+	const Image& page = result.mPages[0].mImage;
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		const AtlasPlacement& placement = result.mPlacements[i];
+		EXPECT_EQ(placement.mRect.mWidth, images[i].mWidth);
+		EXPECT_EQ(placement.mRect.mHeight, images[i].mHeight);
+		EXPECT_EQ(placement.mRect.mX % desc.mPadding, 0U);
+		EXPECT_EQ(placement.mRect.mY % desc.mPadding, 0U);
+
+		for (uint32_t y = 0; y < images[i].mHeight; y += 7)
+		{
+			for (uint32_t x = 0; x < images[i].mWidth; x += 7)
+			{
+				const uint8_t* px = page.GetPixel(placement.mRect.mX + x, placement.mRect.mY + y);
+				ASSERT_EQ(px[0], i + 1);
+				ASSERT_EQ(px[1], x);
+				ASSERT_EQ(px[2], y);
+			}
+		}
+
+		// uv (0,0) and (1,1) of the image land on its corners in the page.
+		EXPECT_FLOAT_EQ(placement.mUVOffset[0] * page.mWidth, placement.mRect.mX);
+		EXPECT_FLOAT_EQ(placement.mUVOffset[1] * page.mHeight, placement.mRect.mY);
+		EXPECT_FLOAT_EQ((placement.mUVOffset[0] + placement.mUVScale[0]) * page.mWidth,
+						placement.mRect.mX + placement.mRect.mWidth);
+		EXPECT_FLOAT_EQ((placement.mUVOffset[1] + placement.mUVScale[1]) * page.mHeight,
+						placement.mRect.mY + placement.mRect.mHeight);
+	}
+}
+
+TEST(AtlasPackerTest, GutterWrapsOrClamps)
+{
+	std::vector<Image> images = {MakeTagged(64, 64, 7)};
+
+	AtlasDesc desc;
+	desc.mWrap = true;
+	AtlasResult wrapped = BuildAtlases(Pointers(images), desc);
+	const AtlasPlacement& wp = wrapped.mPlacements[0];
+	const Image& wpage = wrapped.mPages[0].mImage;
+
+	// Left of column 0 is the last column, above row 0 is the last row.
+	const uint8_t* left = wpage.GetPixel(wp.mRect.mX - 1, wp.mRect.mY + 5);
+	EXPECT_EQ(left[0], 7);
+	EXPECT_EQ(left[1], 63);
+	EXPECT_EQ(left[2], 5);
+	const uint8_t* corner = wpage.GetPixel(wp.mRect.mX - 2, wp.mRect.mY - 3);
+	EXPECT_EQ(corner[1], 62);
+	EXPECT_EQ(corner[2], 61);
+
+	desc.mWrap = false;
+	AtlasResult clamped = BuildAtlases(Pointers(images), desc);
+	const AtlasPlacement& cp = clamped.mPlacements[0];
+	const Image& cpage = clamped.mPages[0].mImage;
+
+	const uint8_t* right = cpage.GetPixel(cp.mRect.mX + 64 + 3, cp.mRect.mY + 10);
+	EXPECT_EQ(right[1], 63);
+	EXPECT_EQ(right[2], 10);
+	const uint8_t* below = cpage.GetPixel(cp.mRect.mX + 20, cp.mRect.mY + 64 + 1);
+	EXPECT_EQ(below[1], 20);
+	EXPECT_EQ(below[2], 63);
+}
+
+TEST(AtlasPackerTest, SkipsLargeImagesAndSpillsToNewPages)
+{
+	std::vector<Image> images;
+	images.push_back(MakeTagged(512, 512, 0));
+	for (int i = 0; i < 40; ++i)
+	{
+		images.push_back(MakeTagged(128, 128, static_cast<uint8_t>(i + 1)));
+	}
+
+	AtlasDesc desc;
+	desc.mMaxPageSize = 512;
+	AtlasResult result = BuildAtlases(Pointers(images), desc);
+
+	EXPECT_FALSE(result.mPlacements[0].mPacked);
+	EXPECT_EQ(result.GetPackedCount(), 40U);
+
+	// 128 + 2 * 4 gutter = 136, only 3x3 cells fit in a 512 page.
+	EXPECT_EQ(result.mPages.size(), 5U);
+	for (const AtlasPage& page : result.mPages)
+	{
+		EXPECT_LE(page.mImage.mWidth, 512U);
+		EXPECT_LE(page.mImage.mHeight, 512U);
+	}
+}
+
+TEST(AtlasPackerTest, ReportsEfficiency)
+{
+	std::mt19937 rng(99);
+	std::uniform_int_distribution<uint32_t> pick(0, 2);
+	const uint32_t sizes[] = {64, 128, 256};
+
+	std::vector<Image> images;
+	for (int i = 0; i < 48; ++i)
+	{
+		images.push_back(MakeTagged(sizes[pick(rng)], sizes[pick(rng)], static_cast<uint8_t>(i)));
+	}
+
+	AtlasDesc desc;
+	AtlasResult result = BuildAtlases(Pointers(images), desc);
+	EXPECT_EQ(result.GetPackedCount(), 48U);
+
+	// Gutters cost something (4 texels around 64-256 px images), but the
+	// packer itself shouldn't leave much empty.
+	EXPECT_GT(result.GetEfficiency(), 0.75F);
+	std::printf("Atlas: 48 images into %zu page(s), %.1f%% efficiency\n", result.mPages.size(),
+				result.GetEfficiency() * 100.0F);
+}
+
+TEST(AtlasPackerTest, MipLevelsFollowPadding)
+{
+	AtlasDesc desc;
+	desc.mPadding = 4;
+	EXPECT_EQ(GetAtlasMipLevels(desc), 3U);
+	desc.mPadding = 8;
+	EXPECT_EQ(GetAtlasMipLevels(desc), 4U);
+	desc.mPadding = 0;
+	EXPECT_EQ(GetAtlasMipLevels(desc), 1U);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/ChannelPacker.h"
+#include "graphics/texture/ImageDecoder.h"
+#include "utils/FileUtils.h"
+#include <filesystem>
+
+using namespace TextureTools;
+
+namespace
+{
+	Image MakeSolid(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b)
+	{
+		Image image(width, height);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t* px = image.GetPixel(x, y);
+				px[0] = r;
+				px[1] = g;
+				px[2] = b;
+				px[3] = 255;
+			}
+		}
+		return image;
+	}
+
+	bool WriteTGA(const std::filesystem::path& path, const Image& image)
+	{
+		std::vector<uint8_t> encoded;
+		return EncodeTGA(image, encoded) &&
+			   Utils::WriteBinaryFile(path, encoded.data(), encoded.size());
+	}
+} // namespace
+
+TEST(ChannelPackerTest, PacksIntoOrmLayout)
+{
+	Image occlusion = MakeSolid(8, 8, 10, 99, 99);
+	Image roughness = MakeSolid(8, 8, 20, 99, 99);
+	Image metallic = MakeSolid(8, 8, 30, 200, 40);
+
+	Image packed = PackORM({&occlusion, &roughness, &metallic});
+	ASSERT_EQ(packed.mWidth, 8U);
+	ASSERT_EQ(packed.mHeight, 8U);
+
+	const uint8_t* px = packed.GetPixel(3, 5);
+	EXPECT_EQ(px[0], 10);
+	EXPECT_EQ(px[1], 20);
+	// Metallic keeps the old max(r, g, b) the shader used to do per pixel.
+	EXPECT_EQ(px[2], 200);
+	EXPECT_EQ(px[3], 255);
+}
+
+TEST(ChannelPackerTest, MissingMapsAreWhite)
+{
+	Image roughness = MakeSolid(4, 2, 64, 0, 0);
+
+	Image packed = PackORM({nullptr, &roughness, nullptr});
+	ASSERT_EQ(packed.mWidth, 4U);
+	ASSERT_EQ(packed.mHeight, 2U);
+
+	const uint8_t* px = packed.GetPixel(1, 1);
+	EXPECT_EQ(px[0], 255);
+	EXPECT_EQ(px[1], 64);
+	EXPECT_EQ(px[2], 255);
+}
+
+TEST(ChannelPackerTest, ResamplesSmallerMaps)
+{
+	// Left half black, right half white at 2x1, upsampled to 8x8.
+	Image occlusion(2, 1);
+	occlusion.GetPixel(0, 0)[0] = 0;
+	occlusion.GetPixel(1, 0)[0] = 255;
+	Image roughness = MakeSolid(8, 8, 128, 0, 0);
+
+	Image packed = PackORM({&occlusion, &roughness, nullptr});
+	ASSERT_EQ(packed.mWidth, 8U);
+	ASSERT_EQ(packed.mHeight, 8U);
+
+	// Edges clamp to the source texels, the middle blends.
+	EXPECT_EQ(packed.GetPixel(0, 4)[0], 0);
+	EXPECT_EQ(packed.GetPixel(7, 4)[0], 255);
+	EXPECT_GT(packed.GetPixel(4, 4)[0], packed.GetPixel(3, 4)[0]);
+	for (uint32_t x = 1; x < 8; ++x)
+	{
+		EXPECT_GE(packed.GetPixel(x, 0)[0], packed.GetPixel(x - 1, 0)[0]);
+	}
+	EXPECT_EQ(packed.GetPixel(4, 4)[1], 128);
+}
+
+TEST(ChannelPackerTest, CookWritesOnceAndTracksSources)
+{
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "jar_orm_test";
+	std::filesystem::remove_all(dir);
+
+	ORMSources sources;
+	sources.mRoughness = dir / "roughness.tga";
+	sources.mMetallic = dir / "metallic.tga";
+	ASSERT_TRUE(WriteTGA(sources.mRoughness, MakeSolid(16, 16, 40, 0, 0)));
+	ASSERT_TRUE(WriteTGA(sources.mMetallic, MakeSolid(16, 16, 0, 0, 220)));
+
+	std::filesystem::path cooked;
+	std::string error;
+	ASSERT_TRUE(CookORM(sources, dir / "cache", cooked, &error)) << error;
+	ASSERT_TRUE(std::filesystem::exists(cooked));
+
+	Image result;
+	ASSERT_TRUE(DecodeImageFile(cooked, result));
+	EXPECT_EQ(result.mWidth, 16U);
+	const uint8_t* px = result.GetPixel(7, 7);
+	EXPECT_EQ(px[0], 255);
+	EXPECT_EQ(px[1], 40);
+	EXPECT_EQ(px[2], 220);
+
+	// Same sources give back the same file without rewriting it.
+	const auto writeTime = std::filesystem::last_write_time(cooked);
+	std::filesystem::path again;
+	ASSERT_TRUE(CookORM(sources, dir / "cache", again));
+	EXPECT_EQ(again, cooked);
+	EXPECT_EQ(std::filesystem::last_write_time(again), writeTime);
+
+	// Editing a source cooks a new file.
+	ASSERT_TRUE(WriteTGA(sources.mRoughness, MakeSolid(16, 16, 90, 0, 0)));
+	std::filesystem::path edited;
+	ASSERT_TRUE(CookORM(sources, dir / "cache", edited));
+	EXPECT_NE(edited, cooked);
+
+	// So does moving a map to another channel.
+	ORMSources swapped;
+	swapped.mOcclusion = sources.mRoughness;
+	swapped.mMetallic = sources.mMetallic;
+	std::filesystem::path swappedPath;
+	ASSERT_TRUE(CookORM(swapped, dir / "cache", swappedPath));
+	EXPECT_NE(swappedPath, edited);
+
+	ORMSources missing;
+	missing.mOcclusion = dir / "nope.png";
+	EXPECT_FALSE(CookORM(missing, dir / "cache", swappedPath));
+	EXPECT_FALSE(CookORM(ORMSources{}, dir / "cache", swappedPath));
+
+	std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "graphics/CommandAllocatorPool.h"
+#include "graphics/FenceRing.h"
+#include <memory>
+#include <set>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Stands in for an ID3D12CommandAllocator, counts its resets.
+	struct FakeAllocator
+	{
+		uint32_t mId = 0;
+		uint32_t mResets = 0;
+	};
+
+	using FakePool = CommandAllocatorPool<std::shared_ptr<FakeAllocator>>;
+
+	FakePool MakePool(uint32_t& created)
+	{
+		return FakePool(
+			[&created]() {
+				auto allocator = std::make_shared<FakeAllocator>();
+				allocator->mId = created++;
+				return allocator;
+			},
+			[](std::shared_ptr<FakeAllocator>& allocator) { allocator->mResets++; });
+	}
+} // namespace
+
+TEST(FenceRingTest, AnswersFromTheCacheWithoutReadingTheFence)
+{
+	uint64_t gpuFence = 0;
+	FenceRing ring([&]() { return gpuFence; });
+
+	uint64_t first = ring.Advance();
+	uint64_t second = ring.Advance();
+	EXPECT_EQ(first, 1U);
+	EXPECT_EQ(second, 2U);
+	EXPECT_EQ(ring.GetLastSignaled(), 2U);
+	EXPECT_EQ(ring.GetPendingCount(), 2U);
+
+	EXPECT_TRUE(ring.IsComplete(0));
+	EXPECT_FALSE(ring.IsComplete(first));
+	EXPECT_EQ(ring.GetStats().mPolls, 1U);
+
+	gpuFence = 2;
+	EXPECT_TRUE(ring.IsComplete(first));
+	EXPECT_EQ(ring.GetStats().mPolls, 2U);
+	EXPECT_EQ(ring.GetPendingCount(), 0U);
+
+	// Both are known now, no more reads.
+	EXPECT_TRUE(ring.IsComplete(first));
+	EXPECT_TRUE(ring.IsComplete(second));
+	EXPECT_EQ(ring.GetStats().mPolls, 2U);
+	// The two above plus IsComplete(0).
+	EXPECT_EQ(ring.GetStats().mCacheHits, 3U);
+}
+
+TEST(FenceRingTest, NeverSignaledIsNeverComplete)
+{
+	uint64_t gpuFence = 100;
+	FenceRing ring([&]() { return gpuFence; });
+
+	ring.Advance();
+	EXPECT_FALSE(ring.IsComplete(5));
+	EXPECT_EQ(ring.GetStats().mPolls, 0U);
+}
+
+TEST(FenceRingTest, CompletedValueOnlyMovesForward)
+{
+	uint64_t gpuFence = 0;
+	FenceRing ring([&]() { return gpuFence; });
+	for (int i = 0; i < 4; ++i)
+	{
+		ring.Advance();
+	}
+
+	gpuFence = 3;
+	EXPECT_EQ(ring.Poll(), 3U);
+	gpuFence = 1;
+	EXPECT_EQ(ring.Poll(), 3U);
+	EXPECT_EQ(ring.GetPendingCount(), 1U);
+	EXPECT_EQ(ring.GetOldestPending(), 4U);
+}
+
+TEST(FenceRingTest, FullRingReportsTheOldestToWaitOn)
+{
+	uint64_t gpuFence = 0;
+	FenceRing ring([&]() { return gpuFence; }, 4);
+	for (int i = 0; i < 4; ++i)
+	{
+		ring.Advance();
+	}
+	EXPECT_TRUE(ring.IsFull());
+	EXPECT_EQ(ring.GetOldestPending(), 1U);
+
+	// What the queue does before signaling again. The values keep going
+	// round the ring well past its capacity.
+	for (uint64_t expected = 5; expected < 50; ++expected)
+	{
+		ASSERT_TRUE(ring.IsFull());
+		gpuFence = ring.GetOldestPending();
+		EXPECT_EQ(ring.Advance(), expected);
+		EXPECT_EQ(ring.GetOldestPending(), expected - 3);
+	}
+}
+
+TEST(CommandAllocatorPoolTest, ReusesOnlyOnceTheFenceCompletes)
+{
+	uint32_t created = 0;
+	FakePool pool = MakePool(created);
+
+	auto first = pool.Request(0);
+	EXPECT_EQ(first->mResets, 0U);
+	pool.Discard(1, first);
+
+	// Frame 1 is still running, a second allocator is needed.
+	auto second = pool.Request(0);
+	EXPECT_NE(second->mId, first->mId);
+	pool.Discard(2, second);
+	EXPECT_EQ(pool.GetStats().mRetired, 2U);
+
+	auto third = pool.Request(1);
+	EXPECT_EQ(third->mId, first->mId);
+	EXPECT_EQ(third->mResets, 1U);
+	EXPECT_EQ(pool.GetSize(), 2U);
+	EXPECT_EQ(pool.GetStats().mReused, 1U);
+}
+
+TEST(CommandAllocatorPoolTest, SteadyStateNeedsLatencyPlusOne)
+{
+	uint32_t created = 0;
+	FakePool pool = MakePool(created);
+
+	// Two frames in flight: the GPU finishes frame N-2 as the CPU starts
+	// frame N.
+	uint64_t signaled = 0;
+	std::set<uint32_t> live;
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		uint64_t completed = signaled >= 2 ? signaled - 2 : 0;
+		auto allocator = pool.Request(completed);
+		live.insert(allocator->mId);
+		pool.Discard(++signaled, allocator);
+	}
+	EXPECT_EQ(pool.GetSize(), 3U);
+	EXPECT_EQ(live.size(), 3U);
+	EXPECT_EQ(pool.GetStats().mReused, 97U);
+}
+
+TEST(CommandAllocatorPoolTest, NeverHandsOutWhatTheGpuStillUses)
+{
+	uint32_t created = 0;
+	FakePool pool = MakePool(created);
+
+	// Allocator id to the fence it was discarded with.
+	std::vector<uint64_t> busyUntil;
+	uint64_t signaled = 0;
+	uint64_t completed = 0;
+	for (int step = 0; step < 200; ++step)
+	{
+		auto allocator = pool.Request(completed);
+		if (allocator->mId >= busyUntil.size())
+		{
+			busyUntil.resize(allocator->mId + 1, 0);
+		}
+		EXPECT_LE(busyUntil[allocator->mId], completed) << "step " << step;
+
+		busyUntil[allocator->mId] = ++signaled;
+		pool.Discard(signaled, allocator);
+
+		// The GPU runs in bursts.
+		if (step % 7 == 6)
+		{
+			completed = signaled - 1;
+		}
+	}
+	EXPECT_LE(pool.GetSize(), 8U);
+}
@@ -0,0 +1,390 @@
+#include <gtest/gtest.h>
+#include "graphics/DescriptorSlotPool.h"
+#include "graphics/RangeAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Bump allocates runs off a pretend heap of capacity slots.
+	struct FakeHeap
+	{
+		explicit FakeHeap(uint32_t capacity)
+		: mCapacity(capacity)
+		{
+		}
+
+		uint32_t mCapacity;
+		uint32_t mNext = 0;
+		uint32_t mGrows = 0;
+
+		DescriptorSlotPoolDesc MakeDesc(uint32_t magazineSize)
+		{
+			DescriptorSlotPoolDesc desc;
+			desc.mMagazineSize = magazineSize;
+			desc.mGrow = [this](uint32_t count)
+			{
+				if (mNext + count > mCapacity)
+				{
+					return DescriptorSlotPool::INVALID_SLOT;
+				}
+				mGrows++;
+				uint32_t first = mNext;
+				mNext += count;
+				return first;
+			};
+			return desc;
+		}
+	};
+} // namespace
+
+TEST(DescriptorSlotPoolTest, GrowsInWholeMagazines)
+{
+	FakeHeap heap(1000);
+	DescriptorSlotPool pool(heap.MakeDesc(16));
+
+	std::set<uint32_t> slots;
+	for (int i = 0; i < 40; ++i)
+	{
+		uint32_t slot = pool.Allocate();
+		ASSERT_NE(slot, DescriptorSlotPool::INVALID_SLOT);
+		EXPECT_TRUE(slots.insert(slot).second);
+	}
+	EXPECT_EQ(*slots.begin(), 0U);
+	EXPECT_EQ(*slots.rbegin(), 39U);
+	EXPECT_EQ(heap.mGrows, 3U);
+
+	DescriptorSlotPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.mAllocations, 40U);
+	EXPECT_EQ(stats.mSlots, 48U);
+	EXPECT_EQ(stats.mThreadCaches, 1U);
+}
+
+TEST(DescriptorSlotPoolTest, ReusesFreedSlotsFromTheThreadCache)
+{
+	FakeHeap heap(1000);
+	DescriptorSlotPool pool(heap.MakeDesc(8));
+
+	uint32_t a = pool.Allocate();
+	uint32_t b = pool.Allocate();
+	pool.Free(a);
+	pool.Free(b);
+	EXPECT_EQ(pool.Allocate(), b);
+	EXPECT_EQ(pool.Allocate(), a);
+
+	// Freeing well past two magazines' worth spills the extra to the depot,
+	// and the slots come back from there without growing again.
+	std::vector<uint32_t> held;
+	for (int i = 0; i < 40; ++i)
+	{
+		held.push_back(pool.Allocate());
+	}
+	uint32_t grows = heap.mGrows;
+	for (uint32_t slot : held)
+	{
+		pool.Free(slot);
+	}
+	EXPECT_GT(pool.GetStats().mDepotSlots, 0U);
+	for (int i = 0; i < 40; ++i)
+	{
+		ASSERT_NE(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+	}
+	EXPECT_EQ(heap.mGrows, grows);
+}
+
+TEST(DescriptorSlotPoolTest, DeferredFreesWaitForTheFence)
+{
+	FakeHeap heap(8);
+	DescriptorSlotPool pool(heap.MakeDesc(8));
+
+	std::vector<uint32_t> slots;
+	for (int i = 0; i < 8; ++i)
+	{
+		slots.push_back(pool.Allocate());
+	}
+	EXPECT_EQ(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		pool.FreeDeferred(slots[i], i < 4 ? 10 : 11);
+	}
+	EXPECT_EQ(pool.GetStats().mPendingFrees, 8U);
+
+	std::vector<uint32_t> freed;
+	auto onFree = [&freed](uint32_t slot) { freed.push_back(slot); };
+	EXPECT_EQ(pool.ProcessDeletions(9, onFree), 0U);
+	EXPECT_EQ(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+
+	EXPECT_EQ(pool.ProcessDeletions(10, onFree), 4U);
+	EXPECT_EQ(freed, std::vector<uint32_t>(slots.begin(), slots.begin() + 4));
+	EXPECT_NE(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+
+	EXPECT_EQ(pool.ProcessDeletions(11, onFree), 4U);
+	EXPECT_EQ(freed.size(), 8U);
+	EXPECT_EQ(pool.GetStats().mPendingFrees, 0U);
+	EXPECT_EQ(pool.GetStats().mFailedAllocations, 2U);
+}
+
+TEST(DescriptorSlotPoolTest, UsesTheLastFewSlotsOfTheHeap)
+{
+	// 70 slots: one whole magazine, then only a run of 6 is left.
+	FakeHeap heap(70);
+	DescriptorSlotPool pool(heap.MakeDesc(64));
+
+	std::set<uint32_t> slots;
+	for (int i = 0; i < 70; ++i)
+	{
+		uint32_t slot = pool.Allocate();
+		ASSERT_NE(slot, DescriptorSlotPool::INVALID_SLOT) << i;
+		EXPECT_TRUE(slots.insert(slot).second);
+	}
+	EXPECT_EQ(*slots.rbegin(), 69U);
+	EXPECT_EQ(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+
+	DescriptorSlotPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.mSlots, 70U);
+	EXPECT_EQ(stats.mFailedAllocations, 1U);
+}
+
+TEST(DescriptorSlotPoolTest, FreedSlotsGoBackToTheHeapForTables)
+{
+	// The heap the way BindlessAllocator carves it, one range per slot.
+	RangeAllocator ranges(1024);
+	std::vector<uint32_t> nodes(1024, RangeAllocation::INVALID);
+	DescriptorSlotPoolDesc desc;
+	desc.mMagazineSize = 16;
+	desc.mMaxDepotMagazines = 0;
+	desc.mGrow = [&](uint32_t count)
+	{
+		RangeAllocation range = ranges.Allocate(count);
+		if (!range.IsValid())
+		{
+			return DescriptorSlotPool::INVALID_SLOT;
+		}
+		uint32_t first = range.mOffset;
+		for (uint32_t i = 1; i < count; ++i)
+		{
+			RangeAllocation rest = ranges.Split(range, 1);
+			nodes[range.mOffset] = range.mNode;
+			range = rest;
+		}
+		nodes[range.mOffset] = range.mNode;
+		return first;
+	};
+	desc.mShrink = [&](uint32_t slot) { EXPECT_TRUE(ranges.Free({slot, 1, nodes[slot]})); };
+	DescriptorSlotPool pool(desc);
+
+	// A burst of single descriptors takes the whole heap.
+	std::vector<uint32_t> slots;
+	for (int i = 0; i < 1024; ++i)
+	{
+		slots.push_back(pool.Allocate());
+	}
+	EXPECT_EQ(ranges.GetFreeSize(), 0U);
+	EXPECT_FALSE(ranges.Allocate(1024).IsValid());
+
+	for (uint32_t slot : slots)
+	{
+		pool.FreeDeferred(slot, 1);
+	}
+	EXPECT_EQ(pool.ProcessDeletions(1), 1024U);
+
+	DescriptorSlotPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.mShrinks, 64U);
+	EXPECT_EQ(stats.mSlots, 0U);
+	EXPECT_EQ(stats.mDepotSlots, 0U);
+	EXPECT_TRUE(ranges.Allocate(1024).IsValid());
+}
+
+TEST(DescriptorSlotPoolTest, DepotKeepsMagazinesUpToItsLimit)
+{
+	FakeHeap heap(1024);
+	DescriptorSlotPoolDesc desc = heap.MakeDesc(16);
+	desc.mMaxDepotMagazines = 2;
+	std::vector<uint32_t> shrunk;
+	desc.mShrink = [&shrunk](uint32_t slot) { shrunk.push_back(slot); };
+	DescriptorSlotPool pool(desc);
+
+	std::vector<uint32_t> slots;
+	for (int i = 0; i < 128; ++i)
+	{
+		slots.push_back(pool.Allocate());
+	}
+	for (uint32_t slot : slots)
+	{
+		pool.FreeDeferred(slot, 1);
+	}
+	pool.ProcessDeletions(1);
+
+	// Two magazines stay for the next burst, the other six go back.
+	DescriptorSlotPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.mDepotSlots, 32U);
+	EXPECT_EQ(stats.mSlots, 32U);
+	EXPECT_EQ(shrunk.size(), 96U);
+
+	uint32_t grows = heap.mGrows;
+	for (int i = 0; i < 32; ++i)
+	{
+		EXPECT_NE(pool.Allocate(), DescriptorSlotPool::INVALID_SLOT);
+	}
+	EXPECT_EQ(heap.mGrows, grows);
+}
+
+TEST(DescriptorSlotPoolTest, FlushHandsTheCacheToOtherThreads)
+{
+	FakeHeap heap(16);
+	DescriptorSlotPool pool(heap.MakeDesc(16));
+
+	std::vector<uint32_t> slots;
+	for (int i = 0; i < 16; ++i)
+	{
+		slots.push_back(pool.Allocate());
+	}
+	for (uint32_t slot : slots)
+	{
+		pool.Free(slot);
+	}
+
+	// The heap is used up and every slot sits in this thread's magazines.
+	uint32_t other = DescriptorSlotPool::INVALID_SLOT;
+	std::thread([&] { other = pool.Allocate(); }).join();
+	EXPECT_EQ(other, DescriptorSlotPool::INVALID_SLOT);
+
+	pool.FlushThreadCache();
+	EXPECT_EQ(pool.GetStats().mDepotSlots, 16U);
+	std::thread([&] { other = pool.Allocate(); }).join();
+	EXPECT_NE(other, DescriptorSlotPool::INVALID_SLOT);
+}
+
+TEST(DescriptorSlotPoolTest, ThreadsNeverShareASlot)
+{
+	const uint32_t threadCount = 8;
+	const uint32_t perThread = 5000;
+	FakeHeap heap(threadCount * perThread + 64 * threadCount);
+	DescriptorSlotPool pool(heap.MakeDesc(64));
+
+	std::vector<std::vector<uint32_t>> taken(threadCount);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back(
+			[&pool, &taken, t, perThread]
+			{
+				// Churn a little first so magazines move through the depot.
+				for (uint32_t i = 0; i < perThread; ++i)
+				{
+					pool.Free(pool.Allocate());
+				}
+				for (uint32_t i = 0; i < perThread; ++i)
+				{
+					taken[t].push_back(pool.Allocate());
+				}
+			});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	std::vector<uint32_t> all;
+	for (const std::vector<uint32_t>& slots : taken)
+	{
+		all.insert(all.end(), slots.begin(), slots.end());
+	}
+	std::sort(all.begin(), all.end());
+	EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+	EXPECT_EQ(std::count(all.begin(), all.end(), DescriptorSlotPool::INVALID_SLOT), 0);
+	EXPECT_EQ(pool.GetStats().mAllocations, uint64_t(threadCount) * perThread * 2);
+}
+
+TEST(DescriptorSlotPoolTest, CrossThreadDeferredFreesAllComeBack)
+{
+	// Loader threads allocate and free with the fence they last saw while
+	// this thread plays the frame loop, advancing the fence and processing.
+	const uint32_t threadCount = 6;
+	const uint32_t perThread = 20000;
+	FakeHeap heap(1 << 16);
+	DescriptorSlotPool pool(heap.MakeDesc(32));
+
+	std::atomic<uint64_t> fence{1};
+	std::atomic<uint32_t> running{threadCount};
+	std::mutex liveMutex;
+	std::set<uint32_t> live;
+	std::atomic<bool> overlap{false};
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back(
+			[&]
+			{
+				std::vector<uint32_t> held;
+				for (uint32_t i = 0; i < perThread; ++i)
+				{
+					// Out of slots until the frame loop catches up, like a
+					// loader waiting on the GPU.
+					uint32_t slot = pool.Allocate();
+					while (slot == DescriptorSlotPool::INVALID_SLOT)
+					{
+						std::this_thread::yield();
+						slot = pool.Allocate();
+					}
+					{
+						std::lock_guard<std::mutex> lock(liveMutex);
+						if (!live.insert(slot).second)
+						{
+							overlap = true;
+						}
+					}
+					held.push_back(slot);
+					if (held.size() == 16)
+					{
+						for (uint32_t h : held)
+						{
+							{
+								std::lock_guard<std::mutex> lock(liveMutex);
+								live.erase(h);
+							}
+							pool.FreeDeferred(h, fence.load());
+						}
+						held.clear();
+					}
+				}
+				for (uint32_t h : held)
+				{
+					{
+						std::lock_guard<std::mutex> lock(liveMutex);
+						live.erase(h);
+					}
+					pool.FreeDeferred(h, fence.load());
+				}
+				pool.FlushThreadCache();
+				running--;
+			});
+	}
+
+	while (running > 0)
+	{
+		// The GPU is two frames behind.
+		uint64_t current = fence++;
+		pool.ProcessDeletions(current > 2 ? current - 2 : 0);
+		std::this_thread::yield();
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	pool.ProcessDeletions(UINT64_MAX);
+
+	EXPECT_FALSE(overlap);
+	DescriptorSlotPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.mPendingFrees, 0U);
+	EXPECT_EQ(stats.mAllocations, stats.mFrees);
+	EXPECT_EQ(stats.mDepotSlots, stats.mSlots);
+}
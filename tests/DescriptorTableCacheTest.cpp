@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "graphics/DescriptorTableCache.h"
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Records what the cache asks to be written, table by table.
+	struct FakeHeap
+	{
+		std::vector<DescriptorTableKey> mTables;
+		uint32_t mWrites = 0;
+
+		DescriptorTableCacheDesc MakeDesc(uint32_t capacity)
+		{
+			mTables.assign(capacity, {});
+			DescriptorTableCacheDesc desc;
+			desc.mCapacity = capacity;
+			desc.mWriteTable = [this](uint32_t table, const DescriptorTableKey& key)
+			{
+				mTables[table] = key;
+				mWrites++;
+			};
+			return desc;
+		}
+	};
+} // namespace
+
+TEST(DescriptorTableCacheTest, WritesEachMaterialOnce)
+{
+	FakeHeap heap;
+	DescriptorTableCache cache(heap.MakeDesc(8));
+
+	DescriptorTableKey brick = {1, 2, 3, 0};
+	DescriptorTableKey metal = {4, 5, 6, 7};
+
+	// 100 entities over two materials for 10 frames.
+	for (uint64_t frame = 1; frame <= 10; ++frame)
+	{
+		cache.Retire(frame - 1);
+		for (int entity = 0; entity < 100; ++entity)
+		{
+			const DescriptorTableKey& key = entity % 2 == 0 ? brick : metal;
+			uint32_t table = cache.Get(key);
+			ASSERT_NE(table, DescriptorTableCache::INVALID_TABLE);
+			EXPECT_EQ(heap.mTables[table], key);
+		}
+		cache.EndFrame(frame);
+	}
+
+	EXPECT_EQ(heap.mWrites, 2U);
+	EXPECT_EQ(cache.GetStats().mHits, 998U);
+	EXPECT_EQ(cache.GetStats().mTables, 2U);
+}
+
+TEST(DescriptorTableCacheTest, ChangedTextureGetsANewTable)
+{
+	FakeHeap heap;
+	DescriptorTableCache cache(heap.MakeDesc(8));
+
+	// Normal map still uploading, then ready.
+	uint32_t uploading = cache.Get({1, 0, 3, 0});
+	cache.EndFrame(1);
+	uint32_t ready = cache.Get({1, 2, 3, 0});
+	cache.EndFrame(2);
+
+	EXPECT_NE(uploading, ready);
+	EXPECT_EQ(heap.mTables[ready], (DescriptorTableKey{1, 2, 3, 0}));
+	EXPECT_EQ(heap.mWrites, 2U);
+
+	// The other materials don't notice.
+	EXPECT_EQ(cache.Get({1, 2, 3, 0}), ready);
+	EXPECT_EQ(heap.mWrites, 2U);
+}
+
+TEST(DescriptorTableCacheTest, NeverRewritesATableInFlight)
+{
+	FakeHeap heap;
+	DescriptorTableCache cache(heap.MakeDesc(2));
+
+	uint32_t a = cache.Get({1, 0, 0, 0});
+	uint32_t b = cache.Get({2, 0, 0, 0});
+	EXPECT_NE(a, b);
+	// Both used by the frame being recorded.
+	EXPECT_EQ(cache.Get({3, 0, 0, 0}), DescriptorTableCache::INVALID_TABLE);
+	cache.EndFrame(1);
+
+	// Frame 1 still on the GPU.
+	EXPECT_EQ(cache.Get({3, 0, 0, 0}), DescriptorTableCache::INVALID_TABLE);
+	cache.EndFrame(2);
+	EXPECT_EQ(cache.GetStats().mFailures, 2U);
+
+	cache.Retire(1);
+	uint32_t c = cache.Get({3, 0, 0, 0});
+	EXPECT_EQ(c, a);
+	EXPECT_EQ(heap.mTables[c], (DescriptorTableKey{3, 0, 0, 0}));
+	EXPECT_EQ(cache.GetStats().mEvictions, 1U);
+
+	// a's key lost its table, b kept its own.
+	EXPECT_EQ(cache.Get({2, 0, 0, 0}), b);
+	EXPECT_EQ(heap.mWrites, 3U);
+}
+
+TEST(DescriptorTableCacheTest, EvictsTheLeastRecentlyUsed)
+{
+	FakeHeap heap;
+	DescriptorTableCache cache(heap.MakeDesc(3));
+
+	uint32_t a = cache.Get({1, 0, 0, 0});
+	uint32_t b = cache.Get({2, 0, 0, 0});
+	uint32_t c = cache.Get({3, 0, 0, 0});
+	cache.EndFrame(1);
+	cache.Retire(1);
+
+	// a is drawn again, so b is the oldest.
+	cache.Get({1, 0, 0, 0});
+	EXPECT_EQ(cache.Get({4, 0, 0, 0}), b);
+	cache.EndFrame(2);
+	cache.Retire(2);
+
+	EXPECT_EQ(cache.Get({1, 0, 0, 0}), a);
+	EXPECT_EQ(cache.Get({5, 0, 0, 0}), c);
+	EXPECT_EQ(cache.GetStats().mEvictions, 2U);
+}
+
+TEST(DescriptorTableCacheTest, ClearRewritesOnNextUse)
+{
+	FakeHeap heap;
+	DescriptorTableCache cache(heap.MakeDesc(2));
+
+	cache.Get({1, 0, 0, 0});
+	cache.Get({2, 0, 0, 0});
+	cache.EndFrame(1);
+	cache.Retire(1);
+	cache.Clear();
+	EXPECT_EQ(cache.GetStats().mTables, 0U);
+
+	cache.Get({1, 0, 0, 0});
+	cache.Get({2, 0, 0, 0});
+	EXPECT_EQ(heap.mWrites, 4U);
+	EXPECT_EQ(cache.GetStats().mTables, 2U);
+	EXPECT_EQ(cache.GetStats().mEvictions, 0U);
+}
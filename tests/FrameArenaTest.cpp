@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "utils/FrameArena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <thread>
+
+using namespace Utils;
+
+// Every general heap allocation in this test binary goes through here, so
+// a test can check a stretch of code didn't make any.
+static std::atomic<uint64_t> gHeapAllocations{0};
+
+void* operator new(std::size_t size)
+{
+	gHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size == 0 ? 1 : size))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept
+{
+	std::free(pointer);
+}
+
+namespace
+{
+	bool Overlaps(const std::byte* a, size_t aSize, const std::byte* b, size_t bSize)
+	{
+		return a < b + bSize && b < a + aSize;
+	}
+
+	/// What a renderer frame might build: a draw list, sort keys and a
+	/// lookup by material.
+	void BuildFrame(FrameArena& arena, uint32_t entities)
+	{
+		FrameVector<uint32_t> drawList{FrameAllocator<uint32_t>(arena)};
+		drawList.reserve(entities);
+		for (uint32_t i = 0; i < entities; ++i)
+		{
+			drawList.push_back(i);
+		}
+
+		uint64_t* keys = arena.AllocateArray<uint64_t>(entities);
+		for (uint32_t i = 0; i < entities; ++i)
+		{
+			keys[i] = (static_cast<uint64_t>(i % 7) << 32) | i;
+		}
+		std::sort(keys, keys + entities);
+
+		using MaterialMap = std::map<uint32_t, uint32_t, std::less<>,
+									 FrameAllocator<std::pair<const uint32_t, uint32_t>>>;
+		MaterialMap byMaterial{FrameAllocator<std::pair<const uint32_t, uint32_t>>(arena)};
+		for (uint32_t i = 0; i < entities; ++i)
+		{
+			byMaterial[i % 31]++;
+		}
+	}
+} // namespace
+
+TEST(FrameArenaTest, AllocationsAreAlignedAndDisjoint)
+{
+	FrameArena arena(4096, 1024);
+	std::vector<std::pair<std::byte*, size_t>> allocations;
+
+	for (size_t i = 0; i < 500; ++i)
+	{
+		size_t size = 1 + (i * 37) % 300;
+		size_t alignment = size_t{1} << (i % 7);
+		auto* pointer = static_cast<std::byte*>(arena.Allocate(size, alignment));
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0U) << i;
+		allocations.emplace_back(pointer, size);
+	}
+
+	std::sort(allocations.begin(), allocations.end());
+	for (size_t i = 1; i < allocations.size(); ++i)
+	{
+		ASSERT_FALSE(Overlaps(allocations[i - 1].first, allocations[i - 1].second,
+							  allocations[i].first, allocations[i].second))
+			<< i;
+	}
+}
+
+TEST(FrameArenaTest, ResetHandsOutTheSameMemoryAgain)
+{
+	FrameArena arena(4096, 1024);
+	void* first = arena.Allocate(64);
+	arena.Allocate(128);
+	arena.Reset();
+
+	EXPECT_EQ(arena.Allocate(64), first);
+	EXPECT_EQ(arena.GetStats().mFrames, 1U);
+	EXPECT_GE(arena.GetStats().mUsed, 192U);
+}
+
+TEST(FrameArenaTest, SpilledFramesMergeIntoOneBlock)
+{
+	FrameArena arena(4096, 1024);
+	for (int i = 0; i < 40; ++i)
+	{
+		arena.Allocate(500);
+	}
+	EXPECT_GT(arena.GetStats().mBlockAllocations, 1U);
+	arena.Reset();
+	EXPECT_GE(arena.GetStats().mCapacity, arena.GetStats().mHighWater);
+
+	uint64_t blocks = arena.GetStats().mBlockAllocations;
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		for (int i = 0; i < 40; ++i)
+		{
+			arena.Allocate(500);
+		}
+		arena.Reset();
+	}
+	EXPECT_EQ(arena.GetStats().mBlockAllocations, blocks);
+}
+
+TEST(FrameArenaTest, LargeAllocationsGetTheirOwnBlock)
+{
+	FrameArena arena(4096, 1024);
+	auto* big = static_cast<std::byte*>(arena.Allocate(100000, 256));
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 256, 0U);
+	std::memset(big, 0xAB, 100000);
+
+	auto* small = static_cast<std::byte*>(arena.Allocate(16));
+	EXPECT_FALSE(Overlaps(big, 100000, small, 16));
+}
+
+TEST(FrameArenaTest, SteadyStateFramesDontTouchTheHeap)
+{
+	FrameArena arena(64 * 1024);
+
+	// The first frames size the arena.
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		BuildFrame(arena, 20000);
+		arena.Reset();
+	}
+
+	uint64_t before = gHeapAllocations.load();
+	uint64_t blocks = arena.GetStats().mBlockAllocations;
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		BuildFrame(arena, 20000);
+		arena.Reset();
+	}
+	EXPECT_EQ(gHeapAllocations.load() - before, 0U);
+	EXPECT_EQ(arena.GetStats().mBlockAllocations, blocks);
+}
+
+TEST(FrameArenaTest, ThreadsAllocateSideBySide)
+{
+	FrameArena arena(256 * 1024, 4096);
+	const uint32_t threadCount = 8;
+	const uint32_t perThread = 5000;
+	std::vector<std::vector<std::pair<uint8_t*, size_t>>> results(threadCount);
+
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&arena, &results, t, perThread]() {
+				results[t].clear();
+				for (uint32_t i = 0; i < perThread; ++i)
+				{
+					size_t size = 1 + (i * 13 + t) % 96;
+					auto* pointer = static_cast<uint8_t*>(arena.Allocate(size, 8));
+					std::memset(pointer, static_cast<int>(t + 1), size);
+					results[t].emplace_back(pointer, size);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// Nobody wrote over anybody else.
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			for (const auto& [pointer, size] : results[t])
+			{
+				for (size_t i = 0; i < size; ++i)
+				{
+					ASSERT_EQ(pointer[i], t + 1) << "frame " << frame << " thread " << t;
+				}
+			}
+		}
+		arena.Reset();
+	}
+}
+
+TEST(FrameArenaTest, TwoArenasOnOneThreadStayApart)
+{
+	FrameArena a(4096, 1024);
+	FrameArena b(4096, 1024);
+
+	auto* fromA = static_cast<std::byte*>(a.Allocate(32));
+	auto* fromB = static_cast<std::byte*>(b.Allocate(32));
+	auto* fromA2 = static_cast<std::byte*>(a.Allocate(32));
+
+	// Back to back in A's chunk, B didn't take it over.
+	EXPECT_EQ(fromA2, fromA + 32);
+	EXPECT_FALSE(Overlaps(fromA, 64, fromB, 32));
+}
@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include "graphics/FrameCapture.h"
+#include "graphics/texture/ImageDecoder.h"
+#include "utils/ThreadPool.h"
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Stands in for the copy queue and the readback buffers. A copy only
+	/// lands in its buffer once the fence it was submitted with completes,
+	/// so mapping too early reads a buffer that was never written.
+	struct FakeGpu
+	{
+		struct Copy
+		{
+			uint32_t mSlot = 0;
+			uint32_t mWidth = 0;
+			uint32_t mHeight = 0;
+			uint8_t mFrame = 0;
+			uint64_t mFence = 0;
+		};
+
+		explicit FakeGpu(uint32_t ringSize)
+		: mBuffers(ringSize)
+		, mWritten(ringSize, false)
+		{
+		}
+
+		/// Placed footprints pad rows to 256 bytes.
+		uint32_t mRowPitch = 256;
+		std::vector<std::vector<uint8_t>> mBuffers;
+		std::vector<bool> mWritten;
+		std::vector<Copy> mCopies;
+		uint8_t mFrame = 0;
+		uint32_t mEarlyMaps = 0;
+		uint32_t mMaps = 0;
+		bool mFailMaps = false;
+
+		CaptureBackend MakeBackend()
+		{
+			CaptureBackend backend;
+			backend.mRecordCopy = [this](uint32_t slot, uint32_t width, uint32_t height) {
+				mCopies.push_back({slot, width, height, mFrame, 0});
+				return true;
+			};
+			backend.mMap = [this](uint32_t slot, uint32_t& rowPitch) -> const uint8_t* {
+				if (mFailMaps)
+				{
+					return nullptr;
+				}
+				mMaps++;
+				if (!mWritten[slot])
+				{
+					mEarlyMaps++;
+				}
+				rowPitch = mRowPitch;
+				return mBuffers[slot].data();
+			};
+			backend.mUnmap = [this](uint32_t slot) { mWritten[slot] = false; };
+			return backend;
+		}
+
+		void Submit(uint64_t fence)
+		{
+			for (Copy& copy : mCopies)
+			{
+				if (copy.mFence == 0)
+				{
+					copy.mFence = fence;
+				}
+			}
+			mFrame++;
+		}
+
+		/// Runs every copy the fence covers. Pixels are (frame, x, y, 255).
+		void Complete(uint64_t fence)
+		{
+			std::erase_if(mCopies, [this, fence](const Copy& copy) {
+				if (copy.mFence == 0 || copy.mFence > fence)
+				{
+					return false;
+				}
+				std::vector<uint8_t>& buffer = mBuffers[copy.mSlot];
+				buffer.assign(static_cast<size_t>(mRowPitch) * copy.mHeight, 0xCD);
+				for (uint32_t y = 0; y < copy.mHeight; ++y)
+				{
+					for (uint32_t x = 0; x < copy.mWidth; ++x)
+					{
+						uint8_t* p = &buffer[(y * mRowPitch) + (x * 4)];
+						p[0] = copy.mFrame;
+						p[1] = static_cast<uint8_t>(x);
+						p[2] = static_cast<uint8_t>(y);
+						p[3] = 255;
+					}
+				}
+				mWritten[copy.mSlot] = true;
+				return true;
+			});
+		}
+	};
+
+	std::filesystem::path MakeTempDir(const std::string& name)
+	{
+		std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+		std::filesystem::remove_all(dir);
+		std::filesystem::create_directories(dir);
+		return dir;
+	}
+
+	std::filesystem::path FramePath(const std::filesystem::path& dir, int frame,
+									const char* extension = ".png")
+	{
+		return dir / ("frame_" + std::to_string(frame) + extension);
+	}
+} // namespace
+
+TEST(FrameCaptureTest, MapsOnlyAfterTheFence)
+{
+	std::filesystem::path dir = MakeTempDir("jar_capture_fence");
+	FakeGpu gpu(3);
+	FrameCapture capture(gpu.MakeBackend(), {3, 8, nullptr});
+
+	ASSERT_TRUE(capture.Capture(10, 6, FramePath(dir, 0)));
+	capture.EndFrame(1);
+	gpu.Submit(1);
+
+	// The GPU hasn't got there yet, nothing gets touched.
+	capture.Retire(0);
+	EXPECT_EQ(gpu.mMaps, 0U);
+	EXPECT_EQ(capture.GetStats().mPendingSlots, 1U);
+
+	gpu.Complete(1);
+	capture.Retire(1);
+	capture.WaitForEncodes();
+	EXPECT_EQ(gpu.mMaps, 1U);
+	EXPECT_EQ(gpu.mEarlyMaps, 0U);
+	EXPECT_TRUE(capture.IsIdle());
+
+	// The row padding is gone and the pixels are the frame's.
+	TextureTools::Image image;
+	ASSERT_TRUE(TextureTools::DecodeImageFile(FramePath(dir, 0), image));
+	ASSERT_EQ(image.mWidth, 10U);
+	ASSERT_EQ(image.mHeight, 6U);
+	const uint8_t* p = image.GetPixel(9, 5);
+	EXPECT_EQ(p[0], 0);
+	EXPECT_EQ(p[1], 9);
+	EXPECT_EQ(p[2], 5);
+	EXPECT_EQ(p[3], 255);
+	EXPECT_EQ(capture.GetStats().mEncoded, 1U);
+	EXPECT_GT(capture.GetStats().mBytesWritten, 0U);
+}
+
+TEST(FrameCaptureTest, FullRingDropsUntilAFenceRetires)
+{
+	std::filesystem::path dir = MakeTempDir("jar_capture_full");
+	FakeGpu gpu(2);
+	FrameCapture capture(gpu.MakeBackend(), {2, 8, nullptr});
+
+	for (int frame = 0; frame < 2; ++frame)
+	{
+		ASSERT_TRUE(capture.Capture(4, 4, FramePath(dir, frame, ".qoi")));
+		capture.EndFrame(frame + 1);
+		gpu.Submit(frame + 1);
+	}
+	EXPECT_FALSE(capture.HasFreeSlot());
+	EXPECT_FALSE(capture.Capture(4, 4, FramePath(dir, 2, ".qoi")));
+	EXPECT_EQ(capture.GetStats().mDropped, 1U);
+
+	// Retiring only the first fence frees exactly one slot.
+	gpu.Complete(1);
+	capture.Retire(1);
+	EXPECT_TRUE(capture.HasFreeSlot());
+	EXPECT_EQ(capture.GetStats().mPendingSlots, 1U);
+	EXPECT_TRUE(capture.Capture(4, 4, FramePath(dir, 2, ".qoi")));
+
+	capture.EndFrame(3);
+	gpu.Submit(3);
+	gpu.Complete(3);
+	capture.Retire(3);
+	capture.WaitForEncodes();
+
+	EXPECT_EQ(gpu.mEarlyMaps, 0U);
+	EXPECT_EQ(capture.GetStats().mEncoded, 3U);
+	EXPECT_TRUE(std::filesystem::exists(FramePath(dir, 2, ".qoi")));
+}
+
+TEST(FrameCaptureTest, KeepsUpWithTheGpu)
+{
+	// A capture every frame with the GPU two frames behind the CPU, the
+	// usual frames in flight. Three slots is enough to never drop. The
+	// encode limit is out of the way, how fast the disk is isn't tested.
+	std::filesystem::path dir = MakeTempDir("jar_capture_steady");
+	Utils::ThreadPool pool(4);
+	FakeGpu gpu(3);
+	const int frameCount = 60;
+	FrameCapture capture(gpu.MakeBackend(), {3, frameCount, &pool});
+
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		uint64_t fence = frame + 1;
+		uint64_t completed = fence > 2 ? fence - 2 : 0;
+		gpu.Complete(completed);
+		capture.Retire(completed);
+
+		EXPECT_TRUE(capture.Capture(16, 16, FramePath(dir, frame, ".qoi"))) << frame;
+		capture.EndFrame(fence);
+		gpu.Submit(fence);
+	}
+	gpu.Complete(frameCount);
+	capture.Retire(frameCount);
+	capture.WaitForEncodes();
+
+	const FrameCaptureStats& stats = capture.GetStats();
+	EXPECT_EQ(stats.mDropped, 0U);
+	EXPECT_EQ(stats.mFailed, 0U);
+	EXPECT_EQ(stats.mEncoded, static_cast<uint64_t>(frameCount));
+	EXPECT_EQ(gpu.mEarlyMaps, 0U);
+	EXPECT_TRUE(capture.IsIdle());
+}
+
+TEST(FrameCaptureTest, SlowEncodersHoldTheRing)
+{
+	std::filesystem::path dir = MakeTempDir("jar_capture_backpressure");
+	Utils::ThreadPool pool(1);
+	FakeGpu gpu(3);
+	FrameCapture capture(gpu.MakeBackend(), {3, 1, &pool});
+
+	// Park the only worker so the first encode can't finish.
+	std::promise<void> gate;
+	std::shared_future<void> opened = gate.get_future().share();
+	std::future<void> blocker = pool.Submit([opened]() { opened.wait(); });
+
+	for (int frame = 0; frame < 2; ++frame)
+	{
+		ASSERT_TRUE(capture.Capture(8, 8, FramePath(dir, frame)));
+		capture.EndFrame(frame + 1);
+		gpu.Submit(frame + 1);
+	}
+	gpu.Complete(2);
+	capture.Retire(2);
+
+	// Both fences passed but only one encode is allowed in flight, the
+	// second frame stays in its readback buffer.
+	EXPECT_EQ(capture.GetStats().mReadBack, 1U);
+	EXPECT_EQ(capture.GetStats().mEncodesInFlight, 1U);
+	EXPECT_EQ(capture.GetStats().mPendingSlots, 1U);
+
+	gate.set_value();
+	blocker.wait();
+	capture.WaitForEncodes();
+	capture.Retire(2);
+	capture.WaitForEncodes();
+
+	EXPECT_EQ(capture.GetStats().mEncoded, 2U);
+	EXPECT_TRUE(capture.IsIdle());
+}
+
+TEST(FrameCaptureTest, FailuresFreeTheSlot)
+{
+	std::filesystem::path dir = MakeTempDir("jar_capture_fail");
+	FakeGpu gpu(1);
+	FrameCapture capture(gpu.MakeBackend(), {1, 8, nullptr});
+
+	// Not a format we write, nothing gets recorded.
+	EXPECT_FALSE(capture.Capture(4, 4, dir / "frame.bmp"));
+	EXPECT_TRUE(gpu.mCopies.empty());
+	EXPECT_EQ(capture.GetStats().mFailed, 1U);
+
+	ASSERT_TRUE(capture.Capture(4, 4, FramePath(dir, 0)));
+	capture.EndFrame(1);
+	gpu.Submit(1);
+	gpu.Complete(1);
+	gpu.mFailMaps = true;
+	capture.Retire(1);
+
+	EXPECT_EQ(capture.GetStats().mFailed, 2U);
+	EXPECT_FALSE(capture.GetLastError().empty());
+	EXPECT_TRUE(capture.HasFreeSlot());
+	EXPECT_FALSE(std::filesystem::exists(FramePath(dir, 0)));
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "graphics/FrameRing.h"
+#include <algorithm>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Queue where the test decides when the GPU finishes. Waiting on a
+	/// fence completes everything up to it, like the real wait would.
+	struct MockQueue
+	{
+		uint64_t mSubmitted = 0;
+		uint64_t mCompleted = 0;
+		std::vector<uint64_t> mWaits;
+
+		uint64_t Submit() { return ++mSubmitted; }
+
+		FrameQueue GetQueue()
+		{
+			FrameQueue queue;
+			queue.mGetCompletedFence = [this]() { return mCompleted; };
+			queue.mWaitForFence = [this](uint64_t fence) {
+				mWaits.push_back(fence);
+				mCompleted = std::max(mCompleted, fence);
+			};
+			return queue;
+		}
+	};
+
+	/// Stands in for the GraphicsContext, remembers who recorded into it.
+	struct FakeContext
+	{
+		uint32_t mId = 0;
+		uint64_t mLastFrame = 0;
+	};
+
+	FrameRing<FakeContext>::Factory MakeFactory(uint32_t& created)
+	{
+		return [&created]() {
+			auto context = std::make_unique<FakeContext>();
+			context->mId = created++;
+			return context;
+		};
+	}
+} // namespace
+
+TEST(FrameRingTest, NoWaitsWhenTheGpuKeepsUp)
+{
+	MockQueue queue;
+	uint32_t created = 0;
+	FrameRing<FakeContext> ring(queue.GetQueue(), MakeFactory(created), 2);
+	EXPECT_EQ(created, 2U);
+
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		ring.BeginFrame();
+		ring.EndFrame(queue.Submit());
+		queue.mCompleted = queue.mSubmitted;
+	}
+
+	EXPECT_TRUE(queue.mWaits.empty());
+	EXPECT_EQ(ring.GetStats().mFrames, 10U);
+	EXPECT_EQ(ring.GetStats().mWaits, 0U);
+}
+
+TEST(FrameRingTest, RecordsAheadOfTheGpuByTheLatency)
+{
+	MockQueue queue;
+	uint32_t created = 0;
+	FrameRing<FakeContext> ring(queue.GetQueue(), MakeFactory(created), 2);
+
+	// The GPU never finishes on its own. Frames 1 and 2 get recorded
+	// straight away, frame 3 has to wait for frame 1 only.
+	FakeContext& first = ring.BeginFrame();
+	ring.EndFrame(queue.Submit());
+	FakeContext& second = ring.BeginFrame();
+	ring.EndFrame(queue.Submit());
+	EXPECT_NE(first.mId, second.mId);
+	EXPECT_TRUE(queue.mWaits.empty());
+
+	FakeContext& third = ring.BeginFrame();
+	EXPECT_EQ(third.mId, first.mId);
+	ASSERT_EQ(queue.mWaits.size(), 1U);
+	EXPECT_EQ(queue.mWaits[0], 1U);
+	// Frame 2 is still allowed to be running.
+	EXPECT_LT(queue.mCompleted, 2U);
+	ring.EndFrame(queue.Submit());
+}
+
+TEST(FrameRingTest, NeverHandsOutASlotTheGpuStillUses)
+{
+	MockQueue queue;
+	uint32_t created = 0;
+	FrameRing<FakeContext> ring(queue.GetQueue(), MakeFactory(created), 3);
+
+	// The GPU finishes a frame every other CPU frame, so it falls behind
+	// and BeginFrame has to throttle.
+	std::vector<uint64_t> slotFences(3, 0);
+	for (uint64_t frame = 1; frame <= 50; ++frame)
+	{
+		uint32_t index = ring.GetFrameIndex();
+		FakeContext& context = ring.BeginFrame();
+		EXPECT_LE(slotFences[index], queue.mCompleted) << "frame " << frame;
+
+		context.mLastFrame = frame;
+		uint64_t fence = queue.Submit();
+		slotFences[index] = fence;
+		ring.EndFrame(fence);
+
+		if (frame % 2 == 0 && queue.mCompleted < queue.mSubmitted)
+		{
+			queue.mCompleted++;
+		}
+		// Never more than the latency in flight.
+		EXPECT_LE(queue.mSubmitted - queue.mCompleted, 3U);
+	}
+	EXPECT_GT(ring.GetStats().mWaits, 0U);
+}
+
+TEST(FrameRingTest, LatencyOfOneSerialises)
+{
+	MockQueue queue;
+	uint32_t created = 0;
+	FrameRing<FakeContext> ring(queue.GetQueue(), MakeFactory(created), 1);
+
+	for (int frame = 0; frame < 5; ++frame)
+	{
+		ring.BeginFrame();
+		EXPECT_EQ(queue.mCompleted, queue.mSubmitted);
+		ring.EndFrame(queue.Submit());
+	}
+	EXPECT_EQ(queue.mWaits.size(), 4U);
+}
+
+TEST(FrameRingTest, ChangingLatencyDrainsFirst)
+{
+	MockQueue queue;
+	uint32_t created = 0;
+	FrameRing<FakeContext> ring(queue.GetQueue(), MakeFactory(created), 2);
+
+	ring.BeginFrame();
+	ring.EndFrame(queue.Submit());
+	ring.BeginFrame();
+	ring.EndFrame(queue.Submit());
+
+	ring.SetLatency(3);
+	EXPECT_EQ(queue.mCompleted, 2U);
+	EXPECT_EQ(ring.GetLatency(), 3U);
+	// The two existing contexts are kept, one more is made.
+	EXPECT_EQ(created, 3U);
+	EXPECT_EQ(ring.GetFrameIndex(), 0U);
+
+	ring.SetLatency(100);
+	EXPECT_EQ(ring.GetLatency(), FrameRing<FakeContext>::MAX_LATENCY);
+	ring.SetLatency(0);
+	EXPECT_EQ(ring.GetLatency(), 1U);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "utils/FileUtils.h"
+#include "utils/Hash.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+TEST(HashTest, KnownValues)
+{
+	// Reference values from the XXH64 spec.
+	EXPECT_EQ(Utils::Hash64("", 0), 0xEF46DB3751D8E999ULL);
+	EXPECT_EQ(Utils::Hash64("a", 1), 0xD24EC4F1A98C6E5BULL);
+	EXPECT_EQ(Utils::Hash64("abc", 3), 0x44BC2CF5AD770999ULL);
+}
+
+TEST(HashTest, StreamingMatchesOneShot)
+{
+	std::vector<uint8_t> data(1000);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<uint8_t>(i * 131 + 7);
+	}
+	uint64_t expected = Utils::Hash64(data.data(), data.size());
+
+	for (size_t chunk : {1U, 3U, 31U, 32U, 33U, 100U, 999U})
+	{
+		Utils::Hasher64 hasher;
+		for (size_t offset = 0; offset < data.size(); offset += chunk)
+		{
+			hasher.Update(data.data() + offset, std::min(chunk, data.size() - offset));
+		}
+		EXPECT_EQ(hasher.Finalize(), expected) << "chunk " << chunk;
+	}
+}
+
+TEST(HashTest, DifferentContentsDiffer)
+{
+	std::string a = "textures/rock_albedo.png";
+	std::string b = "textures/rock_albedo.pnh";
+	EXPECT_NE(Utils::Hash64(a.data(), a.size()), Utils::Hash64(b.data(), b.size()));
+	EXPECT_NE(Utils::Hash64(a.data(), a.size(), 1), Utils::Hash64(a.data(), a.size(), 2));
+	EXPECT_NE(Utils::HashCombine(1, 2), Utils::HashCombine(1, 3));
+}
+
+TEST(HashTest, ReadFileHashesWhileReading)
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "jar_hash_test.bin";
+	std::vector<uint8_t> contents(600 * 1024);
+	for (size_t i = 0; i < contents.size(); ++i)
+	{
+		contents[i] = static_cast<uint8_t>(i ^ (i >> 9));
+	}
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(contents.data()),
+				   static_cast<std::streamsize>(contents.size()));
+	}
+
+	std::vector<uint8_t> data;
+	uint64_t hash = 0;
+	ASSERT_TRUE(Utils::ReadBinaryFile(path, data, hash));
+	EXPECT_EQ(data, contents);
+	EXPECT_EQ(hash, Utils::Hash64(contents.data(), contents.size()));
+
+	std::filesystem::remove(path);
+	EXPECT_FALSE(Utils::ReadBinaryFile(path, data, hash));
+}
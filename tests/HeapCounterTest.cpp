@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "utils/FrameArena.h"
+#include "utils/HeapCounter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Utils;
+
+TEST(HeapCounterTest, CountsEveryOperatorNew)
+{
+	uint64_t before = GetHeapAllocationCount();
+
+	auto single = std::make_unique<int>(1);
+	auto array = std::make_unique<int[]>(16);
+	struct alignas(64) Aligned
+	{
+		float mValues[16];
+	};
+	auto aligned = std::make_unique<Aligned>();
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned.get()) % 64, 0U);
+
+	EXPECT_EQ(GetHeapAllocationCount() - before, 3U);
+}
+
+TEST(HeapCounterTest, SteadyFramesInTheArenaDontAllocate)
+{
+	FrameArena arena(4096, 1024);
+	std::vector<uint32_t> reused;
+
+	// The first frames grow the arena and the vector, after that nothing
+	// new is needed.
+	uint64_t frameAllocations = 0;
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		uint64_t before = GetHeapAllocationCount();
+		arena.Reset();
+		reused.clear();
+
+		FrameVector<uint64_t> drawList{FrameAllocator<uint64_t>(arena)};
+		for (uint32_t i = 0; i < 1000; ++i)
+		{
+			drawList.push_back(i);
+			reused.push_back(i);
+		}
+		frameAllocations = GetHeapAllocationCount() - before;
+	}
+	EXPECT_EQ(frameAllocations, 0U);
+
+	// A string past the small buffer shows up.
+	uint64_t before = GetHeapAllocationCount();
+	std::string name(64, 'x');
+	EXPECT_GE(GetHeapAllocationCount() - before, 1U);
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/IBLBaker.h"
+#include "utils/ThreadPool.h"
+#include <filesystem>
+
+using namespace TextureTools;
+
+namespace
+{
+	ImageF MakeConstant(uint32_t width, uint32_t height, float r, float g, float b)
+	{
+		ImageF image(width, height);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				float* px = image.GetPixel(x, y);
+				px[0] = r;
+				px[1] = g;
+				px[2] = b;
+				px[3] = 1.0F;
+			}
+		}
+		return image;
+	}
+
+	/// Sky above the horizon, black below. Rows are latitude with the top
+	/// row at +y.
+	ImageF MakeSky(uint32_t width, uint32_t height, float brightness)
+	{
+		ImageF image = MakeConstant(width, height, 0.0F, 0.0F, 0.0F);
+		for (uint32_t y = 0; y < height / 2; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				float* px = image.GetPixel(x, y);
+				px[0] = brightness;
+				px[1] = brightness;
+				px[2] = brightness;
+			}
+		}
+		return image;
+	}
+
+	std::filesystem::path TempPath(const char* name)
+	{
+		return std::filesystem::temp_directory_path() / name;
+	}
+} // namespace
+
+TEST(IBLBakerTest, UniformEnvironmentGivesUniformIrradiance)
+{
+	Utils::ThreadPool pool(2);
+	ImageF env = MakeConstant(128, 64, 0.5F, 1.0F, 2.0F);
+
+	SHCoefficients irradiance = ConvolveIrradiance(ProjectToSH(env, pool));
+
+	// Irradiance / pi of a uniform radiance L is L itself.
+	const float dirs[][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, -1}, {0.577F, -0.577F, 0.577F}};
+	for (const auto& d : dirs)
+	{
+		std::array<float, 3> e = EvaluateSH(irradiance, d[0], d[1], d[2]);
+		EXPECT_NEAR(e[0], 0.5F, 0.01F);
+		EXPECT_NEAR(e[1], 1.0F, 0.01F);
+		EXPECT_NEAR(e[2], 2.0F, 0.02F);
+	}
+}
+
+TEST(IBLBakerTest, SkyLightsUpwardNormals)
+{
+	Utils::ThreadPool pool(2);
+	ImageF env = MakeSky(128, 64, 1.0F);
+
+	SHCoefficients irradiance = ConvolveIrradiance(ProjectToSH(env, pool));
+	float up = EvaluateSH(irradiance, 0, 1, 0)[0];
+	float side = EvaluateSH(irradiance, 1, 0, 0)[0];
+	float down = EvaluateSH(irradiance, 0, -1, 0)[0];
+
+	// Exact values for a lit hemisphere are 1, 0.5 and 0, band 2 SH gets
+	// within a few percent.
+	EXPECT_NEAR(up, 1.0F, 0.06F);
+	EXPECT_NEAR(side, 0.5F, 0.03F);
+	EXPECT_NEAR(down, 0.0F, 0.06F);
+}
+
+TEST(IBLBakerTest, EquirectToCubeFacesMatchDirections)
+{
+	Utils::ThreadPool pool(2);
+	ImageF env = MakeSky(256, 128, 3.0F);
+
+	CubeMap cube = EquirectToCube(env, 32, pool);
+	ASSERT_EQ(cube.mSize, 32U);
+	ASSERT_EQ(cube.mLevels.size(), 6U);
+	EXPECT_EQ(cube.mLevels.back()[0].mWidth, 1U);
+
+	// +Y face is all sky, -Y all ground, the side faces half and half.
+	EXPECT_NEAR(cube.mLevels[0][2].GetPixel(16, 16)[0], 3.0F, 1e-3F);
+	EXPECT_NEAR(cube.mLevels[0][3].GetPixel(16, 16)[0], 0.0F, 1e-3F);
+	EXPECT_NEAR(cube.mLevels[0][0].GetPixel(16, 2)[0], 3.0F, 1e-3F);
+	EXPECT_NEAR(cube.mLevels[0][0].GetPixel(16, 29)[0], 0.0F, 1e-3F);
+
+	// Box mips keep the average.
+	EXPECT_NEAR(cube.mLevels.back()[4].GetPixel(0, 0)[0], 1.5F, 0.1F);
+}
+
+TEST(IBLBakerTest, PrefilterKeepsUniformEnvironment)
+{
+	Utils::ThreadPool pool(2);
+	ImageF env = MakeConstant(64, 32, 0.25F, 0.5F, 1.0F);
+
+	CubeMap source = EquirectToCube(env, 32, pool);
+	CubeMap prefiltered = PrefilterGGX(source, 5, 64, pool);
+	ASSERT_EQ(prefiltered.mLevels.size(), 5U);
+
+	for (uint32_t level = 0; level < prefiltered.mLevels.size(); ++level)
+	{
+		EXPECT_EQ(prefiltered.mLevels[level][0].mWidth, 32U >> level);
+		for (const ImageF& face : prefiltered.mLevels[level])
+		{
+			const float* px = face.GetPixel(face.mWidth / 2, face.mHeight / 2);
+			EXPECT_NEAR(px[0], 0.25F, 1e-3F);
+			EXPECT_NEAR(px[2], 1.0F, 1e-3F);
+		}
+	}
+}
+
+TEST(IBLBakerTest, PrefilterBlursWithRoughness)
+{
+	Utils::ThreadPool pool(2);
+	ImageF env = MakeSky(128, 64, 1.0F);
+
+	CubeMap source = EquirectToCube(env, 32, pool);
+	CubeMap prefiltered = PrefilterGGX(source, 5, 128, pool);
+
+	// A bit above the horizon on +X: sharp at roughness 0, pulled towards
+	// the dark ground as the lobe widens.
+	auto aboveHorizon = [&](uint32_t level) {
+		const ImageF& face = prefiltered.mLevels[level][0];
+		return face.GetPixel(face.mWidth / 2, face.mHeight / 2 - 1 - (face.mHeight / 8))[0];
+	};
+	EXPECT_NEAR(aboveHorizon(0), 1.0F, 1e-3F);
+	EXPECT_LT(aboveHorizon(4), aboveHorizon(1));
+	EXPECT_GT(aboveHorizon(4), 0.2F);
+}
+
+TEST(IBLBakerTest, BrdfLutIsEnergyConserving)
+{
+	Utils::ThreadPool pool(2);
+	BrdfLut lut = IntegrateBrdfLut(32, 256, pool);
+	ASSERT_EQ(lut.mData.size(), 32U * 32U * 2U);
+
+	for (uint32_t i = 0; i < 32 * 32; ++i)
+	{
+		const float scale = lut.mData[i * 2];
+		const float bias = lut.mData[i * 2 + 1];
+		ASSERT_GE(scale, 0.0F);
+		ASSERT_GE(bias, 0.0F);
+		ASSERT_LE(scale + bias, 1.01F);
+	}
+
+	// Smooth surface seen head on reflects F0 as is.
+	const float* smoothFacing = lut.mData.data() + (0 * 32 + 31) * 2;
+	EXPECT_NEAR(smoothFacing[0], 1.0F, 0.03F);
+	EXPECT_NEAR(smoothFacing[1], 0.0F, 0.01F);
+
+	// Rough surfaces lose energy, grazing angles pick up Fresnel.
+	const float* roughFacing = lut.mData.data() + (31 * 32 + 31) * 2;
+	EXPECT_LT(roughFacing[0] + roughFacing[1], 0.7F);
+	const float* smoothGrazing = lut.mData.data() + (0 * 32 + 0) * 2;
+	EXPECT_GT(smoothGrazing[1], 0.5F);
+}
+
+TEST(IBLBakerTest, CacheRoundTrip)
+{
+	Utils::ThreadPool pool(2);
+	IBLDesc desc;
+	desc.mCubeSize = 16;
+	desc.mMipLevels = 3;
+	desc.mSampleCount = 32;
+	desc.mLutSize = 16;
+	desc.mLutSampleCount = 64;
+
+	IBLData baked = BakeIBL(MakeSky(64, 32, 2.0F), desc, pool);
+	const uint64_t key = ComputeIBLKey(1234, desc);
+	const std::filesystem::path path = TempPath("jar_ibl_cache_test.bin");
+
+	ASSERT_TRUE(SaveIBLCache(path, key, baked));
+
+	IBLData loaded;
+	ASSERT_TRUE(LoadIBLCache(path, key, loaded));
+	EXPECT_EQ(loaded.mIrradiance.mCoefficients, baked.mIrradiance.mCoefficients);
+	ASSERT_EQ(loaded.mPrefiltered.mLevels.size(), 3U);
+	EXPECT_EQ(loaded.mPrefiltered.mLevels[2][5].mPixels, baked.mPrefiltered.mLevels[2][5].mPixels);
+	EXPECT_EQ(loaded.mBrdfLut.mData, baked.mBrdfLut.mData);
+
+	// A different source or different settings miss the cache.
+	IBLData miss;
+	EXPECT_FALSE(LoadIBLCache(path, ComputeIBLKey(4321, desc), miss));
+	desc.mSampleCount = 64;
+	EXPECT_NE(ComputeIBLKey(1234, desc), key);
+
+	// Truncated files are rejected rather than half loaded.
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+	EXPECT_FALSE(LoadIBLCache(path, key, miss));
+
+	std::filesystem::remove(path);
+	EXPECT_FALSE(LoadIBLCache(path, key, miss));
+}
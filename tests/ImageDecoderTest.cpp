@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/ImageDecoder.h"
+#include "utils/ThreadPool.h"
+#include <fstream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+using namespace TextureTools;
+
+namespace
+{
+	std::vector<uint8_t> MakePattern(uint32_t width, uint32_t height, uint32_t channels)
+	{
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * channels);
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			pixels[i] = static_cast<uint8_t>((i * 37) ^ (i >> 3));
+		}
+		return pixels;
+	}
+
+	void AppendBytes(void* context, void* data, int size)
+	{
+		auto* out = static_cast<std::vector<uint8_t>*>(context);
+		auto* bytes = static_cast<uint8_t*>(data);
+		out->insert(out->end(), bytes, bytes + size);
+	}
+
+	void ExpectMatchesSource(const Image& image, const std::vector<uint8_t>& source,
+							 uint32_t channels)
+	{
+		size_t pixelCount = static_cast<size_t>(image.mWidth) * image.mHeight;
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			const uint8_t* s = source.data() + i * channels;
+			const uint8_t* d = image.mPixels.data() + i * 4;
+			bool grey = channels < 3;
+			ASSERT_EQ(d[0], s[0]);
+			ASSERT_EQ(d[1], grey ? s[0] : s[1]);
+			ASSERT_EQ(d[2], grey ? s[0] : s[2]);
+			ASSERT_EQ(d[3], channels == 2 ? s[1] : (channels == 4 ? s[3] : 255));
+		}
+	}
+} // namespace
+
+TEST(ImageDecoderTest, FormatFromExtension)
+{
+	EXPECT_EQ(GetImageFormat("assets/albedo.png"), ImageFormat::PNG);
+	EXPECT_EQ(GetImageFormat("assets/albedo.JPG"), ImageFormat::JPEG);
+	EXPECT_EQ(GetImageFormat("assets/albedo.jpeg"), ImageFormat::JPEG);
+	EXPECT_EQ(GetImageFormat("assets/albedo.tga"), ImageFormat::TGA);
+	EXPECT_EQ(GetImageFormat("assets/albedo.dds"), ImageFormat::Unknown);
+	EXPECT_EQ(GetImageFormat("assets/albedo"), ImageFormat::Unknown);
+}
+
+TEST(ImageDecoderTest, ExpandToRGBA)
+{
+	// Odd pixel count so both the SIMD loop and the scalar tail run.
+	for (uint32_t channels = 1; channels <= 4; ++channels)
+	{
+		std::vector<uint8_t> source = MakePattern(37, 3, channels);
+		Image image(37, 3);
+		ExpandToRGBA(source.data(), 37 * 3, channels, image.mPixels.data());
+		ExpectMatchesSource(image, source, channels);
+	}
+}
+
+TEST(ImageDecoderTest, StagingPoolReusesBuffers)
+{
+	StagingPool pool(1024);
+
+	std::vector<uint8_t> first = pool.Acquire(256);
+	const uint8_t* firstData = first.data();
+	pool.Release(std::move(first));
+	EXPECT_EQ(pool.GetPooledBytes(), 256U);
+
+	std::vector<uint8_t> second = pool.Acquire(128);
+	EXPECT_EQ(second.data(), firstData);
+	EXPECT_EQ(second.size(), 128U);
+	EXPECT_EQ(pool.GetReuseCount(), 1U);
+	EXPECT_EQ(pool.GetPooledBytes(), 0U);
+
+	// Too big for the pool, gets dropped.
+	pool.Release(std::vector<uint8_t>(4096));
+	EXPECT_EQ(pool.GetPooledBytes(), 0U);
+}
+
+TEST(ImageDecoderTest, PNGRoundTrip)
+{
+	for (uint32_t channels = 1; channels <= 4; ++channels)
+	{
+		std::vector<uint8_t> source = MakePattern(33, 17, channels);
+		std::vector<uint8_t> encoded;
+		ASSERT_NE(stbi_write_png_to_func(AppendBytes, &encoded, 33, 17, static_cast<int>(channels),
+										 source.data(), static_cast<int>(33 * channels)),
+				  0);
+
+		Image image;
+		std::string error;
+		ASSERT_TRUE(DecodeImage(encoded.data(), encoded.size(), image, nullptr, &error)) << error;
+		EXPECT_EQ(image.mWidth, 33U);
+		EXPECT_EQ(image.mHeight, 17U);
+		ExpectMatchesSource(image, source, channels);
+	}
+}
+
+TEST(ImageDecoderTest, TGARoundTrip)
+{
+	std::vector<uint8_t> source = MakePattern(20, 9, 3);
+	std::vector<uint8_t> encoded;
+	ASSERT_NE(stbi_write_tga_to_func(AppendBytes, &encoded, 20, 9, 3, source.data()), 0);
+
+	Image image;
+	ASSERT_TRUE(DecodeImage(encoded.data(), encoded.size(), image));
+	ExpectMatchesSource(image, source, 3);
+}
+
+TEST(ImageDecoderTest, EncodeTGARoundTrip)
+{
+	std::vector<uint8_t> source = MakePattern(13, 7, 4);
+	Image original(13, 7);
+	original.mPixels = source;
+
+	std::vector<uint8_t> encoded;
+	ASSERT_TRUE(EncodeTGA(original, encoded));
+
+	Image image;
+	ASSERT_TRUE(DecodeImage(encoded.data(), encoded.size(), image));
+	ExpectMatchesSource(image, source, 4);
+
+	EXPECT_FALSE(EncodeTGA(Image(), encoded));
+}
+
+TEST(ImageDecoderTest, JPEGDecodes)
+{
+	std::vector<uint8_t> source(64 * 64 * 3, 200);
+	std::vector<uint8_t> encoded;
+	ASSERT_NE(stbi_write_jpg_to_func(AppendBytes, &encoded, 64, 64, 3, source.data(), 95), 0);
+
+	Image image;
+	ASSERT_TRUE(DecodeImage(encoded.data(), encoded.size(), image));
+	ASSERT_EQ(image.mWidth, 64U);
+	for (size_t i = 0; i < image.mPixels.size(); i += 4)
+	{
+		EXPECT_NEAR(image.mPixels[i], 200, 2);
+		EXPECT_EQ(image.mPixels[i + 3], 255);
+	}
+}
+
+TEST(ImageDecoderTest, InfoReadsHeaderOnly)
+{
+	std::vector<uint8_t> source = MakePattern(40, 24, 4);
+	std::vector<uint8_t> encoded;
+	ASSERT_NE(stbi_write_png_to_func(AppendBytes, &encoded, 40, 24, 4, source.data(), 40 * 4), 0);
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	ASSERT_TRUE(GetImageInfo(encoded.data(), encoded.size(), width, height));
+	EXPECT_EQ(width, 40U);
+	EXPECT_EQ(height, 24U);
+
+	std::vector<uint8_t> garbage(64, 0xAB);
+	EXPECT_FALSE(GetImageInfo(garbage.data(), garbage.size(), width, height));
+}
+
+TEST(ImageDecoderTest, GarbageFails)
+{
+	std::vector<uint8_t> garbage(128, 0xAB);
+	Image image;
+	std::string error;
+	EXPECT_FALSE(DecodeImage(garbage.data(), garbage.size(), image, nullptr, &error));
+	EXPECT_FALSE(error.empty());
+}
+
+TEST(ImageDecoderTest, DecodeFilesInParallel)
+{
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "jar_decode_test";
+	std::filesystem::create_directories(dir);
+
+	std::vector<std::filesystem::path> paths;
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		std::vector<uint8_t> source(16 * 16 * 4, static_cast<uint8_t>(i * 10));
+		std::vector<uint8_t> encoded;
+		stbi_write_png_to_func(AppendBytes, &encoded, 16, 16, 4, source.data(), 16 * 4);
+
+		paths.push_back(dir / ("image" + std::to_string(i) + ".png"));
+		std::ofstream file(paths.back(), std::ios::binary);
+		file.write(reinterpret_cast<const char*>(encoded.data()),
+				   static_cast<std::streamsize>(encoded.size()));
+	}
+	paths.push_back(dir / "missing.png");
+
+	Utils::ThreadPool pool(4);
+	StagingPool staging;
+	std::vector<DecodeResult> results = DecodeImageFiles(paths, pool, &staging);
+
+	ASSERT_EQ(results.size(), paths.size());
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		ASSERT_TRUE(results[i].mSuccess) << results[i].mError;
+		EXPECT_EQ(results[i].mImage.GetPixel(5, 5)[0], i * 10);
+	}
+	EXPECT_FALSE(results.back().mSuccess);
+
+	std::filesystem::remove_all(dir);
+}
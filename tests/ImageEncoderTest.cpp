@@ -0,0 +1,316 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/ImageDecoder.h"
+#include "graphics/texture/ImageEncoder.h"
+#include "graphics/texture/MipGenerator.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+using namespace TextureTools;
+
+namespace
+{
+	/// Gradients, flat runs, noise and alpha changes, so every QOI op gets
+	/// used somewhere.
+	Image MakeTestImage(uint32_t width, uint32_t height)
+	{
+		Image image(width, height);
+		uint32_t seed = 12345;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t* p = image.GetPixel(x, y);
+				seed = (seed * 1664525U) + 1013904223U;
+				if (y < height / 4)
+				{
+					p[0] = static_cast<uint8_t>(x * 3);
+					p[1] = static_cast<uint8_t>(y * 5);
+					p[2] = static_cast<uint8_t>(x + y);
+					p[3] = 255;
+				}
+				else if (y < height / 2)
+				{
+					p[0] = 40;
+					p[1] = 80;
+					p[2] = 120;
+					p[3] = x < width / 2 ? 255 : 128;
+				}
+				else
+				{
+					p[0] = static_cast<uint8_t>(seed >> 24);
+					p[1] = static_cast<uint8_t>(seed >> 16);
+					p[2] = static_cast<uint8_t>(seed >> 8);
+					p[3] = (seed & 0x100) != 0 ? 255 : static_cast<uint8_t>(seed);
+				}
+			}
+		}
+		return image;
+	}
+
+	uint32_t ReadBigEndian32(const uint8_t* p)
+	{
+		return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+			   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+	}
+
+	/// Straight from the QOI spec, kept separate from the encoder so a
+	/// mistake doesn't cancel itself out.
+	bool DecodeQOI(const std::vector<uint8_t>& data, Image& out)
+	{
+		if (data.size() < 22 || std::memcmp(data.data(), "qoif", 4) != 0)
+		{
+			return false;
+		}
+		out = Image(ReadBigEndian32(&data[4]), ReadBigEndian32(&data[8]));
+
+		std::array<std::array<uint8_t, 4>, 64> index = {};
+		std::array<uint8_t, 4> pixel = {0, 0, 0, 255};
+		size_t pos = 14;
+		uint32_t run = 0;
+		for (size_t i = 0; i < out.mPixels.size(); i += 4)
+		{
+			if (run > 0)
+			{
+				run--;
+			}
+			else
+			{
+				if (pos >= data.size() - 8)
+				{
+					return false;
+				}
+				uint8_t op = data[pos++];
+				if (op == 0xFE)
+				{
+					pixel[0] = data[pos++];
+					pixel[1] = data[pos++];
+					pixel[2] = data[pos++];
+				}
+				else if (op == 0xFF)
+				{
+					for (uint8_t& channel : pixel)
+					{
+						channel = data[pos++];
+					}
+				}
+				else if ((op & 0xC0) == 0x00)
+				{
+					pixel = index[op];
+				}
+				else if ((op & 0xC0) == 0x40)
+				{
+					pixel[0] += ((op >> 4) & 3) - 2;
+					pixel[1] += ((op >> 2) & 3) - 2;
+					pixel[2] += (op & 3) - 2;
+				}
+				else if ((op & 0xC0) == 0x80)
+				{
+					uint8_t next = data[pos++];
+					int dg = (op & 0x3F) - 32;
+					pixel[0] += dg - 8 + ((next >> 4) & 0x0F);
+					pixel[1] += dg;
+					pixel[2] += dg - 8 + (next & 0x0F);
+				}
+				else
+				{
+					run = op & 0x3F;
+				}
+				index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+			}
+			std::memcpy(&out.mPixels[i], pixel.data(), 4);
+		}
+
+		const uint8_t end[] = {0, 0, 0, 0, 0, 0, 0, 1};
+		return pos + 8 == data.size() && std::memcmp(&data[pos], end, 8) == 0;
+	}
+
+	template <typename T> T ReadLittleEndian(const std::vector<uint8_t>& data, size_t pos)
+	{
+		T value;
+		std::memcpy(&value, &data[pos], sizeof(T));
+		return value;
+	}
+
+	std::string ReadString(const std::vector<uint8_t>& data, size_t& pos)
+	{
+		std::string text(reinterpret_cast<const char*>(&data[pos]));
+		pos += text.size() + 1;
+		return text;
+	}
+} // namespace
+
+TEST(ImageEncoderTest, FormatFromExtension)
+{
+	EXPECT_EQ(GetEncodeFormat("frame.png"), EncodeFormat::PNG);
+	EXPECT_EQ(GetEncodeFormat("out/Frame_0001.QOI"), EncodeFormat::QOI);
+	EXPECT_EQ(GetEncodeFormat("beauty.exr"), EncodeFormat::EXR);
+	EXPECT_EQ(GetEncodeFormat("frame.jpg"), EncodeFormat::Unknown);
+	EXPECT_EQ(GetEncodeFormat("frame"), EncodeFormat::Unknown);
+}
+
+TEST(ImageEncoderTest, PngRoundTrips)
+{
+	Image source = MakeTestImage(37, 29);
+	std::vector<uint8_t> encoded;
+	ASSERT_TRUE(EncodePNG(source, encoded));
+
+	Image decoded;
+	ASSERT_TRUE(DecodeImage(encoded.data(), encoded.size(), decoded));
+	EXPECT_EQ(decoded.mWidth, source.mWidth);
+	EXPECT_EQ(decoded.mHeight, source.mHeight);
+	EXPECT_EQ(decoded.mPixels, source.mPixels);
+}
+
+TEST(ImageEncoderTest, QoiRoundTrips)
+{
+	for (uint32_t size : {1U, 7U, 64U, 131U})
+	{
+		Image source = MakeTestImage(size, size + 3);
+		std::vector<uint8_t> encoded;
+		ASSERT_TRUE(EncodeQOI(source, encoded));
+
+		EXPECT_EQ(ReadBigEndian32(&encoded[4]), source.mWidth);
+		EXPECT_EQ(ReadBigEndian32(&encoded[8]), source.mHeight);
+		EXPECT_EQ(encoded[12], 4);
+
+		Image decoded;
+		ASSERT_TRUE(DecodeQOI(encoded, decoded)) << size;
+		EXPECT_EQ(decoded.mPixels, source.mPixels) << size;
+	}
+}
+
+TEST(ImageEncoderTest, QoiFlatImageIsRuns)
+{
+	Image flat(256, 256);
+	for (size_t i = 0; i < flat.mPixels.size(); i += 4)
+	{
+		flat.mPixels[i + 0] = 10;
+		flat.mPixels[i + 1] = 20;
+		flat.mPixels[i + 2] = 30;
+		flat.mPixels[i + 3] = 255;
+	}
+
+	std::vector<uint8_t> encoded;
+	ASSERT_TRUE(EncodeQOI(flat, encoded));
+	// One RGB op, then runs of 62.
+	EXPECT_EQ(encoded.size(), 14 + 4 + ((65535 + 61) / 62) + 8);
+
+	Image decoded;
+	ASSERT_TRUE(DecodeQOI(encoded, decoded));
+	EXPECT_EQ(decoded.mPixels, flat.mPixels);
+}
+
+TEST(ImageEncoderTest, ExrHeaderAndPixels)
+{
+	Image source = MakeTestImage(19, 11);
+	std::vector<uint8_t> encoded;
+	ASSERT_TRUE(EncodeImage(source, EncodeFormat::EXR, encoded));
+
+	ASSERT_GT(encoded.size(), 8U);
+	EXPECT_EQ(ReadLittleEndian<uint32_t>(encoded, 0), 20000630U);
+	EXPECT_EQ(ReadLittleEndian<uint32_t>(encoded, 4), 2U);
+
+	size_t pos = 8;
+	std::vector<std::string> channels;
+	int32_t maxX = -1;
+	int32_t maxY = -1;
+	uint8_t compression = 0xFF;
+	while (encoded[pos] != 0)
+	{
+		std::string name = ReadString(encoded, pos);
+		std::string type = ReadString(encoded, pos);
+		auto size = ReadLittleEndian<uint32_t>(encoded, pos);
+		pos += 4;
+
+		if (name == "channels")
+		{
+			EXPECT_EQ(type, "chlist");
+			size_t channel = pos;
+			while (encoded[channel] != 0)
+			{
+				channels.push_back(ReadString(encoded, channel));
+				EXPECT_EQ(ReadLittleEndian<int32_t>(encoded, channel), 1) << "not HALF";
+				channel += 16;
+			}
+		}
+		else if (name == "compression")
+		{
+			compression = encoded[pos];
+		}
+		else if (name == "dataWindow")
+		{
+			maxX = ReadLittleEndian<int32_t>(encoded, pos + 8);
+			maxY = ReadLittleEndian<int32_t>(encoded, pos + 12);
+		}
+		pos += size;
+	}
+	pos++;
+
+	EXPECT_EQ(channels, std::vector<std::string>({"A", "B", "G", "R"}));
+	EXPECT_EQ(compression, 0);
+	ASSERT_EQ(maxX, 18);
+	ASSERT_EQ(maxY, 10);
+
+	// Check a scanline through the offset table, channels one after the
+	// other in the same A, B, G, R order.
+	const uint32_t y = 7;
+	auto offset = ReadLittleEndian<uint64_t>(encoded, pos + (y * 8));
+	EXPECT_EQ(ReadLittleEndian<int32_t>(encoded, offset), static_cast<int32_t>(y));
+	EXPECT_EQ(ReadLittleEndian<uint32_t>(encoded, offset + 4), 19U * 4 * 2);
+
+	size_t line = offset + 8;
+	for (uint32_t x = 0; x < source.mWidth; ++x)
+	{
+		const uint8_t* p = source.GetPixel(x, y);
+		auto channel = [&](uint32_t c) {
+			return HalfToFloat(ReadLittleEndian<uint16_t>(encoded, line + ((c * 19) + x) * 2));
+		};
+		EXPECT_NEAR(channel(0), p[3] / 255.0F, 1e-3F);
+		EXPECT_NEAR(channel(1), SRGBToLinear(p[2]), 1e-3F);
+		EXPECT_NEAR(channel(2), SRGBToLinear(p[1]), 1e-3F);
+		EXPECT_NEAR(channel(3), SRGBToLinear(p[0]), 1e-3F);
+	}
+	EXPECT_EQ(encoded.size(), pos + (11 * 8) + (11 * (8 + (19 * 4 * 2))));
+}
+
+TEST(ImageEncoderTest, HalfFloatConversion)
+{
+	EXPECT_EQ(FloatToHalf(0.0F), 0x0000);
+	EXPECT_EQ(FloatToHalf(-0.0F), 0x8000);
+	EXPECT_EQ(FloatToHalf(1.0F), 0x3C00);
+	EXPECT_EQ(FloatToHalf(-2.0F), 0xC000);
+	EXPECT_EQ(FloatToHalf(0.1F), 0x2E66);
+	EXPECT_EQ(FloatToHalf(65504.0F), 0x7BFF);
+	EXPECT_EQ(FloatToHalf(65520.0F), 0x7C00);
+	EXPECT_EQ(FloatToHalf(std::ldexp(1.0F, -24)), 0x0001);
+	EXPECT_EQ(FloatToHalf(std::ldexp(1.0F, -26)), 0x0000);
+	EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+	EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x7C00, 0x7C00);
+	EXPECT_NE(FloatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x03FF, 0);
+	// Halfway between 1 and the next half, ties go to the even one.
+	EXPECT_EQ(FloatToHalf(1.0F + std::ldexp(1.0F, -11)), 0x3C00);
+	EXPECT_EQ(FloatToHalf(1.0F + std::ldexp(3.0F, -11)), 0x3C02);
+
+	// Every half that isn't NaN survives the trip through float.
+	for (uint32_t bits = 0; bits <= 0xFFFF; ++bits)
+	{
+		auto half = static_cast<uint16_t>(bits);
+		if ((half & 0x7C00) == 0x7C00 && (half & 0x03FF) != 0)
+		{
+			continue;
+		}
+		ASSERT_EQ(FloatToHalf(HalfToFloat(half)), half) << bits;
+	}
+}
+
+TEST(ImageEncoderTest, EmptyImageFails)
+{
+	std::vector<uint8_t> encoded;
+	std::string error;
+	EXPECT_FALSE(EncodeImage(Image(), EncodeFormat::PNG, encoded, &error));
+	EXPECT_FALSE(error.empty());
+	EXPECT_FALSE(EncodeImage(MakeTestImage(4, 4), EncodeFormat::Unknown, encoded, &error));
+}
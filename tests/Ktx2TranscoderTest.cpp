@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/Ktx2Transcoder.h"
+#include "utils/FileUtils.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace TextureTools;
+
+TEST(Ktx2TranscoderTest, BlockLevelsAreTightlyPacked)
+{
+	std::vector<BlockLevel> levels;
+	size_t total = ComputeBlockLevels(256, 64, 9, 16, levels);
+
+	ASSERT_EQ(levels.size(), 9U);
+	EXPECT_EQ(levels[0].mBlocksX, 64U);
+	EXPECT_EQ(levels[0].mBlocksY, 16U);
+	EXPECT_EQ(levels[0].mRowPitch, 64U * 16U);
+	EXPECT_EQ(levels[0].mSlicePitch, 64U * 16U * 16U);
+	EXPECT_EQ(levels[0].mOffset, 0U);
+
+	// Levels smaller than a block still take a whole block.
+	EXPECT_EQ(levels[7].mWidth, 2U);
+	EXPECT_EQ(levels[7].mHeight, 1U);
+	EXPECT_EQ(levels[7].mBlocksX, 1U);
+	EXPECT_EQ(levels[7].mBlocksY, 1U);
+
+	size_t expectedOffset = 0;
+	for (const BlockLevel& level : levels)
+	{
+		EXPECT_EQ(level.mOffset, expectedOffset);
+		expectedOffset += level.mSlicePitch;
+	}
+	EXPECT_EQ(total, expectedOffset);
+}
+
+TEST(Ktx2TranscoderTest, DetectsExtension)
+{
+	EXPECT_TRUE(IsKtx2File("assets/rock_albedo.ktx2"));
+	EXPECT_TRUE(IsKtx2File("assets/rock_albedo.KTX2"));
+	EXPECT_FALSE(IsKtx2File("assets/rock_albedo.ktx"));
+	EXPECT_FALSE(IsKtx2File("assets/rock_albedo.dds"));
+}
+
+TEST(Ktx2TranscoderTest, RejectsInvalidData)
+{
+	Utils::ThreadPool pool(2);
+	std::vector<uint8_t> garbage(256, 0x5A);
+
+	TranscodedTexture texture;
+	std::string error;
+	EXPECT_FALSE(TranscodeKtx2(garbage.data(), garbage.size(), texture, pool, &error));
+	EXPECT_FALSE(error.empty());
+	EXPECT_EQ(texture.mData, nullptr);
+}
+
+TEST(Ktx2TranscoderTest, RejectsTruncatedHeader)
+{
+	Utils::ThreadPool pool(2);
+
+	// Valid KTX2 identifier followed by nothing.
+	const uint8_t header[] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+							  0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+	TranscodedTexture texture;
+	EXPECT_FALSE(TranscodeKtx2(header, sizeof(header), texture, pool));
+}
+
+TEST(Ktx2TranscoderTest, TranscodesUastcFixture)
+{
+	// 8x8 sRGB UASTC with two levels, every block the same solid color.
+	std::vector<uint8_t> data;
+	ASSERT_TRUE(Utils::ReadBinaryFile(TEST_DATA_DIR "/uastc_solid_8x8.ktx2", data));
+
+	Utils::ThreadPool pool(2);
+	TranscodedTexture pooled;
+	std::string error;
+	ASSERT_TRUE(TranscodeKtx2(data.data(), data.size(), pooled, pool, &error)) << error;
+
+	EXPECT_EQ(pooled.mWidth, 8U);
+	EXPECT_EQ(pooled.mHeight, 8U);
+	EXPECT_TRUE(pooled.mIsUASTC);
+	EXPECT_TRUE(pooled.mIsSRGB);
+	ASSERT_EQ(pooled.mLevels.size(), 2U);
+	EXPECT_EQ(pooled.mDataSize, 5U * 16U);
+
+	// Same color everywhere, so every BC7 block comes out the same.
+	const uint8_t* first = pooled.mData.get();
+	EXPECT_NE(std::count(first, first + 16, 0), 16);
+	for (size_t offset = 16; offset < pooled.mDataSize; offset += 16)
+	{
+		EXPECT_EQ(std::memcmp(first, first + offset, 16), 0) << "block at " << offset;
+	}
+
+	// Inline transcoding gives the same bytes.
+	TranscodedTexture inlined;
+	ASSERT_TRUE(TranscodeKtx2(data.data(), data.size(), inlined, &error)) << error;
+	ASSERT_EQ(inlined.mDataSize, pooled.mDataSize);
+	EXPECT_EQ(std::memcmp(inlined.mData.get(), pooled.mData.get(), pooled.mDataSize), 0);
+}
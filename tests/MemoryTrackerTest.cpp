@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "utils/MemoryTracker.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Utils;
+
+// The counters are process wide, so every test measures against what was
+// there when it started.
+
+TEST(MemoryTrackerTest, TaggedVectorChargesItsTag)
+{
+	MemoryTagStats before = GetMemoryStats(MemoryTag::MESH_CPU);
+	{
+		TaggedVector<uint32_t, MemoryTag::MESH_CPU> indices;
+		indices.reserve(1000);
+
+		MemoryTagStats during = GetMemoryStats(MemoryTag::MESH_CPU);
+		EXPECT_EQ(during.mBytes - before.mBytes, 1000 * sizeof(uint32_t));
+		EXPECT_EQ(during.mLiveAllocations - before.mLiveAllocations, 1U);
+	}
+
+	MemoryTagStats after = GetMemoryStats(MemoryTag::MESH_CPU);
+	EXPECT_EQ(after.mBytes, before.mBytes);
+	EXPECT_EQ(after.mLiveAllocations, before.mLiveAllocations);
+	EXPECT_EQ(after.mTotalAllocations - before.mTotalAllocations, 1U);
+	EXPECT_GE(after.mPeakBytes, before.mBytes + 1000 * sizeof(uint32_t));
+}
+
+TEST(MemoryTrackerTest, OtherTagsAreLeftAlone)
+{
+	MemoryTagStats texture = GetMemoryStats(MemoryTag::TEXTURE_CPU);
+	{
+		TaggedVector<float, MemoryTag::MESH_CPU> positions(256);
+	}
+	EXPECT_EQ(GetMemoryStats(MemoryTag::TEXTURE_CPU).mBytes, texture.mBytes);
+	EXPECT_EQ(GetMemoryStats(MemoryTag::TEXTURE_CPU).mTotalAllocations, texture.mTotalAllocations);
+}
+
+TEST(MemoryTrackerTest, PeakHoldsUntilReset)
+{
+	ResetMemoryPeaks();
+	uint64_t base = GetMemoryStats(MemoryTag::TEXTURE_STAGING).mBytes;
+
+	TrackAllocation(MemoryTag::TEXTURE_STAGING, 4096);
+	TrackAllocation(MemoryTag::TEXTURE_STAGING, 1024);
+	TrackFree(MemoryTag::TEXTURE_STAGING, 4096);
+
+	MemoryTagStats stats = GetMemoryStats(MemoryTag::TEXTURE_STAGING);
+	EXPECT_EQ(stats.mBytes, base + 1024);
+	EXPECT_EQ(stats.mPeakBytes, base + 5120);
+
+	ResetMemoryPeaks();
+	EXPECT_EQ(GetMemoryStats(MemoryTag::TEXTURE_STAGING).mPeakBytes, base + 1024);
+
+	TrackFree(MemoryTag::TEXTURE_STAGING, 1024);
+}
+
+TEST(MemoryTrackerTest, ChargeFollowsItsLifetime)
+{
+	uint64_t base = GetMemoryStats(MemoryTag::DESCRIPTORS).mBytes;
+	{
+		MemoryCharge heap(MemoryTag::DESCRIPTORS);
+		heap.Set(64 * 1024);
+		EXPECT_EQ(GetMemoryStats(MemoryTag::DESCRIPTORS).mBytes, base + 64 * 1024);
+
+		// Resizing swaps the charge instead of adding to it.
+		heap.Set(128 * 1024);
+		EXPECT_EQ(GetMemoryStats(MemoryTag::DESCRIPTORS).mBytes, base + 128 * 1024);
+		EXPECT_EQ(heap.GetBytes(), 128U * 1024);
+	}
+	EXPECT_EQ(GetMemoryStats(MemoryTag::DESCRIPTORS).mBytes, base);
+}
+
+TEST(MemoryTrackerTest, PolledTagsTakeTheValueAsIs)
+{
+	SetTrackedBytes(MemoryTag::D3D12MA_DEFAULT, 1 << 20, 3);
+	SetTrackedBytes(MemoryTag::D3D12MA_DEFAULT, 1 << 16, 1);
+
+	MemoryTagStats stats = GetMemoryStats(MemoryTag::D3D12MA_DEFAULT);
+	EXPECT_EQ(stats.mBytes, 1U << 16);
+	EXPECT_EQ(stats.mLiveAllocations, 1U);
+	EXPECT_GE(stats.mPeakBytes, 1U << 20);
+	EXPECT_GE(stats.mTotalAllocations, 3U);
+	EXPECT_EQ(stats.mDomain, MemoryDomain::GPU);
+}
+
+TEST(MemoryTrackerTest, ThreadsDontLoseCounts)
+{
+	uint64_t base = GetMemoryStats(MemoryTag::FRAME_ARENA).mTotalAllocations;
+	const int threadCount = 8;
+	const int perThread = 10000;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([perThread]() {
+			for (int i = 0; i < perThread; ++i)
+			{
+				TaggedVector<uint8_t, MemoryTag::FRAME_ARENA> bytes(64);
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	MemoryTagStats stats = GetMemoryStats(MemoryTag::FRAME_ARENA);
+	EXPECT_EQ(stats.mTotalAllocations - base, static_cast<uint64_t>(threadCount) * perThread);
+	EXPECT_LE(stats.mPeakBytes, stats.mBytes + threadCount * 64);
+}
+
+TEST(MemoryTrackerTest, JsonHasEveryTagAndTotals)
+{
+	MemoryCharge staging(MemoryTag::TEXTURE_STAGING);
+	staging.Set(777);
+
+	nlohmann::json dump = nlohmann::json::parse(DumpMemoryStatsJson());
+	ASSERT_TRUE(dump.contains("tags"));
+	EXPECT_EQ(dump["tags"].size(), MEMORY_TAG_COUNT);
+
+	const nlohmann::json& tag = dump["tags"]["Texture.Staging"];
+	EXPECT_EQ(tag["domain"], "gpu");
+	EXPECT_GE(tag["bytes"].get<uint64_t>(), 777U);
+	EXPECT_GE(tag["peakBytes"].get<uint64_t>(), tag["bytes"].get<uint64_t>());
+
+	uint64_t cpu = 0;
+	uint64_t gpu = 0;
+	for (const auto& [name, entry] : dump["tags"].items())
+	{
+		(entry["domain"] == "cpu" ? cpu : gpu) += entry["bytes"].get<uint64_t>();
+	}
+	EXPECT_EQ(dump["totals"]["cpuBytes"].get<uint64_t>(), cpu);
+	EXPECT_EQ(dump["totals"]["gpuBytes"].get<uint64_t>(), gpu);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/MipGenerator.h"
+#include "utils/ThreadPool.h"
+#include <cmath>
+
+using namespace TextureTools;
+
+namespace
+{
+	Image MakeSolid(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+	{
+		Image image(width, height);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t* px = image.GetPixel(x, y);
+				px[0] = r;
+				px[1] = g;
+				px[2] = b;
+				px[3] = a;
+			}
+		}
+		return image;
+	}
+
+	Image MakeCheckerboard(uint32_t size, uint8_t a, uint8_t b)
+	{
+		Image image(size, size);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				uint8_t value = ((x + y) & 1) != 0 ? a : b;
+				uint8_t* px = image.GetPixel(x, y);
+				px[0] = value;
+				px[1] = value;
+				px[2] = value;
+				px[3] = 255;
+			}
+		}
+		return image;
+	}
+} // namespace
+
+TEST(MipGeneratorTest, MipCount)
+{
+	EXPECT_EQ(CalculateMipCount(1, 1), 1U);
+	EXPECT_EQ(CalculateMipCount(256, 256), 9U);
+	EXPECT_EQ(CalculateMipCount(256, 16), 9U);
+	EXPECT_EQ(CalculateMipCount(300, 100), 9U);
+}
+
+TEST(MipGeneratorTest, ChainDimensions)
+{
+	Utils::ThreadPool pool(4);
+	MipChain chain = GenerateMips(MakeSolid(300, 100, 10, 20, 30, 40), MipDesc{}, pool);
+
+	ASSERT_EQ(chain.mLevels.size(), 9U);
+	EXPECT_EQ(chain.mLevels[1].mWidth, 150U);
+	EXPECT_EQ(chain.mLevels[1].mHeight, 50U);
+	EXPECT_EQ(chain.mLevels[8].mWidth, 1U);
+	EXPECT_EQ(chain.mLevels[8].mHeight, 1U);
+}
+
+TEST(MipGeneratorTest, SolidColourIsPreserved)
+{
+	Utils::ThreadPool pool(4);
+	for (MipFilter filter : {MipFilter::Box, MipFilter::Kaiser})
+	{
+		MipDesc desc;
+		desc.mFilter = filter;
+		MipChain chain = GenerateMips(MakeSolid(64, 32, 200, 100, 50, 128), desc, pool);
+
+		for (const Image& level : chain.mLevels)
+		{
+			const uint8_t* px = level.GetPixel(level.mWidth - 1, level.mHeight - 1);
+			EXPECT_EQ(px[0], 200);
+			EXPECT_EQ(px[1], 100);
+			EXPECT_EQ(px[2], 50);
+			EXPECT_EQ(px[3], 128);
+		}
+	}
+}
+
+TEST(MipGeneratorTest, GammaCorrectAverage)
+{
+	Utils::ThreadPool pool(2);
+	Image checker = MakeCheckerboard(16, 0, 255);
+
+	// Averaging in linear space and re-encoding gives ~188, not the 128 a
+	// naive average of the sRGB bytes would.
+	MipDesc srgb;
+	MipChain chain = GenerateMips(checker, srgb, pool);
+	EXPECT_NEAR(chain.mLevels[1].GetPixel(0, 0)[0], 188, 1);
+
+	MipDesc linear;
+	linear.mIsSRGB = false;
+	chain = GenerateMips(checker, linear, pool);
+	EXPECT_NEAR(chain.mLevels[1].GetPixel(0, 0)[0], 128, 1);
+}
+
+TEST(MipGeneratorTest, SRGBRoundTrip)
+{
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		EXPECT_EQ(LinearToSRGB(SRGBToLinear(static_cast<uint8_t>(i))), i);
+	}
+}
+
+TEST(MipGeneratorTest, NormalsAreRenormalized)
+{
+	Utils::ThreadPool pool(2);
+
+	// Alternating columns tilted +x and -x, average points straight up.
+	Image normals(8, 8);
+	for (uint32_t y = 0; y < 8; ++y)
+	{
+		for (uint32_t x = 0; x < 8; ++x)
+		{
+			uint8_t* px = normals.GetPixel(x, y);
+			px[0] = (x & 1) != 0 ? 218 : 37;
+			px[1] = 128;
+			px[2] = 218;
+			px[3] = 255;
+		}
+	}
+
+	MipDesc desc;
+	desc.mIsNormalMap = true;
+	MipChain chain = GenerateMips(normals, desc, pool);
+
+	ASSERT_EQ(chain.mNormalLengths.size(), chain.mLevels.size());
+	EXPECT_FALSE(chain.mIsSRGB);
+
+	const uint8_t* px = chain.mLevels[1].GetPixel(0, 0);
+	float nx = px[0] / 127.5F - 1.0F;
+	float ny = px[1] / 127.5F - 1.0F;
+	float nz = px[2] / 127.5F - 1.0F;
+	EXPECT_NEAR(std::sqrt(nx * nx + ny * ny + nz * nz), 1.0F, 0.02F);
+	EXPECT_NEAR(nz, 1.0F, 0.02F);
+
+	EXPECT_NEAR(chain.mNormalLengths[0][0], 1.0F, 1e-3F);
+	EXPECT_LT(chain.mNormalLengths[1][0], 0.8F);
+}
+
+TEST(MipGeneratorTest, ToksvigWidensRoughness)
+{
+	Utils::ThreadPool pool(2);
+
+	Image normals = MakeCheckerboard(8, 64, 192);
+	for (size_t i = 0; i < normals.mPixels.size(); i += 4)
+	{
+		normals.mPixels[i + 1] = 128;
+		normals.mPixels[i + 2] = 230;
+	}
+	Image flat = MakeSolid(8, 8, 128, 128, 255, 255);
+
+	MipDesc normalDesc;
+	normalDesc.mIsNormalMap = true;
+	MipDesc roughDesc;
+	roughDesc.mIsSRGB = false;
+
+	MipChain bumpy = GenerateMips(normals, normalDesc, pool);
+	MipChain smooth = GenerateMips(flat, normalDesc, pool);
+	MipChain roughness = GenerateMips(MakeSolid(8, 8, 64, 64, 64, 255), roughDesc, pool);
+	MipChain roughnessFlat = roughness;
+
+	ASSERT_TRUE(ApplyToksvig(bumpy, roughness));
+	ASSERT_TRUE(ApplyToksvig(smooth, roughnessFlat));
+
+	EXPECT_EQ(roughness.mLevels[0].GetPixel(0, 0)[0], 64);
+	EXPECT_GT(roughness.mLevels[1].GetPixel(0, 0)[0], 64);
+	EXPECT_EQ(roughnessFlat.mLevels[1].GetPixel(0, 0)[0], 64);
+}
+
+TEST(MipGeneratorTest, ToksvigRejectsMismatchedChains)
+{
+	MipDesc normalDesc;
+	normalDesc.mIsNormalMap = true;
+	MipChain normals = GenerateMips(MakeSolid(8, 8, 128, 128, 255, 255), normalDesc);
+	MipChain roughness = GenerateMips(MakeSolid(16, 16, 64, 64, 64, 255), MipDesc{});
+	MipChain colour = GenerateMips(MakeSolid(8, 8, 64, 64, 64, 255), MipDesc{});
+
+	EXPECT_FALSE(ApplyToksvig(normals, roughness));
+	EXPECT_FALSE(ApplyToksvig(colour, roughness));
+}
+
+TEST(MipGeneratorTest, BatchMatchesSingle)
+{
+	Utils::ThreadPool pool(4);
+	Image a = MakeCheckerboard(32, 10, 250);
+	Image b = MakeSolid(17, 5, 1, 2, 3, 4);
+
+	std::vector<MipChain> batch = GenerateMipsBatch({&a, &b}, {MipDesc{}}, pool);
+	ASSERT_EQ(batch.size(), 2U);
+
+	MipChain single = GenerateMips(a, MipDesc{}, pool);
+	ASSERT_EQ(batch[0].mLevels.size(), single.mLevels.size());
+	for (size_t i = 0; i < single.mLevels.size(); ++i)
+	{
+		EXPECT_EQ(batch[0].mLevels[i].mPixels, single.mLevels[i].mPixels);
+	}
+	EXPECT_EQ(batch[1].mLevels.size(), CalculateMipCount(17, 5));
+}
+
+TEST(MipGeneratorTest, BatchWithoutDescsUsesDefaults)
+{
+	Utils::ThreadPool pool(2);
+	Image a = MakeSolid(8, 8, 10, 20, 30, 40);
+
+	std::vector<MipChain> batch = GenerateMipsBatch({&a}, {}, pool);
+	ASSERT_EQ(batch.size(), 1U);
+
+	MipChain single = GenerateMips(a, MipDesc{}, pool);
+	ASSERT_EQ(batch[0].mLevels.size(), single.mLevels.size());
+	EXPECT_EQ(batch[0].mLevels.back().mPixels, single.mLevels.back().mPixels);
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include "graphics/QueueScheduler.h"
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace Graphics;
+
+namespace
+{
+	/// A GPU with one in-order timeline per queue. Submitted work and waits
+	/// pile up per queue and only run when Step gets to them, a wait holds
+	/// its queue until the producer's fence gets there.
+	struct MockGpu
+	{
+		struct Op
+		{
+			bool mIsWait = false;
+			QueueType mProducer = QueueType::Graphics;
+			uint64_t mValue = 0;
+			std::string mLabel;
+		};
+
+		static constexpr size_t QUEUES = static_cast<size_t>(QueueType::Count);
+
+		std::array<std::deque<Op>, QUEUES> mOps;
+		std::array<uint64_t, QUEUES> mSignaled = {};
+		std::array<uint64_t, QUEUES> mCompleted = {};
+		/// When each label finished, in GPU order.
+		std::map<std::string, uint32_t> mFinishedAt;
+		uint32_t mClock = 0;
+
+		QueueSchedulerBackend GetBackend()
+		{
+			QueueSchedulerBackend backend;
+			backend.mGetCompletedFence = [this](QueueType queue) {
+				return mCompleted[static_cast<size_t>(queue)];
+			};
+			backend.mWait = [this](QueueType consumer, QueueFence producer) {
+				mOps[static_cast<size_t>(consumer)].push_back(
+					{true, producer.mQueue, producer.mValue, {}});
+			};
+			return backend;
+		}
+
+		/// What a context's Execute would be.
+		QueueScheduler::Execute Work(QueueType queue, std::string label)
+		{
+			return [this, queue, label]() {
+				size_t index = static_cast<size_t>(queue);
+				uint64_t value = ++mSignaled[index];
+				mOps[index].push_back({false, queue, value, label});
+				return value;
+			};
+		}
+
+		/// Runs the front op (a wait or a piece of work) of one queue if it
+		/// can, false if it's empty or stuck on a wait.
+		bool Step(size_t queue)
+		{
+			if (mOps[queue].empty())
+			{
+				return false;
+			}
+
+			Op& op = mOps[queue].front();
+			if (op.mIsWait)
+			{
+				if (mCompleted[static_cast<size_t>(op.mProducer)] < op.mValue)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				mCompleted[queue] = op.mValue;
+				mFinishedAt[op.mLabel] = ++mClock;
+			}
+			mOps[queue].pop_front();
+			return true;
+		}
+
+		/// Runs everything in a random queue order. False on a deadlock.
+		bool Drain(std::mt19937& rng)
+		{
+			std::uniform_int_distribution<size_t> pick(0, QUEUES - 1);
+			while (true)
+			{
+				bool pending = false;
+				bool progressed = false;
+				for (size_t attempt = 0; attempt < QUEUES * 4 && !progressed; ++attempt)
+				{
+					progressed = Step(pick(rng));
+				}
+				for (size_t queue = 0; queue < QUEUES && !progressed; ++queue)
+				{
+					progressed = Step(queue);
+				}
+				for (const auto& ops : mOps)
+				{
+					pending |= !ops.empty();
+				}
+				if (!pending)
+				{
+					return true;
+				}
+				if (!progressed)
+				{
+					return false;
+				}
+			}
+		}
+	};
+
+	std::string Label(const char* pass, int frame)
+	{
+		return std::string(pass) + std::to_string(frame);
+	}
+} // namespace
+
+TEST(QueueSchedulerTest, BlurWaitsForTheSceneAndTheUiForTheBlur)
+{
+	MockGpu gpu;
+	QueueScheduler scheduler(gpu.GetBackend());
+	std::mt19937 rng(7);
+
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		QueueFence scene = scheduler.Submit(QueueType::Graphics,
+											gpu.Work(QueueType::Graphics, Label("scene", frame)));
+		QueueFence blur = scheduler.Submit(
+			QueueType::Compute, gpu.Work(QueueType::Compute, Label("blur", frame)), {scene});
+		scheduler.Wait(QueueType::Graphics, blur);
+		scheduler.Submit(QueueType::Graphics, gpu.Work(QueueType::Graphics, Label("ui", frame)));
+
+		// The GPU gets some frames in random order, some it doesn't.
+		if (frame % 3 == 2)
+		{
+			ASSERT_TRUE(gpu.Drain(rng));
+		}
+	}
+	ASSERT_TRUE(gpu.Drain(rng));
+
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		uint32_t scene = gpu.mFinishedAt[Label("scene", frame)];
+		uint32_t blur = gpu.mFinishedAt[Label("blur", frame)];
+		uint32_t ui = gpu.mFinishedAt[Label("ui", frame)];
+		EXPECT_LT(scene, blur) << "frame " << frame;
+		EXPECT_LT(blur, ui) << "frame " << frame;
+	}
+	EXPECT_EQ(scheduler.GetStats().mSubmits, 60U);
+}
+
+TEST(QueueSchedulerTest, ComputeRunsAlongsideGraphicsWorkItDoesNotFeed)
+{
+	MockGpu gpu;
+	QueueScheduler scheduler(gpu.GetBackend());
+
+	QueueFence scene =
+		scheduler.Submit(QueueType::Graphics, gpu.Work(QueueType::Graphics, "scene"));
+	scheduler.Submit(QueueType::Compute, gpu.Work(QueueType::Compute, "blur"), {scene});
+	// Nothing on the graphics queue waits for the blur.
+	scheduler.Submit(QueueType::Graphics, gpu.Work(QueueType::Graphics, "shadows"));
+
+	const size_t GRAPHICS = static_cast<size_t>(QueueType::Graphics);
+	const size_t COMPUTE = static_cast<size_t>(QueueType::Compute);
+
+	// Compute is stuck until the scene is done.
+	EXPECT_FALSE(gpu.Step(COMPUTE));
+	EXPECT_TRUE(gpu.Step(GRAPHICS));
+	// Both are free now, the graphics queue doesn't have to wait for the
+	// blur to get on with the next pass.
+	EXPECT_TRUE(gpu.Step(GRAPHICS));
+	// The wait, then the blur itself.
+	EXPECT_TRUE(gpu.Step(COMPUTE));
+	EXPECT_TRUE(gpu.Step(COMPUTE));
+	EXPECT_LT(gpu.mFinishedAt["shadows"], gpu.mFinishedAt["blur"]);
+}
+
+TEST(QueueSchedulerTest, SkipsWaitsThatAreAlreadyCovered)
+{
+	MockGpu gpu;
+	QueueScheduler scheduler(gpu.GetBackend());
+
+	QueueFence first =
+		scheduler.Submit(QueueType::Graphics, gpu.Work(QueueType::Graphics, "first"));
+	QueueFence second =
+		scheduler.Submit(QueueType::Graphics, gpu.Work(QueueType::Graphics, "second"));
+
+	scheduler.Wait(QueueType::Compute, second);
+	EXPECT_EQ(scheduler.GetStats().mWaits, 1U);
+
+	// Covered by the wait on second.
+	scheduler.Wait(QueueType::Compute, first);
+	scheduler.Wait(QueueType::Compute, second);
+	// Same queue, in order anyway.
+	scheduler.Wait(QueueType::Graphics, first);
+	// Nothing to wait on.
+	scheduler.Wait(QueueType::Copy, QueueFence{});
+	EXPECT_EQ(scheduler.GetStats().mWaits, 1U);
+	EXPECT_EQ(scheduler.GetStats().mSkippedWaits, 3U);
+
+	// Finished before anyone asked.
+	std::mt19937 rng(1);
+	ASSERT_TRUE(gpu.Drain(rng));
+	EXPECT_TRUE(scheduler.IsComplete(second));
+	scheduler.Wait(QueueType::Copy, second);
+	EXPECT_EQ(scheduler.GetStats().mWaits, 1U);
+	EXPECT_EQ(scheduler.GetStats().mSkippedWaits, 4U);
+}
+
+TEST(QueueSchedulerTest, TracksTheLastFencePerQueue)
+{
+	MockGpu gpu;
+	QueueScheduler scheduler(gpu.GetBackend());
+
+	scheduler.Submit(QueueType::Compute, gpu.Work(QueueType::Compute, "a"));
+	QueueFence b = scheduler.Submit(QueueType::Compute, gpu.Work(QueueType::Compute, "b"));
+
+	QueueFence last = scheduler.GetLastSubmitted(QueueType::Compute);
+	EXPECT_EQ(last.mQueue, QueueType::Compute);
+	EXPECT_EQ(last.mValue, b.mValue);
+	EXPECT_FALSE(scheduler.GetLastSubmitted(QueueType::Copy).IsValid());
+	EXPECT_FALSE(scheduler.IsComplete(b));
+}
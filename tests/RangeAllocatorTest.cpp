@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+#include "graphics/RangeAllocator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Which slots are taken, to check the allocator against.
+	struct Occupancy
+	{
+		explicit Occupancy(uint32_t capacity)
+		: mTaken(capacity, false)
+		{
+		}
+
+		std::vector<bool> mTaken;
+
+		bool Take(const RangeAllocation& allocation)
+		{
+			for (uint32_t i = allocation.mOffset; i < allocation.mOffset + allocation.mSize; ++i)
+			{
+				if (mTaken[i])
+				{
+					return false;
+				}
+				mTaken[i] = true;
+			}
+			return true;
+		}
+
+		void Release(const RangeAllocation& allocation)
+		{
+			std::fill_n(mTaken.begin() + allocation.mOffset, allocation.mSize, false);
+		}
+
+		uint32_t GetLongestRun() const
+		{
+			uint32_t longest = 0;
+			uint32_t run = 0;
+			for (bool taken : mTaken)
+			{
+				run = taken ? 0 : run + 1;
+				longest = std::max(longest, run);
+			}
+			return longest;
+		}
+	};
+} // namespace
+
+TEST(RangeAllocatorTest, AllocatesFromTheFront)
+{
+	RangeAllocator allocator(1000);
+
+	RangeAllocation nulls = allocator.Allocate(5);
+	RangeAllocation next = allocator.Allocate(10);
+	EXPECT_EQ(nulls.mOffset, 0U);
+	EXPECT_EQ(next.mOffset, 5U);
+	EXPECT_EQ(allocator.GetFreeSize(), 985U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 985U);
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 1U);
+}
+
+TEST(RangeAllocatorTest, SplitsFreedRangesForSmallerRequests)
+{
+	RangeAllocator allocator(1000);
+	RangeAllocation big = allocator.Allocate(100);
+	RangeAllocation fence = allocator.Allocate(1);
+	ASSERT_TRUE(allocator.Free(big));
+
+	// The old exact size free list would have gone past the end for these.
+	RangeAllocation a = allocator.Allocate(40);
+	RangeAllocation b = allocator.Allocate(60);
+	EXPECT_EQ(a.mOffset, 0U);
+	EXPECT_EQ(b.mOffset, 40U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 1000U - 101U);
+	EXPECT_GE(allocator.GetStats().mSplits, 3U);
+	EXPECT_TRUE(fence.IsValid());
+}
+
+TEST(RangeAllocatorTest, SplitPiecesAreFreedApart)
+{
+	RangeAllocator allocator(100);
+	RangeAllocation run = allocator.Allocate(10);
+	RangeAllocation rest = allocator.Split(run, 4);
+	EXPECT_EQ(run.mSize, 4U);
+	EXPECT_EQ(rest.mOffset, 4U);
+	EXPECT_EQ(rest.mSize, 6U);
+	EXPECT_EQ(allocator.GetStats().mAllocations, 2U);
+	EXPECT_FALSE(allocator.Split(run, 4).IsValid());
+
+	// The tail merges with the free space after it, the front then joins
+	// it all into one range again.
+	ASSERT_TRUE(allocator.Free(rest));
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 96U);
+	ASSERT_TRUE(allocator.Free(run));
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 1U);
+	EXPECT_EQ(allocator.GetFreeSize(), 100U);
+}
+
+TEST(RangeAllocatorTest, CoalescesNeighbours)
+{
+	RangeAllocator allocator(100);
+	RangeAllocation a = allocator.Allocate(10);
+	RangeAllocation b = allocator.Allocate(20);
+	RangeAllocation c = allocator.Allocate(30);
+
+	ASSERT_TRUE(allocator.Free(b));
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 2U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 40U);
+
+	// a merges forward into b, c then joins both sides into one range.
+	ASSERT_TRUE(allocator.Free(a));
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 2U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 40U);
+	ASSERT_TRUE(allocator.Free(c));
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 1U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), 100U);
+	EXPECT_FLOAT_EQ(allocator.GetFragmentation(), 0.0F);
+
+	EXPECT_EQ(allocator.Allocate(100).mOffset, 0U);
+}
+
+TEST(RangeAllocatorTest, RejectsDoubleAndForeignFrees)
+{
+	RangeAllocator allocator(64);
+	RangeAllocation a = allocator.Allocate(8);
+	RangeAllocation b = allocator.Allocate(8);
+
+	EXPECT_TRUE(allocator.Free(a));
+	EXPECT_FALSE(allocator.Free(a));
+	EXPECT_FALSE(allocator.Free(RangeAllocation()));
+
+	RangeAllocation wrongSize = b;
+	wrongSize.mSize = 4;
+	EXPECT_FALSE(allocator.Free(wrongSize));
+	EXPECT_TRUE(allocator.Free(b));
+	EXPECT_EQ(allocator.GetFreeSize(), 64U);
+	EXPECT_EQ(allocator.GetStats().mAllocations, 0U);
+}
+
+TEST(RangeAllocatorTest, ExactFitWhenNearlyFull)
+{
+	// 37 rounds up to the next bin, the only free range is exactly 37
+	// and sits in the bin below.
+	RangeAllocator allocator(100);
+	RangeAllocation a = allocator.Allocate(37);
+	RangeAllocation b = allocator.Allocate(63);
+	ASSERT_TRUE(allocator.Free(a));
+
+	RangeAllocation again = allocator.Allocate(37);
+	EXPECT_TRUE(again.IsValid());
+	EXPECT_EQ(again.mOffset, 0U);
+	EXPECT_EQ(allocator.GetFreeSize(), 0U);
+	EXPECT_TRUE(b.IsValid());
+}
+
+TEST(RangeAllocatorTest, FailsWithoutARangeBigEnough)
+{
+	RangeAllocator allocator(16);
+	EXPECT_FALSE(allocator.Allocate(17).IsValid());
+	EXPECT_FALSE(allocator.Allocate(0).IsValid());
+
+	std::vector<RangeAllocation> ones;
+	for (int i = 0; i < 16; ++i)
+	{
+		ones.push_back(allocator.Allocate(1));
+	}
+	// Every other one back, 8 free but never 2 in a row.
+	for (size_t i = 0; i < ones.size(); i += 2)
+	{
+		allocator.Free(ones[i]);
+	}
+	EXPECT_EQ(allocator.GetFreeSize(), 8U);
+	EXPECT_FALSE(allocator.Allocate(2).IsValid());
+	EXPECT_EQ(allocator.GetStats().mFailedAllocations, 3U);
+	EXPECT_FLOAT_EQ(allocator.GetFragmentation(), 1.0F - (1.0F / 8.0F));
+}
+
+TEST(RangeAllocatorTest, ChurnStress)
+{
+	// Texture loads and unloads at around 80% of the heap, mostly single
+	// descriptors with some tables. Checked against a slot map: nothing
+	// overlaps, and an allocation only fails if no run that long is free.
+	const uint32_t capacity = 1 << 16;
+	RangeAllocator allocator(capacity);
+	Occupancy occupancy(capacity);
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<uint32_t> table(2, 64);
+	std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+	std::vector<RangeAllocation> live;
+	uint32_t failures = 0;
+	for (int step = 0; step < 200000; ++step)
+	{
+		bool allocate = allocator.GetFreeSize() > capacity / 5 ? percent(rng) < 60
+															   : percent(rng) < 40;
+		if (allocate || live.empty())
+		{
+			uint32_t size = percent(rng) < 70 ? 1 : table(rng);
+			RangeAllocation allocation = allocator.Allocate(size);
+			if (!allocation.IsValid())
+			{
+				ASSERT_LT(occupancy.GetLongestRun(), size) << step;
+				failures++;
+				continue;
+			}
+			ASSERT_EQ(allocation.mSize, size);
+			ASSERT_LE(allocation.mOffset + size, capacity);
+			ASSERT_TRUE(occupancy.Take(allocation)) << step;
+			live.push_back(allocation);
+		}
+		else
+		{
+			size_t index = rng() % live.size();
+			ASSERT_TRUE(allocator.Free(live[index]));
+			occupancy.Release(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	uint32_t used = 0;
+	for (const RangeAllocation& allocation : live)
+	{
+		used += allocation.mSize;
+	}
+	EXPECT_EQ(allocator.GetStats().mUsed, used);
+	EXPECT_EQ(allocator.GetStats().mFailedAllocations, failures);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), occupancy.GetLongestRun());
+
+	// With everything back it's one range again.
+	for (const RangeAllocation& allocation : live)
+	{
+		ASSERT_TRUE(allocator.Free(allocation));
+	}
+	EXPECT_EQ(allocator.GetStats().mFreeRanges, 1U);
+	EXPECT_EQ(allocator.GetLargestFreeRange(), capacity);
+}
@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include "graphics/RenderTargetPool.h"
+#include <memory>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Stands in for a ColorBuffer.
+	struct FakeTarget
+	{
+		RenderTargetKey mKey;
+		uint32_t mId = 0;
+	};
+
+	using FakePool = RenderTargetPool<std::shared_ptr<FakeTarget>>;
+
+	FakePool::Factory MakeFactory(uint32_t& created)
+	{
+		return [&created](const RenderTargetKey& key) {
+			auto target = std::make_shared<FakeTarget>();
+			target->mKey = key;
+			target->mId = created++;
+			return target;
+		};
+	}
+
+	constexpr uint32_t RGBA16F = 10;
+} // namespace
+
+TEST(RenderTargetPoolTest, BucketsRoundUpToTheGranularity)
+{
+	EXPECT_EQ(BucketDimension(1, 128), 128U);
+	EXPECT_EQ(BucketDimension(128, 128), 128U);
+	EXPECT_EQ(BucketDimension(129, 128), 256U);
+	EXPECT_EQ(BucketDimension(0, 128), 128U);
+	EXPECT_EQ(BucketDimension(1283, 1), 1283U);
+
+	RenderTargetPoolDesc desc;
+	RenderTargetKey key = MakeRenderTargetKey(RGBA16F, 1283, 721, RENDER_TARGET_UAV, desc);
+	EXPECT_EQ(key.mWidth, 1408U);
+	EXPECT_EQ(key.mHeight, 768U);
+	EXPECT_EQ(key, MakeRenderTargetKey(RGBA16F, 1300, 700, RENDER_TARGET_UAV, desc));
+	EXPECT_NE(key, MakeRenderTargetKey(RGBA16F, 1300, 700, RENDER_TARGET_NONE, desc));
+}
+
+TEST(RenderTargetPoolTest, FitsWithinOneBucketOfSlack)
+{
+	RenderTargetPoolDesc desc;
+	desc.mGranularity = 128;
+	desc.mSlackBuckets = 1;
+
+	EXPECT_TRUE(FitsAllocation(1280, 768, 1280, 768, desc));
+	EXPECT_TRUE(FitsAllocation(1280, 768, 1100, 700, desc));
+	// One bucket over what 1000 rounds to (1024) is fine, two isn't.
+	EXPECT_TRUE(FitsAllocation(1152, 768, 1000, 700, desc));
+	EXPECT_FALSE(FitsAllocation(1280, 768, 1000, 700, desc));
+	// Too small.
+	EXPECT_FALSE(FitsAllocation(1280, 768, 1281, 700, desc));
+	EXPECT_FALSE(FitsAllocation(1280, 768, 1000, 769, desc));
+
+	desc.mSlackBuckets = 0;
+	EXPECT_FALSE(FitsAllocation(1152, 768, 1000, 700, desc));
+}
+
+TEST(RenderTargetPoolTest, CoalescerAllocatesOnceForADrag)
+{
+	RenderTargetPoolDesc desc;
+	desc.mStableFrames = 4;
+	ResizeCoalescer coalescer(desc);
+
+	ResizeDecision first = coalescer.Update(1280, 720);
+	EXPECT_EQ(first.mAction, ResizeDecision::Action::Reallocate);
+	EXPECT_EQ(first.mTargetWidth, 1280U);
+	EXPECT_EQ(first.mTargetHeight, 768U);
+	EXPECT_EQ(coalescer.Update(1280, 720).mAction, ResizeDecision::Action::None);
+
+	// Dragging bigger a few pixels a frame, then letting go.
+	for (uint32_t width = 1290; width < 1600; width += 10)
+	{
+		ResizeDecision decision = coalescer.Update(width, 720);
+		EXPECT_NE(decision.mAction, ResizeDecision::Action::Reallocate) << width;
+		// Until the targets are big enough the old size is kept.
+		EXPECT_LE(decision.mWidth, decision.mTargetWidth);
+	}
+	for (uint32_t frame = 1; frame < desc.mStableFrames; ++frame)
+	{
+		EXPECT_EQ(coalescer.Update(1600, 720).mAction, ResizeDecision::Action::None);
+	}
+	ResizeDecision settled = coalescer.Update(1600, 720);
+	EXPECT_EQ(settled.mAction, ResizeDecision::Action::Reallocate);
+	EXPECT_EQ(settled.mWidth, 1600U);
+	EXPECT_EQ(settled.mTargetWidth, 1664U);
+	EXPECT_EQ(coalescer.GetReallocations(), 2U);
+}
+
+TEST(RenderTargetPoolTest, CoalescerShrinksInPlaceStraightAway)
+{
+	RenderTargetPoolDesc desc;
+	desc.mStableFrames = 4;
+	ResizeCoalescer coalescer(desc);
+	coalescer.Update(1280, 720);
+
+	// Within the slack, only the render size changes, and for good.
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		ResizeDecision decision = coalescer.Update(1200, 700 - frame);
+		EXPECT_EQ(decision.mWidth, 1200U);
+		EXPECT_EQ(decision.mHeight, static_cast<uint32_t>(700 - frame));
+		EXPECT_EQ(decision.mTargetWidth, 1280U);
+		EXPECT_NE(decision.mAction, ResizeDecision::Action::Reallocate);
+	}
+
+	// Far smaller, rendered at once but reallocated once it has settled.
+	ResizeDecision shrunk = coalescer.Update(400, 300);
+	EXPECT_EQ(shrunk.mAction, ResizeDecision::Action::Resize);
+	EXPECT_EQ(shrunk.mWidth, 400U);
+	EXPECT_EQ(shrunk.mTargetWidth, 1280U);
+	for (uint32_t frame = 2; frame < desc.mStableFrames; ++frame)
+	{
+		EXPECT_EQ(coalescer.Update(400, 300).mAction, ResizeDecision::Action::None);
+	}
+	ResizeDecision settled = coalescer.Update(400, 300);
+	EXPECT_EQ(settled.mAction, ResizeDecision::Action::Reallocate);
+	EXPECT_EQ(settled.mTargetWidth, 512U);
+	EXPECT_EQ(settled.mTargetHeight, 384U);
+}
+
+TEST(RenderTargetPoolTest, ReusesOnlyAfterTheFence)
+{
+	uint32_t created = 0;
+	FakePool pool(MakeFactory(created));
+	RenderTargetKey key = MakeRenderTargetKey(RGBA16F, 1280, 720, RENDER_TARGET_NONE, {});
+
+	auto first = pool.Acquire(key);
+	pool.Release(key, first);
+	pool.EndFrame(5);
+
+	// Released but frame 5 is still on the GPU.
+	pool.Retire(4);
+	auto second = pool.Acquire(key);
+	EXPECT_NE(second->mId, first->mId);
+
+	pool.Retire(5);
+	auto third = pool.Acquire(key);
+	EXPECT_EQ(third->mId, first->mId);
+	EXPECT_EQ(pool.GetStats().mCreated, 2U);
+	EXPECT_EQ(pool.GetStats().mReused, 1U);
+}
+
+TEST(RenderTargetPoolTest, OnlyHandsOutMatchingKeys)
+{
+	uint32_t created = 0;
+	FakePool pool(MakeFactory(created));
+	RenderTargetPoolDesc desc;
+	RenderTargetKey small = MakeRenderTargetKey(RGBA16F, 640, 480, RENDER_TARGET_NONE, desc);
+	RenderTargetKey large = MakeRenderTargetKey(RGBA16F, 1920, 1080, RENDER_TARGET_NONE, desc);
+	RenderTargetKey depth = MakeRenderTargetKey(RGBA16F, 640, 480, RENDER_TARGET_DEPTH, desc);
+
+	pool.Release(small, pool.Acquire(small));
+	pool.EndFrame(1);
+	pool.Retire(1);
+
+	EXPECT_EQ(pool.Acquire(large)->mKey, large);
+	EXPECT_EQ(pool.Acquire(depth)->mKey, depth);
+	EXPECT_EQ(pool.Acquire(small)->mKey, small);
+	EXPECT_EQ(pool.GetStats().mCreated, 3U);
+	EXPECT_EQ(pool.GetStats().mReused, 1U);
+}
+
+TEST(RenderTargetPoolTest, ResizingBackAndForthStopsAllocating)
+{
+	uint32_t created = 0;
+	RenderTargetPoolDesc desc;
+	desc.mStableFrames = 2;
+	FakePool pool(MakeFactory(created), desc);
+	ResizeCoalescer coalescer(desc);
+
+	// Two frames in flight. The viewport flips between two sizes that
+	// don't share a bucket, settling each time.
+	uint64_t signaled = 0;
+	std::shared_ptr<FakeTarget> target;
+	RenderTargetKey key;
+	for (int frame = 0; frame < 200; ++frame)
+	{
+		pool.Retire(signaled >= 2 ? signaled - 2 : 0);
+
+		bool wide = (frame / 10) % 2 == 0;
+		ResizeDecision decision = coalescer.Update(wide ? 1920 : 800, 600);
+		if (decision.mAction == ResizeDecision::Action::Reallocate)
+		{
+			if (target)
+			{
+				pool.Release(key, std::move(target));
+			}
+			key = MakeRenderTargetKey(RGBA16F, decision.mTargetWidth, decision.mTargetHeight,
+									  RENDER_TARGET_NONE, desc);
+			target = pool.Acquire(key);
+		}
+		ASSERT_EQ(target->mKey, key);
+		pool.EndFrame(++signaled);
+	}
+
+	EXPECT_EQ(pool.GetStats().mCreated, 2U);
+	EXPECT_GT(pool.GetStats().mReused, 15U);
+}
+
+TEST(RenderTargetPoolTest, DropsTargetsIdleForTooLong)
+{
+	uint32_t created = 0;
+	RenderTargetPoolDesc desc;
+	desc.mMaxIdleFrames = 10;
+	FakePool pool(MakeFactory(created), desc);
+	RenderTargetKey key = MakeRenderTargetKey(RGBA16F, 256, 256, RENDER_TARGET_NONE, desc);
+
+	std::weak_ptr<FakeTarget> watch;
+	{
+		auto target = pool.Acquire(key);
+		watch = target;
+		pool.Release(key, std::move(target));
+	}
+
+	for (uint64_t frame = 1; frame <= 10; ++frame)
+	{
+		pool.EndFrame(frame);
+		pool.Retire(frame);
+	}
+	EXPECT_FALSE(watch.expired());
+	EXPECT_EQ(pool.GetStats().mFree, 1U);
+
+	pool.EndFrame(11);
+	pool.Retire(11);
+	EXPECT_TRUE(watch.expired());
+	EXPECT_EQ(pool.GetStats().mDestroyed, 1U);
+	EXPECT_EQ(pool.GetStats().mFree, 0U);
+}
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include "graphics/ResidencyManager.h"
+#include <random>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	constexpr uint64_t MB = 1024 * 1024;
+
+	/// Stand-ins for textures, only their addresses matter.
+	struct FakeResources
+	{
+		explicit FakeResources(size_t count)
+		: mStorage(count)
+		{
+		}
+
+		void* Get(size_t index) { return &mStorage[index]; }
+
+		std::vector<uint64_t> mStorage;
+	};
+
+	ResidencyDesc FixedBudget(uint64_t budget, uint32_t minIdleFrames = 1)
+	{
+		ResidencyDesc desc;
+		desc.mBudgetOverride = budget;
+		desc.mMinIdleFrames = minIdleFrames;
+		return desc;
+	}
+
+	/// One frame using the given resources, the GPU finishes it at once.
+	void RunFrame(ResidencyManager& manager, FakeResources& resources,
+				  const std::vector<size_t>& used, uint64_t& fence)
+	{
+		for (size_t index : used)
+		{
+			manager.MarkUsed(resources.Get(index));
+		}
+		manager.Commit();
+		manager.EndFrame(++fence);
+		manager.Retire(fence);
+	}
+} // namespace
+
+TEST(ResidencyManagerTest, EvictsLeastRecentlyUsedDownToTheBudget)
+{
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(40 * MB));
+	FakeResources resources(8);
+	uint64_t fence = 0;
+
+	for (size_t i = 0; i < 8; ++i)
+	{
+		manager.Track(resources.Get(i), 10 * MB);
+	}
+	manager.EndFrame(++fence);
+	manager.Retire(fence);
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 80 * MB);
+
+	// 0-3 keep getting used, the rest go idle.
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		RunFrame(manager, resources, {0, 1, 2, 3}, fence);
+	}
+
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 40 * MB);
+	for (size_t i = 0; i < 4; ++i)
+	{
+		EXPECT_TRUE(manager.IsResident(resources.Get(i))) << i;
+		EXPECT_FALSE(gpu.IsEvicted(resources.Get(i))) << i;
+	}
+	for (size_t i = 4; i < 8; ++i)
+	{
+		EXPECT_FALSE(manager.IsResident(resources.Get(i))) << i;
+		EXPECT_TRUE(gpu.IsEvicted(resources.Get(i))) << i;
+	}
+	EXPECT_EQ(manager.GetStats().mEvictions, 4U);
+}
+
+TEST(ResidencyManagerTest, PagesBackInWhatTheFrameUses)
+{
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(20 * MB));
+	FakeResources resources(4);
+	uint64_t fence = 0;
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		manager.Track(resources.Get(i), 10 * MB);
+	}
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		RunFrame(manager, resources, {0, 1}, fence);
+	}
+	ASSERT_TRUE(gpu.IsEvicted(resources.Get(3)));
+
+	// The camera turns around.
+	uint64_t overBudget = manager.GetStats().mOverBudgetFrames;
+	manager.MarkUsed(resources.Get(2));
+	manager.MarkUsed(resources.Get(3));
+	EXPECT_TRUE(manager.Commit());
+	EXPECT_FALSE(gpu.IsEvicted(resources.Get(2)));
+	EXPECT_FALSE(gpu.IsEvicted(resources.Get(3)));
+	EXPECT_EQ(manager.GetStats().mPageIns, 2U);
+	// 0 and 1 were used last frame, they stay too for now.
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 40 * MB);
+	EXPECT_EQ(manager.GetStats().mOverBudgetFrames, overBudget + 1);
+	manager.EndFrame(++fence);
+	manager.Retire(fence);
+
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		RunFrame(manager, resources, {2, 3}, fence);
+	}
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 20 * MB);
+}
+
+TEST(ResidencyManagerTest, NeverEvictsWhatTheGpuStillUses)
+{
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(30 * MB, 0));
+	FakeResources resources(64);
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<size_t> pick(0, 63);
+
+	// Last fence each resource was used with.
+	std::vector<uint64_t> usedUntil(64, 0);
+	for (size_t i = 0; i < 64; ++i)
+	{
+		manager.Track(resources.Get(i), MB * (1 + i % 5));
+	}
+
+	uint64_t signaled = 0;
+	uint64_t completed = 0;
+	for (int frame = 0; frame < 500; ++frame)
+	{
+		// Three frames in flight.
+		completed = signaled >= 3 ? signaled - 3 : 0;
+		manager.Retire(completed);
+
+		std::vector<size_t> used;
+		for (int i = 0; i < 6; ++i)
+		{
+			used.push_back(pick(rng));
+			manager.MarkUsed(resources.Get(used.back()));
+		}
+		ASSERT_TRUE(manager.Commit());
+
+		for (size_t i = 0; i < 64; ++i)
+		{
+			if (gpu.IsEvicted(resources.Get(i)))
+			{
+				ASSERT_LE(usedUntil[i], completed) << "frame " << frame << " resource " << i;
+			}
+		}
+		for (size_t index : used)
+		{
+			ASSERT_FALSE(gpu.IsEvicted(resources.Get(index))) << "frame " << frame;
+		}
+
+		manager.EndFrame(++signaled);
+		for (size_t index : used)
+		{
+			usedUntil[index] = signaled;
+		}
+	}
+	EXPECT_GT(manager.GetStats().mEvictions, 0U);
+	EXPECT_GT(manager.GetStats().mPageIns, 0U);
+}
+
+TEST(ResidencyManagerTest, FollowsTheBackendBudget)
+{
+	SimulatedResidency gpu(100 * MB);
+	ResidencyDesc desc;
+	desc.mBudgetFraction = 0.5F;
+	desc.mMinIdleFrames = 1;
+	ResidencyManager manager(gpu.GetBackend(), desc);
+	FakeResources resources(6);
+	uint64_t fence = 0;
+
+	for (size_t i = 0; i < 6; ++i)
+	{
+		manager.Track(resources.Get(i), 10 * MB);
+	}
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		RunFrame(manager, resources, {0}, fence);
+	}
+	EXPECT_EQ(manager.GetBudget(), 50 * MB);
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 50 * MB);
+
+	// Another application wants memory.
+	gpu.SetBudget(40 * MB);
+	RunFrame(manager, resources, {0}, fence);
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 20 * MB);
+}
+
+TEST(ResidencyManagerTest, FailedPageInIsReported)
+{
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(10 * MB));
+	FakeResources resources(2);
+	uint64_t fence = 0;
+
+	manager.Track(resources.Get(0), 10 * MB);
+	manager.Track(resources.Get(1), 10 * MB);
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		RunFrame(manager, resources, {0}, fence);
+	}
+	ASSERT_FALSE(manager.IsResident(resources.Get(1)));
+
+	gpu.mFailMakeResident = true;
+	manager.MarkUsed(resources.Get(1));
+	EXPECT_FALSE(manager.Commit());
+	EXPECT_FALSE(manager.IsResident(resources.Get(1)));
+	EXPECT_EQ(manager.GetStats().mFailedPageIns, 1U);
+}
+
+TEST(ResidencyManagerTest, FailedPageInLeavesOnlyTheEvictedOut)
+{
+	// What the Renderer does when Commit fails: textures that are still
+	// evicted get the null SRV, everything else draws as usual.
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(20 * MB));
+	FakeResources resources(4);
+	uint64_t fence = 0;
+
+	manager.Track(resources.Get(0), 10 * MB);
+	manager.Track(resources.Get(1), 10 * MB);
+	manager.Track(resources.Get(2), 10 * MB);
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		RunFrame(manager, resources, {0, 1}, fence);
+	}
+	ASSERT_TRUE(gpu.IsEvicted(resources.Get(2)));
+
+	gpu.mFailMakeResident = true;
+	const std::vector<size_t> frame = {0, 1, 2, 3};
+	for (size_t index : frame)
+	{
+		manager.MarkUsed(resources.Get(index));
+	}
+	ASSERT_FALSE(manager.Commit());
+
+	std::vector<size_t> drawn;
+	for (size_t index : frame)
+	{
+		if (manager.IsSafeToUse(resources.Get(index)))
+		{
+			drawn.push_back(index);
+		}
+	}
+	// 3 was never tracked, so nothing could have evicted it.
+	EXPECT_EQ(drawn, (std::vector<size_t>{0, 1, 3}));
+	EXPECT_TRUE(gpu.IsEvicted(resources.Get(2)));
+	manager.EndFrame(++fence);
+	manager.Retire(fence);
+
+	// The next frame pages it in and draws it again.
+	gpu.mFailMakeResident = false;
+	manager.MarkUsed(resources.Get(2));
+	EXPECT_TRUE(manager.Commit());
+	EXPECT_TRUE(manager.IsSafeToUse(resources.Get(2)));
+}
+
+TEST(ResidencyManagerTest, UntrackForgetsTheObject)
+{
+	SimulatedResidency gpu(0);
+	ResidencyManager manager(gpu.GetBackend(), FixedBudget(100 * MB));
+	FakeResources resources(2);
+
+	manager.Track(resources.Get(0), 10 * MB);
+	manager.Track(resources.Get(1), 30 * MB);
+	manager.Untrack(resources.Get(1));
+
+	EXPECT_FALSE(manager.IsTracked(resources.Get(1)));
+	EXPECT_EQ(manager.GetStats().mTracked, 1U);
+	EXPECT_EQ(manager.GetStats().mTrackedBytes, 10 * MB);
+	EXPECT_EQ(manager.GetStats().mResidentBytes, 10 * MB);
+	EXPECT_EQ(manager.GetStats().mUsedThisFrame, 1U);
+
+	// Marking something untracked does nothing.
+	manager.MarkUsed(resources.Get(1));
+	EXPECT_TRUE(manager.Commit());
+	EXPECT_EQ(gpu.mMakeResidentCalls, 0U);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "graphics/ResourceRegistry.h"
+#include <string>
+
+using namespace Graphics;
+
+namespace
+{
+	struct FakeMesh
+	{
+		explicit FakeMesh(std::string name)
+		: mName(std::move(name))
+		{
+		}
+
+		std::string mName;
+	};
+} // namespace
+
+TEST(ResourceRegistryTest, HandlesFitInThirtyTwoBits)
+{
+	static_assert(sizeof(Handle<FakeMesh>) == sizeof(uint32_t));
+
+	Handle<FakeMesh> handle(Handle<FakeMesh>::MAX_INDEX, Handle<FakeMesh>::MAX_GENERATION);
+	EXPECT_EQ(handle.GetIndex(), Handle<FakeMesh>::MAX_INDEX);
+	EXPECT_EQ(handle.GetGeneration(), Handle<FakeMesh>::MAX_GENERATION);
+	EXPECT_FALSE(Handle<FakeMesh>());
+}
+
+TEST(ResourceRegistryTest, ResolvesWhatWasAdded)
+{
+	ResourceRegistry<FakeMesh> registry;
+	Handle<FakeMesh> ball = registry.Add(std::make_shared<FakeMesh>("ball"));
+	Handle<FakeMesh> cube = registry.Add(std::make_shared<FakeMesh>("cube"));
+
+	ASSERT_TRUE(ball);
+	ASSERT_NE(ball, cube);
+	EXPECT_EQ(registry.Get(ball)->mName, "ball");
+	EXPECT_EQ(registry.Get(cube)->mName, "cube");
+	EXPECT_EQ(registry.Get({}), nullptr);
+	EXPECT_EQ(registry.Add(nullptr), Handle<FakeMesh>());
+	EXPECT_EQ(registry.GetCount(), 2U);
+}
+
+TEST(ResourceRegistryTest, SameObjectSameHandle)
+{
+	ResourceRegistry<FakeMesh> registry;
+	auto mesh = std::make_shared<FakeMesh>("ball");
+
+	Handle<FakeMesh> first = registry.Add(mesh);
+	EXPECT_EQ(registry.Add(mesh), first);
+	EXPECT_EQ(registry.Find(mesh.get()), first);
+	EXPECT_EQ(registry.GetCount(), 1U);
+}
+
+TEST(ResourceRegistryTest, RemovedHandlesGoStale)
+{
+	ResourceRegistry<FakeMesh> registry;
+	Handle<FakeMesh> old = registry.Add(std::make_shared<FakeMesh>("old"));
+	registry.Remove(old, 1);
+	EXPECT_EQ(registry.Get(old), nullptr);
+
+	// The slot gets reused, the old handle still doesn't resolve to the
+	// new mesh.
+	Handle<FakeMesh> replacement = registry.Add(std::make_shared<FakeMesh>("new"));
+	EXPECT_EQ(replacement.GetIndex(), old.GetIndex());
+	EXPECT_NE(replacement, old);
+	EXPECT_EQ(registry.Get(old), nullptr);
+	EXPECT_EQ(registry.Get(replacement)->mName, "new");
+
+	// Removing twice does nothing.
+	registry.Remove(old, 2);
+	EXPECT_EQ(registry.GetCount(), 1U);
+}
+
+TEST(ResourceRegistryTest, RemovedObjectsLiveUntilTheirFence)
+{
+	ResourceRegistry<FakeMesh> registry;
+	auto mesh = std::make_shared<FakeMesh>("ball");
+	std::weak_ptr<FakeMesh> watch = mesh;
+	Handle<FakeMesh> handle = registry.Add(std::move(mesh));
+
+	registry.Remove(handle, 5);
+	EXPECT_FALSE(watch.expired());
+	EXPECT_EQ(registry.GetPendingReleaseCount(), 1U);
+
+	registry.Retire(4);
+	EXPECT_FALSE(watch.expired());
+	registry.Retire(5);
+	EXPECT_TRUE(watch.expired());
+	EXPECT_EQ(registry.GetPendingReleaseCount(), 0U);
+}
+
+TEST(ResourceRegistryTest, GenerationWrapsPastZero)
+{
+	ResourceRegistry<FakeMesh> registry;
+	Handle<FakeMesh> handle = registry.Add(std::make_shared<FakeMesh>("churn"));
+	for (uint32_t i = 0; i < Handle<FakeMesh>::MAX_GENERATION + 10; ++i)
+	{
+		registry.Remove(handle, 0);
+		handle = registry.Add(std::make_shared<FakeMesh>("churn"));
+		ASSERT_TRUE(handle) << i;
+		ASSERT_NE(handle.GetGeneration(), 0U) << i;
+		ASSERT_NE(registry.Get(handle), nullptr) << i;
+	}
+	registry.Retire(0);
+	EXPECT_EQ(registry.GetCount(), 1U);
+}
+
+TEST(ResourceRegistryTest, ReservedHandlesResolveOnceSet)
+{
+	ResourceRegistry<FakeMesh> registry;
+	Handle<FakeMesh> loading = registry.Reserve();
+	ASSERT_TRUE(loading);
+	EXPECT_EQ(registry.Get(loading), nullptr);
+	EXPECT_EQ(registry.GetCount(), 1U);
+
+	auto mesh = std::make_shared<FakeMesh>("ball");
+	registry.Set(loading, mesh);
+	EXPECT_EQ(registry.Get(loading), mesh.get());
+	EXPECT_EQ(registry.Add(mesh), loading);
+
+	// Only an empty handle gets filled in.
+	registry.Set(loading, std::make_shared<FakeMesh>("cube"));
+	EXPECT_EQ(registry.Get(loading)->mName, "ball");
+}
+
+TEST(ResourceRegistryTest, TwoHandlesCanShareAnObject)
+{
+	ResourceRegistry<FakeMesh> registry;
+	auto mesh = std::make_shared<FakeMesh>("ball");
+	Handle<FakeMesh> first = registry.Add(mesh);
+	Handle<FakeMesh> copy = registry.Reserve();
+	registry.Set(copy, mesh);
+
+	EXPECT_EQ(registry.Get(copy), mesh.get());
+	EXPECT_EQ(registry.Find(mesh.get()), first);
+
+	// Removing the copy leaves the first one alone.
+	registry.Remove(copy, 1);
+	EXPECT_EQ(registry.Get(copy), nullptr);
+	EXPECT_EQ(registry.Find(mesh.get()), first);
+	EXPECT_EQ(registry.Get(first), mesh.get());
+
+	// A reserved handle that never got filled can still go.
+	Handle<FakeMesh> failed = registry.Reserve();
+	registry.Remove(failed, 1);
+	EXPECT_EQ(registry.GetCount(), 1U);
+	EXPECT_EQ(registry.GetPendingReleaseCount(), 1U);
+}
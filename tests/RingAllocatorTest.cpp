@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "graphics/RingAllocator.h"
+#include <cstring>
+
+using namespace Graphics;
+
+namespace
+{
+	/// Pages backed by plain memory, with made up GPU addresses that are
+	/// deliberately not 256 byte aligned.
+	struct FakePages
+	{
+		uint32_t mCreated = 0;
+
+		RingAllocator::PageFactory GetFactory()
+		{
+			return [this](size_t size, RingPage& page) {
+				auto memory = std::make_shared<std::vector<uint8_t>>(size);
+				page.mCpuAddress = memory->data();
+				page.mGpuAddress = 0x100000ULL * (++mCreated) + 0x40;
+				page.mSize = size;
+				page.mResource = memory;
+				return true;
+			};
+		}
+	};
+
+	struct Written
+	{
+		uint64_t mFence;
+		uint8_t* mData;
+		uint32_t mValue;
+	};
+} // namespace
+
+TEST(RingAllocatorTest, AlignsOnTheGpuAddress)
+{
+	FakePages pages;
+	RingAllocator allocator(pages.GetFactory());
+
+	RingAllocation first = allocator.Allocate(100, 256);
+	RingAllocation second = allocator.Allocate(10, 16);
+	RingAllocation third = allocator.Allocate(64, 256);
+
+	ASSERT_TRUE(first.IsValid() && second.IsValid() && third.IsValid());
+	EXPECT_EQ(first.mGpuAddress % 256, 0U);
+	EXPECT_EQ(second.mGpuAddress % 16, 0U);
+	EXPECT_EQ(third.mGpuAddress % 256, 0U);
+	EXPECT_GE(second.mGpuAddress, first.mGpuAddress + 100);
+	EXPECT_GE(third.mGpuAddress, second.mGpuAddress + 10);
+
+	// CPU and GPU addresses move together.
+	EXPECT_EQ(third.mCpuAddress - first.mCpuAddress,
+			  static_cast<ptrdiff_t>(third.mGpuAddress - first.mGpuAddress));
+}
+
+TEST(RingAllocatorTest, ChainsPagesWhenAFrameOutgrowsOne)
+{
+	FakePages pages;
+	RingAllocatorDesc desc;
+	desc.mPageSize = 1024;
+	RingAllocator allocator(pages.GetFactory(), desc);
+
+	// 3 per page once the base is aligned, 100 would overflow a fixed
+	// 64 slot buffer too.
+	for (int i = 0; i < 100; ++i)
+	{
+		ASSERT_TRUE(allocator.Allocate(256, 256).IsValid());
+	}
+	EXPECT_EQ(pages.mCreated, 34U);
+	EXPECT_EQ(allocator.GetStats().mPageCount, 34U);
+	EXPECT_EQ(allocator.GetStats().mFailedAllocations, 0U);
+}
+
+TEST(RingAllocatorTest, NeverOverwritesDataInFlight)
+{
+	FakePages pages;
+	RingAllocatorDesc desc;
+	desc.mPageSize = 4096;
+	RingAllocator allocator(pages.GetFactory(), desc);
+
+	// The GPU runs two frames behind, every frame writes a different
+	// number of constants.
+	const uint64_t latency = 2;
+	std::vector<Written> written;
+	uint32_t value = 0;
+	for (uint64_t frame = 1; frame <= 300; ++frame)
+	{
+		uint64_t completed = frame > latency ? frame - latency : 0;
+		for (const Written& w : written)
+		{
+			if (w.mFence > completed)
+			{
+				uint32_t stored = 0;
+				std::memcpy(&stored, w.mData, sizeof(stored));
+				ASSERT_EQ(stored, w.mValue) << "frame " << frame;
+			}
+		}
+		std::erase_if(written, [&](const Written& w) { return w.mFence <= completed; });
+		allocator.Retire(completed);
+
+		uint32_t count = 5 + static_cast<uint32_t>((frame * 7) % 40);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			RingAllocation allocation = allocator.Push(++value);
+			ASSERT_TRUE(allocation.IsValid());
+			written.push_back({frame, allocation.mCpuAddress, value});
+		}
+		allocator.EndFrame(frame);
+	}
+
+	// At most 44 allocations of 256 bytes a frame, three frames in flight
+	// plus the page being filled.
+	EXPECT_LE(pages.mCreated, 10U);
+}
+
+TEST(RingAllocatorTest, LargeAllocationsGetTheirOwnPage)
+{
+	FakePages pages;
+	RingAllocatorDesc desc;
+	desc.mPageSize = 1024;
+	RingAllocator allocator(pages.GetFactory(), desc);
+
+	RingAllocation small = allocator.Allocate(64);
+	RingAllocation large = allocator.Allocate(5000);
+	ASSERT_TRUE(small.IsValid() && large.IsValid());
+	EXPECT_EQ(large.mGpuAddress % 256, 0U);
+	EXPECT_EQ(allocator.GetStats().mLargePages, 1U);
+	EXPECT_EQ(allocator.GetStats().mPageCount, 2U);
+
+	// Still bumping the same small page afterwards.
+	RingAllocation next = allocator.Allocate(64);
+	EXPECT_EQ(next.mGpuAddress, small.mGpuAddress + 256);
+
+	allocator.EndFrame(1);
+	allocator.Retire(1);
+	EXPECT_EQ(allocator.GetStats().mPageCount, 1U);
+}
+
+TEST(RingAllocatorTest, MaxPagesCapsGrowth)
+{
+	FakePages pages;
+	RingAllocatorDesc desc;
+	desc.mPageSize = 1024;
+	desc.mMaxPages = 1;
+	RingAllocator allocator(pages.GetFactory(), desc);
+
+	uint32_t succeeded = 0;
+	for (int i = 0; i < 10; ++i)
+	{
+		succeeded += allocator.Allocate(256).IsValid() ? 1 : 0;
+	}
+	EXPECT_EQ(succeeded, 3U);
+	EXPECT_EQ(allocator.GetStats().mFailedAllocations, 7U);
+	EXPECT_EQ(pages.mCreated, 1U);
+
+	// Nothing comes back until the GPU is done with the frame.
+	allocator.EndFrame(1);
+	allocator.Retire(0);
+	EXPECT_FALSE(allocator.Allocate(256).IsValid());
+
+	allocator.EndFrame(2);
+	allocator.Retire(2);
+	EXPECT_TRUE(allocator.Allocate(256).IsValid());
+	EXPECT_EQ(pages.mCreated, 1U);
+}
+
+TEST(RingAllocatorTest, PushCopiesTheData)
+{
+	FakePages pages;
+	RingAllocator allocator(pages.GetFactory());
+
+	struct Constants
+	{
+		float mValues[4];
+	};
+	Constants constants = {{1.0F, 2.0F, 3.0F, 4.0F}};
+
+	RingAllocation allocation = allocator.Push(constants);
+	ASSERT_TRUE(allocation.IsValid());
+	EXPECT_EQ(allocation.mSize, sizeof(Constants));
+	EXPECT_EQ(std::memcmp(allocation.mCpuAddress, &constants, sizeof(Constants)), 0);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "utils/StringId.h"
+#include "utils/Hash.h"
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace Utils;
+
+TEST(StringIdTest, SameTextSameId)
+{
+	StringId a("GeometryPass");
+	StringId b(std::string("Geometry") + "Pass");
+	StringId c("LightingPass");
+
+	EXPECT_EQ(a, b);
+	EXPECT_EQ(a.GetId(), b.GetId());
+	EXPECT_FALSE(a == c);
+	EXPECT_NE(a.GetId(), c.GetId());
+	EXPECT_EQ(a.GetString(), "GeometryPass");
+}
+
+TEST(StringIdTest, EmptyIsNull)
+{
+	StringId empty("");
+	EXPECT_FALSE(empty);
+	EXPECT_EQ(empty, StringId());
+	EXPECT_EQ(empty.GetId(), 0U);
+	EXPECT_EQ(empty.GetString(), "");
+	EXPECT_TRUE(StringId("x"));
+}
+
+TEST(StringIdTest, HashIsWorkedOutUpFront)
+{
+	std::string text = "assets/materials/rust/material.json";
+	StringId id(text);
+	EXPECT_EQ(id.GetHash(), Hash64(text.data(), text.size()));
+	EXPECT_EQ(std::hash<StringId>{}(id), static_cast<size_t>(id.GetHash()));
+}
+
+TEST(StringIdTest, WideCopyMatchesTheOldConversion)
+{
+	std::string path = "assets/textures/rust_albedo.png";
+	StringId id(path);
+	EXPECT_EQ(id.GetWide(), std::wstring(path.begin(), path.end()));
+}
+
+TEST(StringIdTest, StringsStayPutAsTheTableGrows)
+{
+	StringId first("stays-put");
+	const std::string* text = &first.GetString();
+	for (int i = 0; i < 10000; ++i)
+	{
+		StringId filler("filler-" + std::to_string(i));
+	}
+	EXPECT_EQ(&StringId("stays-put").GetString(), text);
+	EXPECT_EQ(*text, "stays-put");
+}
+
+TEST(StringIdTest, WorksAsAMapKey)
+{
+	std::unordered_map<StringId, int> cache;
+	cache[StringId("ball.obj")] = 1;
+	cache[StringId("cube.obj")] = 2;
+
+	EXPECT_EQ(cache.at(StringId("ball.obj")), 1);
+	EXPECT_EQ(cache.at(StringId("cube.obj")), 2);
+	EXPECT_FALSE(cache.contains(StringId("plane.obj")));
+}
+
+TEST(StringIdTest, ThreadsAgreeOnIds)
+{
+	const int threadCount = 8;
+	const int names = 2000;
+	std::vector<std::vector<uint32_t>> ids(threadCount, std::vector<uint32_t>(names));
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&ids, t, names]() {
+			// Every thread interns the same names, in a different order.
+			for (int i = 0; i < names; ++i)
+			{
+				int name = (i * 7 + t * 131) % names;
+				ids[t][name] = StringId("threaded-" + std::to_string(name)).GetId();
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (int t = 1; t < threadCount; ++t)
+	{
+		ASSERT_EQ(ids[t], ids[0]) << "thread " << t;
+	}
+	EXPECT_NE(ids[0][0], ids[0][1]);
+}
@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include "graphics/texture/TextureLoadPipeline.h"
+#include "utils/BoundedQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+using namespace TextureTools;
+
+namespace
+{
+	/// Stand in for the GPU: Submit hands out fence values and the test
+	/// decides how far behind the completed value is.
+	struct FakeGpu
+	{
+		uint64_t mSubmitted = 0;
+		uint32_t mUploadCalls = 0;
+	};
+
+	LoadStages MakeStubStages(FakeGpu& gpu, std::vector<uint32_t>& completed,
+							  size_t stagingBytes = 16)
+	{
+		LoadStages stages;
+		stages.mRead = [stagingBytes](LoadItem& item) {
+			item.mFileData.assign(8, static_cast<uint8_t>(item.mId));
+			item.mStagingBytes = stagingBytes;
+			return true;
+		};
+		stages.mDecode = [stagingBytes](LoadItem& item) {
+			item.mResult = std::make_shared<uint32_t>(item.mId * 10);
+			item.mStagingBytes = stagingBytes;
+			return !item.mFileData.empty();
+		};
+		stages.mUpload = [&gpu](LoadItem&) {
+			gpu.mUploadCalls++;
+			return true;
+		};
+		stages.mSubmit = [&gpu]() { return ++gpu.mSubmitted; };
+		stages.mComplete = [&completed](LoadItem& item) {
+			if (!item.mFailed)
+			{
+				completed.push_back(item.mId);
+			}
+		};
+		return stages;
+	}
+
+	/// Pumps until the pipeline drains, with the GPU lagging gpuLag
+	/// submits behind.
+	void PumpUntilIdle(TextureLoadPipeline& pipeline, FakeGpu& gpu, uint64_t gpuLag = 0,
+					   uint32_t maxUploads = UINT32_MAX)
+	{
+		for (int i = 0; i < 100000 && !pipeline.IsIdle(); ++i)
+		{
+			uint64_t completed = gpu.mSubmitted > gpuLag ? gpu.mSubmitted - gpuLag : 0;
+			// Once nothing new is being submitted let the GPU catch up.
+			if (i > 1000)
+			{
+				completed = gpu.mSubmitted;
+			}
+			pipeline.Pump(completed, maxUploads);
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	}
+} // namespace
+
+TEST(BoundedQueueTest, PushBlocksWhenFull)
+{
+	Utils::BoundedQueue<int> queue(2);
+	ASSERT_TRUE(queue.Push(1));
+	ASSERT_TRUE(queue.Push(2));
+
+	std::atomic<bool> pushed{false};
+	std::thread producer([&]() {
+		queue.Push(3);
+		pushed = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_FALSE(pushed.load());
+
+	EXPECT_EQ(queue.Pop().value(), 1);
+	producer.join();
+	EXPECT_TRUE(pushed.load());
+	EXPECT_EQ(queue.GetSize(), 2U);
+	EXPECT_EQ(queue.GetHighWater(), 2U);
+}
+
+TEST(BoundedQueueTest, CloseWakesConsumersAfterDraining)
+{
+	Utils::BoundedQueue<int> queue(4);
+	queue.Push(7);
+
+	std::thread closer([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		queue.Close();
+	});
+
+	EXPECT_EQ(queue.Pop().value(), 7);
+	EXPECT_FALSE(queue.Pop().has_value());
+	EXPECT_FALSE(queue.Push(8));
+	closer.join();
+}
+
+TEST(TextureLoadPipelineTest, CompletesEveryItem)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+	TextureLoadPipeline pipeline(MakeStubStages(gpu, completed));
+
+	for (int i = 0; i < 50; ++i)
+	{
+		pipeline.Enqueue("texture_" + std::to_string(i) + ".png");
+	}
+	PumpUntilIdle(pipeline, gpu);
+
+	ASSERT_TRUE(pipeline.IsIdle());
+	EXPECT_EQ(completed.size(), 50U);
+	EXPECT_EQ(std::set<uint32_t>(completed.begin(), completed.end()).size(), 50U);
+	EXPECT_EQ(gpu.mUploadCalls, 50U);
+
+	LoadPipelineStats stats = pipeline.GetStats();
+	EXPECT_EQ(stats.mQueued, 50U);
+	EXPECT_EQ(stats.mCompleted, 50U);
+	EXPECT_EQ(stats.mFailed, 0U);
+	EXPECT_EQ(stats.mStagingBytes, 0U);
+}
+
+TEST(TextureLoadPipelineTest, StagingStaysWithinBudget)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+
+	LoadPipelineDesc desc;
+	desc.mDecodeThreads = 4;
+	desc.mQueueDepth = 8;
+	desc.mMaxStagingBytes = 64;
+
+	TextureLoadPipeline pipeline(MakeStubStages(gpu, completed, 16), desc);
+	for (int i = 0; i < 40; ++i)
+	{
+		pipeline.Enqueue("t.png");
+	}
+
+	// The GPU lags a few submits behind and only one upload goes out per
+	// frame, so decoded items pile up unless backpressure stops them.
+	PumpUntilIdle(pipeline, gpu, 3, 1);
+
+	LoadPipelineStats stats = pipeline.GetStats();
+	EXPECT_EQ(stats.mCompleted, 40U);
+	EXPECT_LE(stats.mPeakStagingBytes, 64U);
+	EXPECT_EQ(stats.mPeakStagingBytes, 64U);
+	EXPECT_LE(stats.mDecodeQueueHighWater, 8U);
+	EXPECT_LE(stats.mUploadQueueHighWater, 8U);
+}
+
+TEST(TextureLoadPipelineTest, OversizedItemStillGoesThrough)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+
+	LoadPipelineDesc desc;
+	desc.mMaxStagingBytes = 10;
+	TextureLoadPipeline pipeline(MakeStubStages(gpu, completed, 100), desc);
+
+	pipeline.Enqueue("big.png");
+	pipeline.Enqueue("big2.png");
+	PumpUntilIdle(pipeline, gpu);
+
+	EXPECT_EQ(completed.size(), 2U);
+	EXPECT_EQ(pipeline.GetStats().mPeakStagingBytes, 100U);
+}
+
+TEST(TextureLoadPipelineTest, ItemsBecomeVisibleAsTheirFenceRetires)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+	TextureLoadPipeline pipeline(MakeStubStages(gpu, completed));
+
+	for (int i = 0; i < 4; ++i)
+	{
+		pipeline.Enqueue("t.png");
+	}
+
+	// Wait for all four to be decoded and uploaded without the GPU
+	// finishing anything.
+	for (int i = 0; i < 10000 && gpu.mUploadCalls < 4; ++i)
+	{
+		pipeline.Pump(0, 1);
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	ASSERT_EQ(gpu.mUploadCalls, 4U);
+	ASSERT_EQ(gpu.mSubmitted, 4U);
+	EXPECT_TRUE(completed.empty());
+
+	// One upload per submit, each fence retires its own texture.
+	for (uint64_t fence = 1; fence <= 4; ++fence)
+	{
+		EXPECT_EQ(pipeline.Pump(fence), 1U);
+		EXPECT_EQ(completed.size(), fence);
+	}
+	EXPECT_TRUE(pipeline.IsIdle());
+}
+
+TEST(TextureLoadPipelineTest, FailuresSkipToComplete)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+	LoadStages stages = MakeStubStages(gpu, completed);
+
+	// Ids 0..8: read fails on 1, decode on 2, upload on 3.
+	stages.mRead = [](LoadItem& item) {
+		item.mFileData.assign(8, 0);
+		item.mStagingBytes = 16;
+		return item.mId != 1;
+	};
+	stages.mDecode = [](LoadItem& item) {
+		item.mStagingBytes = 16;
+		return item.mId != 2;
+	};
+	stages.mUpload = [&gpu](LoadItem& item) {
+		gpu.mUploadCalls++;
+		return item.mId != 3;
+	};
+
+	std::vector<uint32_t> failed;
+	stages.mComplete = [&](LoadItem& item) {
+		(item.mFailed ? failed : completed).push_back(item.mId);
+	};
+
+	TextureLoadPipeline pipeline(std::move(stages));
+	for (int i = 0; i < 9; ++i)
+	{
+		pipeline.Enqueue("t.png");
+	}
+	PumpUntilIdle(pipeline, gpu);
+
+	std::sort(failed.begin(), failed.end());
+	EXPECT_EQ(failed, (std::vector<uint32_t>{1, 2, 3}));
+	EXPECT_EQ(completed.size(), 6U);
+	// Items that failed before upload never reach mUpload.
+	EXPECT_EQ(gpu.mUploadCalls, 7U);
+
+	LoadPipelineStats stats = pipeline.GetStats();
+	EXPECT_EQ(stats.mFailed, 3U);
+	EXPECT_EQ(stats.mCompleted, 6U);
+	EXPECT_EQ(stats.mStagingBytes, 0U);
+}
+
+TEST(TextureLoadPipelineTest, ShutsDownWithWorkPending)
+{
+	FakeGpu gpu;
+	std::vector<uint32_t> completed;
+	LoadStages stages = MakeStubStages(gpu, completed);
+	stages.mDecode = [](LoadItem& item) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		item.mStagingBytes = 16;
+		return true;
+	};
+
+	{
+		LoadPipelineDesc desc;
+		desc.mMaxStagingBytes = 32;
+		TextureLoadPipeline pipeline(std::move(stages), desc);
+		for (int i = 0; i < 100; ++i)
+		{
+			pipeline.Enqueue("t.png");
+		}
+		pipeline.Pump(0);
+	}
+
+	// Nothing was retired, and the destructor doesn't call back.
+	EXPECT_TRUE(completed.empty());
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "graphics/TransientAliasing.h"
+#include <random>
+
+using namespace Graphics;
+
+namespace
+{
+	constexpr uint64_t KB64 = DEFAULT_PLACEMENT_ALIGNMENT;
+
+	TransientResource Make(const char* name, uint64_t size, uint32_t first, uint32_t last,
+						   uint32_t heap = 0)
+	{
+		TransientResource resource;
+		resource.mName = name;
+		resource.mSize = size;
+		resource.mFirstPass = first;
+		resource.mLastPass = last;
+		resource.mHeap = heap;
+		return resource;
+	}
+
+	uint64_t TargetSize(uint32_t width, uint32_t height, uint32_t bytesPerPixel)
+	{
+		uint64_t size = static_cast<uint64_t>(width) * height * bytesPerPixel;
+		return (size + KB64 - 1) / KB64 * KB64;
+	}
+} // namespace
+
+TEST(TransientAliasingTest, DisjointLifetimesShareMemory)
+{
+	std::vector<TransientResource> resources = {
+		Make("a", 4 * KB64, 0, 1),
+		Make("b", 4 * KB64, 2, 3),
+	};
+	AliasingPlan plan = PlanTransientAliasing(resources);
+
+	EXPECT_TRUE(ValidateAliasingPlan(resources, plan));
+	EXPECT_EQ(plan.mOffsets[0], plan.mOffsets[1]);
+	EXPECT_EQ(plan.mAliasedSize, 4 * KB64);
+	EXPECT_EQ(plan.GetSavedBytes(), 4 * KB64);
+}
+
+TEST(TransientAliasingTest, TouchingLifetimesDoNot)
+{
+	// Pass 1 writes b while a is still read.
+	std::vector<TransientResource> resources = {
+		Make("a", 2 * KB64, 0, 1),
+		Make("b", 2 * KB64, 1, 2),
+	};
+	AliasingPlan plan = PlanTransientAliasing(resources);
+
+	EXPECT_TRUE(ValidateAliasingPlan(resources, plan));
+	EXPECT_NE(plan.mOffsets[0], plan.mOffsets[1]);
+	EXPECT_EQ(plan.GetSavedBytes(), 0U);
+}
+
+TEST(TransientAliasingTest, RespectsAlignment)
+{
+	std::vector<TransientResource> resources = {
+		Make("small", 1000, 0, 3),
+		Make("msaa", 3 * KB64, 0, 3),
+	};
+	// MSAA targets want 4MB.
+	resources[1].mAlignment = 4 * 1024 * 1024;
+	AliasingPlan plan = PlanTransientAliasing(resources);
+
+	EXPECT_TRUE(ValidateAliasingPlan(resources, plan));
+	EXPECT_EQ(plan.mOffsets[1] % resources[1].mAlignment, 0U);
+	EXPECT_EQ(plan.mOffsets[0] % KB64, 0U);
+}
+
+TEST(TransientAliasingTest, FillsGapsLeftByBiggerResources)
+{
+	// big0 and big1 sit side by side, small fits where big0 was once it's
+	// dead.
+	std::vector<TransientResource> resources = {
+		Make("big0", 8 * KB64, 0, 1),
+		Make("big1", 8 * KB64, 0, 3),
+		Make("small", 2 * KB64, 2, 3),
+	};
+	AliasingPlan plan = PlanTransientAliasing(resources);
+
+	EXPECT_TRUE(ValidateAliasingPlan(resources, plan));
+	EXPECT_EQ(plan.mAliasedSize, 16 * KB64);
+	EXPECT_EQ(plan.GetSavedBytes(), 2 * KB64);
+}
+
+TEST(TransientAliasingTest, KeepsHeapsApart)
+{
+	std::vector<TransientResource> resources = {
+		Make("target", 4 * KB64, 0, 0, 0),
+		Make("buffer", 4 * KB64, 1, 1, 1),
+	};
+	AliasingPlan plan = PlanTransientAliasing(resources);
+
+	EXPECT_TRUE(ValidateAliasingPlan(resources, plan));
+	ASSERT_EQ(plan.mHeapSizes.size(), 2U);
+	EXPECT_EQ(plan.mHeapSizes[0], 4 * KB64);
+	EXPECT_EQ(plan.mHeapSizes[1], 4 * KB64);
+	EXPECT_EQ(plan.GetSavedBytes(), 0U);
+}
+
+TEST(TransientAliasingTest, RandomPassListsStayValid)
+{
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<uint32_t> pass(0, 15);
+	std::uniform_int_distribution<uint64_t> size(1, 40 * KB64);
+	std::uniform_int_distribution<uint32_t> heap(0, 2);
+	std::uniform_int_distribution<uint32_t> alignShift(0, 6);
+
+	for (int round = 0; round < 200; ++round)
+	{
+		std::vector<TransientResource> resources;
+		int count = 1 + round % 30;
+		for (int i = 0; i < count; ++i)
+		{
+			uint32_t a = pass(rng);
+			uint32_t b = pass(rng);
+			TransientResource resource =
+				Make("r", size(rng), std::min(a, b), std::max(a, b), heap(rng));
+			resource.mAlignment = KB64 << alignShift(rng);
+			resources.push_back(resource);
+		}
+
+		AliasingPlan plan = PlanTransientAliasing(resources);
+		ASSERT_TRUE(ValidateAliasingPlan(resources, plan)) << "round " << round;
+		EXPECT_LE(plan.mAliasedSize, plan.mUnaliasedSize + 3 * KB64) << "round " << round;
+	}
+}
+
+TEST(TransientAliasingTest, RendererPassListSavesTheBlurTemp)
+{
+	// Geometry, lighting, the two blur passes and the UI, with the
+	// viewport targets at 1920x1152 (1080p rounded up to a bucket).
+	enum Pass : uint32_t
+	{
+		GEOMETRY,
+		LIGHTING,
+		BLUR_HORIZONTAL,
+		BLUR_VERTICAL,
+		UI,
+	};
+	const uint32_t width = 1920;
+	const uint32_t height = 1152;
+
+	std::vector<TransientResource> resources = {
+		Make("GBuffer_Albedo_AO", TargetSize(width, height, 4), GEOMETRY, LIGHTING),
+		Make("GBuffer_Normal_Roughness", TargetSize(width, height, 8), GEOMETRY, LIGHTING),
+		Make("GBuffer_Metallic_Flags", TargetSize(width, height, 4), GEOMETRY, LIGHTING),
+		Make("GBuffer_Emissive", TargetSize(width, height, 8), GEOMETRY, LIGHTING),
+		Make("GBuffer_Depth", TargetSize(width, height, 4), GEOMETRY, LIGHTING),
+		Make("ViewportDepth", TargetSize(width, height, 4), LIGHTING, LIGHTING),
+		Make("ViewportTexture", TargetSize(width, height, 4), LIGHTING, UI),
+		Make("BlurTempTexture", TargetSize(width, height, 4), BLUR_HORIZONTAL, BLUR_VERTICAL),
+	};
+
+	AliasingPlan plan = PlanTransientAliasing(resources);
+	ASSERT_TRUE(ValidateAliasingPlan(resources, plan));
+
+	// Everything else is alive during the lighting pass, the blur temp
+	// lands on a dead GBuffer target.
+	EXPECT_EQ(plan.GetSavedBytes(), TargetSize(width, height, 4));
+	bool aliased = false;
+	for (size_t i = 0; i < 5; ++i)
+	{
+		aliased |= plan.mOffsets[7] >= plan.mOffsets[i] &&
+				   plan.mOffsets[7] < plan.mOffsets[i] + resources[i].mSize;
+	}
+	EXPECT_TRUE(aliased);
+}
+
+TEST(TransientAliasingTest, SavedBytesNeverWrap)
+{
+	AliasingPlan plan;
+	plan.mAliasedSize = 256;
+	plan.mUnaliasedSize = 192;
+	EXPECT_EQ(plan.GetSavedBytes(), 0U);
+
+	plan.mUnaliasedSize = 1024;
+	EXPECT_EQ(plan.GetSavedBytes(), 768U);
+}
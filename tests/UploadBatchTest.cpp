@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "graphics/UploadBatch.h"
+
+using namespace Graphics;
+
+namespace
+{
+	/// Copy queue plus the graphics queue's GPU waits, all just counters.
+	struct MockQueues
+	{
+		uint32_t mBegins = 0;
+		uint32_t mSubmits = 0;
+		uint64_t mNextFence = 1;
+		uint64_t mCompleted = 0;
+		std::vector<uint64_t> mGraphicsWaits;
+
+		UploadBatchQueue GetQueue()
+		{
+			UploadBatchQueue queue;
+			queue.mBegin = [this]() { mBegins++; };
+			queue.mSubmit = [this]() {
+				mSubmits++;
+				return mNextFence++;
+			};
+			queue.mGetCompletedFence = [this]() { return mCompleted; };
+			queue.mGraphicsWait = [this](uint64_t fence) { mGraphicsWaits.push_back(fence); };
+			return queue;
+		}
+	};
+} // namespace
+
+TEST(UploadBatchTest, ManyCopiesShareOneSubmitAndFence)
+{
+	MockQueues queues;
+	UploadBatch batch(queues.GetQueue());
+
+	batch.Begin();
+	for (int i = 0; i < 25; ++i)
+	{
+		batch.Add(1024);
+	}
+	uint64_t fence = batch.Submit();
+
+	EXPECT_EQ(queues.mSubmits, 1U);
+	EXPECT_EQ(fence, 1U);
+	ASSERT_EQ(queues.mGraphicsWaits.size(), 1U);
+	EXPECT_EQ(queues.mGraphicsWaits[0], fence);
+
+	const UploadBatchStats& stats = batch.GetStats();
+	EXPECT_EQ(stats.mBatches, 1U);
+	EXPECT_EQ(stats.mItems, 25U);
+	EXPECT_EQ(stats.mBytes, 25U * 1024);
+	EXPECT_EQ(stats.mGraphicsWaits, 1U);
+}
+
+TEST(UploadBatchTest, StagingLivesUntilTheCopyFinishes)
+{
+	MockQueues queues;
+	UploadBatch batch(queues.GetQueue());
+
+	int retired = 0;
+	batch.Begin();
+	batch.Add(16, [&]() { retired++; });
+	batch.Add(16, [&]() { retired++; });
+	uint64_t first = batch.Submit();
+
+	batch.Begin();
+	batch.Add(16, [&]() { retired += 10; });
+	uint64_t second = batch.Submit();
+	EXPECT_EQ(batch.GetStats().mPendingBatches, 2U);
+
+	batch.Retire();
+	EXPECT_EQ(retired, 0);
+
+	queues.mCompleted = first;
+	batch.Retire();
+	EXPECT_EQ(retired, 2);
+	EXPECT_EQ(batch.GetStats().mPendingBatches, 1U);
+
+	queues.mCompleted = second;
+	batch.Retire();
+	EXPECT_EQ(retired, 12);
+	EXPECT_EQ(batch.GetStats().mPendingBatches, 0U);
+}
+
+TEST(UploadBatchTest, EmptyBatchDoesNotFenceOrWait)
+{
+	MockQueues queues;
+	UploadBatch batch(queues.GetQueue());
+
+	batch.Begin();
+	batch.Add(8);
+	uint64_t fence = batch.Submit();
+
+	batch.Begin();
+	EXPECT_TRUE(batch.IsRecording());
+	EXPECT_EQ(batch.Submit(), fence);
+	EXPECT_FALSE(batch.IsRecording());
+
+	// The list still got closed, but the graphics queue only waits once.
+	EXPECT_EQ(queues.mBegins, 2U);
+	EXPECT_EQ(queues.mSubmits, 2U);
+	EXPECT_EQ(queues.mGraphicsWaits.size(), 1U);
+	EXPECT_EQ(batch.GetStats().mBatches, 1U);
+	EXPECT_EQ(batch.GetLastFence(), fence);
+}
+
+TEST(UploadBatchTest, FirstBatchEmpty)
+{
+	MockQueues queues;
+	UploadBatch batch(queues.GetQueue());
+
+	batch.Begin();
+	EXPECT_EQ(batch.Submit(), 0U);
+
+	// Closed and executed, nothing to wait for or retire.
+	EXPECT_EQ(queues.mSubmits, 1U);
+	EXPECT_TRUE(queues.mGraphicsWaits.empty());
+	EXPECT_EQ(batch.GetStats().mBatches, 0U);
+	EXPECT_EQ(batch.GetStats().mPendingBatches, 0U);
+	EXPECT_EQ(batch.GetLastFence(), 0U);
+
+	queues.mCompleted = 1;
+	batch.Retire();
+	EXPECT_EQ(batch.GetStats().mPendingBatches, 0U);
+}
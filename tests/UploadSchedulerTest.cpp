@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "graphics/UploadScheduler.h"
+#include <string>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	constexpr size_t MB = 1024 * 1024;
+
+	/// Simulated frame clock: recording a slice costs time proportional to
+	/// its size, nothing else moves it.
+	struct FakeClock
+	{
+		double mNow = 0.0;
+		double mMsPerMB = 0.25;
+	};
+
+	/// Every slice recorded, as "name:slice", so the tests can check the
+	/// order across frames.
+	struct Recorder
+	{
+		explicit Recorder(FakeClock& clock)
+		: mClock(&clock)
+		{
+		}
+
+		FakeClock* mClock;
+		std::vector<std::string> mRecorded;
+
+		UploadJob MakeJob(const std::string& name, std::vector<size_t> sliceBytes,
+						  int32_t priority = 0, const void* key = nullptr)
+		{
+			UploadJob job;
+			job.mKey = key;
+			job.mPriority = priority;
+			job.mSliceBytes = sliceBytes;
+			job.mRecord = [this, name, sliceBytes](uint32_t slice) {
+				mRecorded.push_back(name + ":" + std::to_string(slice));
+				mClock->mNow += static_cast<double>(sliceBytes[slice]) / MB * mClock->mMsPerMB;
+				return true;
+			};
+			return job;
+		}
+	};
+
+	UploadSchedulerDesc MakeDesc(FakeClock& clock, size_t bytesPerFrame, double msPerFrame = 100.0)
+	{
+		UploadSchedulerDesc desc;
+		desc.mBytesPerFrame = bytesPerFrame;
+		desc.mMillisecondsPerFrame = msPerFrame;
+		desc.mNow = [&clock]() { return clock.mNow; };
+		return desc;
+	}
+} // namespace
+
+TEST(UploadSchedulerTest, SpreadsAcrossFramesByBytes)
+{
+	FakeClock clock;
+	Recorder recorder(clock);
+	UploadScheduler scheduler(MakeDesc(clock, 16 * MB));
+
+	for (int i = 0; i < 10; ++i)
+	{
+		scheduler.Enqueue(recorder.MakeJob("mesh" + std::to_string(i), {4 * MB}));
+	}
+	EXPECT_EQ(scheduler.GetStats().mPendingBytes, 40 * MB);
+
+	EXPECT_EQ(scheduler.Pump(), 4U);
+	EXPECT_EQ(scheduler.GetStats().mLastFrameBytes, 16 * MB);
+	EXPECT_EQ(scheduler.Pump(), 4U);
+	EXPECT_EQ(scheduler.Pump(), 2U);
+	EXPECT_FALSE(scheduler.HasPending());
+	EXPECT_EQ(scheduler.Pump(), 0U);
+
+	const UploadSchedulerStats& stats = scheduler.GetStats();
+	EXPECT_EQ(stats.mJobsCompleted, 10U);
+	EXPECT_EQ(stats.mBytes, 40 * MB);
+	EXPECT_EQ(stats.mPendingBytes, 0U);
+	EXPECT_EQ(recorder.mRecorded.front(), "mesh0:0");
+	EXPECT_EQ(recorder.mRecorded.back(), "mesh9:0");
+}
+
+TEST(UploadSchedulerTest, OversizedSliceGoesOnItsOwn)
+{
+	FakeClock clock;
+	Recorder recorder(clock);
+	UploadScheduler scheduler(MakeDesc(clock, 8 * MB));
+
+	scheduler.Enqueue(recorder.MakeJob("huge", {64 * MB}));
+	scheduler.Enqueue(recorder.MakeJob("small", {1 * MB}));
+
+	EXPECT_EQ(scheduler.Pump(), 1U);
+	EXPECT_EQ(recorder.mRecorded, std::vector<std::string>({"huge:0"}));
+	EXPECT_EQ(scheduler.Pump(), 1U);
+	EXPECT_FALSE(scheduler.HasPending());
+}
+
+TEST(UploadSchedulerTest, SlicedJobSpansFrames)
+{
+	FakeClock clock;
+	Recorder recorder(clock);
+	UploadScheduler scheduler(MakeDesc(clock, 8 * MB));
+
+	int key = 0;
+	scheduler.Enqueue(recorder.MakeJob("texture", {8 * MB, 4 * MB, 2 * MB, 1 * MB}, 0, &key));
+
+	EXPECT_EQ(scheduler.Pump(), 1U);
+	EXPECT_TRUE(scheduler.IsPending(&key));
+	EXPECT_EQ(scheduler.Pump(), 3U);
+	EXPECT_FALSE(scheduler.IsPending(&key));
+	EXPECT_EQ(recorder.mRecorded,
+			  std::vector<std::string>({"texture:0", "texture:1", "texture:2", "texture:3"}));
+	EXPECT_EQ(scheduler.GetStats().mJobsCompleted, 1U);
+}
+
+TEST(UploadSchedulerTest, VisibleJobsJumpTheQueue)
+{
+	FakeClock clock;
+	Recorder recorder(clock);
+	UploadScheduler scheduler(MakeDesc(clock, 4 * MB));
+
+	int rock = 0;
+	int tree = 0;
+	int hero = 0;
+	scheduler.Enqueue(recorder.MakeJob("rock", {4 * MB}, 0, &rock));
+	scheduler.Enqueue(recorder.MakeJob("tree", {4 * MB}, 0, &tree));
+	scheduler.Enqueue(recorder.MakeJob("hero", {4 * MB}, 0, &hero));
+
+	// The frame drew the hero, it goes before what was queued earlier.
+	scheduler.MarkVisible(&hero);
+	scheduler.Pump();
+	// Marks only last until the next Pump, back to queue order.
+	scheduler.Pump();
+	scheduler.MarkVisible(&rock);
+	scheduler.Pump();
+
+	EXPECT_EQ(recorder.mRecorded, std::vector<std::string>({"hero:0", "rock:0", "tree:0"}));
+}
+
+TEST(UploadSchedulerTest, PriorityThenQueueOrder)
+{
+	FakeClock clock;
+	Recorder recorder(clock);
+	UploadScheduler scheduler(MakeDesc(clock, 1 * MB));
+
+	scheduler.Enqueue(recorder.MakeJob("a", {MB}));
+	scheduler.Enqueue(recorder.MakeJob("b", {MB}, 5));
+	scheduler.Enqueue(recorder.MakeJob("c", {MB}));
+	scheduler.Enqueue(recorder.MakeJob("d", {MB}, 5));
+
+	while (scheduler.HasPending())
+	{
+		scheduler.Pump();
+	}
+	EXPECT_EQ(recorder.mRecorded, std::vector<std::string>({"b:0", "d:0", "a:0", "c:0"}));
+}
+
+TEST(UploadSchedulerTest, TimeBudgetCutsTheFrame)
+{
+	FakeClock clock;
+	clock.mMsPerMB = 1.0;
+	Recorder recorder(clock);
+	// Plenty of bytes, but 1 ms per MB against a 2 ms budget.
+	UploadScheduler scheduler(MakeDesc(clock, 256 * MB, 2.0));
+
+	for (int i = 0; i < 6; ++i)
+	{
+		scheduler.Enqueue(recorder.MakeJob("job" + std::to_string(i), {MB}));
+	}
+
+	EXPECT_EQ(scheduler.Pump(), 2U);
+	EXPECT_DOUBLE_EQ(scheduler.GetStats().mLastFrameMs, 2.0);
+	EXPECT_EQ(scheduler.Pump(), 2U);
+	EXPECT_EQ(scheduler.Pump(), 2U);
+	EXPECT_EQ(scheduler.GetStats().mOverBudgetFrames, 0U);
+
+	// A single slice slower than the budget is a hitch, and counted.
+	scheduler.Enqueue(recorder.MakeJob("slow", {5 * MB}));
+	scheduler.Pump();
+	EXPECT_EQ(scheduler.GetStats().mOverBudgetFrames, 1U);
+	EXPECT_DOUBLE_EQ(scheduler.GetHitchHistogram().mWorstMs, 5.0);
+}
+
+TEST(UploadSchedulerTest, FailedSliceDropsTheRest)
+{
+	FakeClock clock;
+	UploadScheduler scheduler(MakeDesc(clock, 64 * MB));
+
+	std::vector<uint32_t> recorded;
+	UploadJob job;
+	job.mSliceBytes = {MB, MB, MB};
+	job.mRecord = [&recorded](uint32_t slice) {
+		recorded.push_back(slice);
+		return slice != 1;
+	};
+	scheduler.Enqueue(std::move(job));
+	scheduler.Pump();
+
+	EXPECT_EQ(recorded, std::vector<uint32_t>({0, 1}));
+	EXPECT_FALSE(scheduler.HasPending());
+	EXPECT_EQ(scheduler.GetStats().mJobsFailed, 1U);
+	EXPECT_EQ(scheduler.GetStats().mJobsCompleted, 0U);
+}
+
+TEST(UploadSchedulerTest, HistogramBucketsFrameTimes)
+{
+	UploadHitchHistogram histogram;
+	histogram.Add(0.1);
+	histogram.Add(0.5);
+	histogram.Add(1.5);
+	histogram.Add(20.0);
+	histogram.Add(100.0);
+
+	EXPECT_EQ(histogram.mCounts[0], 2U);
+	EXPECT_EQ(histogram.mCounts[2], 1U);
+	EXPECT_EQ(histogram.mCounts[6], 1U);
+	EXPECT_EQ(histogram.mCounts.back(), 1U);
+	EXPECT_EQ(histogram.GetTotal(), 5U);
+	EXPECT_DOUBLE_EQ(histogram.mWorstMs, 100.0);
+}
@@ -0,0 +1,175 @@
+// Single descriptor allocate and deferred free from 1 to 32 threads, through
+// the DescriptorSlotPool against one mutex around a RangeAllocator and a
+// fence queue, what BindlessAllocator would need without the pool. Each
+// thread holds a batch of slots, frees it with the current fence and takes
+// another, while the main thread advances the fence and processes
+// deletions like the frame loop. Not part of ctest, run by hand:
+//   descriptor_slot_bench [operations per thread]
+#include "graphics/DescriptorSlotPool.h"
+#include "graphics/RangeAllocator.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr uint32_t HEAP_SIZE = 1000000;
+	constexpr uint32_t BATCH = 32;
+	/// How far the pretend GPU runs behind.
+	constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+
+	class LockedAllocator
+	{
+	public:
+		uint32_t Allocate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			RangeAllocation allocation = mRanges.Allocate(1);
+			if (!allocation.IsValid())
+			{
+				return DescriptorSlotPool::INVALID_SLOT;
+			}
+			mNodes[allocation.mOffset] = allocation.mNode;
+			return allocation.mOffset;
+		}
+
+		void FreeDeferred(uint32_t slot, uint64_t fence)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mPending.push_back({fence, slot});
+		}
+
+		void ProcessDeletions(uint64_t completedFence)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			while (!mPending.empty() && mPending.front().first <= completedFence)
+			{
+				uint32_t slot = mPending.front().second;
+				mRanges.Free({slot, 1, mNodes[slot]});
+				mPending.pop_front();
+			}
+		}
+
+	private:
+		std::mutex mMutex;
+		RangeAllocator mRanges{HEAP_SIZE};
+		std::vector<uint32_t> mNodes = std::vector<uint32_t>(HEAP_SIZE);
+		std::deque<std::pair<uint64_t, uint32_t>> mPending;
+	};
+
+	class PoolAllocator
+	{
+	public:
+		PoolAllocator()
+		{
+			DescriptorSlotPoolDesc desc;
+			desc.mGrow = [this](uint32_t count)
+			{
+				RangeAllocation allocation = mRanges.Allocate(count);
+				return allocation.IsValid() ? allocation.mOffset : DescriptorSlotPool::INVALID_SLOT;
+			};
+			mPool = std::make_unique<DescriptorSlotPool>(desc);
+		}
+
+		uint32_t Allocate() { return mPool->Allocate(); }
+		void FreeDeferred(uint32_t slot, uint64_t fence) { mPool->FreeDeferred(slot, fence); }
+		void ProcessDeletions(uint64_t completedFence) { mPool->ProcessDeletions(completedFence); }
+
+	private:
+		RangeAllocator mRanges{HEAP_SIZE};
+		std::unique_ptr<DescriptorSlotPool> mPool;
+	};
+
+	/// Million allocations per second over all threads, each allocation
+	/// paired with a deferred free. stallCount is how often a thread found
+	/// the heap full and had to wait for the fence.
+	template <typename Allocator>
+	double Run(uint32_t threadCount, uint32_t operations, uint32_t& stallCount)
+	{
+		Allocator allocator;
+		std::atomic<uint64_t> fence{1};
+		std::atomic<uint32_t> running{threadCount};
+		std::atomic<uint32_t> stalls{0};
+
+		Clock::time_point start = Clock::now();
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back(
+				[&]
+				{
+					uint32_t batch[BATCH];
+					for (uint32_t done = 0; done < operations; done += BATCH)
+					{
+						for (uint32_t& slot : batch)
+						{
+							// Heap full of pending frees, wait for the frame
+							// loop like a loader would.
+							slot = allocator.Allocate();
+							while (slot == DescriptorSlotPool::INVALID_SLOT)
+							{
+								stalls++;
+								std::this_thread::yield();
+								slot = allocator.Allocate();
+							}
+						}
+						uint64_t current = fence.load(std::memory_order_relaxed);
+						for (uint32_t slot : batch)
+						{
+							allocator.FreeDeferred(slot, current);
+						}
+					}
+					running--;
+				});
+		}
+
+		while (running > 0)
+		{
+			uint64_t current = fence++;
+			if (current > FRAMES_IN_FLIGHT)
+			{
+				allocator.ProcessDeletions(current - FRAMES_IN_FLIGHT);
+			}
+			std::this_thread::yield();
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		stallCount = stalls;
+		return static_cast<double>(operations) * threadCount / seconds / 1e6;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	uint32_t operations = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1000000;
+
+	std::printf("threads   locked Mops/s   pool Mops/s   speedup\n");
+	for (uint32_t threadCount : {1U, 2U, 4U, 8U, 16U, 32U})
+	{
+		uint32_t lockedStalls = 0;
+		uint32_t poolStalls = 0;
+		double locked = Run<LockedAllocator>(threadCount, operations, lockedStalls);
+		double pool = Run<PoolAllocator>(threadCount, operations, poolStalls);
+		std::printf("%7u   %13.1f   %11.1f   %6.1fx", threadCount, locked, pool, pool / locked);
+		if (lockedStalls > 0 || poolStalls > 0)
+		{
+			std::printf("   (%u / %u stalls on a full heap)", lockedStalls, poolStalls);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
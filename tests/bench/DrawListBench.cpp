@@ -0,0 +1,200 @@
+// Building the frame's draw list the way Renderer::Render does, once with
+// entities holding shared_ptrs (a copy of the mesh pointer and the ORM
+// fallbacks per entity, all atomic refcount traffic) and once with 32-bit
+// handles resolved through a ResourceRegistry, on one thread and on
+// several. Not part of ctest, run by hand:
+//   draw_list_bench [entities] [frames]
+#include "graphics/ResourceRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct FakeMesh
+	{
+		uint32_t mIndexCount = 0;
+	};
+
+	struct FakeTexture
+	{
+		uint32_t mSrvIndex = 0;
+	};
+
+	struct SharedEntity
+	{
+		std::shared_ptr<FakeMesh> GetMesh() const { return mMesh; }
+
+		bool mVisible = true;
+		std::shared_ptr<FakeMesh> mMesh;
+		std::shared_ptr<FakeTexture> mAlbedo;
+		std::shared_ptr<FakeTexture> mNormal;
+		std::shared_ptr<FakeTexture> mMetallic;
+		std::shared_ptr<FakeTexture> mRoughness;
+		std::shared_ptr<FakeTexture> mOrm;
+	};
+
+	struct HandleEntity
+	{
+		Handle<FakeMesh> GetMesh() const { return mMesh; }
+
+		bool mVisible = true;
+		Handle<FakeMesh> mMesh;
+		Handle<FakeTexture> mAlbedo;
+		Handle<FakeTexture> mNormal;
+		Handle<FakeTexture> mMetallic;
+		Handle<FakeTexture> mRoughness;
+		Handle<FakeTexture> mOrm;
+	};
+
+	/// What goes into the root constants per draw.
+	struct DrawItem
+	{
+		uint32_t mIndexCount;
+		uint32_t mTextures[4];
+	};
+
+	uint32_t SrvIndex(const FakeTexture* texture)
+	{
+		return texture ? texture->mSrvIndex : 0;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	uint32_t entityCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100000;
+	uint32_t frames = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 200;
+
+	// A few dozen meshes and a few hundred textures shared between all
+	// the entities, like instanced scene content.
+	std::vector<std::shared_ptr<FakeMesh>> meshes(32);
+	std::vector<std::shared_ptr<FakeTexture>> textures(512);
+	ResourceRegistry<FakeMesh> meshRegistry;
+	ResourceRegistry<FakeTexture> textureRegistry;
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		meshes[i] = std::make_shared<FakeMesh>(FakeMesh{static_cast<uint32_t>(i * 3 + 36)});
+		meshRegistry.Add(meshes[i]);
+	}
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		textures[i] = std::make_shared<FakeTexture>(FakeTexture{static_cast<uint32_t>(i + 1)});
+		textureRegistry.Add(textures[i]);
+	}
+
+	std::vector<SharedEntity> sharedEntities(entityCount);
+	std::vector<HandleEntity> handleEntities(entityCount);
+	for (uint32_t i = 0; i < entityCount; ++i)
+	{
+		SharedEntity& shared = sharedEntities[i];
+		shared.mVisible = i % 10 != 0;
+		shared.mMesh = meshes[i % meshes.size()];
+		shared.mAlbedo = textures[(i * 4) % textures.size()];
+		shared.mNormal = textures[(i * 4 + 1) % textures.size()];
+		shared.mMetallic = textures[(i * 4 + 2) % textures.size()];
+		shared.mRoughness = textures[(i * 4 + 3) % textures.size()];
+		shared.mOrm = i % 2 == 0 ? textures[(i * 7) % textures.size()] : nullptr;
+
+		HandleEntity& handle = handleEntities[i];
+		handle.mVisible = shared.mVisible;
+		handle.mMesh = meshRegistry.Find(shared.mMesh.get());
+		handle.mAlbedo = textureRegistry.Find(shared.mAlbedo.get());
+		handle.mNormal = textureRegistry.Find(shared.mNormal.get());
+		handle.mMetallic = textureRegistry.Find(shared.mMetallic.get());
+		handle.mRoughness = textureRegistry.Find(shared.mRoughness.get());
+		handle.mOrm = textureRegistry.Find(shared.mOrm.get());
+	}
+
+	// Each thread builds the list for its slice of the entities, the way a
+	// parallel draw-list build would. The shared meshes and textures are
+	// what the threads fight over with refcounts.
+	auto run = [&](uint32_t threadCount, auto&& buildSlice) {
+		std::vector<std::thread> threads;
+		Clock::time_point begin = Clock::now();
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				uint32_t first = entityCount * t / threadCount;
+				uint32_t last = entityCount * (t + 1) / threadCount;
+				std::vector<DrawItem> drawList;
+				drawList.reserve(last - first);
+				for (uint32_t frame = 0; frame < frames; ++frame)
+				{
+					drawList.clear();
+					buildSlice(first, last, drawList);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		return std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / frames;
+	};
+
+	auto buildShared = [&](uint32_t first, uint32_t last, std::vector<DrawItem>& drawList) {
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const SharedEntity& entity = sharedEntities[i];
+			if (!entity.mVisible)
+			{
+				continue;
+			}
+			auto mesh = entity.GetMesh();
+			if (!mesh)
+			{
+				continue;
+			}
+			const std::shared_ptr<FakeTexture>& metallic =
+				entity.mOrm ? entity.mOrm : entity.mMetallic;
+			const std::shared_ptr<FakeTexture> roughness =
+				entity.mOrm ? nullptr : entity.mRoughness;
+			drawList.push_back({mesh->mIndexCount,
+								{SrvIndex(entity.mAlbedo.get()), SrvIndex(entity.mNormal.get()),
+								 SrvIndex(metallic.get()), SrvIndex(roughness.get())}});
+		}
+	};
+
+	auto buildHandles = [&](uint32_t first, uint32_t last, std::vector<DrawItem>& drawList) {
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const HandleEntity& entity = handleEntities[i];
+			if (!entity.mVisible)
+			{
+				continue;
+			}
+			const FakeMesh* mesh = meshRegistry.Get(entity.GetMesh());
+			if (!mesh)
+			{
+				continue;
+			}
+			const FakeTexture* metallic =
+				textureRegistry.Get(entity.mOrm ? entity.mOrm : entity.mMetallic);
+			const FakeTexture* roughness =
+				entity.mOrm ? nullptr : textureRegistry.Get(entity.mRoughness);
+			drawList.push_back({mesh->mIndexCount,
+								{SrvIndex(textureRegistry.Get(entity.mAlbedo)),
+								 SrvIndex(textureRegistry.Get(entity.mNormal)),
+								 SrvIndex(metallic), SrvIndex(roughness)}});
+		}
+	};
+
+	std::printf("%u entities, %u frames\n", entityCount, frames);
+	uint32_t maxThreads = std::max(1U, std::thread::hardware_concurrency());
+	for (uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		double sharedMs = run(threadCount, buildShared);
+		double handleMs = run(threadCount, buildHandles);
+		std::printf("  %2u threads: shared_ptr %.3f ms/frame, handles %.3f ms/frame (%.2fx)\n",
+					threadCount, sharedMs, handleMs, sharedMs / handleMs);
+	}
+	return 0;
+}
@@ -0,0 +1,143 @@
+// Decode throughput for the PNG/JPEG/TGA texture path. Not part of ctest,
+// run by hand:  image_decode_bench [imageCount] [imageSize]
+#include "graphics/texture/ImageDecoder.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+using namespace TextureTools;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	void AppendBytes(void* context, void* data, int size)
+	{
+		auto* out = static_cast<std::vector<uint8_t>*>(context);
+		auto* bytes = static_cast<uint8_t*>(data);
+		out->insert(out->end(), bytes, bytes + size);
+	}
+
+	/// Gradient plus some noise, compresses roughly like a real albedo map.
+	std::vector<uint8_t> MakeSourcePixels(uint32_t size, uint32_t channels, uint32_t seed)
+	{
+		std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * channels);
+		uint32_t state = seed * 747796405U + 2891336453U;
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				state = state * 1664525U + 1013904223U;
+				uint8_t noise = static_cast<uint8_t>(state >> 28);
+				uint8_t* px = pixels.data() + (static_cast<size_t>(y) * size + x) * channels;
+				for (uint32_t c = 0; c < channels; ++c)
+				{
+					px[c] = static_cast<uint8_t>(((x + y * c + seed) & 0xFF) ^ noise);
+				}
+			}
+		}
+		return pixels;
+	}
+
+	std::vector<uint8_t> Encode(const char* format, uint32_t size, uint32_t seed)
+	{
+		std::vector<uint8_t> encoded;
+		int s = static_cast<int>(size);
+		if (format[0] == 'p')
+		{
+			std::vector<uint8_t> pixels = MakeSourcePixels(size, 4, seed);
+			stbi_write_png_to_func(AppendBytes, &encoded, s, s, 4, pixels.data(), s * 4);
+		}
+		else if (format[0] == 'j')
+		{
+			std::vector<uint8_t> pixels = MakeSourcePixels(size, 3, seed);
+			stbi_write_jpg_to_func(AppendBytes, &encoded, s, s, 3, pixels.data(), 90);
+		}
+		else
+		{
+			std::vector<uint8_t> pixels = MakeSourcePixels(size, 3, seed);
+			stbi_write_tga_to_func(AppendBytes, &encoded, s, s, 3, pixels.data());
+		}
+		return encoded;
+	}
+
+	double Seconds(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	uint32_t imageCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 48;
+	uint32_t imageSize = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 1024;
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "jar_decode_bench";
+	std::filesystem::create_directories(dir);
+
+	const char* formats[] = {"png", "jpg", "tga"};
+	for (const char* format : formats)
+	{
+		std::vector<std::filesystem::path> paths;
+		size_t totalBytes = 0;
+		for (uint32_t i = 0; i < imageCount; ++i)
+		{
+			std::vector<uint8_t> encoded = Encode(format, imageSize, i);
+			totalBytes += encoded.size();
+
+			paths.push_back(dir / ("image" + std::to_string(i) + "." + format));
+			std::ofstream file(paths.back(), std::ios::binary);
+			file.write(reinterpret_cast<const char*>(encoded.data()),
+					   static_cast<std::streamsize>(encoded.size()));
+		}
+
+		std::printf("%s: %u images, %ux%u, %.1f MB on disk\n", format, imageCount, imageSize,
+					imageSize, static_cast<double>(totalBytes) / (1024.0 * 1024.0));
+
+		double megapixels =
+			static_cast<double>(imageCount) * imageSize * imageSize / (1000.0 * 1000.0);
+
+		uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1U);
+		for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			// The caller helps in ParallelFor, so the pool gets one less.
+			Utils::ThreadPool pool(std::max(threads - 1, 1U));
+			StagingPool staging;
+
+			// Warm up the page cache and the staging pool.
+			for (DecodeResult& result : DecodeImageFiles(paths, pool, &staging))
+			{
+				staging.Release(std::move(result.mImage.mPixels));
+			}
+
+			Clock::time_point start = Clock::now();
+			std::vector<DecodeResult> results = DecodeImageFiles(paths, pool, &staging);
+			double seconds = Seconds(start);
+
+			uint32_t failed = 0;
+			for (DecodeResult& result : results)
+			{
+				failed += result.mSuccess ? 0 : 1;
+				staging.Release(std::move(result.mImage.mPixels));
+			}
+
+			std::printf("  %2u threads: %8.1f images/s %8.1f MP/s %s\n", threads,
+						imageCount / seconds, megapixels / seconds, failed ? "(failures!)" : "");
+		}
+
+		for (const std::filesystem::path& path : paths)
+		{
+			std::filesystem::remove(path);
+		}
+	}
+
+	std::filesystem::remove_all(dir);
+	return 0;
+}
@@ -0,0 +1,116 @@
+// KTX2 (Basis ETC1S/UASTC) against DDS: bytes read, read time, transcode
+// time and throughput. Not part of ctest, run by hand with real assets:
+//   ktx2_bench texture.ktx2 [texture.dds] [iterations]
+#include "graphics/texture/Ktx2Transcoder.h"
+#include "utils/FileUtils.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace TextureTools;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double Milliseconds(Clock::time_point start, Clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::printf("usage: ktx2_bench texture.ktx2 [texture.dds] [iterations]\n");
+		return 1;
+	}
+
+	std::filesystem::path ktx2Path = argv[1];
+	std::filesystem::path ddsPath = argc > 2 ? argv[2] : "";
+	uint32_t iterations = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 10;
+
+	std::vector<uint8_t> fileData;
+	if (!Utils::ReadBinaryFile(ktx2Path, fileData))
+	{
+		std::printf("failed to read %s\n", ktx2Path.string().c_str());
+		return 1;
+	}
+
+	uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1U);
+	for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		// The caller helps in ParallelFor, so threads - 1 workers. The
+		// single thread row has no pool at all.
+		std::unique_ptr<Utils::ThreadPool> pool;
+		if (threads > 1)
+		{
+			pool = std::make_unique<Utils::ThreadPool>(threads - 1);
+		}
+
+		double readMs = 0.0;
+		double transcodeMs = 0.0;
+		TranscodedTexture texture;
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			Clock::time_point start = Clock::now();
+			Utils::ReadBinaryFile(ktx2Path, fileData);
+			Clock::time_point read = Clock::now();
+
+			std::string error;
+			bool ok = pool ? TranscodeKtx2(fileData.data(), fileData.size(), texture, *pool, &error)
+						   : TranscodeKtx2(fileData.data(), fileData.size(), texture, &error);
+			if (!ok)
+			{
+				std::printf("transcode failed: %s\n", error.c_str());
+				return 1;
+			}
+			Clock::time_point done = Clock::now();
+
+			readMs += Milliseconds(start, read);
+			transcodeMs += Milliseconds(read, done);
+		}
+
+		readMs /= iterations;
+		transcodeMs /= iterations;
+		double megapixels = static_cast<double>(texture.mWidth) * texture.mHeight / 1.0e6;
+
+		if (threads == 1)
+		{
+			std::printf("%s: %s %ux%u, %zu mips\n", ktx2Path.filename().string().c_str(),
+						texture.mIsUASTC ? "UASTC" : "ETC1S", texture.mWidth, texture.mHeight,
+						texture.mLevels.size());
+			std::printf("  bytes read %zu KB, BC7 output %zu KB\n", fileData.size() / 1024,
+						texture.mDataSize / 1024);
+		}
+
+		std::printf("  %2u threads: read %.2f ms, transcode %.2f ms (%.1f MP/s, %.1f MB/s BC7), "
+					"load %.2f ms\n",
+					threads, readMs, transcodeMs, megapixels / (transcodeMs / 1000.0),
+					texture.mDataSize / (1024.0 * 1024.0) / (transcodeMs / 1000.0),
+					readMs + transcodeMs);
+	}
+
+	if (!ddsPath.empty())
+	{
+		// DDS is already in its GPU format, loading it is just the read.
+		double readMs = 0.0;
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			Clock::time_point start = Clock::now();
+			Utils::ReadBinaryFile(ddsPath, fileData);
+			readMs += Milliseconds(start, Clock::now());
+		}
+
+		std::printf("%s: bytes read %zu KB, load %.2f ms\n", ddsPath.filename().string().c_str(),
+					fileData.size() / 1024, readMs / iterations);
+	}
+
+	return 0;
+}
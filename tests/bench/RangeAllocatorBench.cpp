@@ -0,0 +1,135 @@
+// Descriptor range churn through the RangeAllocator against the old exact
+// size free list BindlessAllocator used, on the 1,000,000 descriptor heap.
+// Reports the allocation rate, how fragmented the free space ends up and
+// how many allocations failed with room left. Not part of ctest, run by hand:
+//   range_allocator_bench [operations] [fill percent]
+#include "graphics/RangeAllocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr uint32_t HEAP_SIZE = 1000000;
+
+	/// What BindlessAllocator did before: reuse only blocks of exactly the
+	/// same size, otherwise bump the end of the heap.
+	class ExactSizeFreeList
+	{
+	public:
+		RangeAllocation Allocate(uint32_t size)
+		{
+			auto it = mFreeList.find(size);
+			if (it != mFreeList.end() && !it->second.empty())
+			{
+				uint32_t offset = it->second.back();
+				it->second.pop_back();
+				return {offset, size, 0};
+			}
+			if (mNext + size > HEAP_SIZE)
+			{
+				return {};
+			}
+			RangeAllocation allocation{mNext, size, 0};
+			mNext += size;
+			return allocation;
+		}
+
+		bool Free(const RangeAllocation& allocation)
+		{
+			mFreeList[allocation.mSize].push_back(allocation.mOffset);
+			return true;
+		}
+
+	private:
+		std::map<uint32_t, std::vector<uint32_t>> mFreeList;
+		uint32_t mNext = 0;
+	};
+
+	struct Result
+	{
+		double mNsPerOperation = 0.0;
+		uint32_t mFailures = 0;
+		uint32_t mLive = 0;
+	};
+
+	/// Loads and unloads around fillPercent of the heap: single texture
+	/// SRVs mostly, some tables of 2 to 64.
+	template <typename Allocator>
+	Result Churn(Allocator& allocator, uint32_t operations, uint32_t fillPercent)
+	{
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<uint32_t> percent(0, 99);
+		std::uniform_int_distribution<uint32_t> table(2, 64);
+
+		std::vector<RangeAllocation> live;
+		uint64_t liveSize = 0;
+		const uint64_t target = static_cast<uint64_t>(HEAP_SIZE) * fillPercent / 100;
+
+		Result result;
+		Clock::time_point start = Clock::now();
+		for (uint32_t i = 0; i < operations; ++i)
+		{
+			bool allocate = liveSize < target ? percent(rng) < 60 : percent(rng) < 40;
+			if (allocate || live.empty())
+			{
+				uint32_t size = percent(rng) < 70 ? 1 : table(rng);
+				RangeAllocation allocation = allocator.Allocate(size);
+				if (!allocation.IsValid())
+				{
+					result.mFailures++;
+					continue;
+				}
+				live.push_back(allocation);
+				liveSize += size;
+			}
+			else
+			{
+				size_t index = rng() % live.size();
+				allocator.Free(live[index]);
+				liveSize -= live[index].mSize;
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		result.mNsPerOperation = ns / operations;
+		result.mLive = static_cast<uint32_t>(live.size());
+		return result;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	uint32_t operations = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 5000000;
+	uint32_t fillPercent = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 80;
+
+	{
+		ExactSizeFreeList allocator;
+		Result result = Churn(allocator, operations, fillPercent);
+		std::printf("exact size list: %6.1f ns/op, %u live, %u failed\n", result.mNsPerOperation,
+					result.mLive, result.mFailures);
+	}
+
+	{
+		RangeAllocator allocator(HEAP_SIZE);
+		Result result = Churn(allocator, operations, fillPercent);
+		const RangeAllocatorStats& stats = allocator.GetStats();
+		std::printf("range allocator: %6.1f ns/op, %u live, %u failed, %u free ranges, "
+					"largest %u of %u free (%.1f%% fragmented), %llu splits, %llu merges\n",
+					result.mNsPerOperation, result.mLive, result.mFailures, stats.mFreeRanges,
+					allocator.GetLargestFreeRange(), allocator.GetFreeSize(),
+					allocator.GetFragmentation() * 100.0F,
+					static_cast<unsigned long long>(stats.mSplits),
+					static_cast<unsigned long long>(stats.mMerges));
+	}
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+// Per-frame constant allocation through the RingAllocator with a fake fence
+// that runs a few frames behind, at scene sizes past the old 64 slot
+// buffers. Not part of ctest, run by hand:
+//   ring_allocator_bench [frames] [latency]
+#include "graphics/RingAllocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Graphics;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	/// Same sizes as Transform and MaterialConstants.
+	struct FakeTransform
+	{
+		float mMatrices[48];
+	};
+	struct FakeMaterial
+	{
+		float mValues[40];
+	};
+} // namespace
+
+int main(int argc, char** argv)
+{
+	uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 200;
+	uint64_t latency = argc > 2 ? static_cast<uint64_t>(std::atoi(argv[2])) : 2;
+
+	for (uint32_t entities : {64U, 1000U, 10000U})
+	{
+		uint32_t pagesCreated = 0;
+		RingAllocator allocator([&](size_t size, RingPage& page) {
+			auto memory = std::make_shared<std::vector<uint8_t>>(size);
+			page.mCpuAddress = memory->data();
+			page.mGpuAddress = 0x10000ULL * (++pagesCreated);
+			page.mSize = size;
+			page.mResource = memory;
+			return true;
+		});
+
+		FakeTransform transform = {};
+		FakeMaterial material = {};
+
+		Clock::time_point start = Clock::now();
+		for (uint64_t frame = 1; frame <= frames; ++frame)
+		{
+			allocator.Retire(frame > latency ? frame - latency : 0);
+			for (uint32_t i = 0; i < entities; ++i)
+			{
+				transform.mMatrices[0] = static_cast<float>(i);
+				allocator.Push(transform);
+				allocator.Push(material);
+			}
+			allocator.EndFrame(frame);
+		}
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		const RingAllocatorStats& stats = allocator.GetStats();
+		double perAllocationNs = ms * 1.0e6 / (static_cast<double>(frames) * entities * 2);
+		std::printf("%5u entities: %.3f ms/frame, %.1f ns/allocation, %u pages (%zu KB), "
+					"peak frame %zu KB, %u failed\n",
+					entities, ms / frames, perAllocationNs, stats.mPageCount,
+					stats.mPageCount * RingAllocatorDesc().mPageSize / 1024,
+					stats.mPeakFrameBytes / 1024, stats.mFailedAllocations);
+	}
+
+	return 0;
+}